@@ -0,0 +1,427 @@
+#ifndef ACTIVITY_HISTORY_H
+#define ACTIVITY_HISTORY_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <Preferences.h>
+#include "Tasks.h"
+#include "Profiler.h"
+#include "WeekSchedule.h"
+
+// What is recorded per bucket
+enum HistoryField : uint8_t {
+  HISTORY_JIGGLES,
+  HISTORY_CONNECTED,    // seconds
+  HISTORY_DISCONNECTS,
+  HISTORY_RSSI_MIN,     // weakest reading, as -dBm (0: no reading)
+  HISTORY_RSSI_AVG,     // mean reading, as -dBm (0: no reading)
+  HISTORY_FIELDS
+};
+
+// Activity over the last day and month in fixed memory, in the manner of
+// RRD: a ring of 1440 one-minute buckets and a ring of 720 one-hour
+// buckets on the uptime clock. Each minute that closes is added to the
+// hour it belongs to, and the hour is stored when its 60th minute closes,
+// so recording and rolling up are O(1) per event and per minute.
+//
+// Buckets are bit-packed (a minute in 32 bits, an hour in 64); counts that
+// do not fit their field stop at its maximum. Only closed buckets are
+// stored and exported.
+//
+// The hour ring survives reboots: it is saved to NVS in blocks of 24
+// hours, and each hour that closes rewrites its block (one small write an
+// hour). Boot takes the newest block that checks out for the count of
+// closed hours, and from every block the hours that are still in that
+// ring. The minutes and the open hour start empty. Each block also holds
+// the local time its newest hour ended at; once the clock is known again
+// (setClock()), the time the device was off is added as empty hours.
+//
+// The export format (see startExport()) sends each field of a ring as a
+// column of zigzag varint deltas, oldest first: a quiet hour is one byte
+// per field and bucket.
+class ActivityHistory {
+public:
+  static const uint16_t MINUTES = 24 * 60;
+  static const uint16_t HOURS = 30 * 24;
+  static const uint8_t VERSION = 1;
+  static const uint8_t HEADER_SIZE = 16;
+  static const uint8_t BLOCK_HOURS = 24;
+  static const uint8_t BLOCKS = HOURS / BLOCK_HOURS;
+
+  struct Cursor {
+    uint8_t part;    // 0 header, 1 minutes, 2 hours, 3 done
+    uint8_t field;
+    uint16_t index;  // within the ring's stored buckets, oldest first
+    uint16_t previous;
+    uint16_t minutes;  // stored when the export started
+    uint16_t hours;
+    uint32_t minuteEnd;  // buckets closed so far when the export started
+    uint32_t hourEnd;
+    uint32_t uptimeMinutes;
+    uint16_t sinceHour;
+  };
+
+private:
+  static const int64_t MINUTE_US = 60000000;
+  static const int64_t HOUR_US = 60 * MINUTE_US;
+
+  // BLOCK_HOURS of the hour ring as saved in NVS
+  struct Block {
+    uint64_t hours[BLOCK_HOURS];
+    int64_t endUs;         // local time the newest hour ended, 0 if unknown
+    uint32_t hoursClosed;  // when it was saved
+    uint32_t check;        // FNV-1a of the fields above
+  };
+
+  // Field widths, in HistoryField order
+  static const uint8_t* minuteBits() {
+    static const uint8_t bits[HISTORY_FIELDS] = {8, 6, 4, 7, 7};
+    return bits;
+  }
+  static const uint8_t* hourBits() {
+    static const uint8_t bits[HISTORY_FIELDS] = {16, 12, 8, 7, 7};
+    return bits;
+  }
+
+  // An open bucket, summed as events come in
+  struct Totals {
+    uint32_t jiggles;
+    uint32_t connectedUs;
+    uint32_t disconnects;
+    uint32_t rssiWorst;
+    uint32_t rssiSum;
+    uint32_t rssiCount;
+
+    void values(uint16_t* v, uint32_t connectedSeconds) const {
+      v[HISTORY_JIGGLES] = jiggles > 0xFFFF ? 0xFFFF : jiggles;
+      v[HISTORY_CONNECTED] = connectedSeconds;
+      v[HISTORY_DISCONNECTS] = disconnects > 0xFFFF ? 0xFFFF : disconnects;
+      v[HISTORY_RSSI_MIN] = rssiWorst;
+      v[HISTORY_RSSI_AVG] = rssiCount ? (rssiSum + rssiCount / 2) / rssiCount : 0;
+    }
+  };
+
+  Mutex mutex;
+  Preferences preferences;
+  WallClock* clock = nullptr;
+  uint32_t minuteRing[MINUTES];
+  uint64_t hourRing[HOURS];
+  uint32_t minutesClosed = 0;  // ever; the newest is at (minutesClosed - 1) % MINUTES
+  uint32_t hoursClosed = 0;
+  int64_t openMinute = 0;      // index on the uptime clock
+  Totals minute = {};
+  Totals hour = {};            // connectedUs holds whole seconds here
+  uint8_t hourMinutes = 0;     // minutes already in hour
+  bool connected = false;
+  int64_t connectedMark = 0;   // connected time up to here is counted
+  int64_t bootMinute = 0;      // openMinute at begin()
+  uint32_t restoredHours = 0;  // hoursClosed at begin()
+  int64_t offSince = 0;        // local time the restored hours ended; 0 once counted
+
+  static uint64_t pack(const uint16_t* v, const uint8_t* bits) {
+    uint64_t packed = 0;
+    uint8_t shift = 0;
+    for (uint8_t f = 0; f < HISTORY_FIELDS; f++) {
+      uint32_t max = (1UL << bits[f]) - 1;
+      packed |= (uint64_t)(v[f] > max ? max : v[f]) << shift;
+      shift += bits[f];
+    }
+    return packed;
+  }
+
+  static uint16_t unpack(uint64_t packed, const uint8_t* bits, uint8_t field) {
+    uint8_t shift = 0;
+    for (uint8_t f = 0; f < field; f++) shift += bits[f];
+    return (packed >> shift) & ((1UL << bits[field]) - 1);
+  }
+
+  static uint32_t checksum(const Block& b) {
+    const uint8_t* p = (const uint8_t*)&b;
+    uint32_t h = 2166136261u;
+    for (size_t i = 0; i < offsetof(Block, check); i++) h = (h ^ p[i]) * 16777619u;
+    return h;
+  }
+
+  // The hour a ring slot holds once `closed` hours have closed; -1 if none
+  static int64_t hourIn(uint16_t slot, uint32_t closed) {
+    if (closed <= slot) return -1;
+    return closed - 1 - (closed - 1 - slot) % HOURS;
+  }
+
+  // Everything below holds the mutex
+
+  // Local time at uptimeUs, 0 while the clock is unknown
+  int64_t localAt(int64_t uptimeUs) {
+    int64_t us;
+    return clock && clock->localUs(uptimeUs, us) ? us : 0;
+  }
+
+  bool readBlock(uint8_t i, Block& b) {
+    char name[4];
+    snprintf(name, sizeof(name), "h%u", i);
+    return preferences.getBytes(name, &b, sizeof(b)) == sizeof(b) && b.check == checksum(b);
+  }
+
+  void saveBlock(uint8_t i) {
+    PROFILE_SCOPE(PROF_NVS_WRITE);
+    Block b;
+    memcpy(b.hours, hourRing + i * BLOCK_HOURS, sizeof(b.hours));
+    b.endUs = localAt((openMinute - hourMinutes) * MINUTE_US);
+    b.hoursClosed = hoursClosed;
+    b.check = checksum(b);
+    char name[4];
+    snprintf(name, sizeof(name), "h%u", i);
+    preferences.putBytes(name, &b, sizeof(b));
+  }
+
+  void load() {
+    Block b;
+    bool found = false;
+    for (uint8_t i = 0; i < BLOCKS; i++) {
+      if (!readBlock(i, b)) continue;
+      if (!found || (int32_t)(b.hoursClosed - hoursClosed) > 0) {
+        found = true;
+        hoursClosed = b.hoursClosed;
+        offSince = b.endUs;
+      }
+    }
+    // A slot is kept if its block was saved while it held the same hour;
+    // the rest (a block lost or not yet written this time round) stay empty
+    for (uint8_t i = 0; found && i < BLOCKS; i++) {
+      if (!readBlock(i, b)) continue;
+      for (uint8_t k = 0; k < BLOCK_HOURS; k++) {
+        uint16_t slot = i * BLOCK_HOURS + k;
+        int64_t hour = hourIn(slot, hoursClosed);
+        if (hour >= 0 && hour == hourIn(slot, b.hoursClosed)) hourRing[slot] = b.hours[k];
+      }
+    }
+    restoredHours = hoursClosed;
+  }
+
+  // Hours from..to-1, reversed in place in the ring (to - from <= HOURS)
+  void reverseHours(uint32_t from, uint32_t to) {
+    for (; from + 1 < to; from++, to--) {
+      uint64_t t = hourRing[from % HOURS];
+      hourRing[from % HOURS] = hourRing[(to - 1) % HOURS];
+      hourRing[(to - 1) % HOURS] = t;
+    }
+  }
+
+  // Once the clock is known: put the hours the device was off between the
+  // restored hours and the ones closed since boot, as empty hours
+  void countOffTime() {
+    int64_t bootUs = localAt(bootMinute * MINUTE_US);
+    if (!bootUs) return;
+    int64_t off = bootUs - offSince;
+    offSince = 0;
+    if (off < HOUR_US / 2) return;
+    uint32_t gap = off > (int64_t)HOURS * HOUR_US ? HOURS : (off + HOUR_US / 2) / HOUR_US;
+
+    // Rotate the hours from `first` on right by gap (three reversals): the
+    // hours since boot move up, and what comes round to the front is
+    // cleared where the gap falls
+    uint32_t end = hoursClosed + gap;
+    uint32_t first = end - restoredHours > HOURS ? end - HOURS : restoredHours;
+    reverseHours(first, end);
+    reverseHours(first, first + gap);
+    reverseHours(first + gap, end);
+    for (uint32_t h = first; h < restoredHours + gap; h++) hourRing[h % HOURS] = 0;
+    hoursClosed = end;
+    for (uint8_t i = 0; i < BLOCKS; i++) saveBlock(i);
+  }
+
+  void countConnected(int64_t untilUs) {
+    if (connected && untilUs > connectedMark) minute.connectedUs += untilUs - connectedMark;
+    connectedMark = untilUs;
+  }
+
+  void closeMinute() {
+    countConnected((openMinute + 1) * MINUTE_US);
+    uint32_t seconds = (minute.connectedUs + 500000) / 1000000;
+    uint16_t v[HISTORY_FIELDS];
+    minute.values(v, seconds > 60 ? 60 : seconds);
+    minuteRing[minutesClosed % MINUTES] = pack(v, minuteBits());
+    minutesClosed++;
+
+    hour.jiggles += minute.jiggles;
+    hour.connectedUs += v[HISTORY_CONNECTED];
+    hour.disconnects += minute.disconnects;
+    if (minute.rssiWorst > hour.rssiWorst) hour.rssiWorst = minute.rssiWorst;
+    hour.rssiSum += minute.rssiSum;
+    hour.rssiCount += minute.rssiCount;
+    minute = {};
+    openMinute++;
+
+    if (++hourMinutes == 60) {
+      hour.values(v, hour.connectedUs);
+      hourRing[hoursClosed % HOURS] = pack(v, hourBits());
+      hoursClosed++;
+      hour = {};
+      hourMinutes = 0;
+      saveBlock((hoursClosed - 1) % HOURS / BLOCK_HOURS);
+    }
+  }
+
+  void advance(int64_t nowUs) {
+    while (nowUs >= (openMinute + 1) * MINUTE_US) closeMinute();
+  }
+
+  static uint16_t stored(uint32_t closed, uint16_t size) {
+    return closed < size ? closed : size;
+  }
+
+  static size_t putVarint(uint8_t* out, uint32_t v) {
+    size_t n = 0;
+    while (v >= 0x80) {
+      out[n++] = v | 0x80;
+      v >>= 7;
+    }
+    out[n++] = v;
+    return n;
+  }
+
+public:
+  // Load the hours saved before the last reboot
+  void begin(int64_t nowUs) {
+    mutex.begin();
+    LockGuard guard(&mutex);
+    memset(minuteRing, 0, sizeof(minuteRing));
+    memset(hourRing, 0, sizeof(hourRing));
+    openMinute = nowUs / MINUTE_US;
+    bootMinute = openMinute;
+    connectedMark = nowUs;
+    preferences.begin("history", false);
+    load();
+  }
+
+  // Local time, for the time the device was off and for saved hours
+  void setClock(WallClock* c) {
+    LockGuard guard(&mutex);
+    clock = c;
+  }
+
+  void setConnected(bool on, int64_t nowUs) {
+    LockGuard guard(&mutex);
+    advance(nowUs);
+    if (on == connected) return;
+    countConnected(nowUs);
+    connected = on;
+    if (!on) minute.disconnects++;
+  }
+
+  void jiggled(int64_t nowUs) {
+    LockGuard guard(&mutex);
+    advance(nowUs);
+    minute.jiggles++;
+  }
+
+  void addRssi(int8_t dBm, int64_t nowUs) {
+    LockGuard guard(&mutex);
+    advance(nowUs);
+    uint32_t magnitude = dBm >= -1 ? 1 : dBm < -127 ? 127 : -dBm;
+    if (magnitude > minute.rssiWorst) minute.rssiWorst = magnitude;
+    minute.rssiSum += magnitude;
+    minute.rssiCount++;
+  }
+
+  // Close the buckets whose time is up; at least once a minute
+  void tick(int64_t nowUs) {
+    LockGuard guard(&mutex);
+    advance(nowUs);
+    if (offSince) countOffTime();
+  }
+
+  // Closed buckets, newest first: ago 0 is the last minute (hour) that closed
+  bool getMinute(uint16_t ago, uint16_t* v) {
+    LockGuard guard(&mutex);
+    if (ago >= stored(minutesClosed, MINUTES)) return false;
+    uint32_t packed = minuteRing[(minutesClosed - 1 - ago) % MINUTES];
+    for (uint8_t f = 0; f < HISTORY_FIELDS; f++) v[f] = unpack(packed, minuteBits(), f);
+    return true;
+  }
+
+  bool getHour(uint16_t ago, uint16_t* v) {
+    LockGuard guard(&mutex);
+    if (ago >= stored(hoursClosed, HOURS)) return false;
+    uint64_t packed = hourRing[(hoursClosed - 1 - ago) % HOURS];
+    for (uint8_t f = 0; f < HISTORY_FIELDS; f++) v[f] = unpack(packed, hourBits(), f);
+    return true;
+  }
+
+  // Binary export, written a chunk at a time so the lock is never held for
+  // long. The header (16 bytes, little endian):
+  //
+  //   'A' 'H' version fields
+  //   u16 minutes, u16 hours   buckets that follow in each ring
+  //   u32 uptime in minutes at the end of the newest minute
+  //   u16 minutes from the end of the newest hour to that point
+  //   u16 0
+  //
+  // then for the minutes and then the hours, each field in HistoryField
+  // order as a column of zigzag varint deltas, oldest bucket first, the
+  // first one from 0. A minute that closes during the export may replace
+  // the oldest one.
+  void startExport(Cursor& c) {
+    LockGuard guard(&mutex);
+    c = {};
+    c.minutes = stored(minutesClosed, MINUTES);
+    c.hours = stored(hoursClosed, HOURS);
+    c.minuteEnd = minutesClosed;
+    c.hourEnd = hoursClosed;
+    c.uptimeMinutes = openMinute;
+    c.sinceHour = hourMinutes;
+  }
+
+  // Next bytes of the export, at most size (at least 16); 0 at the end
+  size_t exportChunk(Cursor& c, uint8_t* out, size_t size) {
+    size_t used = 0;
+    if (c.part == 0) {
+      if (size < HEADER_SIZE) return 0;
+      memset(out, 0, HEADER_SIZE);
+      out[0] = 'A';
+      out[1] = 'H';
+      out[2] = VERSION;
+      out[3] = HISTORY_FIELDS;
+      out[4] = c.minutes;
+      out[5] = c.minutes >> 8;
+      out[6] = c.hours;
+      out[7] = c.hours >> 8;
+      for (uint8_t i = 0; i < 4; i++) out[8 + i] = c.uptimeMinutes >> (8 * i);
+      out[12] = c.sinceHour;
+      out[13] = c.sinceHour >> 8;
+      used = HEADER_SIZE;
+      c.part = 1;
+    }
+
+    LockGuard guard(&mutex);
+
+    while (c.part < 3 && used + 3 <= size) {
+      bool minutes = c.part == 1;
+      uint16_t count = minutes ? c.minutes : c.hours;
+      if (c.index == count) {
+        c.index = 0;
+        c.previous = 0;
+        if (++c.field == HISTORY_FIELDS) {
+          c.field = 0;
+          c.part++;
+        }
+        continue;
+      }
+      uint16_t value;
+      if (minutes) {
+        value = unpack(minuteRing[(c.minuteEnd - count + c.index) % MINUTES], minuteBits(), c.field);
+      } else {
+        value = unpack(hourRing[(c.hourEnd - count + c.index) % HOURS], hourBits(), c.field);
+      }
+      int32_t delta = (int32_t)value - c.previous;
+      used += putVarint(out + used, (uint32_t)((delta << 1) ^ (delta >> 31)));
+      c.previous = value;
+      c.index++;
+    }
+    return used;
+  }
+};
+
+#endif
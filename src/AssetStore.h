@@ -0,0 +1,212 @@
+#ifndef ASSET_STORE_H
+#define ASSET_STORE_H
+
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include "fonts.h"
+
+#ifdef ARDUINO
+#include <esp_partition.h>
+#include <esp_idf_version.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+// Read-only asset archive (fonts, images, web page) kept in its own flash
+// partition, so it can be flashed without rebuilding the firmware.
+//
+// The archive is built by tools/pack_assets.py and memory-mapped as a
+// whole; find() returns pointers straight into flash, nothing is copied.
+// Off the device the same archive is mapped from a file, so the reader and
+// the renderer can be run against it on a PC.
+//
+// Layout, little endian, every offset from the start of the archive:
+//   header   magic "JGAS", u16 format, u16 count, u32 version, u32 size,
+//            u32 crc32 of bytes [32, size), u32 page version (the
+//            JigglerWebServer::PAGE_VERSION the page was packed from, 0 in
+//            older archives), 8 reserved bytes
+//   entries  count x {char name[24], u32 offset, u32 size, u16 width, u16 height}
+//   data     4-byte aligned
+class AssetStore {
+public:
+  static const uint16_t FORMAT = 1;
+
+  struct Entry {
+    char name[24];   // NUL padded
+    uint32_t offset;
+    uint32_t size;
+    uint16_t width;  // images: pixels; 0 otherwise
+    uint16_t height;
+  };
+
+private:
+  struct Header {
+    char magic[4];
+    uint16_t format;
+    uint16_t count;
+    uint32_t version;
+    uint32_t size;
+    uint32_t crc;
+    uint32_t pageVersion;
+    uint8_t reserved[8];
+  };
+
+  // Font entries: this header, a 96-byte remap table when remapped (glyph
+  // index for ' '..'~', last byte padding), then the glyphs
+  struct FontHeader {
+    uint16_t width;
+    uint16_t height;
+    uint8_t packed;
+    uint8_t remapped;
+    uint16_t glyphs;
+  };
+
+  const uint8_t* base = nullptr;
+  uint32_t length = 0;
+#ifdef ARDUINO
+#if ESP_IDF_VERSION_MAJOR >= 5
+  esp_partition_mmap_handle_t handle;
+#else
+  spi_flash_mmap_handle_t handle;
+#endif
+#else
+  size_t mapped = 0;
+#endif
+
+  static uint32_t crc32(const uint8_t* data, uint32_t n) {
+    uint32_t crc = 0xFFFFFFFF;
+    while (n--) {
+      crc ^= *data++;
+      for (uint8_t k = 0; k < 8; k++) crc = (crc >> 1) ^ (0xEDB88320 & (0 - (crc & 1)));
+    }
+    return ~crc;
+  }
+
+  const Header* header() const { return (const Header*)base; }
+  const Entry* entries() const { return (const Entry*)(base + sizeof(Header)); }
+
+  // Map the archive source; sets base and length
+  bool map(const char* source) {
+#ifdef ARDUINO
+    const esp_partition_t* part = esp_partition_find_first(ESP_PARTITION_TYPE_DATA,
+                                                           ESP_PARTITION_SUBTYPE_ANY, source);
+    if (!part) return false;
+    const void* ptr;
+#if ESP_IDF_VERSION_MAJOR >= 5
+    if (esp_partition_mmap(part, 0, part->size, ESP_PARTITION_MMAP_DATA, &ptr, &handle) != ESP_OK) return false;
+#else
+    if (esp_partition_mmap(part, 0, part->size, SPI_FLASH_MMAP_DATA, &ptr, &handle) != ESP_OK) return false;
+#endif
+    base = (const uint8_t*)ptr;
+    length = part->size;
+#else
+    int fd = open(source, O_RDONLY);
+    if (fd < 0) return false;
+    struct stat st;
+    void* ptr = fstat(fd, &st) == 0 && st.st_size > 0
+                ? mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0) : MAP_FAILED;
+    close(fd);
+    if (ptr == MAP_FAILED) return false;
+    base = (const uint8_t*)ptr;
+    length = mapped = st.st_size;
+#endif
+    return true;
+  }
+
+  void unmap() {
+    if (!base) return;
+#ifdef ARDUINO
+#if ESP_IDF_VERSION_MAJOR >= 5
+    esp_partition_munmap(handle);
+#else
+    spi_flash_munmap(handle);
+#endif
+#else
+    munmap((void*)base, mapped);
+#endif
+    base = nullptr;
+    length = 0;
+  }
+
+public:
+  ~AssetStore() { end(); }
+
+  // Map and validate the archive: the partition with this label on the
+  // device, a file path elsewhere. False if missing, corrupt or of another
+  // format; the store then stays empty.
+  bool begin(const char* source = "assets") {
+    end();
+    if (!map(source)) return false;
+
+    const Header* h = header();
+    bool ok = length >= sizeof(Header) && memcmp(h->magic, "JGAS", 4) == 0 && h->format == FORMAT &&
+              h->size <= length && h->size >= sizeof(Header) + (uint32_t)h->count * sizeof(Entry) &&
+              crc32(base + sizeof(Header), h->size - sizeof(Header)) == h->crc;
+    for (uint16_t i = 0; ok && i < h->count; i++) {
+      const Entry& e = entries()[i];
+      ok = e.offset <= h->size && e.size <= h->size - e.offset && e.name[sizeof(e.name) - 1] == '\0';
+    }
+    if (!ok) {
+      unmap();
+      return false;
+    }
+    length = h->size;
+    return true;
+  }
+
+  void end() { unmap(); }
+
+  bool isValid() const { return base != nullptr; }
+  uint32_t getVersion() const { return base ? header()->version : 0; }
+  uint32_t getPageVersion() const { return base ? header()->pageVersion : 0; }
+  uint16_t getCount() const { return base ? header()->count : 0; }
+  uint32_t getSize() const { return length; }
+
+  const Entry* entry(const char* name) const {
+    for (uint16_t i = 0; i < getCount(); i++) {
+      if (strncmp(entries()[i].name, name, sizeof(entries()[i].name)) == 0) return &entries()[i];
+    }
+    return nullptr;
+  }
+
+  // Pointer into the archive, or nullptr; size is set when found
+  const uint8_t* find(const char* name, uint32_t* size = nullptr) const {
+    const Entry* e = entry(name);
+    if (!e) return nullptr;
+    if (size) *size = e->size;
+    return base + e->offset;
+  }
+
+  // Point a compiled-in font at the archive copy of the same cell size,
+  // "font/<width>x<height>" (screen layouts are built on the cell size).
+  // False leaves the font as it was.
+  bool useFont(sFONT* font) const {
+    char key[sizeof(Entry::name)];
+    snprintf(key, sizeof(key), "font/%ux%u", font->Width, font->Height);
+    uint32_t size;
+    const uint8_t* blob = find(key, &size);
+    if (!blob || size < sizeof(FontHeader)) return false;
+
+    const FontHeader* f = (const FontHeader*)blob;
+    uint32_t rowBits = f->packed ? f->width : (f->width + 7) / 8 * 8;
+    uint32_t glyphBytes = (rowBits * f->height + 7) / 8;
+    uint32_t remapBytes = f->remapped ? 96 : 0;
+    if (!f->remapped && f->glyphs < 95) return false;
+    if (size < sizeof(FontHeader) + remapBytes + f->glyphs * glyphBytes) return false;
+    const uint8_t* remap = blob + sizeof(FontHeader);
+    for (uint8_t i = 0; i < 95 && f->remapped; i++) {
+      if (remap[i] >= f->glyphs) return false;
+    }
+
+    font->Remap = f->remapped ? remap : nullptr;
+    font->table = blob + sizeof(FontHeader) + remapBytes;
+    font->Packed = f->packed;
+    return true;
+  }
+};
+
+#endif
@@ -0,0 +1,72 @@
+#ifndef BOOT_TRACE_H
+#define BOOT_TRACE_H
+
+#include <stdint.h>
+#include <string.h>
+#include "Tasks.h"
+
+// Start and end of each boot phase, in microseconds on the esp_timer clock
+// (which starts just before setup(); ROM and bootloader time is not
+// counted). Phases may run on different tasks at once, and a phase may be
+// a single moment, such as the first advertisement going out.
+class BootTrace {
+public:
+  static const uint8_t MAX_PHASES = 12;
+  static const uint8_t NONE = 0xFF;  // from start() when the table is full
+
+  struct Phase {
+    const char* name;  // static string
+    int64_t startUs;
+    int64_t endUs;     // -1 while the phase runs
+  };
+
+private:
+  Mutex mutex;
+  Phase phases[MAX_PHASES];
+  uint8_t count = 0;
+
+public:
+  // Before any other call, and before the tasks start
+  void begin() { mutex.begin(); }
+
+  uint8_t start(const char* name, int64_t nowUs) {
+    LockGuard guard(&mutex);
+    if (count == MAX_PHASES) return NONE;
+    phases[count] = {name, nowUs, -1};
+    return count++;
+  }
+
+  void end(uint8_t phase, int64_t nowUs) {
+    LockGuard guard(&mutex);
+    if (phase < count) phases[phase].endUs = nowUs;
+  }
+
+  void mark(const char* name, int64_t nowUs) {
+    end(start(name, nowUs), nowUs);
+  }
+
+  // Whether a phase of that name has ended
+  bool isDone(const char* name) {
+    LockGuard guard(&mutex);
+    for (uint8_t i = 0; i < count; i++) {
+      if (strcmp(phases[i].name, name) == 0 && phases[i].endUs >= 0) return true;
+    }
+    return false;
+  }
+
+  // The phases so far in the order they started; returns how many
+  uint8_t copy(Phase* out) {
+    LockGuard guard(&mutex);
+    uint8_t n = count;
+    memcpy(out, phases, n * sizeof(Phase));
+    for (uint8_t i = 1; i < n; i++) {
+      Phase p = out[i];
+      uint8_t j = i;
+      for (; j > 0 && out[j - 1].startUs > p.startUs; j--) out[j] = out[j - 1];
+      out[j] = p;
+    }
+    return n;
+  }
+};
+
+#endif
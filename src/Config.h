@@ -2,88 +2,153 @@
 #define CONFIG_H
 
 #include <Preferences.h>
+#include "MotionPattern.h"
+#include "WeekSchedule.h"
+#include "Profiler.h"
+#include "Tasks.h"
 
 struct JigglerConfig {
   unsigned long jiggleInterval;  // Milliseconds between jiggles
+  unsigned long jiggleJitter;    // Up to this many ms earlier or later, at random
   int moveDistance;              // Pixel movement distance
   bool randomMoves;              // Use random movements instead of square pattern
   int randomMinDistance;         // Minimum random movement distance
   int randomMaxDistance;         // Maximum random movement distance
+  bool curvedMoves;              // Use curved, human-like paths instead
+  int curveDuration;             // Milliseconds a curved path takes
+  int curveAmplitude;            // Farthest a curved path goes, in pixels
+  bool bigCountdown;             // Show the countdown in large digits
   char deviceName[32];           // BLE device name
   char wifiSSID[32];             // WiFi AP SSID
   char wifiPassword[64];         // WiFi AP password
+  bool customPattern;            // Play the user pattern instead of the built-in ones
+  uint8_t pattern[MotionPattern::MAX_BYTES];  // Compiled user pattern (see MotionPattern.h)
+  uint8_t patternLength;         // Bytes of pattern, 0 if there is none
+  bool scheduleEnabled;          // Jiggle only inside the weekly windows
+  uint8_t schedule[WeekSchedule::BYTES];  // Compiled windows (see WeekSchedule.h)
 };
 
+// Settings in NVS. The HTTP task writes them while the UI and BLE tasks
+// read them, so readers get a copy taken under the lock, never a reference
+// into the live settings; the BLE task refreshes its copy when it is told
+// of a change (BLE_CONFIG_CHANGED in main.cpp).
 class ConfigManager {
 private:
   Preferences preferences;
   JigglerConfig config;
+  Mutex lock;
+  
+  // Writes every field of c; callers do not hold the lock
+  void save(const JigglerConfig& c) {
+    PROFILE_SCOPE(PROF_NVS_WRITE);
+    preferences.putULong("interval", c.jiggleInterval);
+    preferences.putULong("jitter", c.jiggleJitter);
+    preferences.putInt("distance", c.moveDistance);
+    preferences.putBool("random", c.randomMoves);
+    preferences.putInt("randMin", c.randomMinDistance);
+    preferences.putInt("randMax", c.randomMaxDistance);
+    preferences.putBool("curved", c.curvedMoves);
+    preferences.putInt("curveMs", c.curveDuration);
+    preferences.putInt("curveAmp", c.curveAmplitude);
+    preferences.putBool("bigDigits", c.bigCountdown);
+    preferences.putString("deviceName", c.deviceName);
+    preferences.putString("wifiSSID", c.wifiSSID);
+    preferences.putString("wifiPass", c.wifiPassword);
+    preferences.putBool("customPat", c.customPattern);
+    if (c.patternLength) {
+      preferences.putBytes("pattern", c.pattern, c.patternLength);
+    } else {
+      preferences.remove("pattern");  // putBytes() does not store empty values
+    }
+    preferences.putBool("schedOn", c.scheduleEnabled);
+    preferences.putBytes("schedule", c.schedule, sizeof(c.schedule));
+  }
   
 public:
-  ConfigManager() {
-    // Default values
-    config.jiggleInterval = 30000;
-    config.moveDistance = 2;
-    config.randomMoves = false;
-    config.randomMinDistance = 1;
-    config.randomMaxDistance = 5;
-    strcpy(config.deviceName, "Mouse Jiggler");
-    strcpy(config.wifiSSID, "MouseJiggler-Config");
-    strcpy(config.wifiPassword, "jiggler123");
+  ConfigManager() : config(defaults()) {}
+  
+  // Factory settings
+  static JigglerConfig defaults() {
+    JigglerConfig c = {};
+    c.jiggleInterval = 30000;
+    c.jiggleJitter = 0;
+    c.moveDistance = 2;
+    c.randomMoves = false;
+    c.randomMinDistance = 1;
+    c.randomMaxDistance = 5;
+    c.curvedMoves = false;
+    c.curveDuration = 800;
+    c.curveAmplitude = 20;
+    c.bigCountdown = false;
+    strcpy(c.deviceName, "Mouse Jiggler");
+    strcpy(c.wifiSSID, "MouseJiggler-Config");
+    strcpy(c.wifiPassword, "jiggler123");
+    c.customPattern = false;
+    c.patternLength = 0;
+    c.scheduleEnabled = false;
+    memset(c.schedule, 0xFF, sizeof(c.schedule));
+    return c;
   }
   
   void begin() {
+    lock.begin();
     preferences.begin("jiggler", false);
     loadConfig();
   }
   
   void loadConfig() {
+    LockGuard guard(&lock);
     config.jiggleInterval = preferences.getULong("interval", 30000);
+    config.jiggleJitter = preferences.getULong("jitter", 0);
     config.moveDistance = preferences.getInt("distance", 2);
     config.randomMoves = preferences.getBool("random", false);
     config.randomMinDistance = preferences.getInt("randMin", 1);
     config.randomMaxDistance = preferences.getInt("randMax", 5);
+    config.curvedMoves = preferences.getBool("curved", false);
+    config.curveDuration = preferences.getInt("curveMs", 800);
+    config.curveAmplitude = preferences.getInt("curveAmp", 20);
+    config.bigCountdown = preferences.getBool("bigDigits", false);
     preferences.getString("deviceName", config.deviceName, sizeof(config.deviceName));
     preferences.getString("wifiSSID", config.wifiSSID, sizeof(config.wifiSSID));
     preferences.getString("wifiPass", config.wifiPassword, sizeof(config.wifiPassword));
+    config.customPattern = preferences.getBool("customPat", false);
+    config.patternLength = preferences.getBytes("pattern", config.pattern, sizeof(config.pattern));
+    config.scheduleEnabled = preferences.getBool("schedOn", false);
+    if (preferences.getBytes("schedule", config.schedule, sizeof(config.schedule)) != sizeof(config.schedule)) {
+      memset(config.schedule, 0xFF, sizeof(config.schedule));
+    }
     
     // Set defaults if empty
     if (strlen(config.deviceName) == 0) strcpy(config.deviceName, "Mouse Jiggler");
     if (strlen(config.wifiSSID) == 0) strcpy(config.wifiSSID, "MouseJiggler-Config");
     if (strlen(config.wifiPassword) == 0) strcpy(config.wifiPassword, "jiggler123");
+    // Drop a pattern this firmware cannot run (e.g. saved by another version)
+    if (!MotionPattern::check(config.pattern, config.patternLength)) config.patternLength = 0;
+    // A schedule that never opens would stop jiggling for good
+    if (WeekSchedule::openSlots(config.schedule) == 0) config.scheduleEnabled = false;
   }
   
   void saveConfig() {
-    preferences.putULong("interval", config.jiggleInterval);
-    preferences.putInt("distance", config.moveDistance);
-    preferences.putBool("random", config.randomMoves);
-    preferences.putInt("randMin", config.randomMinDistance);
-    preferences.putInt("randMax", config.randomMaxDistance);
-    preferences.putString("deviceName", config.deviceName);
-    preferences.putString("wifiSSID", config.wifiSSID);
-    preferences.putString("wifiPass", config.wifiPassword);
+    save(getConfig());
   }
   
-  JigglerConfig& getConfig() {
+  // A copy of the settings as they are now
+  JigglerConfig getConfig() {
+    LockGuard guard(&lock);
     return config;
   }
   
   void setConfig(const JigglerConfig& newConfig) {
-    config = newConfig;
-    saveConfig();
+    {
+      LockGuard guard(&lock);
+      config = newConfig;
+    }
+    save(newConfig);
   }
   
   void resetToDefaults() {
     preferences.clear();
-    config.jiggleInterval = 30000;
-    config.moveDistance = 2;
-    config.randomMoves = false;
-    config.randomMinDistance = 1;
-    config.randomMaxDistance = 5;
-    strcpy(config.deviceName, "Mouse Jiggler");
-    strcpy(config.wifiSSID, "MouseJiggler-Config");
-    strcpy(config.wifiPassword, "jiggler123");
-    saveConfig();
+    setConfig(defaults());
   }
 };
 
@@ -38,6 +38,7 @@
 #include "Debug.h"
 #include <pgmspace.h>
 #include <Arduino.h>
+#include <esp_heap_caps.h>
 
 
 #define UBYTE   uint8_t
@@ -65,12 +66,24 @@
  * SPI
 **/
 #define DEV_SPI_WRITE(_dat)   SPI.transfer(_dat)
+#define DEV_SPI_WRITE_BUF(_buf, _len)   SPI.writeBytes(_buf, _len)
 
 /**
  * delay x ms
 **/
 #define DEV_Delay_ms(__xms)    delay(__xms)
 
+/**
+ * microsecond timestamp
+**/
+#define DEV_Time_us()    micros()
+
+/**
+ * internal SRAM (DMA capable), never PSRAM
+**/
+#define DEV_Malloc_DMA(_size)   heap_caps_malloc(_size, MALLOC_CAP_DMA | MALLOC_CAP_8BIT)
+#define DEV_Free(_ptr)          heap_caps_free(_ptr)
+
 /**
  * PWM_BL
 **/
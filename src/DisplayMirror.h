@@ -0,0 +1,374 @@
+#ifndef DISPLAY_MIRROR_H
+#define DISPLAY_MIRROR_H
+
+#include <Arduino.h>
+#include <WiFi.h>
+#include <lwip/sockets.h>
+#include "GUI_Paint.h"
+
+// Mirror counters, reset by resetStats()
+struct MirrorStats {
+  uint32_t frames;   // client updates sent
+  uint32_t rects;    // rectangles sent
+  uint32_t bytes;    // bytes written, WebSocket headers included
+  uint32_t dropped;  // frame slots skipped because a client could not take data
+};
+
+// Live copy of the LCD for the config page, pushed over a WebSocket.
+//
+// The strip renderer reports every region it pushes to the panel and each
+// client keeps its own small set of dirty rectangles. At most frameRate
+// times a second, a client whose socket has room gets its rectangles, read
+// back from the display list at that moment. A slow client therefore skips
+// the states it missed; nothing is queued for it.
+//
+// One WebSocket message per rectangle, little endian:
+//   u16 x, y, w, h, then w*h RGB565 pixels row by row as tokens:
+//   t < 128: t+1 copies of the next pixel; t >= 128: t-127 literal pixels
+// Messages go out as fragments of one TCP segment each, so the only buffer
+// is one segment plus a line.
+class DisplayMirror {
+public:
+  static const uint8_t MAX_CLIENTS = 2;
+
+private:
+  static const uint8_t MAX_RECTS = 4;
+#ifdef CONFIG_LWIP_TCP_MSS
+  static const size_t CHUNK_SIZE = CONFIG_LWIP_TCP_MSS;
+#else
+  static const size_t CHUNK_SIZE = 1436;
+#endif
+  static const size_t FRAME_HEADER = 4;  // server frame header, payload < 64 KB
+
+  struct Rect {
+    uint16_t x0, y0, x1, y1;  // inclusive
+  };
+
+  struct Client {
+    WiFiClient socket;
+    bool active;
+    Rect dirty[MAX_RECTS];
+    uint8_t count;
+  };
+
+  Client clients[MAX_CLIENTS];
+  uint16_t framePeriod = 100;  // ms, 10 FPS
+  unsigned long nextFrame = 0;
+  MirrorStats stats = {};
+
+  uint8_t chunk[CHUNK_SIZE];  // fragment being filled, header space first
+  size_t used = FRAME_HEADER;
+  bool firstFragment = true;
+  uint16_t line[320];
+
+  // Add a rectangle, merging it with any it touches. When the set is full
+  // it goes into the rectangle that grows the least.
+  static void addRect(Client& c, Rect r) {
+    for (uint8_t i = 0; i < c.count; ) {
+      const Rect& o = c.dirty[i];
+      if (r.x0 <= o.x1 + 1 && r.x1 + 1 >= o.x0 && r.y0 <= o.y1 + 1 && r.y1 + 1 >= o.y0) {
+        r = unite(r, o);
+        c.dirty[i] = c.dirty[--c.count];
+        i = 0;  // the grown rectangle may touch one already passed
+      } else {
+        i++;
+      }
+    }
+    if (c.count < MAX_RECTS) {
+      c.dirty[c.count++] = r;
+      return;
+    }
+
+    uint8_t best = 0;
+    uint32_t bestGrowth = UINT32_MAX;
+    for (uint8_t i = 0; i < c.count; i++) {
+      uint32_t growth = area(unite(c.dirty[i], r)) - area(c.dirty[i]);
+      if (growth < bestGrowth) {
+        bestGrowth = growth;
+        best = i;
+      }
+    }
+    Rect merged = unite(c.dirty[best], r);
+    c.dirty[best] = c.dirty[--c.count];
+    addRect(c, merged);
+  }
+
+  static Rect unite(const Rect& a, const Rect& b) {
+    return {min(a.x0, b.x0), min(a.y0, b.y0), max(a.x1, b.x1), max(a.y1, b.y1)};
+  }
+
+  static uint32_t area(const Rect& r) {
+    return (uint32_t)(r.x1 - r.x0 + 1) * (r.y1 - r.y0 + 1);
+  }
+
+  // Room in the socket's send buffer. lwIP reports a socket writable only
+  // while its send buffer is above the low-water mark.
+  static bool canWrite(WiFiClient& socket) {
+    int fd = socket.fd();
+    if (fd < 0) return false;
+    fd_set set;
+    FD_ZERO(&set);
+    FD_SET(fd, &set);
+    struct timeval zero = {0, 0};
+    return select(fd + 1, nullptr, &set, nullptr, &zero) > 0;
+  }
+
+  // Send the chunk as one fragment of the current message
+  bool sendFragment(WiFiClient& socket, bool fin) {
+    size_t payload = used - FRAME_HEADER;
+    uint8_t first = (fin ? 0x80 : 0x00) | (firstFragment ? 0x2 : 0x0);  // binary, then continuation
+    size_t start;
+    if (payload < 126) {
+      start = 2;
+      chunk[2] = first;
+      chunk[3] = payload;
+    } else {
+      start = 0;
+      chunk[0] = first;
+      chunk[1] = 126;
+      chunk[2] = payload >> 8;
+      chunk[3] = payload;
+    }
+    size_t length = used - start;
+    bool ok = socket.write(chunk + start, length) == length;
+    stats.bytes += length;
+    used = FRAME_HEADER;
+    firstFragment = false;
+    return ok;
+  }
+
+  bool put(WiFiClient& socket, const void* data, size_t n) {
+    const uint8_t* p = (const uint8_t*)data;
+    while (n > 0) {
+      size_t room = CHUNK_SIZE - used;
+      size_t k = min(n, room);
+      memcpy(chunk + used, p, k);
+      used += k;
+      p += k;
+      n -= k;
+      if (used == CHUNK_SIZE && !sendFragment(socket, false)) return false;
+    }
+    return true;
+  }
+
+  // Runs of 2 or more become repeat tokens, everything else literal tokens.
+  // Pixels are stored little endian, which is the ESP32's own byte order.
+  bool encodeRow(WiFiClient& socket, const uint16_t* px, uint16_t n) {
+    uint16_t i = 0;
+    while (i < n) {
+      uint16_t run = 1;
+      while (i + run < n && run < 128 && px[i + run] == px[i]) run++;
+      if (run >= 2) {
+        uint8_t token = run - 1;
+        if (!put(socket, &token, 1) || !put(socket, &px[i], 2)) return false;
+        i += run;
+        continue;
+      }
+
+      uint16_t literal = 1;
+      while (i + literal < n && literal < 128 &&
+             !(i + literal + 1 < n && px[i + literal] == px[i + literal + 1])) {
+        literal++;
+      }
+      uint8_t token = 127 + literal;
+      if (!put(socket, &token, 1) || !put(socket, &px[i], literal * 2)) return false;
+      i += literal;
+    }
+    return true;
+  }
+
+  bool sendRect(WiFiClient& socket, const Rect& r) {
+    uint16_t head[4] = {r.x0, r.y0, (uint16_t)(r.x1 - r.x0 + 1), (uint16_t)(r.y1 - r.y0 + 1)};
+    used = FRAME_HEADER;
+    firstFragment = true;
+    if (!put(socket, head, sizeof(head))) return false;
+    for (uint16_t y = r.y0; y <= r.y1; y++) {
+      Paint_ReadLine(y, line);
+      if (!encodeRow(socket, line + r.x0, head[2])) return false;
+    }
+    stats.rects++;
+    return sendFragment(socket, true);
+  }
+
+  void close(Client& c) {
+    if (c.socket.connected()) {
+      static const uint8_t closeFrame[2] = {0x88, 0x00};
+      c.socket.write(closeFrame, 2);
+    }
+    c.socket.stop();
+    c.active = false;
+    c.count = 0;
+    Serial.println("Mirror client closed");
+  }
+
+  static uint32_t rol(uint32_t v, uint8_t n) {
+    return (v << n) | (v >> (32 - n));
+  }
+
+  // SHA-1 of a short message (up to 119 bytes), for the handshake only
+  static void sha1(const uint8_t* msg, size_t len, uint8_t* out) {
+    uint8_t buf[128] = {0};
+    memcpy(buf, msg, len);
+    buf[len] = 0x80;
+    size_t blocks = (len + 8) / 64 + 1;
+    uint64_t bits = (uint64_t)len * 8;
+    for (uint8_t i = 0; i < 8; i++) buf[blocks * 64 - 1 - i] = bits >> (8 * i);
+
+    uint32_t h[5] = {0x67452301, 0xEFCDAB89, 0x98BADCFE, 0x10325476, 0xC3D2E1F0};
+    for (size_t b = 0; b < blocks; b++) {
+      uint32_t w[80];
+      for (uint8_t t = 0; t < 16; t++) {
+        const uint8_t* p = buf + b * 64 + t * 4;
+        w[t] = ((uint32_t)p[0] << 24) | ((uint32_t)p[1] << 16) | ((uint32_t)p[2] << 8) | p[3];
+      }
+      for (uint8_t t = 16; t < 80; t++) w[t] = rol(w[t - 3] ^ w[t - 8] ^ w[t - 14] ^ w[t - 16], 1);
+
+      uint32_t a = h[0], bb = h[1], c = h[2], d = h[3], e = h[4];
+      for (uint8_t t = 0; t < 80; t++) {
+        uint32_t f, k;
+        if (t < 20) { f = (bb & c) | (~bb & d); k = 0x5A827999; }
+        else if (t < 40) { f = bb ^ c ^ d; k = 0x6ED9EBA1; }
+        else if (t < 60) { f = (bb & c) | (bb & d) | (c & d); k = 0x8F1BBCDC; }
+        else { f = bb ^ c ^ d; k = 0xCA62C1D6; }
+        uint32_t temp = rol(a, 5) + f + e + k + w[t];
+        e = d;
+        d = c;
+        c = rol(bb, 30);
+        bb = a;
+        a = temp;
+      }
+      h[0] += a;
+      h[1] += bb;
+      h[2] += c;
+      h[3] += d;
+      h[4] += e;
+    }
+    for (uint8_t i = 0; i < 20; i++) out[i] = h[i / 4] >> (24 - 8 * (i % 4));
+  }
+
+  static String base64(const uint8_t* data, size_t len) {
+    static const char table[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+    String out;
+    for (size_t i = 0; i < len; i += 3) {
+      uint32_t v = (uint32_t)data[i] << 16;
+      if (i + 1 < len) v |= (uint32_t)data[i + 1] << 8;
+      if (i + 2 < len) v |= data[i + 2];
+      out += table[(v >> 18) & 63];
+      out += table[(v >> 12) & 63];
+      out += i + 1 < len ? table[(v >> 6) & 63] : '=';
+      out += i + 2 < len ? table[v & 63] : '=';
+    }
+    return out;
+  }
+
+public:
+  DisplayMirror() {
+    for (uint8_t i = 0; i < MAX_CLIENTS; i++) {
+      clients[i].active = false;
+      clients[i].count = 0;
+    }
+  }
+
+  void setFrameRate(uint16_t fps) { framePeriod = fps ? 1000 / fps : 1000; }
+
+  // Sec-WebSocket-Accept for a client key (RFC 6455)
+  static String acceptKey(const String& key) {
+    String text = key + "258EAFA5-E914-47DA-95CA-C5AB0DC85B11";
+    uint8_t digest[20];
+    if (text.length() > 119) return String();
+    sha1((const uint8_t*)text.c_str(), text.length(), digest);
+    return base64(digest, 20);
+  }
+
+  // Finish the WebSocket handshake for an upgrade request and keep the
+  // connection. Answers 503 and returns false when all slots are taken.
+  bool accept(WiFiClient& client, const String& key) {
+    Client* slot = nullptr;
+    for (uint8_t i = 0; i < MAX_CLIENTS; i++) {
+      if (clients[i].active && !clients[i].socket.connected()) close(clients[i]);
+      if (!clients[i].active && !slot) slot = &clients[i];
+    }
+    String accepted = acceptKey(key);
+    if (!slot || accepted.length() == 0) {
+      client.println("HTTP/1.1 503 Service Unavailable");
+      client.println("Content-type:text/plain");
+      client.println();
+      client.print("Too many viewers");
+      return false;
+    }
+
+    client.println("HTTP/1.1 101 Switching Protocols");
+    client.println("Upgrade: websocket");
+    client.println("Connection: Upgrade");
+    client.println("Sec-WebSocket-Accept: " + accepted);
+    client.println();
+    client.setNoDelay(true);
+
+    slot->socket = client;
+    slot->active = true;
+    slot->count = 0;
+    addRect(*slot, {0, 0, (uint16_t)(Paint.Width - 1), (uint16_t)(Paint.Height - 1)});
+    Serial.println("Mirror client connected");
+    return true;
+  }
+
+  // A region reached the panel (logical, inclusive); from the flush hook
+  void markDirty(uint16_t xStart, uint16_t yStart, uint16_t xEnd, uint16_t yEnd) {
+    for (uint8_t i = 0; i < MAX_CLIENTS; i++) {
+      if (clients[i].active) addRect(clients[i], {xStart, yStart, xEnd, yEnd});
+    }
+  }
+
+  bool hasClients() const {
+    for (uint8_t i = 0; i < MAX_CLIENTS; i++) {
+      if (clients[i].active) return true;
+    }
+    return false;
+  }
+
+  // Drop closed clients and, once per frame period, send what changed
+  void tick(unsigned long now) {
+    for (uint8_t i = 0; i < MAX_CLIENTS; i++) {
+      Client& c = clients[i];
+      if (!c.active) continue;
+      if (!c.socket.connected()) {
+        close(c);
+        continue;
+      }
+      // The page never sends, so anything but a close frame is ignored
+      if (c.socket.available()) {
+        bool closing = (c.socket.read() & 0x0F) == 0x8;
+        while (c.socket.available()) c.socket.read();
+        if (closing) close(c);
+      }
+    }
+
+    if ((long)(now - nextFrame) < 0) return;
+    nextFrame = now + framePeriod;
+
+    // Nothing to read back from while the list is invalid; keep the rectangles
+    if (!hasClients() || !Paint_ReadLine(0, line)) return;
+
+    for (uint8_t i = 0; i < MAX_CLIENTS; i++) {
+      Client& c = clients[i];
+      if (!c.active || c.count == 0) continue;
+      if (!canWrite(c.socket)) {
+        stats.dropped++;  // its rectangles wait and absorb later changes
+        continue;
+      }
+      while (c.count > 0 && canWrite(c.socket)) {
+        if (!sendRect(c.socket, c.dirty[0])) {
+          close(c);
+          break;
+        }
+        c.dirty[0] = c.dirty[--c.count];
+      }
+      stats.frames++;
+    }
+  }
+
+  const MirrorStats& getStats() const { return stats; }
+  void resetStats() { stats = {}; }
+};
+
+#endif
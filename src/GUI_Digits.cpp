@@ -0,0 +1,243 @@
+/*****************************************************************************
+* | File        :   GUI_Digits.cpp
+* | Function    :   Large seven-segment digits from a pre-rendered cache
+* | Info        :
+*   Scaling the 1-bit fonts up costs one Paint_SetPixel() per output pixel
+*   on every redraw. Instead every glyph of PAINT_DIGIT_CHARS is rendered
+*   once, for one size and color pair, straight into panel memory order and
+*   byte order. A digit is then one window plus one SPI burst when drawing
+*   directly, or a few row copies when the strip renderer rasterizes it.
+*
+*   The cache is rendered for the current Paint rotation and mirroring and
+*   is re-rendered on the next draw if those change.
+******************************************************************************/
+#include "GUI_Strip.h"
+#include "LCD_Driver.h"
+#include "GUI_Pixel.h"
+#include <string.h>
+
+#define PAINT_DIGIT_COUNT   (sizeof(PAINT_DIGIT_CHARS) - 1)
+
+// Segments a..g in bits 0..6, for the characters of PAINT_DIGIT_CHARS
+static const UBYTE Paint_Segments[PAINT_DIGIT_COUNT] = {
+  0x3F, 0x06, 0x5B, 0x4F, 0x66, 0x6D, 0x7D, 0x07, 0x7F, 0x6F,   // 0-9
+  0x00, 0x00, 0x40, 0x00                                        // : . - space
+};
+
+/******************************************************************************
+  function: Tell whether a glyph pixel is lit
+  parameter:
+    W, H  : glyph cell
+    Glyph : index into PAINT_DIGIT_CHARS
+    x, y  : pixel in the cell
+******************************************************************************/
+static UBYTE Paint_DigitInk(int W, int H, UBYTE Glyph, int x, int y)
+{
+  int T = W / 5 > 2 ? W / 5 : 2;          // segment thickness
+  int M = W / 10 > 1 ? W / 10 : 1;        // side margin between digits
+  int Left = M, Right = W - 1 - M;
+  int Mid = (H - T) / 2;
+  char Ch = PAINT_DIGIT_CHARS[Glyph];
+
+  if (Ch == ':' || Ch == '.') {
+    int Cx = (W - T) / 2;
+    if (x < Cx || x >= Cx + T)
+      return 0;
+    if (Ch == '.')
+      return y >= H - T;
+    return (y >= H / 3 - T / 2 && y < H / 3 - T / 2 + T) ||
+           (y >= 2 * H / 3 - T / 2 && y < 2 * H / 3 - T / 2 + T);
+  }
+
+  UBYTE Seg = Paint_Segments[Glyph];
+  int Xa = Left + T / 2, Xb = Right - T / 2;   // ends of the horizontal segments
+  int Ya = T / 2, Ym = Mid + T / 2, Yb = H - 1 - T / 2;
+
+  // Horizontal segments a, g, d: bands of T rows, pointed ends
+  const int Rows[3] = {0, Mid, H - T};
+  const UBYTE HBits[3] = {0x01, 0x40, 0x08};
+  for (UBYTE i = 0; i < 3; i++) {
+    if (!(Seg & HBits[i]) || y < Rows[i] || y >= Rows[i] + T)
+      continue;
+    int D = 2 * y - (2 * Rows[i] + T - 1);
+    D = (D < 0 ? -D : D) / 2;
+    if (x >= Xa + 1 + D && x <= Xb - 1 - D)
+      return 1;
+  }
+
+  // Vertical segments f, b (upper) and e, c (lower)
+  const int Cols[2] = {Left, Right - T + 1};
+  const UBYTE VBits[2][2] = {{0x20, 0x10}, {0x02, 0x04}};
+  for (UBYTE i = 0; i < 2; i++) {
+    if (x < Cols[i] || x >= Cols[i] + T)
+      continue;
+    int D = 2 * x - (2 * Cols[i] + T - 1);
+    D = (D < 0 ? -D : D) / 2;
+    if ((Seg & VBits[i][0]) && y >= Ya + 1 + D && y <= Ym - 1 - D)
+      return 1;
+    if ((Seg & VBits[i][1]) && y >= Ym + 1 + D && y <= Yb - 1 - D)
+      return 1;
+  }
+  return 0;
+}
+
+/******************************************************************************
+  function: Render every glyph for the current rotation and mirroring
+******************************************************************************/
+static void Paint_Digits_Render(PAINT_DIGITS *Digits)
+{
+  int W = Digits->Width, H = Digits->Height;
+  int Ax, Ay, Bx, By;
+
+  // The mapping only flips and swaps axes, so a glyph's layout in memory
+  // does not depend on where it is drawn. With an invalid rotation the
+  // cache stays stale, and Paint_DrawDigit() draws nothing.
+  if (!Paint_MapPoint(0, 0, &Ax, &Ay) || !Paint_MapPoint(W - 1, H - 1, &Bx, &By))
+    return;
+  int BaseX = Ax < Bx ? Ax : Bx, BaseY = Ay < By ? Ay : By;
+  int Pitch = (Ax < Bx ? Bx - Ax : Ax - Bx) + 1;
+
+  for (UBYTE g = 0; g < PAINT_DIGIT_COUNT; g++) {
+    UWORD *Glyph = Digits->Pixels + (UDOUBLE)g * W * H;
+    for (int y = 0; y < H; y++) {
+      for (int x = 0; x < W; x++) {
+        int X = 0, Y = 0;  // always mapped: the setting was checked above
+        Paint_MapPoint(x, y, &X, &Y);
+        Glyph[(Y - BaseY) * Pitch + (X - BaseX)] =
+          Paint_DigitInk(W, H, g, x, y) ? Digits->Color_Foreground : Digits->Color_Background;
+      }
+    }
+  }
+  Pixel_Swap(Digits->Pixels, Digits->Pixels, (UDOUBLE)W * H * PAINT_DIGIT_COUNT);
+  Digits->Rotate = Paint.Rotate;
+  Digits->Mirror = Paint.Mirror;
+}
+
+/******************************************************************************
+  function: Allocate and render a digit cache
+  parameter:
+    Digits           : The cache
+    Width, Height    : Glyph cell in pixels (Height about 1.6 x Width looks right)
+    Color_Background : Cell background
+    Color_Foreground : Segment color
+  return: 1 on success, 0 if out of memory (Paint_DrawDigit() then draws nothing)
+******************************************************************************/
+UBYTE Paint_Digits_Init(PAINT_DIGITS *Digits, UWORD Width, UWORD Height,
+                        UWORD Color_Background, UWORD Color_Foreground)
+{
+  Digits->Pixels = NULL;
+  Digits->Width = Width;
+  Digits->Height = Height;
+  Digits->Color_Background = Color_Background;
+  Digits->Color_Foreground = Color_Foreground;
+
+  Digits->Pixels = (UWORD *)DEV_Malloc_DMA((UDOUBLE)Width * Height * 2 * PAINT_DIGIT_COUNT);
+  if (!Digits->Pixels) {
+    Debug("Paint_Digits_Init: out of memory\r\n");
+    return 0;
+  }
+  Paint_Digits_Render(Digits);
+  return 1;
+}
+
+/******************************************************************************
+  function: Release a digit cache. It must not be in the current display
+            list any more, so redraw the screen first.
+******************************************************************************/
+void Paint_Digits_Free(PAINT_DIGITS *Digits)
+{
+  DEV_Free(Digits->Pixels);
+  Digits->Pixels = NULL;
+}
+
+/******************************************************************************
+  function: Draw one cached glyph
+  parameter:
+    Digits         : The cache
+    Xpoint, Ypoint : Top left of the cell
+    Ch             : One of PAINT_DIGIT_CHARS, anything else is ignored
+******************************************************************************/
+void Paint_DrawDigit(PAINT_DIGITS *Digits, UWORD Xpoint, UWORD Ypoint, char Ch)
+{
+  const char *Pos = Ch ? strchr(PAINT_DIGIT_CHARS, Ch) : NULL;
+
+  if (!Digits->Pixels || !Pos)
+    return;
+  if (Xpoint > Paint.Width || Ypoint > Paint.Height) {
+    Debug("Paint_DrawDigit Input exceeds the normal display range\r\n");
+    return;
+  }
+
+  if (sPaint_mode == PAINT_MODE_RECORD) {
+    PAINT_CMD *Cmd = Paint_RecordCmd(PAINT_OP_DIGIT, Xpoint, Ypoint,
+                                     Xpoint + Digits->Width - 1, Ypoint + Digits->Height - 1, 0);
+    if (Cmd) {
+      Cmd->Arg[0] = Xpoint;
+      Cmd->Arg[1] = Ypoint;
+      Cmd->Arg8[0] = Ch;
+      Cmd->Ptr = Digits;
+      Paint_CommitCmd(Cmd, 1);
+      return;
+    }
+  }
+
+  if (Digits->Rotate != Paint.Rotate || Digits->Mirror != Paint.Mirror)
+    Paint_Digits_Render(Digits);
+
+  // Glyph box in panel memory, unclipped
+  int Ax, Ay, Bx, By;
+  if (!Paint_MapPoint(Xpoint, Ypoint, &Ax, &Ay) ||
+      !Paint_MapPoint(Xpoint + Digits->Width - 1, Ypoint + Digits->Height - 1, &Bx, &By))
+    return;
+  int GX0 = Ax < Bx ? Ax : Bx, GX1 = Ax < Bx ? Bx : Ax;
+  int GY0 = Ay < By ? Ay : By, GY1 = Ay < By ? By : Ay;
+  int Pitch = GX1 - GX0 + 1;
+
+  // Clip to the strip being rasterized, or to the panel
+  int X0 = 0, Y0 = 0, X1 = Paint.WidthMemory - 1, Y1 = Paint.HeightMemory - 1;
+  if (sPaint_mode == PAINT_MODE_RASTER) {
+    X0 = sPaint_target.X0;
+    Y0 = sPaint_target.Y0;
+    X1 = sPaint_target.X1;
+    Y1 = sPaint_target.Y1;
+  }
+  if (GX0 > X0) X0 = GX0;
+  if (GY0 > Y0) Y0 = GY0;
+  if (GX1 < X1) X1 = GX1;
+  if (GY1 < Y1) Y1 = GY1;
+  if (X0 > X1 || Y0 > Y1)
+    return;
+
+  const UWORD *Glyph = Digits->Pixels + (UDOUBLE)(Pos - PAINT_DIGIT_CHARS) * Digits->Width * Digits->Height;
+  UWORD Len = X1 - X0 + 1;
+
+  if (sPaint_mode == PAINT_MODE_RASTER) {
+    for (int Y = Y0; Y <= Y1; Y++)
+      memcpy(sPaint_target.Buf + (Y - sPaint_target.Y0) * sPaint_target.Pitch + (X0 - sPaint_target.X0),
+             Glyph + (Y - GY0) * Pitch + (X0 - GX0), Len * 2);
+    return;
+  }
+
+  LCD_SetCursor(X0, Y0, X1, Y1);
+  if (Len == Pitch) {
+    LCD_WriteData_Buf((const UBYTE *)(Glyph + (Y0 - GY0) * Pitch), (UDOUBLE)Len * (Y1 - Y0 + 1) * 2);
+  } else {
+    for (int Y = Y0; Y <= Y1; Y++)
+      LCD_WriteData_Buf((const UBYTE *)(Glyph + (Y - GY0) * Pitch + (X0 - GX0)), (UDOUBLE)Len * 2);
+  }
+}
+
+/******************************************************************************
+  function: Draw a string of cached glyphs
+  return: Width drawn in pixels
+******************************************************************************/
+UWORD Paint_DrawDigits(PAINT_DIGITS *Digits, UWORD Xpoint, UWORD Ypoint, const char *pString)
+{
+  UWORD Xstart = Xpoint;
+
+  while (*pString != '\0') {
+    Paint_DrawDigit(Digits, Xpoint, Ypoint, *pString++);
+    Xpoint += Digits->Width;
+  }
+  return Xpoint - Xstart;
+}
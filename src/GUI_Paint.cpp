@@ -32,6 +32,7 @@
 
 ******************************************************************************/
 #include "GUI_Paint.h"
+#include "GUI_Strip.h"
 #include "DEV_Config.h"
 #include <stdint.h>
 #include <stdlib.h>
@@ -115,53 +116,33 @@ void Paint_SetPixel(UWORD Xpoint, UWORD Ypoint, UWORD Color)
     //Debug("Exceeding display boundaries\r\n");
     return;
   }
-  UWORD X, Y;
 
-  switch (Paint.Rotate) {
-    case 0:
-      X = Xpoint;
-      Y = Ypoint;
-      break;
-    case 90:
-      X = Paint.WidthMemory - Ypoint - 1;
-      Y = Xpoint;
-      break;
-    case 180:
-      X = Paint.WidthMemory - Xpoint - 1;
-      Y = Paint.HeightMemory - Ypoint - 1;
-      break;
-    case 270:
-      X = Ypoint;
-      Y = Paint.HeightMemory - Xpoint - 1;
-      break;
-
-    default:
+  if (sPaint_mode == PAINT_MODE_RECORD) {
+    PAINT_CMD *Cmd = Paint_RecordCmd(PAINT_OP_PIXEL, Xpoint, Ypoint, Xpoint, Ypoint, 0);
+    if (Cmd) {
+      Cmd->Arg[0] = Xpoint;
+      Cmd->Arg[1] = Ypoint;
+      Cmd->Arg[2] = Color;
+      Paint_CommitCmd(Cmd, 0);
       return;
+    }
   }
 
-  switch (Paint.Mirror) {
-    case MIRROR_NONE:
-      break;
-    case MIRROR_HORIZONTAL:
-      X = Paint.WidthMemory - X - 1;
-      break;
-    case MIRROR_VERTICAL:
-      Y = Paint.HeightMemory - Y - 1;
-      break;
-    case MIRROR_ORIGIN:
-      X = Paint.WidthMemory - X - 1;
-      Y = Paint.HeightMemory - Y - 1;
-      break;
-    default:
-      return;
-  }
+  int X, Y;
+  if (!Paint_MapPoint(Xpoint, Ypoint, &X, &Y))
+    return;
 
   // printf("x = %d, y = %d\r\n", X, Y);
-  if (X > Paint.WidthMemory || Y > Paint.HeightMemory) {
+  if (X < 0 || Y < 0 || X > Paint.WidthMemory || Y > Paint.HeightMemory) {
     //Debug("Exceeding display boundaries\r\n");
     return;
   }
 
+  if (sPaint_mode == PAINT_MODE_RASTER) {
+    Paint_RasterPixel(X, Y, Color);
+    return;
+  }
+
   // UDOUBLE Addr = X / 8 + Y * Paint.WidthByte;
   LCD_SetUWORD(X, Y, Color);
 }
@@ -173,6 +154,18 @@ void Paint_SetPixel(UWORD Xpoint, UWORD Ypoint, UWORD Color)
 ******************************************************************************/
 void Paint_Clear(UWORD Color)
 {
+  if (sPaint_mode == PAINT_MODE_RECORD) {
+    PAINT_CMD *Cmd = Paint_RecordCmd(PAINT_OP_CLEAR, 0, 0, Paint.Width - 1, Paint.Height - 1, 0);
+    if (Cmd) {
+      Cmd->Arg[0] = Color;
+      Paint_CommitCmd(Cmd, 1);
+      return;
+    }
+  } else if (sPaint_mode == PAINT_MODE_RASTER) {
+    Paint_RasterFill(0, 0, Paint.Width - 1, Paint.Height - 1, Color);
+    return;
+  }
+
   LCD_SetCursor(0, 0, Paint.WidthByte-1 , Paint.HeightByte-1);
   for (UWORD Y = 0; Y < Paint.HeightByte; Y++) {
     for (UWORD X = 0; X < Paint.WidthByte; X++ ) {//8 pixel =  1 byte
@@ -191,6 +184,22 @@ void Paint_Clear(UWORD Color)
 ******************************************************************************/
 void Paint_ClearWindows(UWORD Xstart, UWORD Ystart, UWORD Xend, UWORD Yend, UWORD Color)
 {
+  if (sPaint_mode == PAINT_MODE_RECORD) {
+    PAINT_CMD *Cmd = Paint_RecordCmd(PAINT_OP_CLEAR_WINDOWS, Xstart, Ystart, Xend - 1, Yend - 1, 0);
+    if (Cmd) {
+      Cmd->Arg[0] = Xstart;
+      Cmd->Arg[1] = Ystart;
+      Cmd->Arg[2] = Xend;
+      Cmd->Arg[3] = Yend;
+      Cmd->Arg[4] = Color;
+      Paint_CommitCmd(Cmd, 1);
+      return;
+    }
+  } else if (sPaint_mode == PAINT_MODE_RASTER) {
+    Paint_RasterFill(Xstart, Ystart, Xend - 1, Yend - 1, Color);
+    return;
+  }
+
   UWORD X, Y;
   for (Y = Ystart; Y < Yend; Y++) {
     for (X = Xstart; X < Xend; X++) {//8 pixel =  1 byte
@@ -199,6 +208,164 @@ void Paint_ClearWindows(UWORD Xstart, UWORD Ystart, UWORD Xend, UWORD Yend, UWOR
   }
 }
 
+/******************************************************************************
+  function: Gradient color at a position, per channel in 16.16 fixed point
+  parameter:
+    Gradient : The gradient
+    Pos      : Position along the gradient axis
+    C        : Output, R5 G6 B5 levels << 16
+    S        : Output, change of C per pixel while Pos stays in Lo..Hi
+    Lo, Hi   : Output, positions for which stepping by S stays exact
+******************************************************************************/
+static void Paint_GradientAt(const PAINT_GRADIENT *Gradient, int Pos, int32_t *C, int32_t *S, int *Lo, int *Hi)
+{
+  UBYTE Stops = Gradient->Stops == 3 ? 3 : 2;
+  int P[3];
+  P[0] = Gradient->From;
+  P[Stops - 1] = Gradient->To;
+  if (Stops == 3)
+    P[1] = (Gradient->From + Gradient->To) / 2;
+
+  // Each position belongs to exactly one segment, so stepping into it
+  // from either side gives the same values as computing it directly
+  UBYTE i = 0;
+  if (Pos < P[0]) {
+    *Lo = -0x8000;
+    *Hi = P[0] - 1;
+  } else if (Pos >= P[Stops - 1]) {
+    i = Stops - 1;
+    *Lo = P[Stops - 1];
+    *Hi = 0x7FFF;
+  } else {
+    while (Pos >= P[i + 1])
+      i++;
+    *Lo = P[i];
+    *Hi = P[i + 1] - 1;
+  }
+
+  UWORD C0 = Gradient->Color[i];
+  int32_t L0[3] = {C0 >> 11, (C0 >> 5) & 0x3F, C0 & 0x1F};
+  for (UBYTE c = 0; c < 3; c++) {
+    S[c] = 0;
+    C[c] = L0[c] << 16;
+  }
+  if (*Lo == -0x8000 || *Hi == 0x7FFF)
+    return;
+
+  UWORD C1 = Gradient->Color[i + 1];
+  int32_t L1[3] = {C1 >> 11, (C1 >> 5) & 0x3F, C1 & 0x1F};
+  for (UBYTE c = 0; c < 3; c++) {
+    S[c] = ((L1[c] - L0[c]) << 16) / (P[i + 1] - P[i]);
+    C[c] += S[c] * (Pos - P[i]);
+  }
+}
+
+/******************************************************************************
+  function: Render one panel memory row of a gradient in panel byte order
+  parameter:
+    Dst      : Output, X1 - X0 + 1 pixels
+    X0, X1   : Memory columns, inclusive
+    Y        : Memory row
+  info: The logical position moves by at most one pixel per memory column,
+        so the colors are stepped by adding the slope instead of being
+        recomputed, and only re-derived when a stop is crossed. A 4x4 Bayer
+        threshold on the logical position rounds each channel to RGB565.
+******************************************************************************/
+static const UBYTE Paint_Bayer4[4][4] = {
+  { 0,  8,  2, 10},
+  {12,  4, 14,  6},
+  { 3, 11,  1,  9},
+  {15,  7, 13,  5},
+};
+
+static void Paint_GradientSpan(UWORD *Dst, int X0, int X1, int Y, const PAINT_GRADIENT *Gradient)
+{
+  int Xpoint, Ypoint, Xnext, Ynext;
+  Paint_UnmapPoint(X0, Y, &Xpoint, &Ypoint);
+  Paint_UnmapPoint(X0 + 1, Y, &Xnext, &Ynext);
+  int Dx = Xnext - Xpoint, Dy = Ynext - Ypoint;
+
+  int Horizontal = Gradient->Dir == GRADIENT_HORIZONTAL;
+  int Pos = Horizontal ? Xpoint : Ypoint;
+  int Step = Horizontal ? Dx : Dy;
+  int32_t C[3], S[3];
+  int Lo, Hi;
+  Paint_GradientAt(Gradient, Pos, C, S, &Lo, &Hi);
+
+  for (int X = X0; X <= X1; X++) {
+    int32_t T = ((int32_t)Paint_Bayer4[Ypoint & 3][Xpoint & 3] << 12) + 0x800;
+    int32_t R = (C[0] + T) >> 16, G = (C[1] + T) >> 16, B = (C[2] + T) >> 16;
+    if (R > 0x1F) R = 0x1F;
+    if (G > 0x3F) G = 0x3F;
+    if (B > 0x1F) B = 0x1F;
+    UWORD Color = (UWORD)((R << 11) | (G << 5) | B);
+    *Dst++ = (UWORD)((Color << 8) | (Color >> 8));
+
+    Xpoint += Dx;
+    Ypoint += Dy;
+    if (Step) {
+      Pos += Step;
+      if (Pos < Lo || Pos > Hi) {
+        Paint_GradientAt(Gradient, Pos, C, S, &Lo, &Hi);
+      } else {
+        for (UBYTE c = 0; c < 3; c++)
+          C[c] += Step > 0 ? S[c] : -S[c];
+      }
+    }
+  }
+}
+
+/******************************************************************************
+  function: Fill a window with a dithered gradient
+  parameter:
+    Xstart, Ystart : Top left, inclusive
+    Xend, Yend     : Bottom right, exclusive (as Paint_ClearWindows())
+    Gradient       : Colors and stops, must outlive the current frame
+******************************************************************************/
+#define PAINT_LINE_MAX  320
+
+void Paint_DrawGradient(UWORD Xstart, UWORD Ystart, UWORD Xend, UWORD Yend, const PAINT_GRADIENT *Gradient)
+{
+  UWORD X0, Y0, X1, Y1;
+
+  if (sPaint_mode == PAINT_MODE_RECORD) {
+    PAINT_CMD *Cmd = Paint_RecordCmd(PAINT_OP_GRADIENT, Xstart, Ystart, Xend - 1, Yend - 1, 0);
+    if (Cmd) {
+      Cmd->Arg[0] = Xstart;
+      Cmd->Arg[1] = Ystart;
+      Cmd->Arg[2] = Xend;
+      Cmd->Arg[3] = Yend;
+      Cmd->Ptr = Gradient;
+      Paint_CommitCmd(Cmd, 1);
+      return;
+    }
+  }
+
+  if (!Paint_MapBox(Xstart, Ystart, Xend - 1, Yend - 1, &X0, &Y0, &X1, &Y1))
+    return;
+
+  if (sPaint_mode == PAINT_MODE_RASTER) {
+    if (X0 < sPaint_target.X0) X0 = sPaint_target.X0;
+    if (Y0 < sPaint_target.Y0) Y0 = sPaint_target.Y0;
+    if (X1 > sPaint_target.X1) X1 = sPaint_target.X1;
+    if (Y1 > sPaint_target.Y1) Y1 = sPaint_target.Y1;
+    for (int Y = Y0; Y <= Y1; Y++)
+      Paint_GradientSpan(sPaint_target.Buf + (Y - sPaint_target.Y0) * sPaint_target.Pitch + (X0 - sPaint_target.X0),
+                         X0, X1, Y, Gradient);
+    return;
+  }
+
+  // Direct: one window, one burst per row
+  static UWORD Line[PAINT_LINE_MAX];
+  if (X1 - X0 + 1 > PAINT_LINE_MAX)
+    X1 = X0 + PAINT_LINE_MAX - 1;
+  LCD_SetCursor(X0, Y0, X1, Y1);
+  for (int Y = Y0; Y <= Y1; Y++) {
+    Paint_GradientSpan(Line, X0, X1, Y, Gradient);
+    LCD_WriteData_Buf((const UBYTE *)Line, (UDOUBLE)(X1 - X0 + 1) * 2);
+  }
+}
+
 /******************************************************************************
 function:	Draw Point(Xpoint, Ypoint) Fill the color
 parameter:
@@ -215,6 +382,21 @@ void Paint_DrawPoint( UWORD Xpoint,       UWORD Ypoint, UWORD Color,
         return;
     }
 
+    if (sPaint_mode == PAINT_MODE_RECORD) {
+        int Left = Dot_FillWay == DOT_FILL_AROUND ? Dot_Pixel : 1;
+        PAINT_CMD *Cmd = Paint_RecordCmd(PAINT_OP_POINT, Xpoint - Left, Ypoint - Left,
+                                         Xpoint + Dot_Pixel - 2, Ypoint + Dot_Pixel - 2, 0);
+        if (Cmd) {
+            Cmd->Arg[0] = Xpoint;
+            Cmd->Arg[1] = Ypoint;
+            Cmd->Arg[2] = Color;
+            Cmd->Arg8[0] = Dot_Pixel;
+            Cmd->Arg8[1] = Dot_FillWay;
+            Paint_CommitCmd(Cmd, 0);
+            return;
+        }
+    }
+
     int16_t XDir_Num , YDir_Num;
     if (Dot_FillWay == DOT_FILL_AROUND) {
         for (XDir_Num = 0; XDir_Num < 2*Dot_Pixel - 1; XDir_Num++) {
@@ -252,6 +434,28 @@ void Paint_DrawLine(UWORD Xstart, UWORD Ystart, UWORD Xend, UWORD Yend,
         return;
     }
 
+    if (sPaint_mode == PAINT_MODE_RECORD) {
+        // Every point is a (2w-1)x(2w-1) square offset by -w, so a solid
+        // horizontal or vertical line covers its box completely
+        int Xmin = (Xstart < Xend ? Xstart : Xend) - Line_width;
+        int Ymin = (Ystart < Yend ? Ystart : Yend) - Line_width;
+        int Xmax = (Xstart < Xend ? Xend : Xstart) + Line_width - 2;
+        int Ymax = (Ystart < Yend ? Yend : Ystart) + Line_width - 2;
+        PAINT_CMD *Cmd = Paint_RecordCmd(PAINT_OP_LINE, Xmin, Ymin, Xmax, Ymax, 0);
+        if (Cmd) {
+            Cmd->Arg[0] = Xstart;
+            Cmd->Arg[1] = Ystart;
+            Cmd->Arg[2] = Xend;
+            Cmd->Arg[3] = Yend;
+            Cmd->Arg[4] = Color;
+            Cmd->Arg8[0] = Line_width;
+            Cmd->Arg8[1] = Line_Style;
+            Paint_CommitCmd(Cmd, Line_Style == LINE_STYLE_SOLID && (Xstart == Xend || Ystart == Yend) &&
+                                 Xmin >= 0 && Ymin >= 0);
+            return;
+        }
+    }
+
     UWORD Xpoint = Xstart;
     UWORD Ypoint = Ystart;
     int dx = (int)Xend - (int)Xstart >= 0 ? Xend - Xstart : Xstart - Xend;
@@ -309,6 +513,30 @@ void Paint_DrawRectangle( UWORD Xstart, UWORD Ystart, UWORD Xend, UWORD Yend,
         return;
     }
 
+    int Xmin = Xstart < Xend ? Xstart : Xend;
+    int Xmax = Xstart < Xend ? Xend : Xstart;
+    if (sPaint_mode == PAINT_MODE_RECORD) {
+        int Ylast = Filled ? Yend - 1 : (Ystart < Yend ? Yend : Ystart);
+        int Yfirst = Filled ? Ystart : (Ystart < Yend ? Ystart : Yend);
+        PAINT_CMD *Cmd = Paint_RecordCmd(PAINT_OP_RECTANGLE, Xmin - Line_width, Yfirst - Line_width,
+                                         Xmax + Line_width - 2, Ylast + Line_width - 2, 0);
+        if (Cmd) {
+            Cmd->Arg[0] = Xstart;
+            Cmd->Arg[1] = Ystart;
+            Cmd->Arg[2] = Xend;
+            Cmd->Arg[3] = Yend;
+            Cmd->Arg[4] = Color;
+            Cmd->Arg8[0] = Line_width;
+            Cmd->Arg8[1] = Filled;
+            Paint_CommitCmd(Cmd, Filled && Yend > Ystart && Xmin >= Line_width && Yfirst >= Line_width);
+            return;
+        }
+    } else if (sPaint_mode == PAINT_MODE_RASTER && Filled && Line_width == DOT_PIXEL_1X1) {
+        // Same pixels as the per-row lines below: 1x1 points land at (x-1, y-1)
+        Paint_RasterFill(Xmin > 0 ? Xmin - 1 : 0, Ystart > 0 ? Ystart - 1 : 0, Xmax - 1, Yend - 2, Color);
+        return;
+    }
+
     if (Filled ) {
         UWORD Ypoint;
         for(Ypoint = Ystart; Ypoint < Yend; Ypoint++) {
@@ -340,6 +568,22 @@ void Paint_DrawCircle(  UWORD X_Center, UWORD Y_Center, UWORD Radius,
         return;
     }
 
+    if (sPaint_mode == PAINT_MODE_RECORD) {
+        int Width = Draw_Fill == DRAW_FILL_FULL ? DOT_PIXEL_DFT : Line_width;
+        PAINT_CMD *Cmd = Paint_RecordCmd(PAINT_OP_CIRCLE, X_Center - Radius - Width, Y_Center - Radius - Width,
+                                         X_Center + Radius + Width - 2, Y_Center + Radius + Width - 2, 0);
+        if (Cmd) {
+            Cmd->Arg[0] = X_Center;
+            Cmd->Arg[1] = Y_Center;
+            Cmd->Arg[2] = Radius;
+            Cmd->Arg[3] = Color;
+            Cmd->Arg8[0] = Line_width;
+            Cmd->Arg8[1] = Draw_Fill;
+            Paint_CommitCmd(Cmd, 0);
+            return;
+        }
+    }
+
     //Draw a circle from(0, R) as a starting point
     int16_t XCurrent, YCurrent;
     XCurrent = 0;
@@ -411,31 +655,48 @@ void Paint_DrawChar(UWORD Xpoint, UWORD Ypoint, const char Acsii_Char,
     //Debug("Paint_DrawChar Input exceeds the normal display range\r\n");
     return;
   }
-  uint32_t Char_Offset = (Acsii_Char - ' ') * Font->Height * (Font->Width / 8 + (Font->Width % 8 ? 1 : 0));
-  const unsigned char *ptr = &Font->table[Char_Offset];
+
+  if (sPaint_mode == PAINT_MODE_RECORD) {
+    PAINT_CMD *Cmd = Paint_RecordCmd(PAINT_OP_CHAR, Xpoint, Ypoint,
+                                     Xpoint + Font->Width - 1, Ypoint + Font->Height - 1, 0);
+    if (Cmd) {
+      Cmd->Arg[0] = Xpoint;
+      Cmd->Arg[1] = Ypoint;
+      Cmd->Arg[2] = Color_Background;
+      Cmd->Arg[3] = Color_Foreground;
+      Cmd->Arg8[0] = Acsii_Char;
+      Cmd->Ptr = Font;
+      Paint_CommitCmd(Cmd, FONT_BACKGROUND != Color_Background);
+      return;
+    }
+  } else if (Paint_RasterSkip(Xpoint, Ypoint, Xpoint + Font->Width - 1, Ypoint + Font->Height - 1)) {
+    return;
+  }
+  // Subset fonts (tools/font_subset.py) remap characters to glyphs and may
+  // pack rows without padding; full fonts pad every row to whole bytes
+  UWORD Glyph = Acsii_Char - ' ';
+  if (Font->Remap)
+    Glyph = Glyph < 95 ? pgm_read_byte(&Font->Remap[Glyph]) : pgm_read_byte(&Font->Remap[0]);
+  UDOUBLE Row_Bits = Font->Packed ? Font->Width : (Font->Width + 7) / 8 * 8;
+  const unsigned char *ptr = &Font->table[Glyph * ((Row_Bits * Font->Height + 7) / 8)];
 
   for ( Page = 0; Page < Font->Height; Page ++ ) {
-    for ( Column = 0; Column < Font->Width; Column ++ ) {
+    UDOUBLE Bit = Page * Row_Bits;
+    for ( Column = 0; Column < Font->Width; Column ++, Bit ++ ) {
+      UBYTE On = pgm_read_byte(ptr + (Bit >> 3)) & (0x80 >> (Bit & 7));
 
       //To determine whether the font background color and screen background color is consistent
       if (FONT_BACKGROUND == Color_Background) { //this process is to speed up the scan
-        if (pgm_read_byte(ptr) & (0x80 >> (Column % 8)))
+        if (On)
           Paint_SetPixel (Xpoint + Column, Ypoint + Page, Color_Foreground );
       } else {
-        if (pgm_read_byte(ptr) & (0x80 >> (Column % 8))) {
+        if (On) {
           Paint_SetPixel (Xpoint + Column, Ypoint + Page, Color_Foreground );
         } else {
           Paint_SetPixel (Xpoint + Column, Ypoint + Page, Color_Background );
         }
       }
-      //One pixel is 8 bits
-      if (Column % 8 == 7) {
-        ptr++;
-      }
     }/* Write a line */
-    if (Font->Width % 8 != 0) {
-      ptr++;
-    }
   }/* Write all */
 }
 
@@ -460,6 +721,25 @@ void Paint_DrawString_EN(UWORD Xstart, UWORD Ystart, const char * pString,
     return;
   }
 
+  if (sPaint_mode == PAINT_MODE_RECORD) {
+    // One entry for the whole string; if it wraps, claim the rest of the screen
+    UWORD Len = strlen(pString);
+    UBYTE Wraps = Xstart + Len * Font->Width > Paint.Width || Ystart + Font->Height > Paint.Height;
+    int Xend = Wraps ? Paint.Width : Xstart + Len * Font->Width - 1;
+    int Yend = Wraps ? Paint.Height : Ystart + Font->Height - 1;
+    PAINT_CMD *Cmd = Paint_RecordCmd(PAINT_OP_STRING_EN, Xstart, Ystart, Xend, Yend, Len + 1);
+    if (Cmd) {
+      Cmd->Arg[0] = Xstart;
+      Cmd->Arg[1] = Ystart;
+      Cmd->Arg[2] = Color_Background;
+      Cmd->Arg[3] = Color_Foreground;
+      Cmd->Ptr = Font;
+      memcpy(Cmd + 1, pString, Len + 1);
+      Paint_CommitCmd(Cmd, !Wraps && Len && FONT_BACKGROUND != Color_Background);
+      return;
+    }
+  }
+
   while (* pString != '\0') {
     //if X direction filled , reposition to(Xstart,Ypoint),Ypoint is Y direction plus the Height of the character
     if ((Xpoint + Font->Width ) > Paint.Width ) {
@@ -498,6 +778,26 @@ void Paint_DrawString_CN(UWORD Xstart, UWORD Ystart, const char * pString, cFONT
 {
  const char* p_text = pString;
 
+  if (sPaint_mode == PAINT_MODE_RECORD) {
+    int Width = 0;
+    for (p_text = pString; *p_text != 0; p_text += (*p_text < 0x7F) ? 1 : 3)
+      Width += (*p_text < 0x7F) ? font->ASCII_Width : font->Width;
+    UWORD Len = p_text - pString;
+    PAINT_CMD *Cmd = Paint_RecordCmd(PAINT_OP_STRING_CN, Xstart, Ystart,
+                                     Xstart + Width - 1, Ystart + font->Height - 1, Len + 1);
+    if (Cmd) {
+      Cmd->Arg[0] = Xstart;
+      Cmd->Arg[1] = Ystart;
+      Cmd->Arg[2] = Color_Background;
+      Cmd->Arg[3] = Color_Foreground;
+      Cmd->Ptr = font;
+      memcpy(Cmd + 1, pString, Len + 1);
+      Paint_CommitCmd(Cmd, 0);
+      return;
+    }
+    p_text = pString;
+  }
+
   int refcolumn = Xstart;
   int i, j, Num;
   /* Send the string character by character on EPD */
@@ -556,6 +856,85 @@ void Paint_DrawString_CN(UWORD Xstart, UWORD Ystart, const char * pString, cFONT
   }
 }
 
+/******************************************************************************
+  function: Convert numbers to text without sprintf, division by 100 at a
+            time through a two-digit table
+  parameter:
+    Str           : Output, at least PAINT_NUM_MAX + 1 bytes
+    Nummber       : The number to convert
+    Decimal_Point : Fixed point: Nummber is scaled by 10^Decimal_Point
+  return: Length of the text
+******************************************************************************/
+static const char Paint_Digits2[] =
+  "00010203040506070809101112131415161718192021222324252627282930313233343536373839"
+  "40414243444546474849505152535455565758596061626364656667686970717273747576777879"
+  "8081828384858687888990919293949596979899";
+
+static const UDOUBLE Paint_Pow10[] = {
+  1, 10, 100, 1000, 10000, 100000, 1000000, 10000000, 100000000, 1000000000
+};
+
+UBYTE Paint_UIntToStr(char *Str, UDOUBLE Nummber)
+{
+  char Tmp[10];
+  char *p = Tmp + sizeof(Tmp);
+
+  while (Nummber >= 100) {
+    UDOUBLE Rest = Nummber % 100;
+    Nummber /= 100;
+    p -= 2;
+    p[0] = Paint_Digits2[Rest * 2];
+    p[1] = Paint_Digits2[Rest * 2 + 1];
+  }
+  if (Nummber >= 10) {
+    p -= 2;
+    p[0] = Paint_Digits2[Nummber * 2];
+    p[1] = Paint_Digits2[Nummber * 2 + 1];
+  } else {
+    *--p = '0' + Nummber;
+  }
+
+  UBYTE Len = Tmp + sizeof(Tmp) - p;
+  memcpy(Str, p, Len);
+  Str[Len] = '\0';
+  return Len;
+}
+
+UBYTE Paint_IntToStr(char *Str, int32_t Nummber)
+{
+  if (Nummber < 0) {
+    *Str = '-';
+    return 1 + Paint_UIntToStr(Str + 1, 0u - (UDOUBLE)Nummber);
+  }
+  return Paint_UIntToStr(Str, Nummber);
+}
+
+UBYTE Paint_FixedToStr(char *Str, int32_t Nummber, UBYTE Decimal_Point)
+{
+  UBYTE Len = 0;
+  UDOUBLE Value = Nummber;
+
+  if (Decimal_Point > 9)
+    Decimal_Point = 9;
+  if (Nummber < 0) {
+    Str[Len++] = '-';
+    Value = 0u - (UDOUBLE)Nummber;
+  }
+
+  Len += Paint_UIntToStr(Str + Len, Value / Paint_Pow10[Decimal_Point]);
+  if (Decimal_Point) {
+    UDOUBLE Frac = Value % Paint_Pow10[Decimal_Point];
+    Str[Len++] = '.';
+    for (UBYTE i = Decimal_Point; i > 0; i--) {
+      Str[Len + i - 1] = '0' + Frac % 10;
+      Frac /= 10;
+    }
+    Len += Decimal_Point;
+    Str[Len] = '\0';
+  }
+  return Len;
+}
+
 /******************************************************************************
   function: Display nummber
   parameter:
@@ -566,63 +945,140 @@ void Paint_DrawString_CN(UWORD Xstart, UWORD Ystart, const char * pString, cFONT
     Color_Background : Select the background color of the English character
     Color_Foreground : Select the foreground color of the English character
 ******************************************************************************/
-#define  ARRAY_LEN 50
 void Paint_DrawNum(UWORD Xpoint, UWORD Ypoint, int32_t Nummber,
                    sFONT* Font, UWORD Color_Background, UWORD Color_Foreground )
 {
-
-  int16_t Num_Bit = 0, Str_Bit = 0;
-  uint8_t Str_Array[ARRAY_LEN] = {0}, Num_Array[ARRAY_LEN] = {0};
-  uint8_t *pStr = Str_Array;
+  char Str[PAINT_NUM_MAX + 1];
 
   if (Xpoint > Paint.Width || Ypoint > Paint.Height) {
     //Debug("Paint_DisNum Input exceeds the normal display range\r\n");
     return;
   }
 
-  //Converts a number to a string
-  do{
-    Num_Array[Num_Bit] = Nummber % 10 + '0';
-    Num_Bit++;
-    Nummber /= 10;
-  }while (Nummber);
+  Paint_IntToStr(Str, Nummber);
+  Paint_DrawString_EN(Xpoint, Ypoint, Str, Font, Color_Background, Color_Foreground);
+}
 
-  //The string is inverted
-  while (Num_Bit > 0) {
-    Str_Array[Str_Bit] = Num_Array[Num_Bit - 1];
-    Str_Bit ++;
-    Num_Bit --;
-  }
+/******************************************************************************
+function:	Display fixed-point number
+parameter:
+    Xstart           ：X coordinate
+    Ystart           : Y coordinate
+    Nummber          : The value scaled by 10^Decimal_Point (1234, 2 -> 12.34)
+	Decimal_Point	 : Show decimal places
+    Font             ：A structure pointer that displays a character size
+    Color            : Select the background color of the English character
+******************************************************************************/
+void Paint_DrawFixedNum(UWORD Xpoint, UWORD Ypoint, int32_t Nummber, UBYTE Decimal_Point,
+                        sFONT* Font, UWORD Color_Background, UWORD Color_Foreground)
+{
+  char Str[PAINT_NUM_MAX + 1];
 
-  //show
-  Paint_DrawString_EN(Xpoint, Ypoint, (const char*)pStr, Font, Color_Background, Color_Foreground);
+  Paint_FixedToStr(Str, Nummber, Decimal_Point);
+  Paint_DrawString_EN(Xpoint, Ypoint, Str, Font, Color_Background, Color_Foreground);
 }
+
 /******************************************************************************
 function:	Display float number
 parameter:
     Xstart           ：X coordinate
     Ystart           : Y coordinate
     Nummber          : The float data that you want to display
-	Decimal_Point	 : Show decimal places
+	Decimal_Point	 : Show decimal places (truncated, not rounded)
     Font             ：A structure pointer that displays a character size
     Color            : Select the background color of the English character
 ******************************************************************************/
 void Paint_DrawFloatNum(UWORD Xpoint, UWORD Ypoint, double Nummber,  UBYTE Decimal_Point, 
                         sFONT* Font,  UWORD Color_Background, UWORD Color_Foreground)
 {
-  char Str[ARRAY_LEN] = {0};
-  dtostrf(Nummber,0,Decimal_Point+2,Str);
-  char * pStr= (char *)malloc((strlen(Str))*sizeof(char));
-  memcpy(pStr,Str,(strlen(Str)-2));
-  * (pStr+strlen(Str)-1)='\0';
-  if((*(pStr+strlen(Str)-3))=='.')
-  {
-	*(pStr+strlen(Str)-3)='\0';
-  }
-  //show
-  Paint_DrawString_EN(Xpoint, Ypoint, (const char*)pStr, Font, Color_Foreground, Color_Background);
-  free(pStr);
-  pStr=NULL;
+  if (Decimal_Point > 9)
+    Decimal_Point = 9;
+  // One multiply into fixed point, the rest is integer formatting
+  Paint_DrawFixedNum(Xpoint, Ypoint, (int32_t)(Nummber * Paint_Pow10[Decimal_Point]), Decimal_Point,
+                     Font, Color_Background, Color_Foreground);
+}
+
+/******************************************************************************
+  function: Set up a fixed-width number field
+  parameter:
+    Field            : The field
+    Xpoint, Ypoint   : Top left of the first character cell
+    Width            : Character cells (at most PAINT_NUM_MAX)
+    Align            : PAINT_ALIGN_LEFT or PAINT_ALIGN_RIGHT
+    Font, colors     : As Paint_DrawString_EN()
+******************************************************************************/
+void Paint_NumField_Init(PAINT_NUMFIELD *Field, UWORD Xpoint, UWORD Ypoint, UBYTE Width, UBYTE Align,
+                         sFONT* Font, UWORD Color_Background, UWORD Color_Foreground)
+{
+  Field->Xpoint = Xpoint;
+  Field->Ypoint = Ypoint;
+  Field->Width = Width > PAINT_NUM_MAX ? PAINT_NUM_MAX : Width;
+  Field->Align = Align;
+  Field->Font = Font;
+  Field->Color_Background = Color_Background;
+  Field->Color_Foreground = Color_Foreground;
+  Field->Digits = NULL;
+  Paint_NumField_Invalidate(Field);
+}
+
+/******************************************************************************
+  function: Set up a number field drawn with a large digit cache
+  parameter:
+    Digits : Initialized by Paint_Digits_Init(), must outlive the field
+******************************************************************************/
+void Paint_NumField_InitDigits(PAINT_NUMFIELD *Field, UWORD Xpoint, UWORD Ypoint, UBYTE Width, UBYTE Align,
+                               PAINT_DIGITS *Digits)
+{
+  Paint_NumField_Init(Field, Xpoint, Ypoint, Width, Align, NULL, Digits->Color_Background, Digits->Color_Foreground);
+  Field->Digits = Digits;
+}
+
+/******************************************************************************
+  function: Forget what the field shows, e.g. after the screen was cleared,
+            so the next Paint_DrawNumField() draws every cell
+******************************************************************************/
+void Paint_NumField_Invalidate(PAINT_NUMFIELD *Field)
+{
+  memset(Field->Drawn, 0, sizeof(Field->Drawn));
+}
+
+/******************************************************************************
+  function: Show a number in a fixed-width field, redrawing only the cells
+            whose character changed. Unused cells are blank.
+  parameter:
+    Field         : The field
+    Nummber       : The value, scaled by 10^Decimal_Point
+    Decimal_Point : 0 for integers
+  return: Number of character cells redrawn
+******************************************************************************/
+UBYTE Paint_DrawNumField(PAINT_NUMFIELD *Field, int32_t Nummber, UBYTE Decimal_Point)
+{
+  char Str[PAINT_NUM_MAX + 1];
+  char Cells[PAINT_NUM_MAX];
+  UBYTE Len = Decimal_Point ? Paint_FixedToStr(Str, Nummber, Decimal_Point) : Paint_IntToStr(Str, Nummber);
+  UBYTE Pad, Drawn = 0;
+
+  // Too wide: keep the least significant characters
+  const char *Text = Len > Field->Width ? Str + Len - Field->Width : Str;
+  if (Len > Field->Width)
+    Len = Field->Width;
+
+  Pad = Field->Align == PAINT_ALIGN_RIGHT ? Field->Width - Len : 0;
+  memset(Cells, ' ', Field->Width);
+  memcpy(Cells + Pad, Text, Len);
+
+  for (UBYTE i = 0; i < Field->Width; i++) {
+    if (Field->Drawn[i] == Cells[i])
+      continue;
+    if (Field->Digits)
+      Paint_DrawDigit(Field->Digits, Field->Xpoint + i * Field->Digits->Width, Field->Ypoint, Cells[i]);
+    else
+      Paint_DrawChar(Field->Xpoint + i * Field->Font->Width, Field->Ypoint, Cells[i],
+                     Field->Font, Field->Color_Background, Field->Color_Foreground);
+    Field->Drawn[i] = Cells[i];
+    Drawn++;
+  }
+  return Drawn;
 }
 
 /******************************************************************************
@@ -663,6 +1119,19 @@ void Paint_DrawTime(UWORD Xstart, UWORD Ystart, PAINT_TIME *pTime, sFONT* Font,
 ******************************************************************************/
 void Paint_DrawImage(const unsigned char *image, UWORD xStart, UWORD yStart, UWORD W_Image, UWORD H_Image)
 {
+  if (sPaint_mode == PAINT_MODE_RECORD) {
+    PAINT_CMD *Cmd = Paint_RecordCmd(PAINT_OP_IMAGE, xStart, yStart, xStart + W_Image - 1, yStart + H_Image - 1, 0);
+    if (Cmd) {
+      Cmd->Arg[0] = xStart;
+      Cmd->Arg[1] = yStart;
+      Cmd->Arg[2] = W_Image;
+      Cmd->Arg[3] = H_Image;
+      Cmd->Ptr = image;
+      Paint_CommitCmd(Cmd, 0);
+      return;
+    }
+  }
+
   int i, j;
   for (j = 0; j < H_Image; j++) {
     for (i = 0; i < W_Image; i++) {
@@ -676,3 +1145,72 @@ void Paint_DrawImage(const unsigned char *image, UWORD xStart, UWORD yStart, UWO
   }
 
 }
+
+/******************************************************************************
+  function: Fill one bitmap span: a window per span, never one per pixel
+******************************************************************************/
+static void Paint_BitmapSpan(int Xstart, int Ystart, int Xend, int Yend, UWORD Color)
+{
+  UWORD X0, Y0, X1, Y1;
+
+  if (sPaint_mode == PAINT_MODE_RASTER) {
+    Paint_RasterFill(Xstart, Ystart, Xend, Yend, Color);
+    return;
+  }
+  if (Paint_MapBox(Xstart, Ystart, Xend, Yend, &X0, &Y0, &X1, &Y1))
+    LCD_ClearWindow(X0, Y0, X1 + 1, Y1 + 1, Color);
+}
+
+/******************************************************************************
+  function: Display a 1 bit bitmap, each bit scaled to a Scale x Scale square
+  parameter:
+    Xstart, Ystart   : Top left
+    Bitmap           : Bits and size, must outlive the current frame
+    Scale            : Pixels per bitmap pixel
+    Color_Background : Color of clear bits
+    Color_Foreground : Color of set bits
+  info:
+    Each row is drawn as runs of equal bits, one window fill per run, so a
+    QR code costs a few hundred fills instead of thousands of pixels.
+******************************************************************************/
+void Paint_DrawBitmap(UWORD Xstart, UWORD Ystart, const PAINT_BITMAP *Bitmap, UBYTE Scale,
+                      UWORD Color_Background, UWORD Color_Foreground)
+{
+  if (!Scale || !Bitmap->Width || !Bitmap->Height)
+    return;
+  int Xend = Xstart + Bitmap->Width * Scale - 1;
+  int Yend = Ystart + Bitmap->Height * Scale - 1;
+
+  if (sPaint_mode == PAINT_MODE_RECORD) {
+    PAINT_CMD *Cmd = Paint_RecordCmd(PAINT_OP_BITMAP, Xstart, Ystart, Xend, Yend, 0);
+    if (Cmd) {
+      Cmd->Arg[0] = Xstart;
+      Cmd->Arg[1] = Ystart;
+      Cmd->Arg[2] = Color_Background;
+      Cmd->Arg[3] = Color_Foreground;
+      Cmd->Arg8[0] = Scale;
+      Cmd->Ptr = Bitmap;
+      Paint_CommitCmd(Cmd, 1);
+      return;
+    }
+  } else if (Paint_RasterSkip(Xstart, Ystart, Xend, Yend)) {
+    return;
+  }
+
+  for (UWORD Row = 0; Row < Bitmap->Height; Row++) {
+    int Y = Ystart + Row * Scale;
+    if (Paint_RasterSkip(Xstart, Y, Xend, Y + Scale - 1))
+      continue;
+    const UBYTE *Bits = Bitmap->Bits + Row * Bitmap->Stride;
+    UWORD Col = 0;
+    while (Col < Bitmap->Width) {
+      UBYTE Set = (Bits[Col >> 3] >> (7 - (Col & 7))) & 1;
+      UWORD End = Col + 1;
+      while (End < Bitmap->Width && ((Bits[End >> 3] >> (7 - (End & 7))) & 1) == Set)
+        End++;
+      Paint_BitmapSpan(Xstart + Col * Scale, Y, Xstart + End * Scale - 1, Y + Scale - 1,
+                       Set ? Color_Foreground : Color_Background);
+      Col = End;
+    }
+  }
+}
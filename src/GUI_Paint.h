@@ -146,6 +146,33 @@ typedef enum {
     DRAW_FILL_FULL,
 } DRAW_FILL;
 
+/**
+ * Gradient fill: colors are interpolated along one axis between stops at
+ * From, the middle (three stops only) and To, then ordered-dithered to
+ * RGB565. Positions outside From..To take the end colors.
+**/
+typedef enum {
+    GRADIENT_HORIZONTAL = 0,    // color changes along X
+    GRADIENT_VERTICAL,          // color changes along Y
+} GRADIENT_DIR;
+
+typedef struct {
+    UBYTE Dir;                  // GRADIENT_DIR
+    UBYTE Stops;                // 2 or 3
+    UWORD From, To;             // logical positions of the first and last stop
+    UWORD Color[3];
+} PAINT_GRADIENT;
+
+/**
+ * 1 bit per pixel bitmap (QR codes and the like), MSB first, every row
+ * starting on a byte boundary. Set bits take the foreground color.
+**/
+typedef struct {
+    const UBYTE *Bits;
+    UWORD Width, Height;        // in bitmap pixels
+    UWORD Stride;               // bytes per row
+} PAINT_BITMAP;
+
 /**
  * Custom structure of a time attribute
 **/
@@ -159,6 +186,79 @@ typedef struct {
 } PAINT_TIME;
 extern PAINT_TIME sPaint_time;
 
+/**
+ * Large digit cache: seven-segment glyphs pre-rendered once in panel
+ * memory order, so drawing a digit is a single blit
+**/
+#define PAINT_DIGIT_CHARS   "0123456789:.- "
+
+typedef struct {
+    UWORD Width;                    // glyph cell, logical pixels
+    UWORD Height;
+    UWORD Color_Background;
+    UWORD Color_Foreground;
+    UWORD Rotate;                   // orientation the cache was rendered for
+    UWORD Mirror;
+    UWORD *Pixels;                  // one glyph per PAINT_DIGIT_CHARS entry
+} PAINT_DIGITS;
+
+/**
+ * Fixed-width number field: remembers what each character cell shows so
+ * only the cells that change are redrawn
+**/
+#define PAINT_NUM_MAX   12  // sign, 10 digits and a decimal point
+
+typedef enum {
+    PAINT_ALIGN_LEFT = 0,
+    PAINT_ALIGN_RIGHT,
+} PAINT_ALIGN;
+
+typedef struct {
+    UWORD Xpoint;
+    UWORD Ypoint;
+    UBYTE Width;                    // character cells
+    UBYTE Align;                    // PAINT_ALIGN
+    sFONT *Font;
+    UWORD Color_Background;
+    UWORD Color_Foreground;
+    PAINT_DIGITS *Digits;           // large digits instead of Font, or NULL
+    char Drawn[PAINT_NUM_MAX];      // character in each cell, 0 = unknown
+} PAINT_NUMFIELD;
+
+/**
+ * Strip renderer
+ * Between Paint_BeginFrame() (or Paint_BeginUpdate()) and Paint_EndFrame()
+ * the Paint_* calls are recorded into a display list instead of going to the
+ * panel. Paint_EndFrame() replays the list into a small SRAM strip buffer
+ * and pushes each strip in one burst, so every pixel reaches the panel once.
+ *
+ * Paint_BeginOverlay() records into a second layer that is always composited
+ * over the base layer. Window fills on it are blended with the layer alpha
+ * and pixels of the color key are left out. Paint_ClearOverlay() removes it
+ * and repaints only the area it covered from the base layer.
+**/
+#define PAINT_STRIP_BYTES_DFT   (240 * 16 * 2)      // one 240x16 RGB565 strip
+#define PAINT_LIST_BYTES_DFT    4096                // display list arena
+#define OVERLAY_NO_KEY          0x10000             // overlay without a color key
+
+/**
+ * Called after a region reaches the panel, with its logical box (inclusive).
+ * Lets a screen mirror follow the panel without reading it back in full.
+**/
+typedef void (*PAINT_FLUSH_HOOK)(UWORD Xstart, UWORD Ystart, UWORD Xend, UWORD Yend);
+
+typedef struct {
+    UDOUBLE FrameTime;   // us spent in the last Paint_EndFrame()
+    UDOUBLE RasterTime;  // part of FrameTime spent replaying the list
+    UDOUBLE Pixels;      // pixels pushed by the last frame
+    UWORD Strips;        // strips pushed by the last frame
+    UWORD StripLines;    // rows per full-width strip at the current budget
+    UWORD Commands;      // live display list entries
+    UWORD ListUsed;      // display list bytes in use
+    UDOUBLE Overflows;   // frames that fell back to direct drawing
+} PAINT_FRAME_STATS;
+extern PAINT_FRAME_STATS sPaint_frame;
+
 //init and Clear
 void Paint_NewImage(UWORD Width, UWORD Height, UWORD Rotate, UWORD Color);
 void Paint_SelectImage(UBYTE *image);
@@ -168,6 +268,7 @@ void Paint_SetPixel(UWORD Xpoint, UWORD Ypoint, UWORD Color);
 
 void Paint_Clear(UWORD Color);
 void Paint_ClearWindows(UWORD Xstart, UWORD Ystart, UWORD Xend, UWORD Yend, UWORD Color);
+void Paint_DrawGradient(UWORD Xstart, UWORD Ystart, UWORD Xend, UWORD Yend, const PAINT_GRADIENT *Gradient);
 
 //Drawing
 void Paint_DrawPoint(UWORD Xpoint, UWORD Ypoint, UWORD Color, DOT_PIXEL Dot_Pixel, DOT_STYLE Dot_FillWay);
@@ -181,10 +282,39 @@ void Paint_DrawString_EN(UWORD Xstart, UWORD Ystart, const char * pString, sFONT
 void Paint_DrawString_CN(UWORD Xstart, UWORD Ystart, const char * pString, cFONT* font, UWORD Color_Background, UWORD Color_Foreground);
 void Paint_DrawNum(UWORD Xpoint, UWORD Ypoint, int32_t Nummber, sFONT* Font, UWORD Color_Background, UWORD Color_Foreground);
 void Paint_DrawFloatNum(UWORD Xpoint, UWORD Ypoint, double Nummber,  UBYTE Decimal_Point, sFONT* Font, UWORD Color_Background, UWORD Color_Foreground);
+void Paint_DrawFixedNum(UWORD Xpoint, UWORD Ypoint, int32_t Nummber, UBYTE Decimal_Point, sFONT* Font, UWORD Color_Background, UWORD Color_Foreground);
 void Paint_DrawTime(UWORD Xstart, UWORD Ystart, PAINT_TIME *pTime, sFONT* Font, UWORD Color_Background, UWORD Color_Foreground);
 
+//Number formatting (no sprintf, no heap)
+UBYTE Paint_UIntToStr(char *Str, UDOUBLE Nummber);
+UBYTE Paint_IntToStr(char *Str, int32_t Nummber);
+UBYTE Paint_FixedToStr(char *Str, int32_t Nummber, UBYTE Decimal_Point);
+
+//Number fields
+void Paint_NumField_Init(PAINT_NUMFIELD *Field, UWORD Xpoint, UWORD Ypoint, UBYTE Width, UBYTE Align, sFONT* Font, UWORD Color_Background, UWORD Color_Foreground);
+void Paint_NumField_InitDigits(PAINT_NUMFIELD *Field, UWORD Xpoint, UWORD Ypoint, UBYTE Width, UBYTE Align, PAINT_DIGITS *Digits);
+void Paint_NumField_Invalidate(PAINT_NUMFIELD *Field);
+UBYTE Paint_DrawNumField(PAINT_NUMFIELD *Field, int32_t Nummber, UBYTE Decimal_Point);
+
+//Large digits
+UBYTE Paint_Digits_Init(PAINT_DIGITS *Digits, UWORD Width, UWORD Height, UWORD Color_Background, UWORD Color_Foreground);
+void Paint_Digits_Free(PAINT_DIGITS *Digits);
+void Paint_DrawDigit(PAINT_DIGITS *Digits, UWORD Xpoint, UWORD Ypoint, char Ch);
+UWORD Paint_DrawDigits(PAINT_DIGITS *Digits, UWORD Xpoint, UWORD Ypoint, const char *pString);
+
 //pic
 void Paint_DrawImage(const unsigned char *image,UWORD Startx, UWORD Starty,UWORD Endx, UWORD Endy); 
+void Paint_DrawBitmap(UWORD Xstart, UWORD Ystart, const PAINT_BITMAP *Bitmap, UBYTE Scale, UWORD Color_Background, UWORD Color_Foreground);
+
+//strip renderer
+UBYTE Paint_SetFrameBudget(UDOUBLE StripBytes, UDOUBLE ListBytes);
+void Paint_BeginFrame(void);
+void Paint_BeginUpdate(void);
+void Paint_EndFrame(void);
+UBYTE Paint_BeginOverlay(UBYTE Alpha, UDOUBLE ColorKey);
+UBYTE Paint_ClearOverlay(void);
+UBYTE Paint_ReadLine(UWORD Ypoint, UWORD *Buf);
+void Paint_SetFlushHook(PAINT_FLUSH_HOOK Hook);
 
 
 #endif
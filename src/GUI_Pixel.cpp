@@ -0,0 +1,172 @@
+/*****************************************************************************
+* | File        :   GUI_Pixel.cpp
+* | Function    :   RGB565 pixel kernels for the strip buffers
+* | Info        :
+*   Pixel_Fill  : fill with one color (strip background, rectangles)
+*   Pixel_Swap  : RGB565 <-> panel byte order, in place or copying
+*   Pixel_Blend : mix a color over panel-order pixels with one alpha
+******************************************************************************/
+#include "GUI_Pixel.h"
+
+#if defined(PIXEL_USE_PIE) && defined(CONFIG_IDF_TARGET_ESP32S3)
+#define PIXEL_PIE 1
+#else
+#define PIXEL_PIE 0
+#endif
+
+// Two pixels at once; may alias the UWORD buffers it is used on
+typedef UDOUBLE __attribute__((__may_alias__)) PIXEL_WORD;
+
+#if PIXEL_PIE
+/******************************************************************************
+  function: Store Blocks x 16 bytes of Word, Dst 16-byte aligned
+******************************************************************************/
+static void Pixel_FillPie(UWORD *Dst, UDOUBLE Word, UDOUBLE Blocks)
+{
+  __asm__ volatile (
+    "ee.movi.32.q   q0, %[w], 0     \n"
+    "ee.movi.32.q   q0, %[w], 1     \n"
+    "ee.movi.32.q   q0, %[w], 2     \n"
+    "ee.movi.32.q   q0, %[w], 3     \n"
+    "loopnez        %[n], 1f        \n"
+    "ee.vst.128.ip  q0, %[d], 16    \n"
+    "1:                             \n"
+    : [d] "+r" (Dst)
+    : [w] "r" (Word), [n] "r" (Blocks)
+    : "memory");
+}
+
+/******************************************************************************
+  function: Byte swap Blocks x 16 pixels, Dst and Src 16-byte aligned.
+            Unzip splits 32 bytes into low and high bytes, zipping them back
+            in the other order swaps every pixel.
+******************************************************************************/
+static void Pixel_SwapPie(UWORD *Dst, const UWORD *Src, UDOUBLE Blocks)
+{
+  __asm__ volatile (
+    "loopnez        %[n], 1f        \n"
+    "ee.vld.128.ip  q0, %[s], 16    \n"
+    "ee.vld.128.ip  q1, %[s], 16    \n"
+    "ee.vunzip.8    q0, q1          \n"
+    "ee.vzip.8      q1, q0          \n"
+    "ee.vst.128.ip  q1, %[d], 16    \n"
+    "ee.vst.128.ip  q0, %[d], 16    \n"
+    "1:                             \n"
+    : [d] "+r" (Dst), [s] "+r" (Src)
+    : [n] "r" (Blocks)
+    : "memory");
+}
+#endif
+
+/******************************************************************************
+  function: Fill Count pixels with a color
+******************************************************************************/
+void Pixel_Fill(UWORD *Dst, UWORD Color, UDOUBLE Count)
+{
+  UWORD Swapped = PIXEL_SWAP(Color);
+  UDOUBLE Word = Swapped | ((UDOUBLE)Swapped << 16);
+
+  if (((uintptr_t)Dst & 2) && Count) {
+    *Dst++ = Swapped;
+    Count--;
+  }
+
+#if PIXEL_PIE
+  while (((uintptr_t)Dst & 15) && Count >= 2) {
+    *(PIXEL_WORD *)Dst = Word;
+    Dst += 2;
+    Count -= 2;
+  }
+  if (Count >= 8) {
+    Pixel_FillPie(Dst, Word, Count / 8);
+    Dst += Count & ~7u;
+    Count &= 7;
+  }
+#endif
+
+  PIXEL_WORD *W = (PIXEL_WORD *)Dst;
+  for (; Count >= 8; Count -= 8) {
+    W[0] = Word;
+    W[1] = Word;
+    W[2] = Word;
+    W[3] = Word;
+    W += 4;
+  }
+  for (; Count >= 2; Count -= 2)
+    *W++ = Word;
+  if (Count)
+    *(UWORD *)W = Swapped;
+}
+
+/******************************************************************************
+  function: Swap the bytes of Count pixels. Dst may be Src.
+******************************************************************************/
+void Pixel_Swap(UWORD *Dst, const UWORD *Src, UDOUBLE Count)
+{
+  if ((((uintptr_t)Dst ^ (uintptr_t)Src) & 3) == 0) {
+    if (((uintptr_t)Dst & 2) && Count) {
+      *Dst++ = PIXEL_SWAP(*Src);
+      Src++;
+      Count--;
+    }
+
+#if PIXEL_PIE
+    if ((((uintptr_t)Dst ^ (uintptr_t)Src) & 15) == 0) {
+      while (((uintptr_t)Dst & 15) && Count >= 2) {
+        UDOUBLE Word = *(const PIXEL_WORD *)Src;
+        *(PIXEL_WORD *)Dst = ((Word & 0x00FF00FF) << 8) | ((Word >> 8) & 0x00FF00FF);
+        Dst += 2;
+        Src += 2;
+        Count -= 2;
+      }
+      if (Count >= 16) {
+        Pixel_SwapPie(Dst, Src, Count / 16);
+        Dst += Count & ~15u;
+        Src += Count & ~15u;
+        Count &= 15;
+      }
+    }
+#endif
+
+    for (; Count >= 2; Count -= 2) {
+      UDOUBLE Word = *(const PIXEL_WORD *)Src;
+      *(PIXEL_WORD *)Dst = ((Word & 0x00FF00FF) << 8) | ((Word >> 8) & 0x00FF00FF);
+      Dst += 2;
+      Src += 2;
+    }
+  }
+
+  while (Count--) {
+    *Dst++ = PIXEL_SWAP(*Src);
+    Src++;
+  }
+}
+
+/******************************************************************************
+  function: Blend a color over Count panel-order pixels
+  parameter:
+    Alpha : 0 keeps the pixels, 255 replaces them with Color
+  info: Green is moved to the upper half word so all three channels scale
+        with one multiply: dst = (fg * a + bg * (32 - a)) / 32, a in 0..32
+******************************************************************************/
+void Pixel_Blend(UWORD *Dst, UWORD Color, UBYTE Alpha, UDOUBLE Count)
+{
+  UDOUBLE A = (Alpha + 4) >> 3;
+  UDOUBLE Fg = (((UDOUBLE)Color << 16) | Color) & 0x07E0F81F;
+
+  if (A == 0)
+    return;
+  if (A >= 32) {
+    Pixel_Fill(Dst, Color, Count);
+    return;
+  }
+
+  Fg *= A;
+  for (UDOUBLE i = 0; i < Count; i++) {
+    UWORD Pixel = PIXEL_SWAP(Dst[i]);
+    UDOUBLE Bg = (((UDOUBLE)Pixel << 16) | Pixel) & 0x07E0F81F;
+    UDOUBLE Mix = ((Fg + Bg * (32 - A)) >> 5) & 0x07E0F81F;
+    Pixel = (UWORD)(Mix | (Mix >> 16));
+    Dst[i] = PIXEL_SWAP(Pixel);
+  }
+}
@@ -0,0 +1,23 @@
+/*****************************************************************************
+* | File        :   GUI_Pixel.h
+* | Function    :   RGB565 pixel kernels for the strip buffers
+* | Info        :
+*   Buffers hold pixels in panel byte order (high byte first), colors are
+*   passed in normal RGB565. The portable versions work a 32-bit word (two
+*   pixels) at a time. Building with -DPIXEL_USE_PIE on an ESP32-S3 switches
+*   fill and byte swap to the PIE 128-bit vector unit for the aligned middle
+*   of each buffer; the results are identical, which the serial "check"
+*   command verifies on the device (PixelCheck.h).
+******************************************************************************/
+#ifndef __GUI_PIXEL_H
+#define __GUI_PIXEL_H
+
+#include "DEV_Config.h"
+
+#define PIXEL_SWAP(_c)    ((UWORD)(((_c) << 8) | ((_c) >> 8)))
+
+void Pixel_Fill(UWORD *Dst, UWORD Color, UDOUBLE Count);
+void Pixel_Swap(UWORD *Dst, const UWORD *Src, UDOUBLE Count);
+void Pixel_Blend(UWORD *Dst, UWORD Color, UBYTE Alpha, UDOUBLE Count);
+
+#endif
@@ -0,0 +1,710 @@
+/*****************************************************************************
+* | File        :   GUI_Strip.cpp
+* | Function    :   Display list and strip rasterizer behind GUI_Paint
+* | Info        :
+*   A frame is recorded as a display list (PAINT_CMD entries in one arena),
+*   then replayed strip by strip into one SRAM buffer, each strip pushed in
+*   one burst before the next is rasterized, so the memory cost is one strip
+*   plus the list, never a framebuffer. The push is synchronous, so a second
+*   buffer would only sit idle; it is worth adding with a queued DMA push.
+*
+*   The list is kept after Paint_EndFrame(): Paint_BeginUpdate() appends to
+*   it and only the rows and columns touched by the new entries are pushed.
+*   An opaque entry (clear, filled rectangle, text on a solid background)
+*   retires every older entry hidden under it, which keeps the list bounded
+*   across the once-a-second partial updates.
+*
+*   Overlay entries share the arena but are replayed after all base entries,
+*   so base updates under a toast still come out below it, and removing the
+*   overlay only needs its boxes re-rasterized from the base entries. No
+*   extra pixel memory is needed for either layer.
+******************************************************************************/
+#include "GUI_Strip.h"
+#include "GUI_Pixel.h"
+#include <stdlib.h>
+#include <string.h>
+
+UBYTE sPaint_mode = PAINT_MODE_DIRECT;
+PAINT_TARGET sPaint_target;
+PAINT_LAYER sPaint_layer;
+PAINT_FRAME_STATS sPaint_frame;
+static PAINT_FLUSH_HOOK sPaint_flushHook;
+
+/**
+ * Display list arena and the strip buffer
+**/
+typedef struct {
+    UBYTE *List;
+    UDOUBLE ListSize;
+    UDOUBLE ListUsed;       // bytes in use, dead entries included
+    UDOUBLE ListDead;       // bytes held by dead entries
+    UWORD *Strip;
+    UDOUBLE StripPixels;    // capacity of the strip buffer
+    UBYTE Full;             // current frame repaints the whole panel
+    UBYTE Valid;            // list describes what is on the panel
+    UBYTE Layer;            // recording into the overlay layer
+    UBYTE Overlay;          // an overlay is on the panel
+    UBYTE OverlayAlpha;
+    UDOUBLE OverlayKey;     // color key or OVERLAY_NO_KEY
+} PAINT_STRIP;
+static PAINT_STRIP sStrip;
+
+#define PAINT_CMD_ALIGN(_n)   (((_n) + sizeof(void *) - 1) & ~(sizeof(void *) - 1))
+#define PAINT_CMD_AT(_off)    ((PAINT_CMD *)(sStrip.List + (_off)))
+
+/******************************************************************************
+  function: Set the memory budget of the strip renderer
+  parameter:
+    StripBytes : bytes for the strip buffer
+    ListBytes  : bytes for the display list arena
+  return: 1 on success, 0 if the budget is too small or allocation failed.
+          On failure frames fall back to direct drawing.
+******************************************************************************/
+UBYTE Paint_SetFrameBudget(UDOUBLE StripBytes, UDOUBLE ListBytes)
+{
+  DEV_Free(sStrip.List);
+  DEV_Free(sStrip.Strip);
+  memset(&sStrip, 0, sizeof(sStrip));
+  sPaint_frame.StripLines = 0;
+
+  UDOUBLE StripPixels = StripBytes / 2;
+  if (StripPixels < Paint.WidthMemory || ListBytes < 2 * sizeof(PAINT_CMD)) {
+    Debug("Paint_SetFrameBudget: budget too small\r\n");
+    return 0;
+  }
+
+  sStrip.List = (UBYTE *)DEV_Malloc_DMA(ListBytes);
+  sStrip.Strip = (UWORD *)DEV_Malloc_DMA(StripPixels * 2);
+  if (!sStrip.List || !sStrip.Strip) {
+    Debug("Paint_SetFrameBudget: out of memory\r\n");
+    Paint_SetFrameBudget(0, 0);
+    return 0;
+  }
+
+  sStrip.ListSize = ListBytes;
+  sStrip.StripPixels = StripPixels;
+  sPaint_frame.StripLines = StripPixels / Paint.WidthMemory;
+  return 1;
+}
+
+/******************************************************************************
+  function: Map a logical box to panel memory, clipped to the panel
+  return: 0 if nothing of the box is on the panel
+******************************************************************************/
+UBYTE Paint_MapBox(int Xstart, int Ystart, int Xend, int Yend,
+                   UWORD *X0, UWORD *Y0, UWORD *X1, UWORD *Y1)
+{
+  int Ax, Ay, Bx, By;
+
+  if (Xstart > Xend || Ystart > Yend)
+    return 0;
+  if (!Paint_MapPoint(Xstart, Ystart, &Ax, &Ay) || !Paint_MapPoint(Xend, Yend, &Bx, &By))
+    return 0;
+
+  int Xmin = Ax < Bx ? Ax : Bx, Xmax = Ax < Bx ? Bx : Ax;
+  int Ymin = Ay < By ? Ay : By, Ymax = Ay < By ? By : Ay;
+  if (Xmin < 0) Xmin = 0;
+  if (Ymin < 0) Ymin = 0;
+  if (Xmax > Paint.WidthMemory - 1) Xmax = Paint.WidthMemory - 1;
+  if (Ymax > Paint.HeightMemory - 1) Ymax = Paint.HeightMemory - 1;
+  if (Xmin > Xmax || Ymin > Ymax)
+    return 0;
+
+  *X0 = Xmin;
+  *Y0 = Ymin;
+  *X1 = Xmax;
+  *Y1 = Ymax;
+  return 1;
+}
+
+/******************************************************************************
+  function: Drop dead entries from the list
+******************************************************************************/
+static void Paint_CompactList(void)
+{
+  UDOUBLE Read = 0, Write = 0;
+
+  while (Read < sStrip.ListUsed) {
+    PAINT_CMD *Cmd = PAINT_CMD_AT(Read);
+    UWORD Size = Cmd->Size;
+    if (Cmd->Op != PAINT_OP_NONE) {
+      if (Write != Read)
+        memmove(sStrip.List + Write, Cmd, Size);
+      Write += Size;
+    }
+    Read += Size;
+  }
+  sStrip.ListUsed = Write;
+  sStrip.ListDead = 0;
+}
+
+/******************************************************************************
+  function: Replay one entry through the normal Paint_* code path
+******************************************************************************/
+static void Paint_Replay(const PAINT_CMD *Cmd)
+{
+  const UWORD *A = Cmd->Arg;
+
+  switch (Cmd->Op) {
+    case PAINT_OP_CLEAR:
+      Paint_Clear(A[0]);
+      break;
+    case PAINT_OP_CLEAR_WINDOWS:
+      Paint_ClearWindows(A[0], A[1], A[2], A[3], A[4]);
+      break;
+    case PAINT_OP_PIXEL:
+      Paint_SetPixel(A[0], A[1], A[2]);
+      break;
+    case PAINT_OP_POINT:
+      Paint_DrawPoint(A[0], A[1], A[2], (DOT_PIXEL)Cmd->Arg8[0], (DOT_STYLE)Cmd->Arg8[1]);
+      break;
+    case PAINT_OP_LINE:
+      Paint_DrawLine(A[0], A[1], A[2], A[3], A[4], (DOT_PIXEL)Cmd->Arg8[0], (LINE_STYLE)Cmd->Arg8[1]);
+      break;
+    case PAINT_OP_RECTANGLE:
+      Paint_DrawRectangle(A[0], A[1], A[2], A[3], A[4], (DOT_PIXEL)Cmd->Arg8[0], (DRAW_FILL)Cmd->Arg8[1]);
+      break;
+    case PAINT_OP_CIRCLE:
+      Paint_DrawCircle(A[0], A[1], A[2], A[3], (DOT_PIXEL)Cmd->Arg8[0], (DRAW_FILL)Cmd->Arg8[1]);
+      break;
+    case PAINT_OP_CHAR:
+      Paint_DrawChar(A[0], A[1], (char)Cmd->Arg8[0], (sFONT *)Cmd->Ptr, A[2], A[3]);
+      break;
+    case PAINT_OP_STRING_EN:
+      Paint_DrawString_EN(A[0], A[1], (const char *)(Cmd + 1), (sFONT *)Cmd->Ptr, A[2], A[3]);
+      break;
+    case PAINT_OP_STRING_CN:
+      Paint_DrawString_CN(A[0], A[1], (const char *)(Cmd + 1), (cFONT *)Cmd->Ptr, A[2], A[3]);
+      break;
+    case PAINT_OP_IMAGE:
+      Paint_DrawImage((const unsigned char *)Cmd->Ptr, A[0], A[1], A[2], A[3]);
+      break;
+    case PAINT_OP_DIGIT:
+      Paint_DrawDigit((PAINT_DIGITS *)Cmd->Ptr, A[0], A[1], (char)Cmd->Arg8[0]);
+      break;
+    case PAINT_OP_GRADIENT:
+      Paint_DrawGradient(A[0], A[1], A[2], A[3], (const PAINT_GRADIENT *)Cmd->Ptr);
+      break;
+    case PAINT_OP_BITMAP:
+      Paint_DrawBitmap(A[0], A[1], (const PAINT_BITMAP *)Cmd->Ptr, Cmd->Arg8[0], A[2], A[3]);
+      break;
+    default:
+      break;
+  }
+}
+
+/******************************************************************************
+  function: Rasterize the list into sPaint_target
+******************************************************************************/
+static void Paint_Raster(void)
+{
+  UBYTE Mode = sPaint_mode;
+  UDOUBLE Count = (UDOUBLE)sPaint_target.Pitch * (sPaint_target.Y1 - sPaint_target.Y0 + 1);
+
+  Pixel_Fill(sPaint_target.Buf, Paint.Color, Count);
+
+  // Base layer, then the overlay on top of it
+  sPaint_mode = PAINT_MODE_RASTER;
+  for (UBYTE Layer = 0; Layer <= sStrip.Overlay; Layer++) {
+    sPaint_layer.Active = Layer;
+    sPaint_layer.Alpha = Layer ? sStrip.OverlayAlpha : 255;
+    sPaint_layer.Keyed = Layer && sStrip.OverlayKey != OVERLAY_NO_KEY;
+    sPaint_layer.Key = (UWORD)sStrip.OverlayKey;
+
+    for (UDOUBLE Off = 0; Off < sStrip.ListUsed; Off += PAINT_CMD_AT(Off)->Size) {
+      const PAINT_CMD *Cmd = PAINT_CMD_AT(Off);
+      if (Cmd->Op == PAINT_OP_NONE || !(Cmd->Flags & PAINT_CMD_OVERLAY) != !Layer ||
+          Cmd->X1 < sPaint_target.X0 || Cmd->X0 > sPaint_target.X1 ||
+          Cmd->Y1 < sPaint_target.Y0 || Cmd->Y0 > sPaint_target.Y1)
+        continue;
+      Paint_Replay(Cmd);
+    }
+  }
+  memset(&sPaint_layer, 0, sizeof(sPaint_layer));
+  sPaint_mode = Mode;
+}
+
+/******************************************************************************
+  function: Push a region of panel memory, one strip at a time
+  parameter:
+    X0, Y0, X1, Y1 : memory-space region, inclusive
+******************************************************************************/
+static void Paint_RenderRegion(UWORD X0, UWORD Y0, UWORD X1, UWORD Y1)
+{
+  UWORD Pitch = X1 - X0 + 1;
+  UWORD Lines = sStrip.StripPixels / Pitch;
+
+  LCD_SetCursor(X0, Y0, X1, Y1);
+  for (UDOUBLE Y = Y0; Y <= Y1; Y += Lines) {
+    UWORD Yend = (Y + Lines - 1 < Y1) ? Y + Lines - 1 : Y1;
+
+    sPaint_target.Buf = sStrip.Strip;
+    sPaint_target.X0 = X0;
+    sPaint_target.Y0 = Y;
+    sPaint_target.X1 = X1;
+    sPaint_target.Y1 = Yend;
+    sPaint_target.Pitch = Pitch;
+
+    UDOUBLE Start = DEV_Time_us();
+    Paint_Raster();
+    sPaint_frame.RasterTime += DEV_Time_us() - Start;
+
+    // The window auto-increments, so consecutive strips need no new cursor
+    LCD_WriteData_Buf((const UBYTE *)sStrip.Strip, (UDOUBLE)Pitch * (Yend - Y + 1) * 2);
+    sPaint_frame.Strips++;
+    sPaint_frame.Pixels += (UDOUBLE)Pitch * (Yend - Y + 1);
+  }
+}
+
+/******************************************************************************
+  function: Add a box to a small set of disjoint dirty rectangles. Boxes that
+            touch an existing rectangle are merged into it; when the set is
+            full the box goes to the rectangle that grows the least.
+******************************************************************************/
+#define PAINT_DIRTY_MAX   4
+
+typedef struct {
+    UWORD X0, Y0, X1, Y1;
+} PAINT_RECT;
+
+static UDOUBLE Paint_RectArea(const PAINT_RECT *R)
+{
+  return (UDOUBLE)(R->X1 - R->X0 + 1) * (R->Y1 - R->Y0 + 1);
+}
+
+static void Paint_RectUnion(PAINT_RECT *R, const PAINT_RECT *B)
+{
+  if (B->X0 < R->X0) R->X0 = B->X0;
+  if (B->Y0 < R->Y0) R->Y0 = B->Y0;
+  if (B->X1 > R->X1) R->X1 = B->X1;
+  if (B->Y1 > R->Y1) R->Y1 = B->Y1;
+}
+
+static UBYTE Paint_AddDirty(PAINT_RECT *Set, UBYTE Count, PAINT_RECT Box)
+{
+  for (;;) {
+    UBYTE i, Hit = Count;
+    for (i = 0; i < Count; i++) {
+      if (Box.X0 <= Set[i].X1 && Box.X1 >= Set[i].X0 && Box.Y0 <= Set[i].Y1 && Box.Y1 >= Set[i].Y0) {
+        Hit = i;
+        break;
+      }
+    }
+    if (Hit == Count)
+      break;
+    // Merge and retry: the grown box may now touch another rectangle
+    Paint_RectUnion(&Box, &Set[Hit]);
+    Set[Hit] = Set[--Count];
+  }
+
+  if (Count < PAINT_DIRTY_MAX) {
+    Set[Count++] = Box;
+    return Count;
+  }
+
+  // Set is full: merge into the rectangle that grows the least, then re-add
+  UBYTE Best = 0;
+  UDOUBLE BestGrowth = 0xFFFFFFFF;
+  for (UBYTE i = 0; i < Count; i++) {
+    PAINT_RECT Merged = Set[i];
+    Paint_RectUnion(&Merged, &Box);
+    UDOUBLE Growth = Paint_RectArea(&Merged) - Paint_RectArea(&Set[i]);
+    if (Growth < BestGrowth) {
+      BestGrowth = Growth;
+      Best = i;
+    }
+  }
+  PAINT_RECT Merged = Set[Best];
+  Paint_RectUnion(&Merged, &Box);
+  Set[Best] = Set[--Count];
+  return Paint_AddDirty(Set, Count, Merged);
+}
+
+/******************************************************************************
+  function: Push everything recorded so far (the whole panel for a full
+            frame, otherwise the dirty rectangles of the new entries)
+******************************************************************************/
+static void Paint_PushRects(PAINT_RECT *Dirty, UBYTE Count)
+{
+  for (UBYTE i = 0; i < Count; i++) {
+    Paint_RenderRegion(Dirty[i].X0, Dirty[i].Y0, Dirty[i].X1, Dirty[i].Y1);
+
+    if (sPaint_flushHook) {
+      int Ax, Ay, Bx, By;
+      Paint_UnmapPoint(Dirty[i].X0, Dirty[i].Y0, &Ax, &Ay);
+      Paint_UnmapPoint(Dirty[i].X1, Dirty[i].Y1, &Bx, &By);
+      sPaint_flushHook(Ax < Bx ? Ax : Bx, Ay < By ? Ay : By, Ax < Bx ? Bx : Ax, Ay < By ? By : Ay);
+    }
+  }
+}
+
+static void Paint_FlushList(void)
+{
+  PAINT_RECT Dirty[PAINT_DIRTY_MAX];
+  UBYTE Count = 0;
+
+  if (sStrip.Full) {
+    Dirty[0].X0 = 0;
+    Dirty[0].Y0 = 0;
+    Dirty[0].X1 = Paint.WidthMemory - 1;
+    Dirty[0].Y1 = Paint.HeightMemory - 1;
+    Count = 1;
+  } else {
+    for (UDOUBLE Off = 0; Off < sStrip.ListUsed; Off += PAINT_CMD_AT(Off)->Size) {
+      const PAINT_CMD *Cmd = PAINT_CMD_AT(Off);
+      if (Cmd->Op == PAINT_OP_NONE || !(Cmd->Flags & PAINT_CMD_DIRTY))
+        continue;
+      PAINT_RECT Box = {Cmd->X0, Cmd->Y0, Cmd->X1, Cmd->Y1};
+      Count = Paint_AddDirty(Dirty, Count, Box);
+    }
+  }
+
+  Paint_PushRects(Dirty, Count);
+
+  for (UDOUBLE Off = 0; Off < sStrip.ListUsed; Off += PAINT_CMD_AT(Off)->Size)
+    PAINT_CMD_AT(Off)->Flags &= ~PAINT_CMD_DIRTY;
+  sStrip.Full = 0;
+}
+
+/******************************************************************************
+  function: Merge window fills (or gradient fills) that continue an older
+            fill of the same color (gradient) into it. Run after a flush,
+            when no entry is dirty, so growing an entry's box does not make
+            it be pushed again. Keeps the list short when a bar grows a few
+            columns per frame.
+******************************************************************************/
+static void Paint_MergeList(void)
+{
+  for (UDOUBLE Off = 0; Off < sStrip.ListUsed; Off += PAINT_CMD_AT(Off)->Size) {
+    PAINT_CMD *New = PAINT_CMD_AT(Off);
+    if (New->Op != PAINT_OP_CLEAR_WINDOWS && New->Op != PAINT_OP_GRADIENT)
+      continue;
+    const UWORD *N = New->Arg;
+
+    // Newest first: entries between the two must not overlap the new fill,
+    // as it moves down to the older entry's place in the drawing order
+    PAINT_CMD *Into = NULL;
+    for (UDOUBLE Prev = 0; Prev < Off; Prev += PAINT_CMD_AT(Prev)->Size) {
+      PAINT_CMD *Old = PAINT_CMD_AT(Prev);
+      if (Old->Op == PAINT_OP_NONE)
+        continue;
+      if (Old->X1 >= New->X0 && Old->X0 <= New->X1 && Old->Y1 >= New->Y0 && Old->Y0 <= New->Y1)
+        Into = NULL;
+      if (Old->Op != New->Op || Old->Arg[4] != N[4] || Old->Ptr != New->Ptr ||
+          Old->Flags != New->Flags)
+        continue;
+      const UWORD *O = Old->Arg;
+      if ((O[1] == N[1] && O[3] == N[3] && (O[2] == N[0] || N[2] == O[0])) ||
+          (O[0] == N[0] && O[2] == N[2] && (O[3] == N[1] || N[3] == O[1])))
+        Into = Old;
+    }
+    if (!Into)
+      continue;
+
+    UWORD *O = Into->Arg;
+    if (N[0] < O[0]) O[0] = N[0];
+    if (N[1] < O[1]) O[1] = N[1];
+    if (N[2] > O[2]) O[2] = N[2];
+    if (N[3] > O[3]) O[3] = N[3];
+    Paint_MapBox(O[0], O[1], O[2] - 1, O[3] - 1, &Into->X0, &Into->Y0, &Into->X1, &Into->Y1);
+    New->Op = PAINT_OP_NONE;
+    sStrip.ListDead += New->Size;
+  }
+}
+
+/******************************************************************************
+  function: Append an entry for a Paint_* call being recorded
+  parameter:
+    Op                   : PAINT_OP_*
+    Xstart .. Yend       : logical bounding box of the call, inclusive
+    TextLen              : bytes of inline text to reserve (0 for none)
+  return: the entry to fill in, or NULL when not recording. If the list
+          is full the frame recorded so far is pushed, the renderer falls
+          back to direct drawing and NULL is returned, so the caller just
+          draws as usual.
+******************************************************************************/
+PAINT_CMD *Paint_RecordCmd(UBYTE Op, int Xstart, int Ystart, int Xend, int Yend, UWORD TextLen)
+{
+  if (sPaint_mode != PAINT_MODE_RECORD)
+    return NULL;
+
+  UDOUBLE Size = PAINT_CMD_ALIGN(sizeof(PAINT_CMD) + TextLen);
+  if (sStrip.ListUsed + Size > sStrip.ListSize && sStrip.ListDead)
+    Paint_CompactList();
+  if (sStrip.ListUsed + Size > sStrip.ListSize) {
+    Paint_FlushList();
+    sStrip.Valid = 0;
+    sStrip.ListUsed = 0;
+    sStrip.ListDead = 0;
+    sStrip.Layer = 0;
+    sPaint_mode = PAINT_MODE_DIRECT;
+    sPaint_frame.Overflows++;
+    return NULL;
+  }
+
+  PAINT_CMD *Cmd = PAINT_CMD_AT(sStrip.ListUsed);
+  memset(Cmd, 0, sizeof(PAINT_CMD));
+  Cmd->Op = Op;
+  Cmd->Size = Size;
+  if (!Paint_MapBox(Xstart, Ystart, Xend, Yend, &Cmd->X0, &Cmd->Y0, &Cmd->X1, &Cmd->Y1))
+    Cmd->Op = PAINT_OP_NONE;    // entirely off the panel, kept only until compaction
+  sStrip.ListUsed += Size;
+  return Cmd;
+}
+
+/******************************************************************************
+  function: Finish an entry returned by Paint_RecordCmd()
+  parameter:
+    Opaque : 1 if the call writes every pixel of its box. Older entries
+             lying completely under it are retired.
+******************************************************************************/
+void Paint_CommitCmd(PAINT_CMD *Cmd, UBYTE Opaque)
+{
+  if (Cmd->Op == PAINT_OP_NONE) {
+    sStrip.ListDead += Cmd->Size;
+    return;
+  }
+
+  // Overlay entries are never opaque: they must not hide base entries the
+  // overlay's removal has to bring back
+  if (sStrip.Layer) {
+    Cmd->Flags = PAINT_CMD_DIRTY | PAINT_CMD_OVERLAY;
+    return;
+  }
+  Cmd->Flags = PAINT_CMD_DIRTY | (Opaque ? PAINT_CMD_OPAQUE : 0);
+  if (!Opaque)
+    return;
+
+  for (UDOUBLE Off = 0; PAINT_CMD_AT(Off) != Cmd; Off += PAINT_CMD_AT(Off)->Size) {
+    PAINT_CMD *Old = PAINT_CMD_AT(Off);
+    if (Old->Op != PAINT_OP_NONE && !(Old->Flags & PAINT_CMD_OVERLAY) &&
+        Old->X0 >= Cmd->X0 && Old->X1 <= Cmd->X1 &&
+        Old->Y0 >= Cmd->Y0 && Old->Y1 <= Cmd->Y1) {
+      Old->Op = PAINT_OP_NONE;
+      sStrip.ListDead += Old->Size;
+    }
+  }
+}
+
+/******************************************************************************
+  function: While rasterizing, tell whether a logical box misses the strip
+******************************************************************************/
+UBYTE Paint_RasterSkip(int Xstart, int Ystart, int Xend, int Yend)
+{
+  UWORD X0, Y0, X1, Y1;
+
+  if (sPaint_mode != PAINT_MODE_RASTER)
+    return 0;
+  if (!Paint_MapBox(Xstart, Ystart, Xend, Yend, &X0, &Y0, &X1, &Y1))
+    return 1;
+  return X1 < sPaint_target.X0 || X0 > sPaint_target.X1 ||
+         Y1 < sPaint_target.Y0 || Y0 > sPaint_target.Y1;
+}
+
+/******************************************************************************
+  function: While rasterizing, fill a logical box (inclusive) with a color
+******************************************************************************/
+void Paint_RasterFill(int Xstart, int Ystart, int Xend, int Yend, UWORD Color)
+{
+  UWORD X0, Y0, X1, Y1;
+
+  if (!Paint_MapBox(Xstart, Ystart, Xend, Yend, &X0, &Y0, &X1, &Y1))
+    return;
+  if (X0 < sPaint_target.X0) X0 = sPaint_target.X0;
+  if (Y0 < sPaint_target.Y0) Y0 = sPaint_target.Y0;
+  if (X1 > sPaint_target.X1) X1 = sPaint_target.X1;
+  if (Y1 > sPaint_target.Y1) Y1 = sPaint_target.Y1;
+  if (X0 > X1 || Y0 > Y1)
+    return;
+
+  if (sPaint_layer.Keyed && Color == sPaint_layer.Key)
+    return;
+  for (UWORD Y = Y0; Y <= Y1; Y++) {
+    UWORD *Row = sPaint_target.Buf + (Y - sPaint_target.Y0) * sPaint_target.Pitch + (X0 - sPaint_target.X0);
+    if (sPaint_layer.Active && sPaint_layer.Alpha != 255)
+      Pixel_Blend(Row, Color, sPaint_layer.Alpha, X1 - X0 + 1);
+    else
+      Pixel_Fill(Row, Color, X1 - X0 + 1);
+  }
+}
+
+/******************************************************************************
+  function: Start recording a full frame. The previous base layer is
+            discarded and Paint_EndFrame() repaints the whole panel. An
+            overlay stays and is composited over the new frame.
+******************************************************************************/
+void Paint_BeginFrame(void)
+{
+  if (!sStrip.List)
+    return;
+
+  UDOUBLE Write = 0;
+  if (sStrip.Overlay && sStrip.Valid) {
+    for (UDOUBLE Off = 0; Off < sStrip.ListUsed; Off += PAINT_CMD_AT(Off)->Size) {
+      PAINT_CMD *Cmd = PAINT_CMD_AT(Off);
+      UWORD Size = Cmd->Size;
+      if (Cmd->Op != PAINT_OP_NONE && (Cmd->Flags & PAINT_CMD_OVERLAY)) {
+        memmove(sStrip.List + Write, Cmd, Size);
+        Write += Size;
+      }
+    }
+  }
+
+  sStrip.ListUsed = Write;
+  sStrip.ListDead = 0;
+  sStrip.Full = 1;
+  sStrip.Valid = 1;
+  sStrip.Layer = 0;
+  sPaint_mode = PAINT_MODE_RECORD;
+}
+
+/******************************************************************************
+  function: Start recording a partial update on top of the current list.
+            Paint_EndFrame() only pushes the area the new calls touch.
+            Draws directly when the list was lost to an overflow.
+******************************************************************************/
+void Paint_BeginUpdate(void)
+{
+  if (!sStrip.List || !sStrip.Valid)
+    return;
+
+  sStrip.Full = 0;
+  sStrip.Layer = 0;
+  sPaint_mode = PAINT_MODE_RECORD;
+}
+
+/******************************************************************************
+  function: Start recording onto the overlay layer, like Paint_BeginUpdate()
+            and ended by Paint_EndFrame(). Calls add to the current overlay.
+  parameter:
+    Alpha    : Opacity of window fills (Paint_ClearWindows, filled
+               rectangles), 255 = opaque. Text, lines and pixels are opaque.
+    ColorKey : Pixels of this color are not drawn, or OVERLAY_NO_KEY
+  return: 0 if the strip renderer is unavailable (nothing is recorded)
+******************************************************************************/
+UBYTE Paint_BeginOverlay(UBYTE Alpha, UDOUBLE ColorKey)
+{
+  if (!sStrip.List || !sStrip.Valid)
+    return 0;
+
+  sStrip.Full = 0;
+  sStrip.Layer = 1;
+  sStrip.Overlay = 1;
+  sStrip.OverlayAlpha = Alpha;
+  sStrip.OverlayKey = ColorKey;
+  sPaint_mode = PAINT_MODE_RECORD;
+  return 1;
+}
+
+/******************************************************************************
+  function: Remove the overlay and repaint the area it covered from the
+            base layer
+  return: 0 if the base layer was lost to a list overflow meanwhile; the
+          caller has to redraw the screen
+******************************************************************************/
+UBYTE Paint_ClearOverlay(void)
+{
+  PAINT_RECT Dirty[PAINT_DIRTY_MAX];
+  UBYTE Count = 0;
+
+  if (!sStrip.Overlay)
+    return 1;
+  sStrip.Overlay = 0;
+
+  for (UDOUBLE Off = 0; Off < sStrip.ListUsed; Off += PAINT_CMD_AT(Off)->Size) {
+    PAINT_CMD *Cmd = PAINT_CMD_AT(Off);
+    if (Cmd->Op == PAINT_OP_NONE || !(Cmd->Flags & PAINT_CMD_OVERLAY))
+      continue;
+    PAINT_RECT Box = {Cmd->X0, Cmd->Y0, Cmd->X1, Cmd->Y1};
+    Count = Paint_AddDirty(Dirty, Count, Box);
+    Cmd->Op = PAINT_OP_NONE;
+    sStrip.ListDead += Cmd->Size;
+  }
+
+  if (!sStrip.List || !sStrip.Valid)
+    return 0;
+  Paint_PushRects(Dirty, Count);
+  return 1;
+}
+
+/******************************************************************************
+  function: Rasterize and push what was recorded since Paint_BeginFrame()
+            or Paint_BeginUpdate(), and update sPaint_frame
+******************************************************************************/
+void Paint_EndFrame(void)
+{
+  if (sPaint_mode != PAINT_MODE_RECORD) {
+    sPaint_mode = PAINT_MODE_DIRECT;
+    return;
+  }
+
+  UDOUBLE Start = DEV_Time_us();
+  sPaint_frame.RasterTime = 0;
+  sPaint_frame.Pixels = 0;
+  sPaint_frame.Strips = 0;
+
+  Paint_FlushList();
+  Paint_MergeList();
+  sPaint_mode = PAINT_MODE_DIRECT;
+
+  UWORD Commands = 0;
+  for (UDOUBLE Off = 0; Off < sStrip.ListUsed; Off += PAINT_CMD_AT(Off)->Size)
+    Commands += PAINT_CMD_AT(Off)->Op != PAINT_OP_NONE;
+  sPaint_frame.Commands = Commands;
+  sPaint_frame.ListUsed = sStrip.ListUsed - sStrip.ListDead;
+  sPaint_frame.FrameTime = DEV_Time_us() - Start;
+}
+
+/******************************************************************************
+  function: Read back one logical row of the screen by replaying the list
+            into a line buffer. The panel is not read or written, so this
+            works on write-only SPI panels and costs no framebuffer.
+  parameter:
+    Ypoint : logical row
+    Buf    : Paint.Width pixels, native RGB565 (not panel byte order)
+  return: 0 if the list does not describe the panel (no strip renderer,
+          the last frame overflowed, or called while recording)
+******************************************************************************/
+UBYTE Paint_ReadLine(UWORD Ypoint, UWORD *Buf)
+{
+  UWORD X0, Y0, X1, Y1;
+  int Ax, Ay, Bx, By;
+
+  if (!sStrip.List || !sStrip.Valid || sPaint_mode != PAINT_MODE_DIRECT || Ypoint >= Paint.Height)
+    return 0;
+  if (!Paint_MapBox(0, Ypoint, Paint.Width - 1, Ypoint, &X0, &Y0, &X1, &Y1))
+    return 0;
+
+  // A logical row is one memory row or column, so the target is a line
+  sPaint_target.Buf = Buf;
+  sPaint_target.X0 = X0;
+  sPaint_target.Y0 = Y0;
+  sPaint_target.X1 = X1;
+  sPaint_target.Y1 = Y1;
+  sPaint_target.Pitch = X1 - X0 + 1;
+  Paint_Raster();
+
+  // Put it in logical order: the row may run backwards through memory
+  UWORD Count = (X1 - X0 + 1) * (Y1 - Y0 + 1);
+  if (!Paint_MapPoint(0, Ypoint, &Ax, &Ay) || !Paint_MapPoint(1, Ypoint, &Bx, &By))
+    return 0;
+  if (Bx < Ax || By < Ay) {
+    for (UWORD i = 0, j = Count - 1; i < j; i++, j--) {
+      UWORD T = Buf[i];
+      Buf[i] = Buf[j];
+      Buf[j] = T;
+    }
+  }
+  Pixel_Swap(Buf, Buf, Count);
+  return 1;
+}
+
+/******************************************************************************
+  function: Set the function told about every region pushed to the panel,
+            or NULL. Direct drawing (no strip renderer, list overflow) is not
+            reported; the next full frame is.
+******************************************************************************/
+void Paint_SetFlushHook(PAINT_FLUSH_HOOK Hook)
+{
+  sPaint_flushHook = Hook;
+}
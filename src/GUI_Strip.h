@@ -0,0 +1,197 @@
+/*****************************************************************************
+* | File        :   GUI_Strip.h
+* | Function    :   Display list and strip rasterizer behind GUI_Paint
+* | Info        :
+*   Internal to GUI_Paint.cpp / GUI_Strip.cpp. Sketch code only needs the
+*   Paint_BeginFrame / Paint_BeginUpdate / Paint_EndFrame API in GUI_Paint.h.
+*
+*   Coordinates named Xpoint/Ypoint are logical (rotated) coordinates, X/Y
+*   are panel memory coordinates, the same split as Paint_SetPixel().
+******************************************************************************/
+#ifndef __GUI_STRIP_H
+#define __GUI_STRIP_H
+
+#include "GUI_Paint.h"
+
+/**
+ * Where Paint_SetPixel() output goes
+**/
+typedef enum {
+    PAINT_MODE_DIRECT = 0,  // straight to the panel, one window per pixel
+    PAINT_MODE_RECORD,      // Paint_* calls are appended to the display list
+    PAINT_MODE_RASTER,      // into sPaint_target, while replaying the list
+} PAINT_MODE;
+
+/**
+ * Display list opcodes, one per recordable Paint_* call
+**/
+typedef enum {
+    PAINT_OP_NONE = 0,      // dead entry, dropped by the next compaction
+    PAINT_OP_CLEAR,
+    PAINT_OP_CLEAR_WINDOWS,
+    PAINT_OP_PIXEL,
+    PAINT_OP_POINT,
+    PAINT_OP_LINE,
+    PAINT_OP_RECTANGLE,
+    PAINT_OP_CIRCLE,
+    PAINT_OP_CHAR,
+    PAINT_OP_STRING_EN,
+    PAINT_OP_STRING_CN,
+    PAINT_OP_IMAGE,
+    PAINT_OP_DIGIT,
+    PAINT_OP_GRADIENT,
+    PAINT_OP_BITMAP,
+} PAINT_OP;
+
+#define PAINT_CMD_OPAQUE    0x01    // writes every pixel of its box
+#define PAINT_CMD_DIRTY     0x02    // recorded but not yet on the panel
+#define PAINT_CMD_OVERLAY   0x04    // belongs to the overlay layer
+
+/**
+ * Display list entry. Strings are stored inline right after the entry.
+**/
+typedef struct {
+    UBYTE Op;
+    UBYTE Flags;
+    UWORD Size;             // entry size in bytes, inline text included
+    UWORD X0, Y0, X1, Y1;   // memory-space bounding box, inclusive
+    UWORD Arg[5];
+    UBYTE Arg8[2];
+    const void *Ptr;        // font or image table
+} PAINT_CMD;
+
+/**
+ * Raster target: a window of panel memory backed by an SRAM buffer.
+ * Pixels are stored in panel byte order so the buffer can be sent as is.
+**/
+typedef struct {
+    UWORD *Buf;
+    UWORD X0, Y0, X1, Y1;   // memory-space window, inclusive
+    UWORD Pitch;            // pixels per buffer row
+} PAINT_TARGET;
+
+/**
+ * Composition state while the overlay layer is rasterized
+**/
+typedef struct {
+    UBYTE Active;           // replaying overlay entries
+    UBYTE Alpha;            // window fills: 0 transparent .. 255 opaque
+    UBYTE Keyed;            // pixels of Key are not drawn
+    UWORD Key;
+} PAINT_LAYER;
+
+extern UBYTE sPaint_mode;
+extern PAINT_TARGET sPaint_target;
+extern PAINT_LAYER sPaint_layer;
+
+PAINT_CMD *Paint_RecordCmd(UBYTE Op, int Xstart, int Ystart, int Xend, int Yend, UWORD TextLen);
+void Paint_CommitCmd(PAINT_CMD *Cmd, UBYTE Opaque);
+UBYTE Paint_MapBox(int Xstart, int Ystart, int Xend, int Yend, UWORD *X0, UWORD *Y0, UWORD *X1, UWORD *Y1);
+UBYTE Paint_RasterSkip(int Xstart, int Ystart, int Xend, int Yend);
+void Paint_RasterFill(int Xstart, int Ystart, int Xend, int Yend, UWORD Color);
+
+/******************************************************************************
+  function: Map a logical point to panel memory (rotation, then mirroring)
+  parameter:
+    Xpoint, Ypoint : logical coordinates
+    X, Y           : memory coordinates, may fall outside the panel
+  return: 0 if the current rotation/mirror setting is invalid
+******************************************************************************/
+static inline UBYTE Paint_MapPoint(int Xpoint, int Ypoint, int *X, int *Y)
+{
+  switch (Paint.Rotate) {
+    case 0:
+      *X = Xpoint;
+      *Y = Ypoint;
+      break;
+    case 90:
+      *X = Paint.WidthMemory - Ypoint - 1;
+      *Y = Xpoint;
+      break;
+    case 180:
+      *X = Paint.WidthMemory - Xpoint - 1;
+      *Y = Paint.HeightMemory - Ypoint - 1;
+      break;
+    case 270:
+      *X = Ypoint;
+      *Y = Paint.HeightMemory - Xpoint - 1;
+      break;
+    default:
+      return 0;
+  }
+
+  switch (Paint.Mirror) {
+    case MIRROR_NONE:
+      break;
+    case MIRROR_HORIZONTAL:
+      *X = Paint.WidthMemory - *X - 1;
+      break;
+    case MIRROR_VERTICAL:
+      *Y = Paint.HeightMemory - *Y - 1;
+      break;
+    case MIRROR_ORIGIN:
+      *X = Paint.WidthMemory - *X - 1;
+      *Y = Paint.HeightMemory - *Y - 1;
+      break;
+    default:
+      return 0;
+  }
+  return 1;
+}
+
+/******************************************************************************
+  function: Map a panel memory point back to logical coordinates, the
+            inverse of Paint_MapPoint()
+******************************************************************************/
+static inline void Paint_UnmapPoint(int X, int Y, int *Xpoint, int *Ypoint)
+{
+  switch (Paint.Mirror) {
+    case MIRROR_HORIZONTAL:
+      X = Paint.WidthMemory - X - 1;
+      break;
+    case MIRROR_VERTICAL:
+      Y = Paint.HeightMemory - Y - 1;
+      break;
+    case MIRROR_ORIGIN:
+      X = Paint.WidthMemory - X - 1;
+      Y = Paint.HeightMemory - Y - 1;
+      break;
+    default:
+      break;
+  }
+
+  switch (Paint.Rotate) {
+    case 90:
+      *Xpoint = Y;
+      *Ypoint = Paint.WidthMemory - X - 1;
+      break;
+    case 180:
+      *Xpoint = Paint.WidthMemory - X - 1;
+      *Ypoint = Paint.HeightMemory - Y - 1;
+      break;
+    case 270:
+      *Xpoint = Paint.HeightMemory - Y - 1;
+      *Ypoint = X;
+      break;
+    default:
+      *Xpoint = X;
+      *Ypoint = Y;
+      break;
+  }
+}
+
+/******************************************************************************
+  function: Store one pixel into the raster target, clipped to its window
+******************************************************************************/
+static inline void Paint_RasterPixel(int X, int Y, UWORD Color)
+{
+  if (X < sPaint_target.X0 || X > sPaint_target.X1 ||
+      Y < sPaint_target.Y0 || Y > sPaint_target.Y1)
+    return;
+  if (sPaint_layer.Keyed && Color == sPaint_layer.Key)
+    return;
+  sPaint_target.Buf[(Y - sPaint_target.Y0) * sPaint_target.Pitch + (X - sPaint_target.X0)] =
+    (UWORD)((Color << 8) | (Color >> 8));
+}
+
+#endif
@@ -0,0 +1,128 @@
+#ifndef JIGGLE_SCHEDULER_H
+#define JIGGLE_SCHEDULER_H
+
+#include <stdint.h>
+
+// How late jiggles fired, counted in power-of-two buckets of microseconds
+struct JiggleTiming {
+  static const uint8_t BUCKETS = 24;  // the last one takes everything from ~8.4 s
+
+  uint32_t fired;            // jiggles recorded
+  uint32_t skipped;          // deadlines missed by a whole interval or more
+  uint32_t maxLateUs;
+  uint64_t totalLateUs;
+  uint32_t buckets[BUCKETS]; // [0] 0-1 us, [i] 2^i to 2^(i+1)-1 us
+
+  static uint32_t bucketStartUs(uint8_t i) { return i ? 1UL << i : 0; }
+
+  void add(uint32_t lateUs) {
+    uint8_t i = 0;
+    while (i < BUCKETS - 1 && (lateUs >> (i + 1))) i++;
+    buckets[i]++;
+    fired++;
+    totalLateUs += lateUs;
+    if (lateUs > maxLateUs) maxLateUs = lateUs;
+  }
+};
+
+// When to jiggle: absolute deadlines on a 64-bit microsecond clock
+// (esp_timer_get_time() on the device), so nothing wraps and nothing drifts.
+//
+// The deadlines sit on a fixed grid, start + k * interval. Jitter moves a
+// single jiggle up to jitterMs either way off its grid point but never
+// moves the grid, and a late wakeup only delays the jiggle it belongs to.
+// After n intervals the schedule is therefore exactly n * interval on,
+// however late each one fired.
+class JiggleScheduler {
+private:
+  bool running = false;
+  int64_t gridPoint = 0;  // start of the current interval
+  int64_t next = 0;       // deadline of the next jiggle
+  int32_t offsetUs = 0;   // jitter of that jiggle
+  uint32_t intervalMs = 30000;
+  uint32_t jitterMs = 0;
+  uint32_t rng = 1;
+  JiggleTiming timing = {};
+
+  uint32_t nextRandom() {
+    rng ^= rng << 13;
+    rng ^= rng >> 17;
+    rng ^= rng << 5;
+    return rng;
+  }
+
+  // At most a third of the interval, so jiggles always keep their order
+  uint32_t jitterLimitMs() const {
+    return jitterMs < intervalMs / 3 ? jitterMs : intervalMs / 3;
+  }
+
+  void drawOffset() {
+    uint32_t limitUs = jitterLimitMs() * 1000;
+    offsetUs = limitUs ? (int32_t)(nextRandom() % (2 * limitUs + 1)) - (int32_t)limitUs : 0;
+  }
+
+  void place() {
+    next = gridPoint + (int64_t)intervalMs * 1000 + offsetUs;
+  }
+
+public:
+  void setSeed(uint32_t seed) { rng = seed ? seed : 1; }
+
+  // Takes effect on the interval that is running: its deadline is moved to
+  // the new length from where it started
+  void setInterval(uint32_t ms, uint32_t jitter = 0) {
+    if (ms == 0) ms = 1;
+    if (ms == intervalMs && jitter == jitterMs) return;
+    intervalMs = ms;
+    jitterMs = jitter;
+    drawOffset();
+    if (running) place();
+  }
+
+  uint32_t getInterval() const { return intervalMs; }
+  uint32_t getJitter() const { return jitterMs; }
+
+  // First interval starts now
+  void start(int64_t nowUs) {
+    running = true;
+    gridPoint = nowUs;
+    drawOffset();
+    place();
+  }
+
+  void stop() { running = false; }
+  bool isRunning() const { return running; }
+
+  int64_t deadline() const { return next; }
+  bool isDue(int64_t nowUs) const { return running && nowUs >= next; }
+
+  // Until the next deadline, 0 if it has passed; -1 when stopped
+  int64_t usUntilDue(int64_t nowUs) const {
+    if (!running) return -1;
+    return nowUs >= next ? 0 : next - nowUs;
+  }
+
+  // The jiggle that was due fired at nowUs: record how late it was and
+  // move to the next grid point. Grid points that have already gone by
+  // (the task was held up a whole interval) are skipped, not made up.
+  void fired(int64_t nowUs) {
+    if (!running) return;
+    int64_t late = nowUs - next;
+    timing.add(late <= 0 ? 0 : late > 0xFFFFFFFF ? 0xFFFFFFFF : (uint32_t)late);
+
+    int64_t intervalUs = (int64_t)intervalMs * 1000;
+    gridPoint += intervalUs;
+    if (nowUs - gridPoint >= intervalUs) {
+      int64_t missed = (nowUs - gridPoint) / intervalUs;
+      gridPoint += missed * intervalUs;
+      timing.skipped += missed;
+    }
+    drawOffset();
+    place();
+  }
+
+  const JiggleTiming& getTiming() const { return timing; }
+  void resetTiming() { timing = {}; }
+};
+
+#endif
@@ -29,6 +29,9 @@
 ******************************************************************************/
 #include "LCD_Driver.h"
 
+LCD_BUS_STATS LCD_Bus;
+static UBYTE sLCD_memWrite;     // data bytes go to panel memory (after RAMWR)
+
 /*******************************************************************************
 function:
   Hardware reset
@@ -64,6 +67,9 @@ void LCD_WriteData_Byte(UBYTE da)
   DEV_Digital_Write(DEV_DC_PIN,1);
   DEV_SPI_WRITE(da);  
   DEV_Digital_Write(DEV_CS_PIN,1);
+  LCD_Bus.Selects++;
+  LCD_Bus.Bytes++;
+  if (sLCD_memWrite) LCD_Bus.PixelBytes++;
 }  
 
  void LCD_WriteData_Word(UWORD da)
@@ -74,14 +80,37 @@ void LCD_WriteData_Byte(UBYTE da)
   DEV_SPI_WRITE(i);
   DEV_SPI_WRITE(da);
   DEV_Digital_Write(DEV_CS_PIN,1);
+  LCD_Bus.Selects++;
+  LCD_Bus.Bytes += 2;
+  if (sLCD_memWrite) LCD_Bus.PixelBytes += 2;
 }   
 
+/******************************************************************************
+function: Write a block of data bytes in one burst (CS held low throughout)
+parameter :
+    buf   :   Data, already in panel byte order
+    len   :   Number of bytes
+******************************************************************************/
+void LCD_WriteData_Buf(const UBYTE *buf, UDOUBLE len)
+{
+  DEV_Digital_Write(DEV_CS_PIN,0);
+  DEV_Digital_Write(DEV_DC_PIN,1);
+  DEV_SPI_WRITE_BUF(buf, len);
+  DEV_Digital_Write(DEV_CS_PIN,1);
+  LCD_Bus.Selects++;
+  LCD_Bus.Bytes += len;
+  if (sLCD_memWrite) LCD_Bus.PixelBytes += len;
+}
+
 void LCD_WriteReg(UBYTE da)  
 { 
   DEV_Digital_Write(DEV_CS_PIN,0);
   DEV_Digital_Write(DEV_DC_PIN,0);
   DEV_SPI_WRITE(da);
   //DEV_Digital_Write(DEV_CS_PIN,1);
+  LCD_Bus.Selects++;
+  LCD_Bus.Bytes++;
+  sLCD_memWrite = (da == 0x2C);
 }
 
 /******************************************************************************
@@ -179,6 +208,7 @@ parameter :
 ******************************************************************************/
 void LCD_SetCursor(UWORD Xstart, UWORD Ystart, UWORD Xend, UWORD  Yend)
 { 
+  LCD_Bus.Windows++;
   LCD_WriteReg(0x2a);
   LCD_WriteData_Word(Xstart	+52);
   LCD_WriteData_Word(Xend	+52);
@@ -35,9 +35,22 @@
 #define LCD_WIDTH   135 //LCD width
 #define LCD_HEIGHT  240 //LCD height
 
+/**
+ * Bus traffic counters, for benchmarks. Never reset by the driver.
+**/
+typedef struct {
+    UDOUBLE Bytes;       // SPI bytes, commands and parameters included
+    UDOUBLE Selects;     // CS assertions
+    UDOUBLE Windows;     // address windows set (LCD_SetCursor)
+    UDOUBLE PixelBytes;  // bytes written to panel memory, 2 per pixel
+} LCD_BUS_STATS;
+extern LCD_BUS_STATS LCD_Bus;
+
+
 
 void LCD_WriteData_Byte(UBYTE da); 
 void LCD_WriteData_Word(UWORD da);
+void LCD_WriteData_Buf(const UBYTE *buf, UDOUBLE len);
 void LCD_WriteReg(UBYTE da);
 
 void LCD_SetCursor(UWORD x1, UWORD y1, UWORD x2,UWORD y2);
@@ -0,0 +1,160 @@
+#ifndef LIFETIME_STATS_H
+#define LIFETIME_STATS_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <Preferences.h>
+#include "Tasks.h"
+#include "Profiler.h"
+
+// Counters that survive reboots
+struct LifetimeCounters {
+  uint32_t jiggles;
+  uint32_t connectedSeconds;
+  uint32_t connections;
+  uint32_t reboots;
+};
+
+// Lifetime counters kept in NVS as a ring of small records, each with a
+// sequence number: a commit writes the slot after the newest, and boot
+// reads every slot once and takes the newest one that checks out. A
+// record lost to a power cut mid-write only costs that commit.
+//
+// Commits are rate limited to one per COMMIT_INTERVAL_MS (plus one per
+// boot for the reboot count); flush() writes at once, for a planned
+// restart. NVS spreads the writes over its pages as well, so even with a
+// host connected all the time it is about 150 small writes a day.
+class LifetimeStats {
+public:
+  static const uint8_t SLOTS = 8;
+  static const uint32_t COMMIT_INTERVAL_MS = 10 * 60 * 1000;
+
+private:
+  struct Record {
+    uint32_t sequence;
+    LifetimeCounters counters;
+    uint32_t check;  // FNV-1a of the fields above
+  };
+
+  Preferences preferences;
+  Mutex mutex;
+  LifetimeCounters counters = {};
+  uint32_t sequence = 0;   // of the newest record
+  uint8_t slot = SLOTS - 1;  // where it is
+  bool dirty = false;
+  int64_t lastCommit = 0;
+  bool connected = false;
+  int64_t connectedSince = 0;  // us; time up to here is in counters
+  uint32_t connectedUs = 0;    // fraction of a second not yet counted
+
+  static uint32_t checksum(const Record& r) {
+    const uint8_t* p = (const uint8_t*)&r;
+    uint32_t h = 2166136261u;
+    for (size_t i = 0; i < offsetof(Record, check); i++) h = (h ^ p[i]) * 16777619u;
+    return h;
+  }
+
+  static void key(char* out, uint8_t i) {
+    out[0] = 'r';
+    out[1] = 'e';
+    out[2] = 'c';
+    out[3] = '0' + i;
+    out[4] = '\0';
+  }
+
+  // Caller holds the mutex
+  void commit(int64_t nowUs) {
+    PROFILE_SCOPE(PROF_NVS_WRITE);
+    Record r = {sequence + 1, counters, 0};
+    r.check = checksum(r);
+    uint8_t next = (slot + 1) % SLOTS;
+    char name[5];
+    key(name, next);
+    if (preferences.putBytes(name, &r, sizeof(r)) == sizeof(r)) {
+      sequence = r.sequence;
+      slot = next;
+      dirty = false;
+    }
+    lastCommit = nowUs;
+  }
+
+  // Caller holds the mutex
+  void addConnectedTime(int64_t nowUs) {
+    if (!connected) return;
+    int64_t us = nowUs - connectedSince + connectedUs;
+    connectedSince = nowUs;
+    if (us < 0) us = 0;
+    counters.connectedSeconds += us / 1000000;
+    connectedUs = us % 1000000;
+    if (us >= 1000000) dirty = true;
+  }
+
+public:
+  // Load the newest record and count this boot
+  void begin(int64_t nowUs) {
+    mutex.begin();
+    LockGuard guard(&mutex);
+    preferences.begin("lifetime", false);
+
+    bool found = false;
+    for (uint8_t i = 0; i < SLOTS; i++) {
+      char name[5];
+      key(name, i);
+      Record r;
+      if (preferences.getBytes(name, &r, sizeof(r)) != sizeof(r) || r.check != checksum(r)) continue;
+      if (!found || (int32_t)(r.sequence - sequence) > 0) {
+        found = true;
+        sequence = r.sequence;
+        slot = i;
+        counters = r.counters;
+      }
+    }
+    counters.reboots++;
+    commit(nowUs);
+  }
+
+  void jiggled() {
+    LockGuard guard(&mutex);
+    counters.jiggles++;
+    dirty = true;
+  }
+
+  void setConnected(bool on, int64_t nowUs) {
+    LockGuard guard(&mutex);
+    if (on == connected) return;
+    addConnectedTime(nowUs);
+    connected = on;
+    connectedSince = nowUs;
+    if (on) {
+      counters.connections++;
+      dirty = true;
+    }
+  }
+
+  // Commit if something changed and the last commit is old enough
+  void tick(int64_t nowUs) {
+    LockGuard guard(&mutex);
+    addConnectedTime(nowUs);
+    if (dirty && nowUs - lastCommit >= (int64_t)COMMIT_INTERVAL_MS * 1000) commit(nowUs);
+  }
+
+  // Commit now if anything changed, e.g. before a restart
+  void flush(int64_t nowUs) {
+    LockGuard guard(&mutex);
+    addConnectedTime(nowUs);
+    if (dirty) commit(nowUs);
+  }
+
+  LifetimeCounters get(int64_t nowUs) {
+    LockGuard guard(&mutex);
+    addConnectedTime(nowUs);
+    return counters;
+  }
+
+  uint32_t getSequence() {
+    LockGuard guard(&mutex);
+    return sequence;
+  }
+};
+
+#endif
@@ -0,0 +1,158 @@
+#ifndef MOTION_CURVE_H
+#define MOTION_CURVE_H
+
+#include <stdint.h>
+#include "MotionExecutor.h"
+
+// Curved, human-looking jiggles: a closed path from the origin through a
+// few random waypoints and back, played as one report per BLE HID interval.
+//
+// Each leg is a quadratic Bezier curve bowed to one side by a random
+// control point, and is walked with a minimum-jerk speed profile (slow
+// start, fast middle, slow stop), as people move a mouse. Everything after
+// begin() is integer arithmetic on precomputed tables: positions are kept
+// in 1/16 pixel, and every report sends the difference between the
+// rounded position and what was already sent, so rounding never adds up
+// and the pointer ends exactly where it started.
+class CurveRunner : public MotionSource {
+public:
+  static const uint16_t REPORT_MS = 15;  // a common BLE HID connection interval
+  static const uint16_t MIN_DURATION = 200;
+  static const uint16_t MAX_DURATION = 5000;
+  static const uint8_t MIN_AMPLITUDE = 2;
+  static const uint8_t MAX_AMPLITUDE = 100;
+  static const uint8_t MAX_WAYPOINTS = 3;  // between leaving and returning
+
+  // Minimum-jerk position 10t^3 - 15t^4 + 6t^5 at t = i/64, Q15
+  static uint16_t ease(uint32_t t) {  // t: 0..1 in Q16
+    static const uint16_t table[65] = {
+      0, 1, 10, 31, 73, 139, 233, 361, 526, 730, 975, 1264, 1598, 1977, 2403, 2875,
+      3392, 3954, 4561, 5209, 5898, 6626, 7391, 8189, 9018, 9875, 10758, 11662, 12584, 13521, 14469, 15425,
+      16384, 17343, 18299, 19247, 20184, 21106, 22010, 22893, 23750, 24579, 25377, 26142, 26870, 27559, 28207, 28814,
+      29376, 29893, 30365, 30791, 31170, 31504, 31793, 32038, 32242, 32407, 32535, 32629, 32695, 32737, 32758,
+      32767, 32768,
+    };
+    if (t >= 0x10000) return 32768;
+    uint32_t i = t >> 10;           // 64 intervals
+    uint32_t fraction = t & 0x3FF;  // Q10 within the interval
+    return table[i] + (((table[i + 1] - table[i]) * fraction) >> 10);
+  }
+
+private:
+  struct Point {
+    int16_t x;  // 1/16 pixel
+    int16_t y;
+  };
+
+  Point points[MAX_WAYPOINTS + 2];  // origin, waypoints, origin
+  Point control[MAX_WAYPOINTS + 1];
+  uint8_t legs = 0;
+  uint8_t leg = 0;
+  uint16_t legMs = 0;
+  uint16_t legReports = 0;
+  uint16_t report = 0;    // of the current leg, 1..legReports
+  uint32_t stepQ16 = 0;   // t per report
+  uint32_t legStart = 0;  // ms from the start of the path
+  uint32_t lastTime = 0;
+  int16_t sentX = 0;      // pixels reported so far
+  int16_t sentY = 0;
+  uint32_t rng = 1;
+
+  uint32_t nextRandom() {
+    rng ^= rng << 13;
+    rng ^= rng >> 17;
+    rng ^= rng << 5;
+    return rng;
+  }
+
+  int16_t draw(int16_t lo, int16_t hi) {
+    return lo + (int16_t)(nextRandom() % (uint32_t)(hi - lo + 1));
+  }
+
+  static int8_t clamp8(int32_t v) {
+    return v > 127 ? 127 : v < -127 ? -127 : v;
+  }
+
+  // Nearest whole pixel of a 1/16 pixel coordinate
+  static int16_t pixels(int32_t v) {
+    return (v + 8) >> 4;
+  }
+
+  void startLeg() {
+    legStart = (uint32_t)legMs * leg;
+    report = 0;
+    stepQ16 = 0x10000 / legReports;
+  }
+
+  // Point on the current leg after report k of legReports
+  Point at(uint16_t k) const {
+    int32_t u = k >= legReports ? 32768 : ease(stepQ16 * k);
+    int32_t v = 32768 - u;
+    int32_t a = (v * v) >> 15, b = (2 * v * u) >> 15, c = (u * u) >> 15;
+    const Point& p0 = points[leg];
+    const Point& p1 = points[leg + 1];
+    const Point& q = control[leg];
+    return {(int16_t)((a * p0.x + b * q.x + c * p1.x) >> 15), (int16_t)((a * p0.y + b * q.y + c * p1.y) >> 15)};
+  }
+
+public:
+  // A new path of about durationMs through 2..MAX_WAYPOINTS random points
+  // at most amplitude pixels out. Both are clamped to their limits.
+  void begin(uint16_t durationMs, uint8_t amplitude, uint32_t seed) {
+    if (durationMs < MIN_DURATION) durationMs = MIN_DURATION;
+    if (durationMs > MAX_DURATION) durationMs = MAX_DURATION;
+    if (amplitude < MIN_AMPLITUDE) amplitude = MIN_AMPLITUDE;
+    if (amplitude > MAX_AMPLITUDE) amplitude = MAX_AMPLITUDE;
+    rng = seed ? seed : 1;
+
+    int16_t reach = amplitude * 16;
+    uint8_t waypoints = draw(2, MAX_WAYPOINTS);
+    legs = waypoints + 1;
+    points[0] = points[legs] = {0, 0};
+    for (uint8_t i = 1; i <= waypoints; i++) {
+      points[i] = {draw(-reach, reach), draw(-reach, reach)};
+    }
+    // Bow each leg by up to a quarter of its length, to either side
+    for (uint8_t i = 0; i < legs; i++) {
+      int32_t dx = points[i + 1].x - points[i].x, dy = points[i + 1].y - points[i].y;
+      int32_t bend = draw(-64, 64);  // Q8 of the length, both ways
+      control[i] = {(int16_t)((points[i].x + points[i + 1].x) / 2 - (dy * bend >> 8)),
+                    (int16_t)((points[i].y + points[i + 1].y) / 2 + (dx * bend >> 8))};
+    }
+
+    legMs = durationMs / legs;
+    legReports = legMs / REPORT_MS ? legMs / REPORT_MS : 1;
+    leg = 0;
+    lastTime = 0;
+    sentX = sentY = 0;
+    startLeg();
+  }
+
+  bool next(MotionStep& step) override {
+    if (leg < legs) {
+      Point p = at(++report);
+      uint32_t time = legStart + (uint32_t)legMs * report / legReports;
+      int8_t dx = clamp8(pixels(p.x) - sentX), dy = clamp8(pixels(p.y) - sentY);
+      sentX += dx;
+      sentY += dy;
+      step = {(uint16_t)(time - lastTime), dx, dy, 0, 0};
+      lastTime = time;
+      if (report == legReports) {
+        leg++;
+        if (leg < legs) startLeg();
+      }
+      return true;
+    }
+    // Only if a fast leg hit the report limit: send what is still owed
+    if (sentX || sentY) {
+      int8_t dx = clamp8(-sentX), dy = clamp8(-sentY);
+      sentX += dx;
+      sentY += dy;
+      step = {REPORT_MS, dx, dy, 0, 0};
+      return true;
+    }
+    return false;
+  }
+};
+
+#endif
@@ -0,0 +1,142 @@
+#ifndef MOTION_EXECUTOR_H
+#define MOTION_EXECUTOR_H
+
+#include <stdint.h>
+
+// One HID report of a motion pattern, sent delay ms after the previous step
+// (or the start). A step without movement or click only adds time.
+struct MotionStep {
+  uint16_t delay;
+  int8_t x;
+  int8_t y;
+  int8_t wheel;
+  uint8_t click;  // buttons pressed and released (MOUSE_LEFT, ...)
+};
+
+// Produces the steps of a pattern one at a time; false when it has ended
+class MotionSource {
+public:
+  virtual bool next(MotionStep& step) = 0;
+};
+
+// Motion counters, reset by resetStats()
+struct MotionStats {
+  uint32_t patterns;  // patterns played to the end
+  uint32_t reports;   // reports sent
+  uint32_t maxLate;   // ms the latest report was sent after its due time
+};
+
+// Plays a motion pattern without blocking.
+//
+// Due times are fixed from the start of the pattern, so a late wakeup
+// delays one report but never the ones after it. The owner calls tick()
+// whenever msUntilNext() has passed; reports go out through the output
+// function from that context (the BLE task), nothing here waits.
+// Patterns are either a queued list of steps or a MotionSource that is
+// asked for one step at a time, so they can be longer than the queue.
+class MotionExecutor {
+public:
+  static const uint8_t MAX_STEPS = 32;
+  typedef void (*Output)(const MotionStep& step, void* context);
+
+private:
+  MotionStep steps[MAX_STEPS];
+  uint8_t count = 0;
+  uint8_t next = 0;           // next queued step to fetch
+  MotionSource* source = nullptr;
+  MotionStep current = {};    // step waiting for its due time
+  unsigned long due = 0;
+  bool running = false;
+  Output output = nullptr;
+  void* context = nullptr;
+  MotionStats stats = {};
+
+  bool fetch(MotionStep& step) {
+    if (source) return source->next(step);
+    if (next >= count) return false;
+    step = steps[next++];
+    return true;
+  }
+
+  bool start(unsigned long now) {
+    running = fetch(current);
+    due = now + current.delay;
+    return running;
+  }
+
+public:
+  void setOutput(Output fn, void* ctx) {
+    output = fn;
+    context = ctx;
+  }
+
+  // Queue a pattern starting at now, replacing one still running. False if
+  // it is empty or longer than MAX_STEPS.
+  bool play(const MotionStep* pattern, uint8_t n, unsigned long now) {
+    if (n == 0 || n > MAX_STEPS) return false;
+    for (uint8_t i = 0; i < n; i++) steps[i] = pattern[i];
+    count = n;
+    next = 0;
+    source = nullptr;
+    return start(now);
+  }
+
+  // Play steps from a source, which must outlive the pattern. False if it
+  // has none.
+  bool play(MotionSource& from, unsigned long now) {
+    source = &from;
+    return start(now);
+  }
+
+  void cancel() { running = false; }
+
+  bool isRunning() const { return running; }
+
+  // Time until the next step is due, at most idleMs
+  unsigned long msUntilNext(unsigned long now, unsigned long idleMs) const {
+    if (!isRunning()) return idleMs;
+    long wait = (long)(due - now);
+    if (wait <= 0) return 0;
+    return (unsigned long)wait < idleMs ? (unsigned long)wait : idleMs;
+  }
+
+  // Send every step that is due. Returns true when this finished the pattern.
+  bool tick(unsigned long now) {
+    if (!isRunning()) return false;
+    while (running && (long)(now - due) >= 0) {
+      if (current.x || current.y || current.wheel || current.click) {
+        if (now - due > stats.maxLate) stats.maxLate = now - due;
+        if (output) output(current, context);
+        stats.reports++;
+      }
+      running = fetch(current);
+      if (running) due += current.delay;
+    }
+    if (running) return false;
+    stats.patterns++;
+    return true;
+  }
+
+  const MotionStats& getStats() const { return stats; }
+  void resetStats() { stats = {}; }
+
+  // Square: right, down, left, up, 50 ms apart; 200 ms in all
+  static uint8_t square(MotionStep* out, int8_t distance) {
+    out[0] = {0, distance, 0, 0, 0};
+    out[1] = {50, 0, distance, 0, 0};
+    out[2] = {50, (int8_t)-distance, 0, 0, 0};
+    out[3] = {50, 0, (int8_t)-distance, 0, 0};
+    out[4] = {50, 0, 0, 0, 0};
+    return 5;
+  }
+
+  // Out to (dx, dy) and back 100 ms later; 150 ms in all
+  static uint8_t outAndBack(MotionStep* out, int8_t dx, int8_t dy) {
+    out[0] = {0, dx, dy, 0, 0};
+    out[1] = {100, (int8_t)-dx, (int8_t)-dy, 0, 0};
+    out[2] = {50, 0, 0, 0, 0};
+    return 3;
+  }
+};
+
+#endif
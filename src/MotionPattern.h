@@ -0,0 +1,463 @@
+#ifndef MOTION_PATTERN_H
+#define MOTION_PATTERN_H
+
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include "MotionExecutor.h"
+
+// User-defined jiggle patterns: a small text language, compiled on the
+// device into bytecode that is stored in NVS and run by PatternRunner.
+//
+//   move X Y        relative move, -127..127
+//   scroll N        wheel, -127..127
+//   click [BUTTON]  left (default), right or middle
+//   wait MS         0..10000 ms before the next report
+//   repeat N        1..255 times, up to "end"; nested up to 4 deep
+//   end
+//
+// Any number can also be a range "lo..hi", drawn anew each time it runs.
+// Statements are separated by newlines or ';'; '#' starts a comment.
+//
+// Bytecode: an opcode byte, then its operands (a range is lo, hi):
+//   0x10|r  move    r: bit 0 x is a range, bit 1 y is; int8 operands
+//   0x20|r  wait    uint16 LE operands
+//   0x30|r  scroll  int8 operands
+//   0x40|b  click   b: buttons, 1 left, 2 right, 4 middle
+//   0x50    repeat  uint8 count, then the body up to
+//   0x00    end
+class MotionPattern {
+public:
+  static const uint8_t MAX_BYTES = 96;
+  static const uint8_t MAX_DEPTH = 4;
+  static const uint16_t MAX_WAIT = 10000;
+  static const uint32_t MAX_DURATION = 10000;  // ms, longest random draws
+  static const uint16_t MAX_REPORTS = 500;
+  static const uint16_t MAX_SOURCE = 2048;  // decompiled text of any program, NUL included
+
+  enum Opcode : uint8_t {
+    OP_END = 0x00,
+    OP_MOVE = 0x10,
+    OP_WAIT = 0x20,
+    OP_SCROLL = 0x30,
+    OP_CLICK = 0x40,
+    OP_REPEAT = 0x50,
+  };
+
+  // Worst case of a program: longest waits, every repeat run in full
+  struct Info {
+    uint32_t duration;  // ms
+    uint32_t reports;
+  };
+
+  struct Result {
+    bool ok;
+    uint8_t length;     // bytecode bytes
+    uint16_t line;      // of the error, 0 if it is about the whole pattern
+    const char* error;
+    Info info;
+  };
+
+private:
+  // Operand bytes of an instruction, or -1 if the opcode is not valid
+  static int8_t operandBytes(uint8_t op) {
+    switch (op & 0xF0) {
+      case OP_END: return op == OP_END ? 0 : -1;
+      case OP_MOVE: return op & 0x0C ? -1 : 2 + (op & 1) + ((op >> 1) & 1);
+      case OP_WAIT: return op & 0x0E ? -1 : (op & 1) ? 4 : 2;
+      case OP_SCROLL: return op & 0x0E ? -1 : (op & 1) ? 2 : 1;
+      case OP_CLICK: return (op & 0x0F) && !(op & 0x08) ? 0 : -1;
+      case OP_REPEAT: return op == OP_REPEAT ? 1 : -1;
+    }
+    return -1;
+  }
+
+  static uint16_t u16(const uint8_t* p) { return p[0] | (p[1] << 8); }
+
+  static uint32_t saturate(uint64_t v) { return v > 0xFFFFFFFF ? 0xFFFFFFFF : (uint32_t)v; }
+
+  struct Token {
+    const char* text;
+    uint8_t length;
+  };
+
+  static bool equals(const Token& t, const char* word) {
+    return strlen(word) == t.length && strncmp(t.text, word, t.length) == 0;
+  }
+
+  static bool parseInt(const char* p, const char* end, long& value) {
+    bool negative = p < end && *p == '-';
+    if (negative) p++;
+    if (p == end) return false;
+    value = 0;
+    for (; p < end; p++) {
+      if (*p < '0' || *p > '9' || value > 100000) return false;
+      value = value * 10 + (*p - '0');
+    }
+    if (negative) value = -value;
+    return true;
+  }
+
+  // A number or "lo..hi" within [min, max]
+  static const char* parseValue(const Token& t, long min, long max, long& lo, long& hi, bool& range) {
+    const char* end = t.text + t.length;
+    const char* dots = nullptr;
+    for (const char* p = t.text; p + 1 < end; p++) {
+      if (p[0] == '.' && p[1] == '.') {
+        dots = p;
+        break;
+      }
+    }
+    range = dots != nullptr;
+    if (range ? !parseInt(t.text, dots, lo) || !parseInt(dots + 2, end, hi) : !parseInt(t.text, end, lo)) {
+      return "bad number";
+    }
+    if (!range) hi = lo;
+    if (lo < min || hi > max) return "number out of range";
+    if (lo > hi) return "range is backwards";
+    return nullptr;
+  }
+
+  // Compile one statement of n tokens into code at length
+  static const char* statement(const Token* tokens, uint8_t n, uint8_t* code, uint8_t capacity,
+                               uint8_t& length, uint8_t& depth) {
+    uint8_t out[5];
+    uint8_t size = 0;
+    long lo, hi, lo2, hi2;
+    bool range, range2;
+    const char* error;
+    const Token& op = tokens[0];
+
+    if (equals(op, "move")) {
+      if (n != 3) return "move takes x and y";
+      if ((error = parseValue(tokens[1], -127, 127, lo, hi, range))) return error;
+      if ((error = parseValue(tokens[2], -127, 127, lo2, hi2, range2))) return error;
+      out[size++] = OP_MOVE | range | (range2 << 1);
+      out[size++] = (int8_t)lo;
+      if (range) out[size++] = (int8_t)hi;
+      out[size++] = (int8_t)lo2;
+      if (range2) out[size++] = (int8_t)hi2;
+    } else if (equals(op, "wait")) {
+      if (n != 2) return "wait takes milliseconds";
+      if ((error = parseValue(tokens[1], 0, MAX_WAIT, lo, hi, range))) return error;
+      out[size++] = OP_WAIT | range;
+      out[size++] = lo & 0xFF;
+      out[size++] = lo >> 8;
+      if (range) {
+        out[size++] = hi & 0xFF;
+        out[size++] = hi >> 8;
+      }
+    } else if (equals(op, "scroll")) {
+      if (n != 2) return "scroll takes a distance";
+      if ((error = parseValue(tokens[1], -127, 127, lo, hi, range))) return error;
+      out[size++] = OP_SCROLL | range;
+      out[size++] = (int8_t)lo;
+      if (range) out[size++] = (int8_t)hi;
+    } else if (equals(op, "click")) {
+      if (n > 2) return "click takes one button";
+      uint8_t button = 1;
+      if (n == 2) {
+        if (equals(tokens[1], "left")) button = 1;
+        else if (equals(tokens[1], "right")) button = 2;
+        else if (equals(tokens[1], "middle")) button = 4;
+        else return "unknown button";
+      }
+      out[size++] = OP_CLICK | button;
+    } else if (equals(op, "repeat")) {
+      if (n != 2) return "repeat takes a count";
+      if ((error = parseValue(tokens[1], 1, 255, lo, hi, range))) return error;
+      if (range) return "repeat count cannot be random";
+      if (depth == MAX_DEPTH) return "repeats nested too deep";
+      depth++;
+      out[size++] = OP_REPEAT;
+      out[size++] = lo;
+    } else if (equals(op, "end")) {
+      if (n != 1) return "end takes nothing";
+      if (depth == 0) return "end without repeat";
+      depth--;
+      out[size++] = OP_END;
+    } else {
+      return "unknown command";
+    }
+
+    if (length + size > capacity) return "pattern too long";
+    memcpy(code + length, out, size);
+    length += size;
+    return nullptr;
+  }
+
+public:
+  // Check a program: valid opcodes, complete operands, balanced repeats,
+  // and within MAX_DURATION and MAX_REPORTS
+  static bool check(const uint8_t* code, uint8_t length, Info* info = nullptr) {
+    uint64_t duration[MAX_DEPTH + 1] = {};
+    uint64_t reports[MAX_DEPTH + 1] = {};
+    uint8_t counts[MAX_DEPTH + 1];
+    uint8_t depth = 0;
+
+    for (uint8_t pc = 0; pc < length;) {
+      uint8_t op = code[pc];
+      int8_t operands = operandBytes(op);
+      if (operands < 0 || pc + 1 + operands > length) return false;
+      const uint8_t* arg = code + pc + 1;
+      pc += 1 + operands;
+
+      switch (op & 0xF0) {
+        case OP_MOVE:
+        case OP_SCROLL:
+        case OP_CLICK:
+          reports[depth]++;
+          break;
+        case OP_WAIT: {
+          uint16_t lo = u16(arg), hi = (op & 1) ? u16(arg + 2) : lo;
+          if (hi > MAX_WAIT || lo > hi) return false;
+          duration[depth] += hi;
+          break;
+        }
+        case OP_REPEAT:
+          if (depth == MAX_DEPTH || arg[0] == 0) return false;
+          counts[depth++] = arg[0];
+          duration[depth] = reports[depth] = 0;
+          break;
+        case OP_END:
+          if (depth == 0) return false;
+          depth--;
+          duration[depth] += duration[depth + 1] * counts[depth];
+          reports[depth] += reports[depth + 1] * counts[depth];
+          break;
+      }
+      // A range on a move or scroll must not be backwards either
+      if (((op & 0xF0) == OP_MOVE && (((op & 1) && (int8_t)arg[0] > (int8_t)arg[1]) ||
+                                      ((op & 2) && (int8_t)arg[1 + (op & 1)] > (int8_t)arg[2 + (op & 1)]))) ||
+          ((op & 0xF0) == OP_SCROLL && (op & 1) && (int8_t)arg[0] > (int8_t)arg[1])) {
+        return false;
+      }
+    }
+    if (depth != 0) return false;
+    // The sums cannot overflow (at most 255^4 runs of a 96-byte body), but
+    // they can exceed 32 bits: report those as the largest value
+    if (info) *info = {saturate(duration[0]), saturate(reports[0])};
+    return duration[0] <= MAX_DURATION && reports[0] <= MAX_REPORTS;
+  }
+
+  // Compile source into code (at most capacity bytes)
+  static Result compile(const char* source, uint8_t* code, uint8_t capacity) {
+    Result result = {false, 0, 0, nullptr, {0, 0}};
+    uint8_t depth = 0;
+    uint16_t line = 1;
+    uint16_t repeatLine[MAX_DEPTH];
+    const char* p = source;
+
+    while (*p) {
+      // Split one statement into tokens, skipping comments
+      Token tokens[4];
+      uint8_t n = 0;
+      bool tooMany = false;
+      while (*p && *p != '\n' && *p != ';') {
+        if (*p == '#') {
+          while (*p && *p != '\n') p++;
+          break;
+        }
+        if (*p == ' ' || *p == '\t' || *p == '\r') {
+          p++;
+          continue;
+        }
+        const char* start = p;
+        while (*p && *p != ' ' && *p != '\t' && *p != '\r' && *p != '\n' && *p != ';' && *p != '#') p++;
+        if (n < 4 && p - start < 24) {
+          tokens[n++] = {start, (uint8_t)(p - start)};
+        } else {
+          tooMany = true;
+        }
+      }
+
+      if (tooMany || n > 0) {
+        if (n > 0 && equals(tokens[0], "repeat") && depth < MAX_DEPTH) repeatLine[depth] = line;
+        const char* error = tooMany ? "statement too long"
+                                    : statement(tokens, n, code, capacity, result.length, depth);
+        if (error) {
+          result.line = line;
+          result.error = error;
+          return result;
+        }
+      }
+      if (*p == '\n') line++;
+      if (*p) p++;
+    }
+
+    if (depth > 0) {
+      result.line = repeatLine[depth - 1];
+      result.error = "repeat without end";
+    } else if (result.length == 0) {
+      result.error = "empty pattern";
+    } else if (!check(code, result.length, &result.info)) {
+      result.error = result.info.duration > MAX_DURATION ? "pattern runs longer than 10 s"
+                                                         : "pattern sends too many reports";
+    } else if (result.info.reports == 0) {
+      result.error = "pattern never moves";
+    } else {
+      result.ok = true;
+    }
+    return result;
+  }
+
+  // Turn bytecode back into source, one statement per line, repeat bodies
+  // indented. Returns the characters written (the text is cut at size).
+  static size_t decompile(const uint8_t* code, uint8_t length, char* out, size_t size) {
+    size_t used = 0;
+    uint8_t depth = 0;
+    if (size) out[0] = '\0';
+
+    for (uint8_t pc = 0; pc < length;) {
+      uint8_t op = code[pc];
+      int8_t operands = operandBytes(op);
+      if (operands < 0 || pc + 1 + operands > length) break;
+      const uint8_t* arg = code + pc + 1;
+      pc += 1 + operands;
+
+      char text[40];
+      char a[16], b[16];  // "10000..10000" is the widest
+      if (op == OP_END && depth > 0) depth--;
+      switch (op & 0xF0) {
+        case OP_MOVE:
+          formatValue(a, sizeof(a), (int8_t)arg[0], (int8_t)arg[op & 1], op & 1);
+          formatValue(b, sizeof(b), (int8_t)arg[1 + (op & 1)], (int8_t)arg[1 + (op & 1) + ((op >> 1) & 1)], op & 2);
+          snprintf(text, sizeof(text), "move %s %s", a, b);
+          break;
+        case OP_WAIT:
+          formatValue(a, sizeof(a), u16(arg), u16(arg + ((op & 1) ? 2 : 0)), op & 1);
+          snprintf(text, sizeof(text), "wait %s", a);
+          break;
+        case OP_SCROLL:
+          formatValue(a, sizeof(a), (int8_t)arg[0], (int8_t)arg[op & 1], op & 1);
+          snprintf(text, sizeof(text), "scroll %s", a);
+          break;
+        case OP_CLICK:
+          snprintf(text, sizeof(text), "click %s", (op & 2) ? "right" : (op & 4) ? "middle" : "left");
+          break;
+        case OP_REPEAT:
+          snprintf(text, sizeof(text), "repeat %u", arg[0]);
+          break;
+        default:
+          snprintf(text, sizeof(text), "end");
+          break;
+      }
+
+      int written = snprintf(out + used, size > used ? size - used : 0, "%*s%s\n", depth * 2, "", text);
+      if (written < 0 || used + written >= size) {
+        if (size) out[used] = '\0';
+        return used;
+      }
+      used += written;
+      if (op == OP_REPEAT) depth++;
+    }
+    return used;
+  }
+
+private:
+  static void formatValue(char* out, size_t size, long lo, long hi, bool range) {
+    if (range) {
+      snprintf(out, size, "%ld..%ld", lo, hi);
+    } else {
+      snprintf(out, size, "%ld", lo);
+    }
+  }
+};
+
+// Runs a compiled pattern one step at a time, in fixed memory: the program
+// is copied in, repeats use a stack of MAX_DEPTH counters, and random
+// ranges come from a seeded xorshift generator (so a seed replays exactly).
+// Waits are folded into the delay of the next report; a trailing wait
+// becomes one empty step.
+class PatternRunner : public MotionSource {
+private:
+  struct Loop {
+    uint8_t body;  // pc of the first body instruction
+    uint8_t left;  // runs still to go, this one included
+  };
+
+  uint8_t code[MotionPattern::MAX_BYTES];
+  uint8_t length = 0;
+  uint8_t pc = 0;
+  Loop loops[MotionPattern::MAX_DEPTH];
+  uint8_t depth = 0;
+  uint32_t rng = 1;
+
+  uint32_t nextRandom() {
+    rng ^= rng << 13;
+    rng ^= rng >> 17;
+    rng ^= rng << 5;
+    return rng;
+  }
+
+  long draw(long lo, long hi) {
+    return lo == hi ? lo : lo + (long)(nextRandom() % (uint32_t)(hi - lo + 1));
+  }
+
+  int8_t byteValue(uint8_t& at, bool range) {
+    int8_t lo = code[at++];
+    if (!range) return lo;
+    int8_t hi = code[at++];
+    return draw(lo, hi);
+  }
+
+public:
+  // Copy and check a program; false (nothing to run) if it is not valid.
+  // Checking the copy makes it safe against the settings changing meanwhile.
+  bool begin(const uint8_t* program, uint8_t n, uint32_t seed) {
+    length = 0;
+    if (n > sizeof(code)) return false;
+    memcpy(code, program, n);
+    if (!MotionPattern::check(code, n)) return false;
+    length = n;
+    pc = 0;
+    depth = 0;
+    rng = seed ? seed : 1;
+    return true;
+  }
+
+  bool next(MotionStep& step) override {
+    uint32_t delay = 0;
+    while (pc < length) {
+      uint8_t op = code[pc++];
+      switch (op & 0xF0) {
+        case MotionPattern::OP_END:
+          if (--loops[depth - 1].left) {
+            pc = loops[depth - 1].body;
+          } else {
+            depth--;
+          }
+          break;
+        case MotionPattern::OP_REPEAT:
+          loops[depth++] = {(uint8_t)(pc + 1), code[pc]};
+          pc++;
+          break;
+        case MotionPattern::OP_WAIT: {
+          uint16_t lo = code[pc] | (code[pc + 1] << 8);
+          uint16_t hi = lo;
+          if (op & 1) hi = code[pc + 2] | (code[pc + 3] << 8);
+          pc += (op & 1) ? 4 : 2;
+          delay += draw(lo, hi);
+          break;
+        }
+        case MotionPattern::OP_MOVE: {
+          int8_t x = byteValue(pc, op & 1);
+          int8_t y = byteValue(pc, op & 2);
+          step = {(uint16_t)delay, x, y, 0, 0};
+          return true;
+        }
+        case MotionPattern::OP_SCROLL:
+          step = {(uint16_t)delay, 0, 0, byteValue(pc, op & 1), 0};
+          return true;
+        case MotionPattern::OP_CLICK:
+          step = {(uint16_t)delay, 0, 0, 0, (uint8_t)(op & 0x07)};
+          return true;
+      }
+    }
+    if (delay == 0) return false;
+    step = {(uint16_t)delay, 0, 0, 0, 0};
+    return true;
+  }
+};
+
+#endif
@@ -0,0 +1,163 @@
+#ifndef POWER_MANAGER_H
+#define POWER_MANAGER_H
+
+#include <stdint.h>
+#include "Tasks.h"
+
+#ifdef ARDUINO
+#include <esp_pm.h>
+#include <esp_timer.h>
+#include <esp_idf_version.h>
+#else
+#include <chrono>
+#endif
+
+// What keeps the chip awake, each a counted lock
+enum PowerLock : uint8_t {
+  POWER_RENDER,  // drawing and pushing the screen; full CPU speed
+  POWER_HTTP,    // serving a web request; full CPU speed
+  POWER_MOTION,  // a jiggle pattern is playing; no light sleep between reports
+  POWER_LOCKS
+};
+
+// Lets the chip scale its clock down and light-sleep whenever no task has
+// work, and measures how much of the time something had.
+//
+// Tasks hold a lock (PowerGuard) only while they render, serve a request
+// or play a pattern; in between they block on their queues and timers, and
+// the jiggle deadline timer wakes the chip from light sleep on time. The
+// chip sleeps only if the firmware is built with power management
+// (CONFIG_PM_ENABLE) and the radios allow it: the WiFi AP and the BLE
+// controller hold their own locks while they need the chip, and BLE needs
+// modem sleep (CONFIG_BT_CTRL_MODEM_SLEEP) to let go between events.
+// Without it the locks are only counted.
+//
+// "Awake" in the stats is the time at least one of these locks was held,
+// and a wakeup is the step from none held to one held: what the firmware
+// itself asks for, whatever the radios add.
+class PowerManager {
+private:
+  Mutex mutex;
+  uint16_t counts[POWER_LOCKS] = {};
+  uint8_t held = 0;           // locks with a non-zero count
+  bool sleepEnabled = false;
+  int64_t statsStart = 0;
+  int64_t awakeSince = 0;
+  int64_t awakeUs = 0;        // before awakeSince
+  uint32_t wakeups = 0;
+#ifdef ARDUINO
+  esp_pm_lock_handle_t handles[POWER_LOCKS] = {};
+#endif
+
+  int64_t awakeAt(int64_t nowUs) const {
+    return awakeUs + (held ? nowUs - awakeSince : 0);
+  }
+
+public:
+  // Microseconds since boot, the clock the stats are kept on
+  static int64_t now() {
+#ifdef ARDUINO
+    return esp_timer_get_time();
+#else
+    static const auto start = std::chrono::steady_clock::now();
+    return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count();
+#endif
+  }
+
+  // Scale the CPU between minMHz and maxMHz and, with lightSleep, sleep
+  // when idle. Returns whether light sleep could be enabled; the locks and
+  // stats work either way.
+  bool begin(uint16_t maxMHz, uint16_t minMHz, bool lightSleep, int64_t nowUs) {
+    mutex.begin();
+    statsStart = nowUs;
+#ifdef ARDUINO
+#if ESP_IDF_VERSION_MAJOR >= 5
+    esp_pm_config_t config = {};
+#else
+    esp_pm_config_esp32s3_t config = {};
+#endif
+    config.max_freq_mhz = maxMHz;
+    config.min_freq_mhz = minMHz;
+    config.light_sleep_enable = lightSleep;
+    sleepEnabled = lightSleep && esp_pm_configure(&config) == ESP_OK;
+
+    static const esp_pm_lock_type_t types[POWER_LOCKS] = {ESP_PM_CPU_FREQ_MAX, ESP_PM_CPU_FREQ_MAX, ESP_PM_NO_LIGHT_SLEEP};
+    static const char* names[POWER_LOCKS] = {"render", "http", "motion"};
+    for (uint8_t i = 0; i < POWER_LOCKS; i++) {
+      if (!handles[i] && esp_pm_lock_create(types[i], 0, names[i], &handles[i]) != ESP_OK) handles[i] = nullptr;
+    }
+#else
+    (void)maxMHz; (void)minMHz;
+    sleepEnabled = lightSleep;
+#endif
+    return sleepEnabled;
+  }
+
+  void acquire(PowerLock lock, int64_t nowUs) {
+    LockGuard guard(&mutex);
+    if (counts[lock]++ == 0 && held++ == 0) {
+      awakeSince = nowUs;
+      wakeups++;
+    }
+#ifdef ARDUINO
+    if (handles[lock]) esp_pm_lock_acquire(handles[lock]);
+#endif
+  }
+
+  void release(PowerLock lock, int64_t nowUs) {
+    LockGuard guard(&mutex);
+    if (counts[lock] == 0) return;
+#ifdef ARDUINO
+    if (handles[lock]) esp_pm_lock_release(handles[lock]);
+#endif
+    if (--counts[lock] == 0 && --held == 0) awakeUs += nowUs - awakeSince;
+  }
+
+  bool isSleepEnabled() const { return sleepEnabled; }
+  bool isAwake() const { return held != 0; }
+  bool isHeld(PowerLock lock) const { return counts[lock] != 0; }
+
+  // Share of the time since the stats were reset that a lock was held, in
+  // tenths of a percent
+  uint32_t awakePermille(int64_t nowUs) {
+    LockGuard guard(&mutex);
+    int64_t total = nowUs - statsStart;
+    return total > 0 ? (uint32_t)(awakeAt(nowUs) * 1000 / total) : 0;
+  }
+
+  uint32_t wakeupsPerHour(int64_t nowUs) {
+    LockGuard guard(&mutex);
+    int64_t total = nowUs - statsStart;
+    return total > 0 ? (uint32_t)((int64_t)wakeups * 3600000000LL / total) : 0;
+  }
+
+  // Seconds the stats cover
+  uint32_t statsSeconds(int64_t nowUs) const { return (uint32_t)((nowUs - statsStart) / 1000000); }
+
+  void resetStats(int64_t nowUs) {
+    LockGuard guard(&mutex);
+    statsStart = nowUs;
+    awakeSince = nowUs;
+    awakeUs = 0;
+    wakeups = 0;
+  }
+};
+
+// Holds a power lock for the enclosing scope; a null manager holds nothing
+class PowerGuard {
+private:
+  PowerManager* manager;
+  PowerLock lock;
+
+public:
+  PowerGuard(PowerManager* m, PowerLock l) : manager(m), lock(l) {
+    if (manager) manager->acquire(lock, PowerManager::now());
+  }
+  ~PowerGuard() {
+    if (manager) manager->release(lock, PowerManager::now());
+  }
+  PowerGuard(const PowerGuard&) = delete;
+  PowerGuard& operator=(const PowerGuard&) = delete;
+};
+
+#endif
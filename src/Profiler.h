@@ -0,0 +1,127 @@
+#ifndef PROFILER_H
+#define PROFILER_H
+
+// Where the time goes: PROFILE_SCOPE(id) at the top of a block adds the
+// time spent in it to that scope's log2 histogram and running total, shown
+// by the "stats" serial command and /api/stats.
+//
+// Only built with -DPROFILE_SCOPES; without it PROFILE_SCOPE() expands to
+// nothing and none of the code or tables below exist.
+//
+// Times come from esp_timer_get_time() rather than the cycle counter: the
+// power manager scales the CPU clock, so cycles are not a fixed length.
+// They are wall time, so a scope that is preempted or blocks (NVS waiting
+// for flash, a client sending slowly) counts that time too.
+#ifdef PROFILE_SCOPES
+
+#include <stdint.h>
+#include "Tasks.h"
+
+#ifdef ARDUINO
+#include <esp_timer.h>
+#else
+#include <chrono>
+#endif
+
+enum ProfileScopeId : uint8_t {
+  PROF_HTTP,          // serving one web request
+  PROF_DISPLAY,       // full screen redraw (updateDisplay)
+  PROF_COUNTDOWN,     // countdown digits and bar target (updateCountdownOnly)
+  PROF_PROGRESS_BAR,  // drawProgressBar
+  PROF_JIGGLE,        // starting a jiggle or sending its next reports
+  PROF_NVS_WRITE,     // saving the settings, lifetime counters or history
+  PROF_COUNT
+};
+
+struct ProfileStats {
+  static const uint8_t BUCKETS = 20;  // the last one takes everything from ~0.5 s
+
+  uint32_t calls;
+  uint32_t maxUs;
+  uint64_t totalUs;
+  uint32_t buckets[BUCKETS];  // [0] 0-1 us, [i] 2^i to 2^(i+1)-1 us
+
+  static uint32_t bucketStartUs(uint8_t i) { return i ? 1UL << i : 0; }
+
+  void add(uint32_t us) {
+    uint8_t i = 0;
+    while (i < BUCKETS - 1 && (us >> (i + 1))) i++;
+    buckets[i]++;
+    calls++;
+    totalUs += us;
+    if (us > maxUs) maxUs = us;
+  }
+};
+
+class Profiler {
+private:
+  Mutex mutex;
+  ProfileStats stats[PROF_COUNT] = {};
+  int64_t since;
+
+  Profiler() : since(now()) { mutex.begin(); }
+
+public:
+  // The one set of tables every scope adds to
+  static Profiler& instance() {
+    static Profiler profiler;
+    return profiler;
+  }
+
+  static int64_t now() {
+#ifdef ARDUINO
+    return esp_timer_get_time();
+#else
+    static const auto start = std::chrono::steady_clock::now();
+    return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count();
+#endif
+  }
+
+  static const char* name(uint8_t id) {
+    static const char* const names[PROF_COUNT] = {"http", "display", "countdown", "progress_bar", "jiggle", "nvs_write"};
+    return id < PROF_COUNT ? names[id] : "?";
+  }
+
+  void add(ProfileScopeId id, int64_t us) {
+    LockGuard guard(&mutex);
+    stats[id].add(us < 0 ? 0 : us > 0xFFFFFFFF ? 0xFFFFFFFF : (uint32_t)us);
+  }
+
+  // All scopes at once; returns when they started counting
+  int64_t copy(ProfileStats* out) {
+    LockGuard guard(&mutex);
+    for (uint8_t i = 0; i < PROF_COUNT; i++) out[i] = stats[i];
+    return since;
+  }
+
+  void reset() {
+    LockGuard guard(&mutex);
+    for (uint8_t i = 0; i < PROF_COUNT; i++) stats[i] = {};
+    since = now();
+  }
+};
+
+// Times its own lifetime into one scope
+class ProfileScope {
+private:
+  ProfileScopeId id;
+  int64_t start;
+
+public:
+  explicit ProfileScope(ProfileScopeId i) : id(i), start(Profiler::now()) {}
+  ~ProfileScope() { Profiler::instance().add(id, Profiler::now() - start); }
+  ProfileScope(const ProfileScope&) = delete;
+  ProfileScope& operator=(const ProfileScope&) = delete;
+};
+
+#define PROFILE_CONCAT_(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_(a, b)
+#define PROFILE_SCOPE(id) ProfileScope PROFILE_CONCAT(profileScope, __LINE__)(id)
+
+#else
+
+#define PROFILE_SCOPE(id)
+
+#endif
+
+#endif
@@ -0,0 +1,166 @@
+#ifndef PROGRESS_ANIMATOR_H
+#define PROGRESS_ANIMATOR_H
+
+#include <Arduino.h>
+#include "GUI_Paint.h"
+
+// Animation counters, reset by resetStats()
+struct AnimatorStats {
+  uint32_t frames;         // frames drawn
+  uint32_t dropped;        // frame slots missed because loop() was late
+  uint32_t budgetLimited;  // frames that hit the SPI byte cap and deferred columns
+  uint32_t lastFrameBytes; // SPI bytes of the most recent frame
+  uint16_t fps;            // frame rate achieved by the last finished tween
+};
+
+// Tweens a horizontal progress bar at a fixed frame rate.
+//
+// Every frame only the columns between the drawn and the wanted fill are
+// touched: newly covered columns are filled, uncovered ones cleared. The
+// fill is a gradient fixed to the bar's position (green, yellow, red), so
+// every column always has the same colour and a growing bar never
+// repaints what is already drawn.
+// Frames are capped at a number of SPI bytes; columns beyond the cap are
+// left for the next frame, so a large jump can't stall loop().
+class ProgressAnimator {
+private:
+  int x, y, width, height;  // bar interior, logical pixels
+  uint16_t background;
+  PAINT_GRADIENT gradient;
+  uint16_t framePeriod = 40;     // ms, 25 FPS
+  uint16_t tweenTime = 400;      // ms to reach a new target
+  uint32_t byteBudget = 2048;    // SPI bytes per frame
+
+  int drawn = 0;            // columns currently filled on screen
+  int from = 0;             // tween start
+  int target = 0;           // tween end
+  unsigned long tweenStart = 0;
+  unsigned long nextFrame = 0;
+  bool animating = false;
+
+  AnimatorStats stats = {};
+  uint32_t animFrames = 0;  // frames since the animation started
+  unsigned long animStart = 0;
+
+  static const uint16_t WINDOW_OVERHEAD = 11;  // CASET/RASET/RAMWR bytes per window
+
+  int columnsFor(int percentage) const {
+    if (percentage < 0) percentage = 0;
+    if (percentage > 100) percentage = 100;
+    return (width * percentage) / 100;
+  }
+
+  // Fill columns [a, b)
+  void fill(int a, int b) {
+    if (a < b) Paint_DrawGradient(x + a, y, x + b, y + height, &gradient);
+  }
+
+  // Move the drawn edge towards want, at most maxColumns columns
+  void drawTo(int want, int maxColumns) {
+    if (want > drawn + maxColumns) want = drawn + maxColumns;
+    if (want < drawn - maxColumns) want = drawn - maxColumns;
+    if (want > drawn) {
+      fill(drawn, want);
+    } else if (want < drawn) {
+      Paint_ClearWindows(x + want, y, x + drawn, y + height, background);
+    }
+    drawn = want;
+  }
+
+  // Tween position at time now, ease-out quadratic in 1/1024 steps
+  int tweenAt(unsigned long now) const {
+    unsigned long elapsed = now - tweenStart;
+    if (elapsed >= tweenTime) return target;
+    int32_t t = (int32_t)((elapsed << 10) / tweenTime);
+    int32_t eased = 1024 - (((1024 - t) * (1024 - t)) >> 10);
+    return from + (int)(((int32_t)(target - from) * eased) >> 10);
+  }
+
+public:
+  ProgressAnimator(int x, int y, int width, int height, uint16_t background)
+    : x(x), y(y), width(width), height(height), background(background) {
+    gradient.Dir = GRADIENT_HORIZONTAL;
+    gradient.Stops = 3;
+    gradient.From = x;
+    gradient.To = x + width - 1;
+    gradient.Color[0] = 0x07E0;  // Green
+    gradient.Color[1] = 0xFFE0;  // Yellow
+    gradient.Color[2] = 0xF800;  // Red
+  }
+
+  void setFrameRate(uint16_t fps) { framePeriod = fps ? 1000 / fps : 1000; }
+  void setTweenTime(uint16_t ms) { tweenTime = ms ? ms : 1; }
+  void setByteBudget(uint32_t bytesPerFrame) { byteBudget = bytesPerFrame; }
+
+  // Draw the fill at once, for use inside a full frame. Stops any tween.
+  void reset(int percentage) {
+    drawn = 0;
+    from = target = columnsFor(percentage);
+    animating = false;
+    fill(0, target);
+    drawn = target;
+  }
+
+  // Start tweening from where the bar is now to a new percentage
+  void animateTo(int percentage, unsigned long now) {
+    int want = columnsFor(percentage);
+    if (want == target) return;
+    from = animating ? tweenAt(now) : drawn;
+    target = want;
+    tweenStart = now;
+    if (!animating) {
+      nextFrame = now;
+      animStart = now;
+      animFrames = 0;
+      animating = true;
+    }
+  }
+
+  bool isAnimating() const { return animating; }
+
+  // Milliseconds until the next frame is due, or idleMs when nothing moves
+  unsigned long msUntilNextFrame(unsigned long now, unsigned long idleMs) const {
+    if (!animating) return idleMs;
+    long wait = (long)(nextFrame - now);
+    if (wait <= 0) return 0;
+    return (unsigned long)wait < idleMs ? (unsigned long)wait : idleMs;
+  }
+
+  // Draw one frame if it is due. Returns true if something was drawn.
+  bool tick(unsigned long now) {
+    if (!animating || (long)(now - nextFrame) < 0) return false;
+
+    // Skip the slots we were too late for instead of bursting to catch up
+    unsigned long late = now - nextFrame;
+    stats.dropped += late / framePeriod;
+    nextFrame += (late / framePeriod + 1) * framePeriod;
+
+    int want = tweenAt(now);
+    int columnBytes = height * 2;
+    int maxColumns = byteBudget > WINDOW_OVERHEAD * 3
+                     ? (int)((byteBudget - WINDOW_OVERHEAD * 3) / columnBytes) : 1;
+    if (maxColumns < 1) maxColumns = 1;
+    if (abs(want - drawn) > maxColumns) stats.budgetLimited++;
+
+    int before = drawn;
+    Paint_BeginUpdate();
+    drawTo(want, maxColumns);
+    Paint_EndFrame();
+
+    stats.lastFrameBytes = abs(drawn - before) * columnBytes + WINDOW_OVERHEAD;
+    stats.frames++;
+    animFrames++;
+
+    if (drawn == target && now - tweenStart >= tweenTime) {
+      animating = false;
+      // Frames drawn over the animation, counting the final frame's slot
+      stats.fps = (uint16_t)((animFrames * 1000UL) / (now - animStart + framePeriod));
+    }
+    return true;
+  }
+
+  const AnimatorStats& getStats() const { return stats; }
+  void resetStats() { stats = {}; }
+};
+
+#endif
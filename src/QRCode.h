@@ -0,0 +1,407 @@
+#ifndef QR_CODE_H
+#define QR_CODE_H
+
+#include <Arduino.h>
+#include "GUI_Paint.h"
+
+// QR code encoder for short strings: byte mode, versions 1-10, error
+// correction level M where it fits in the smallest version, L otherwise.
+//
+// encode() runs once and keeps only the finished module matrix (1 bit per
+// module), which getBitmap() hands to Paint_DrawBitmap() so every redraw
+// is a few hundred span fills instead of a new encode. All scratch space
+// lives on the stack; nothing is allocated.
+class QRCode {
+public:
+  static const uint8_t MAX_VERSION = 10;
+  static const uint8_t MAX_SIZE = 17 + 4 * MAX_VERSION;  // 57 modules
+  static const uint16_t MAX_LENGTH = 271;                // bytes at version 10-L
+
+private:
+  static const uint8_t ROW_BYTES = (MAX_SIZE + 7) / 8;
+  static const uint16_t MAX_CODEWORDS = 346;             // version 10
+
+  enum { ECC_M = 0, ECC_L = 1 };  // index into the tables below
+
+  uint8_t modules[MAX_SIZE * ROW_BYTES];  // dark modules
+  uint8_t size = 0;
+  uint8_t version = 0;
+  uint8_t eccLevel = ECC_M;
+  uint8_t mask = 0;
+  PAINT_BITMAP bitmap = {modules, 0, 0, ROW_BYTES};
+
+  // Error correction codewords per block and block count, versions 1-10
+  static uint8_t eccPerBlock(uint8_t ecc, uint8_t ver) {
+    static const uint8_t table[2][MAX_VERSION] = {
+      {10, 16, 26, 18, 24, 16, 18, 22, 22, 26},  // M
+      { 7, 10, 15, 20, 26, 18, 20, 24, 30, 18},  // L
+    };
+    return table[ecc][ver - 1];
+  }
+
+  static uint8_t numBlocks(uint8_t ecc, uint8_t ver) {
+    static const uint8_t table[2][MAX_VERSION] = {
+      {1, 1, 1, 2, 2, 4, 4, 4, 5, 5},  // M
+      {1, 1, 1, 1, 1, 2, 2, 2, 2, 4},  // L
+    };
+    return table[ecc][ver - 1];
+  }
+
+  // Codewords (data plus error correction) that fit in a version
+  static uint16_t totalCodewords(uint8_t ver) {
+    uint32_t bits = (16UL * ver + 128) * ver + 64;
+    if (ver >= 2) {
+      uint8_t align = ver / 7 + 2;
+      bits -= (25UL * align - 10) * align - 55;
+      if (ver >= 7) bits -= 36;
+    }
+    return bits / 8;
+  }
+
+  static uint16_t dataCodewords(uint8_t ecc, uint8_t ver) {
+    return totalCodewords(ver) - eccPerBlock(ecc, ver) * numBlocks(ecc, ver);
+  }
+
+  // Bytes of text that fit: 4 bit mode, 8 or 16 bit length, then the text
+  static uint16_t capacity(uint8_t ecc, uint8_t ver) {
+    uint16_t header = ver < 10 ? 12 : 20;
+    return (dataCodewords(ecc, ver) * 8 - header) / 8;
+  }
+
+  // Centres of the alignment patterns, returns their count per axis
+  static uint8_t alignmentPositions(uint8_t ver, uint8_t* pos) {
+    if (ver == 1) return 0;
+    uint8_t count = ver / 7 + 2;
+    uint8_t step = (ver * 4 + count * 2 + 1) / (count * 2 - 2) * 2;
+    pos[0] = 6;
+    for (uint8_t i = count - 1, p = ver * 4 + 10; i >= 1; i--, p -= step) {
+      pos[i] = p;
+    }
+    return count;
+  }
+
+  // GF(256) multiply, polynomial 0x11D
+  static uint8_t gfMul(uint8_t a, uint8_t b) {
+    uint8_t z = 0;
+    for (int8_t i = 7; i >= 0; i--) {
+      z = (z << 1) ^ ((z >> 7) * 0x1D);
+      z ^= ((b >> i) & 1) * a;
+    }
+    return z;
+  }
+
+  static bool getBit(const uint8_t* grid, uint8_t x, uint8_t y) {
+    return (grid[y * ROW_BYTES + (x >> 3)] >> (7 - (x & 7))) & 1;
+  }
+
+  static void setBit(uint8_t* grid, uint8_t x, uint8_t y, bool on) {
+    uint8_t bit = 0x80 >> (x & 7);
+    if (on) grid[y * ROW_BYTES + (x >> 3)] |= bit;
+    else grid[y * ROW_BYTES + (x >> 3)] &= ~bit;
+  }
+
+  // Function patterns are set in both grids: their color in modules,
+  // "reserved" in function so data and masking skip them
+  void setFunction(uint8_t* function, uint8_t x, uint8_t y, bool dark) {
+    setBit(modules, x, y, dark);
+    setBit(function, x, y, true);
+  }
+
+  void drawFinder(uint8_t* function, int cx, int cy) {
+    for (int dy = -4; dy <= 4; dy++) {
+      for (int dx = -4; dx <= 4; dx++) {
+        int x = cx + dx, y = cy + dy;
+        if (x < 0 || x >= size || y < 0 || y >= size) continue;
+        int dist = max(abs(dx), abs(dy));
+        setFunction(function, x, y, dist != 2 && dist != 4);
+      }
+    }
+  }
+
+  void drawFormatBits(uint8_t* function, uint8_t msk) {
+    // Level bits: L = 01, M = 00
+    uint16_t data = ((eccLevel == ECC_L ? 1 : 0) << 3) | msk;
+    uint16_t rem = data;
+    for (uint8_t i = 0; i < 10; i++) rem = (rem << 1) ^ ((rem >> 9) * 0x537);
+    uint16_t bits = ((data << 10) | rem) ^ 0x5412;
+
+    for (uint8_t i = 0; i <= 5; i++) setFunction(function, 8, i, (bits >> i) & 1);
+    setFunction(function, 8, 7, (bits >> 6) & 1);
+    setFunction(function, 8, 8, (bits >> 7) & 1);
+    setFunction(function, 7, 8, (bits >> 8) & 1);
+    for (uint8_t i = 9; i < 15; i++) setFunction(function, 14 - i, 8, (bits >> i) & 1);
+
+    for (uint8_t i = 0; i < 8; i++) setFunction(function, size - 1 - i, 8, (bits >> i) & 1);
+    for (uint8_t i = 8; i < 15; i++) setFunction(function, 8, size - 15 + i, (bits >> i) & 1);
+    setFunction(function, 8, size - 8, true);  // always dark
+  }
+
+  void drawFunctionPatterns(uint8_t* function) {
+    for (uint8_t i = 0; i < size; i++) {
+      setFunction(function, 6, i, i % 2 == 0);
+      setFunction(function, i, 6, i % 2 == 0);
+    }
+
+    drawFinder(function, 3, 3);
+    drawFinder(function, size - 4, 3);
+    drawFinder(function, 3, size - 4);
+
+    uint8_t pos[MAX_VERSION / 7 + 2];
+    uint8_t count = alignmentPositions(version, pos);
+    for (uint8_t i = 0; i < count; i++) {
+      for (uint8_t j = 0; j < count; j++) {
+        // Skip the three corners taken by finder patterns
+        if ((i == 0 && j == 0) || (i == 0 && j == count - 1) || (i == count - 1 && j == 0)) continue;
+        for (int dy = -2; dy <= 2; dy++) {
+          for (int dx = -2; dx <= 2; dx++) {
+            setFunction(function, pos[i] + dx, pos[j] + dy, max(abs(dx), abs(dy)) != 1);
+          }
+        }
+      }
+    }
+
+    drawFormatBits(function, 0);  // reserve, real bits come with the mask
+
+    if (version >= 7) {
+      uint32_t rem = version;
+      for (uint8_t i = 0; i < 12; i++) rem = (rem << 1) ^ ((rem >> 11) * 0x1F25);
+      uint32_t bits = ((uint32_t)version << 12) | rem;
+      for (uint8_t i = 0; i < 18; i++) {
+        bool dark = (bits >> i) & 1;
+        uint8_t a = size - 11 + i % 3, b = i / 3;
+        setFunction(function, a, b, dark);
+        setFunction(function, b, a, dark);
+      }
+    }
+  }
+
+  // Split the data into blocks, add Reed-Solomon codewords, interleave
+  static uint16_t addErrorCorrection(uint8_t ecc, uint8_t ver, const uint8_t* data, uint8_t* out) {
+    uint8_t blocks = numBlocks(ecc, ver);
+    uint8_t eccLen = eccPerBlock(ecc, ver);
+    uint16_t total = totalCodewords(ver);
+    uint8_t shortBlocks = blocks - total % blocks;
+    uint8_t shortData = total / blocks - eccLen;
+
+    // Generator polynomial, highest coefficient (always 1) left out
+    uint8_t divisor[30] = {0};
+    divisor[eccLen - 1] = 1;
+    uint8_t root = 1;
+    for (uint8_t i = 0; i < eccLen; i++) {
+      for (uint8_t j = 0; j < eccLen; j++) {
+        divisor[j] = gfMul(divisor[j], root);
+        if (j + 1 < eccLen) divisor[j] ^= divisor[j + 1];
+      }
+      root = gfMul(root, 0x02);
+    }
+
+    uint16_t dataLen = dataCodewords(ecc, ver);
+    uint16_t n = 0;
+
+    // Data codewords, column by column across the blocks
+    for (uint8_t i = 0; i <= shortData; i++) {
+      uint16_t start = 0;
+      for (uint8_t b = 0; b < blocks; b++) {
+        uint8_t len = shortData + (b < shortBlocks ? 0 : 1);
+        if (i < len) out[n++] = data[start + i];
+        start += len;
+      }
+    }
+
+    // Error correction codewords, same order
+    uint16_t start = 0;
+    for (uint8_t b = 0; b < blocks; b++) {
+      uint8_t len = shortData + (b < shortBlocks ? 0 : 1);
+      uint8_t rem[30] = {0};
+      for (uint8_t i = 0; i < len; i++) {
+        uint8_t factor = data[start + i] ^ rem[0];
+        memmove(rem, rem + 1, eccLen - 1);
+        rem[eccLen - 1] = 0;
+        for (uint8_t j = 0; j < eccLen; j++) rem[j] ^= gfMul(divisor[j], factor);
+      }
+      for (uint8_t i = 0; i < eccLen; i++) out[dataLen + i * blocks + b] = rem[i];
+      start += len;
+    }
+    return total;
+  }
+
+  // Place codewords in the two-column zigzag, skipping function modules
+  void drawCodewords(const uint8_t* function, const uint8_t* codewords, uint16_t count) {
+    uint32_t i = 0, bits = (uint32_t)count * 8;
+    for (int right = size - 1; right >= 1; right -= 2) {
+      if (right == 6) right = 5;  // skip the vertical timing pattern
+      bool upward = ((right + 1) & 2) == 0;
+      for (uint8_t vert = 0; vert < size; vert++) {
+        uint8_t y = upward ? size - 1 - vert : vert;
+        for (uint8_t j = 0; j < 2; j++) {
+          uint8_t x = right - j;
+          if (getBit(function, x, y) || i >= bits) continue;
+          setBit(modules, x, y, (codewords[i >> 3] >> (7 - (i & 7))) & 1);
+          i++;
+        }
+      }
+    }
+  }
+
+  // XOR a mask pattern over the data modules; applying it twice undoes it
+  void applyMask(const uint8_t* function, uint8_t msk) {
+    for (uint8_t y = 0; y < size; y++) {
+      for (uint8_t x = 0; x < size; x++) {
+        bool invert;
+        switch (msk) {
+          case 0: invert = (x + y) % 2 == 0; break;
+          case 1: invert = y % 2 == 0; break;
+          case 2: invert = x % 3 == 0; break;
+          case 3: invert = (x + y) % 3 == 0; break;
+          case 4: invert = (x / 3 + y / 2) % 2 == 0; break;
+          case 5: invert = x * y % 2 + x * y % 3 == 0; break;
+          case 6: invert = (x * y % 2 + x * y % 3) % 2 == 0; break;
+          default: invert = ((x + y) % 2 + x * y % 3) % 2 == 0; break;
+        }
+        if (invert && !getBit(function, x, y)) {
+          modules[y * ROW_BYTES + (x >> 3)] ^= 0x80 >> (x & 7);
+        }
+      }
+    }
+  }
+
+  // Finder-like 1:1:3:1:1 runs with 4 light modules on one side
+  uint8_t finderPatterns(const uint16_t* run) const {
+    uint16_t n = run[1];
+    bool core = n > 0 && run[2] == n && run[3] == n * 3 && run[4] == n && run[5] == n;
+    return (core && run[0] >= n * 4 && run[6] >= n ? 1 : 0) +
+           (core && run[6] >= n * 4 && run[0] >= n ? 1 : 0);
+  }
+
+  void pushRun(uint16_t length, uint16_t* run) const {
+    if (run[0] == 0) length += size;  // light border before the first run
+    memmove(run + 1, run, 6 * sizeof(uint16_t));
+    run[0] = length;
+  }
+
+  // Penalty of one row or column, rules 1 and 3
+  uint32_t linePenalty(bool column, uint8_t index) const {
+    uint32_t penalty = 0;
+    uint16_t run[7] = {0};
+    bool color = false;
+    uint16_t length = 0;
+    for (uint8_t i = 0; i < size; i++) {
+      bool dark = column ? getBit(modules, index, i) : getBit(modules, i, index);
+      if (dark == color) {
+        length++;
+        if (length == 5) penalty += 3;
+        else if (length > 5) penalty++;
+      } else {
+        pushRun(length, run);
+        if (!color) penalty += finderPatterns(run) * 40;
+        color = dark;
+        length = 1;
+      }
+    }
+    if (color) {
+      pushRun(length, run);
+      length = 0;
+    }
+    pushRun(length + size, run);  // light border after the last run
+    return penalty + finderPatterns(run) * 40;
+  }
+
+  uint32_t penalty() const {
+    uint32_t result = 0;
+    for (uint8_t i = 0; i < size; i++) {
+      result += linePenalty(false, i) + linePenalty(true, i);
+    }
+
+    uint16_t dark = 0;
+    for (uint8_t y = 0; y < size; y++) {
+      for (uint8_t x = 0; x < size; x++) {
+        bool c = getBit(modules, x, y);
+        dark += c;
+        if (x + 1 < size && y + 1 < size && c == getBit(modules, x + 1, y) &&
+            c == getBit(modules, x, y + 1) && c == getBit(modules, x + 1, y + 1)) {
+          result += 3;
+        }
+      }
+    }
+
+    // 10 points for every 5% away from half dark
+    uint32_t total = (uint32_t)size * size;
+    uint32_t off = abs((int32_t)dark * 20 - (int32_t)total * 10);
+    result += ((off + total - 1) / total - 1) * 10;
+    return result;
+  }
+
+public:
+  QRCode() {}
+
+  // Encode text, returns false if it is empty or too long for version 10
+  bool encode(const char* text) {
+    size = 0;
+    bitmap.Width = bitmap.Height = 0;
+    uint16_t length = strlen(text);
+    if (length == 0 || length > MAX_LENGTH) return false;
+
+    // Smallest version that holds the text at level L, then M if it still fits
+    for (version = 1; version <= MAX_VERSION; version++) {
+      if (capacity(ECC_L, version) >= length) break;
+    }
+    eccLevel = capacity(ECC_M, version) >= length ? ECC_M : ECC_L;
+    size = 17 + 4 * version;
+
+    // Data codewords: mode, length, text, terminator, pad bytes
+    uint8_t data[MAX_CODEWORDS] = {0};
+    uint16_t dataLen = dataCodewords(eccLevel, version);
+    uint32_t bit = 0;
+    auto put = [&](uint32_t value, uint8_t bits) {
+      for (int8_t i = bits - 1; i >= 0; i--, bit++) {
+        if ((value >> i) & 1) data[bit >> 3] |= 0x80 >> (bit & 7);
+      }
+    };
+    put(0x4, 4);
+    put(length, version < 10 ? 8 : 16);
+    for (uint16_t i = 0; i < length; i++) put((uint8_t)text[i], 8);
+    uint32_t room = (uint32_t)dataLen * 8 - bit;
+    put(0, room < 4 ? room : 4);
+    bit = (bit + 7) & ~7UL;
+    for (uint8_t pad = 0xEC; bit < (uint32_t)dataLen * 8; pad ^= 0xEC ^ 0x11) put(pad, 8);
+
+    uint8_t codewords[MAX_CODEWORDS];
+    uint16_t count = addErrorCorrection(eccLevel, version, data, codewords);
+
+    uint8_t function[MAX_SIZE * ROW_BYTES];
+    memset(modules, 0, sizeof(modules));
+    memset(function, 0, sizeof(function));
+    drawFunctionPatterns(function);
+    drawCodewords(function, codewords, count);
+
+    // Keep the mask with the lowest penalty
+    uint32_t best = UINT32_MAX;
+    for (uint8_t m = 0; m < 8; m++) {
+      applyMask(function, m);
+      drawFormatBits(function, m);
+      uint32_t score = penalty();
+      if (score < best) {
+        best = score;
+        mask = m;
+      }
+      applyMask(function, m);
+    }
+    applyMask(function, mask);
+    drawFormatBits(function, mask);
+
+    bitmap.Width = bitmap.Height = size;
+    return true;
+  }
+
+  bool isValid() const { return size != 0; }
+  uint8_t getSize() const { return size; }       // modules per side, no quiet zone
+  uint8_t getVersion() const { return version; }
+  char getEccLevel() const { return eccLevel == ECC_L ? 'L' : 'M'; }
+  uint8_t getMask() const { return mask; }
+  bool getModule(uint8_t x, uint8_t y) const { return x < size && y < size && getBit(modules, x, y); }
+
+  // Module matrix for Paint_DrawBitmap(), dark modules are set bits
+  const PAINT_BITMAP* getBitmap() const { return &bitmap; }
+};
+
+#endif
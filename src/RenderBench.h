@@ -0,0 +1,174 @@
+#ifndef RENDER_BENCH_H
+#define RENDER_BENCH_H
+
+#include <Arduino.h>
+#include "LCD_Driver.h"
+#include "GUI_Paint.h"
+#include "GUI_Pixel.h"
+#include "image.h"
+
+// Renderer benchmarks, run on the device from the serial console.
+//
+// Every case prints one CSV line, counts averaged per iteration:
+//   bench,<case>,<mode>,<iterations>,<us>,<pixels>,<spi bytes>,<cs>,<windows>
+// Modes: "direct" draws straight to the panel, "frame" records the call and
+// pushes it through the strip renderer (Paint_BeginUpdate/Paint_EndFrame),
+// screen cases say how the sketch draws them. Grep the "bench," lines out
+// of the log to compare releases; the counters come from LCD_Bus and do not
+// depend on timing, so only <us> should move between runs.
+class RenderBench {
+private:
+  uint16_t iterations = 5;
+  uint16_t background = 0x0010;
+  volatile char sink = 0;  // keeps the numbers() conversions from being optimized out
+
+  // Put a known screen up, also giving the renderer a valid list
+  void resetScreen() {
+    Paint_BeginFrame();
+    Paint_Clear(background);
+    Paint_EndFrame();
+  }
+
+  template <typename F>
+  void primitive(const char* name, F draw) {
+    resetScreen();
+    measure(name, "direct", iterations, draw);
+    resetScreen();
+    measure(name, "frame", iterations, [&]() {
+      Paint_BeginUpdate();
+      draw();
+      Paint_EndFrame();
+    });
+  }
+
+public:
+  void setIterations(uint16_t n) { iterations = n ? n : 1; }
+
+  static void printHeader() {
+    Serial.println("bench,case,mode,iterations,us,pixels,spi_bytes,cs,windows");
+  }
+
+  // Run draw() once untimed (caches, list growth), then n times
+  template <typename F>
+  void measure(const char* name, const char* mode, uint16_t n, F draw) {
+    draw();
+    LCD_BUS_STATS start = LCD_Bus;
+    uint32_t t0 = micros();
+    for (uint16_t i = 0; i < n; i++) draw();
+    uint32_t us = micros() - t0;
+
+    Serial.printf("bench,%s,%s,%u,%lu,%lu,%lu,%lu,%lu\n", name, mode, n,
+                  (unsigned long)(us / n),
+                  (unsigned long)((LCD_Bus.PixelBytes - start.PixelBytes) / 2 / n),
+                  (unsigned long)((LCD_Bus.Bytes - start.Bytes) / n),
+                  (unsigned long)((LCD_Bus.Selects - start.Selects) / n),
+                  (unsigned long)((LCD_Bus.Windows - start.Windows) / n));
+  }
+
+  // Every Paint_* drawing call, each both ways. Leaves the screen cleared.
+  void primitives(PAINT_DIGITS* digits) {
+    static const PAINT_GRADIENT gradient = {GRADIENT_VERTICAL, 2, 0, 24, {0x04DF, 0x000C, 0}};
+    static const UBYTE checker[32] = {
+      0xF0, 0xF0, 0xF0, 0xF0, 0xF0, 0xF0, 0xF0, 0xF0, 0x0F, 0x0F, 0x0F, 0x0F, 0x0F, 0x0F, 0x0F, 0x0F,
+      0xF0, 0xF0, 0xF0, 0xF0, 0xF0, 0xF0, 0xF0, 0xF0, 0x0F, 0x0F, 0x0F, 0x0F, 0x0F, 0x0F, 0x0F, 0x0F,
+    };
+    static const PAINT_BITMAP bitmap = {checker, 16, 16, 2};
+    uint16_t bg = background;
+
+    primitive("clear", [&]() { Paint_Clear(0x0000); });
+    primitive("clear_window", [&]() { Paint_ClearWindows(40, 30, 200, 100, 0x001F); });
+    primitive("gradient", [&]() { Paint_DrawGradient(0, 0, LCD_HEIGHT, 25, &gradient); });
+    primitive("point", [&]() { Paint_DrawPoint(120, 60, 0xFFFF, DOT_PIXEL_3X3, DOT_FILL_AROUND); });
+    primitive("line_h", [&]() { Paint_DrawLine(10, 60, 230, 60, 0xFFFF, DOT_PIXEL_1X1, LINE_STYLE_SOLID); });
+    primitive("line_diag", [&]() { Paint_DrawLine(0, 0, 239, 134, 0xFFFF, DOT_PIXEL_1X1, LINE_STYLE_SOLID); });
+    primitive("rect", [&]() { Paint_DrawRectangle(20, 20, 220, 115, 0x07E0, DOT_PIXEL_1X1, DRAW_FILL_EMPTY); });
+    primitive("rect_fill", [&]() { Paint_DrawRectangle(20, 20, 220, 115, 0x07E0, DOT_PIXEL_1X1, DRAW_FILL_FULL); });
+    primitive("circle", [&]() { Paint_DrawCircle(120, 67, 40, 0xF800, DOT_PIXEL_1X1, DRAW_FILL_EMPTY); });
+    primitive("circle_fill", [&]() { Paint_DrawCircle(120, 67, 40, 0xF800, DOT_PIXEL_1X1, DRAW_FILL_FULL); });
+    primitive("char", [&]() { Paint_DrawChar(10, 10, 'A', &Font24, bg, 0xFFFF); });
+    primitive("string", [&]() { Paint_DrawString_EN(15, 60, "Waiting for", &Font16, bg, 0xFFFF); });
+    primitive("string_transparent", [&]() { Paint_DrawString_EN(15, 60, "Waiting for", &Font16, FONT_BACKGROUND, 0xFFFF); });
+    primitive("number", [&]() { Paint_DrawNum(114, 60, 1234567, &Font16, bg, 0xFFFF); });
+    primitive("image", [&]() { Paint_DrawImage(gImage_70X70, 40, 30, 70, 70); });
+    primitive("bitmap", [&]() { Paint_DrawBitmap(96, 43, &bitmap, 3, 0xFFFF, 0x0000); });
+    if (digits && digits->Pixels) {
+      primitive("digits", [&]() { Paint_DrawDigits(digits, 150, 58, "42"); });
+    }
+    resetScreen();
+  }
+
+  // The pixel kernels on one 240x16 strip in internal RAM, as the renderer
+  // uses them. Each iteration is 1000 calls, so <us> is nanoseconds per
+  // strip (3840 pixels); the panel counts stay 0.
+  void kernels() {
+    const UDOUBLE pixels = LCD_HEIGHT * 16;
+    UWORD* strip = (UWORD*)DEV_Malloc_DMA(pixels * sizeof(UWORD));
+    UWORD* source = (UWORD*)DEV_Malloc_DMA(pixels * sizeof(UWORD));
+    if (strip && source) {
+      Pixel_Fill(source, 0x1234, pixels);
+      measure("pixel_fill", "kernel", iterations, [&]() {
+        for (uint16_t i = 0; i < 1000; i++) Pixel_Fill(strip, i, pixels);
+      });
+      measure("pixel_swap", "kernel", iterations, [&]() {
+        for (uint16_t i = 0; i < 1000; i++) Pixel_Swap(strip, source, pixels);
+      });
+      measure("pixel_swap_in_place", "kernel", iterations, [&]() {
+        for (uint16_t i = 0; i < 1000; i++) Pixel_Swap(strip, strip, pixels);
+      });
+      measure("pixel_blend", "kernel", iterations, [&]() {
+        for (uint16_t i = 0; i < 1000; i++) Pixel_Blend(strip, i, 128, pixels);
+      });
+    }
+    DEV_Free(strip);
+    DEV_Free(source);
+  }
+
+  // The countdown and jiggle counter as the sketch updates them, one step
+  // per iteration: the old way (clear the number's area, sprintf, draw the
+  // whole string) against a number field, which redraws only the cells
+  // that changed. format_* time the conversion alone, 1000 numbers per
+  // iteration, so <us> is nanoseconds per number.
+  void numbers() {
+    char text[PAINT_NUM_MAX + 1];
+    uint32_t value = 0;
+    measure("format_sprintf", "kernel", iterations, [&]() {
+      for (uint16_t i = 0; i < 1000; i++) {
+        sprintf(text, "%lu", (unsigned long)(value += 7919));
+        sink = text[0];
+      }
+    });
+    measure("format_uint", "kernel", iterations, [&]() {
+      for (uint16_t i = 0; i < 1000; i++) {
+        Paint_UIntToStr(text, value += 7919);
+        sink = text[0];
+      }
+    });
+
+    uint16_t bg = background;
+    uint32_t countdown = 0, count = 12345;
+    PAINT_NUMFIELD countdownField, countField;
+    Paint_NumField_Init(&countdownField, 114, 85, 2, PAINT_ALIGN_RIGHT, &Font16, bg, 0xFFE0);
+    Paint_NumField_Init(&countField, 114, 60, 10, PAINT_ALIGN_LEFT, &Font16, bg, 0xFFFF);
+    primitive("countdown_sprintf", [&]() {
+      countdown = countdown ? countdown - 1 : 59;
+      Paint_DrawRectangle(114, 85, LCD_HEIGHT - 15, 100, bg, DOT_PIXEL_1X1, DRAW_FILL_FULL);
+      sprintf(text, "%lus", (unsigned long)countdown);
+      Paint_DrawString_EN(114, 85, text, &Font16, bg, 0xFFE0);
+    });
+    primitive("countdown_field", [&]() {
+      countdown = countdown ? countdown - 1 : 59;
+      Paint_DrawNumField(&countdownField, countdown, 0);
+    });
+    primitive("counter_sprintf", [&]() {
+      Paint_DrawRectangle(114, 60, LCD_HEIGHT - 15, 75, bg, DOT_PIXEL_1X1, DRAW_FILL_FULL);
+      sprintf(text, "%lu", (unsigned long)++count);
+      Paint_DrawString_EN(114, 60, text, &Font16, bg, 0xFFFF);
+    });
+    primitive("counter_field", [&]() {
+      Paint_DrawNumField(&countField, ++count, 0);
+    });
+    resetScreen();
+  }
+};
+
+#endif
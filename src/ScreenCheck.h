@@ -0,0 +1,153 @@
+#ifndef SCREEN_CHECK_H
+#define SCREEN_CHECK_H
+
+#include <Arduino.h>
+#include "GUI_Paint.h"
+#include "ScreenGolden.h"
+
+// Pixel-exact check of the UI screens against golden row hashes.
+//
+// Each screen is read back row by row from the renderer (Paint_ReadLine)
+// and every row hashed (FNV-1a over its RGB565 pixels). A screen passes
+// when all rows match ScreenGolden.h; otherwise the rows that differ are
+// listed, so a screenshot (/api/screenshot) shows where to look.
+// In generate mode the hashes are printed as a new ScreenGolden.h instead.
+class ScreenCheck {
+private:
+  static const uint8_t MAX_SCREENS = 8;
+
+  bool generate;
+  const char* names[MAX_SCREENS];
+  uint8_t count = 0;
+  uint8_t failures = 0;
+  uint16_t line[320];
+  uint32_t rows[GOLDEN_ROWS];
+
+  bool capture() {
+    for (uint16_t y = 0; y < GOLDEN_ROWS; y++) {
+      if (!Paint_ReadLine(y, line)) return false;
+      uint32_t hash = 2166136261UL;
+      for (uint16_t x = 0; x < Paint.Width; x++) {
+        hash = (hash ^ (line[x] & 0xFF)) * 16777619UL;
+        hash = (hash ^ (line[x] >> 8)) * 16777619UL;
+      }
+      rows[y] = hash;
+    }
+    return true;
+  }
+
+  static const uint32_t* golden(const char* name) {
+    for (const GoldenScreen& screen : GOLDEN_SCREENS) {
+      if (strcmp(screen.name, name) == 0) return screen.rows;
+    }
+    return nullptr;
+  }
+
+  static void printUpper(const char* text) {
+    for (; *text; text++) Serial.print((char)toupper(*text));
+  }
+
+  void printTable(const char* name) {
+    Serial.print("static const uint32_t GOLDEN_");
+    printUpper(name);
+    Serial.println("[GOLDEN_ROWS] = {");
+    for (uint16_t y = 0; y < GOLDEN_ROWS; y += 6) {
+      Serial.print(" ");
+      for (uint16_t i = y; i < y + 6 && i < GOLDEN_ROWS; i++) Serial.printf(" 0x%08lX,", (unsigned long)rows[i]);
+      Serial.println();
+    }
+    Serial.println("};");
+    Serial.println();
+  }
+
+  // "check,<name>,FAIL,<rows>,<first>-<last> ..." listing differing row ranges
+  void printDiff(const char* name, const uint32_t* expected) {
+    uint16_t differing = 0;
+    for (uint16_t y = 0; y < GOLDEN_ROWS; y++) differing += rows[y] != expected[y];
+    Serial.printf("check,%s,FAIL,%u,", name, differing);
+    for (uint16_t y = 0; y < GOLDEN_ROWS; y++) {
+      if (rows[y] == expected[y]) continue;
+      uint16_t end = y;
+      while (end + 1 < GOLDEN_ROWS && rows[end + 1] != expected[end + 1]) end++;
+      Serial.printf(" %u-%u", y, end);
+      y = end;
+    }
+    Serial.println();
+  }
+
+public:
+  explicit ScreenCheck(bool generate) : generate(generate) {}
+
+  void begin() {
+    count = 0;
+    failures = 0;
+    if (!generate) return;
+    Serial.println("#ifndef SCREEN_GOLDEN_H");
+    Serial.println("#define SCREEN_GOLDEN_H");
+    Serial.println();
+    Serial.println("#include <stdint.h>");
+    Serial.println();
+    Serial.println("// Row hashes of the UI screens in their fixed check state (see");
+    Serial.println("// runScreenCheck() in main.cpp), from the \"golden\" serial command.");
+    Serial.println("// Regenerate after a change that is meant to alter a screen.");
+    Serial.printf("static const uint16_t GOLDEN_ROWS = %u;\n", GOLDEN_ROWS);
+    Serial.println();
+  }
+
+  // Check the screen now on the panel, or print its table in generate mode
+  void screen(const char* name) {
+    if (!capture()) {
+      Serial.printf("check,%s,UNREADABLE\n", name);
+      failures++;
+      return;
+    }
+    if (generate) {
+      if (count < MAX_SCREENS) names[count++] = name;
+      printTable(name);
+      return;
+    }
+
+    const uint32_t* expected = golden(name);
+    if (!expected) {
+      Serial.printf("check,%s,NO_GOLDEN\n", name);
+      failures++;
+    } else if (memcmp(rows, expected, sizeof(rows)) != 0) {
+      printDiff(name, expected);
+      failures++;
+    } else {
+      Serial.printf("check,%s,ok\n", name);
+    }
+  }
+
+  // Count a failure another check has printed, for the summary
+  void fail() { failures++; }
+
+  void skip(const char* name, const char* reason) {
+    Serial.printf("check,%s,skipped,%s\n", name, reason);
+  }
+
+  // Print the summary (or the screen table); true if every screen matched
+  bool finish() {
+    if (generate) {
+      Serial.println("struct GoldenScreen {");
+      Serial.println("  const char* name;");
+      Serial.println("  const uint32_t* rows;");
+      Serial.println("};");
+      Serial.println();
+      Serial.println("static const GoldenScreen GOLDEN_SCREENS[] = {");
+      for (uint8_t i = 0; i < count; i++) {
+        Serial.printf("  {\"%s\", GOLDEN_", names[i]);
+        printUpper(names[i]);
+        Serial.println("},");
+      }
+      Serial.println("};");
+      Serial.println();
+      Serial.println("#endif");
+    } else {
+      Serial.printf("check,summary,%s,%u\n", failures ? "FAIL" : "ok", failures);
+    }
+    return failures == 0;
+  }
+};
+
+#endif
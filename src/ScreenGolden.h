@@ -0,0 +1,154 @@
+#ifndef SCREEN_GOLDEN_H
+#define SCREEN_GOLDEN_H
+
+#include <stdint.h>
+
+// Row hashes of the UI screens in their fixed check state (see
+// runScreenCheck() in main.cpp), from the "golden" serial command.
+// Regenerate after a change that is meant to alter a screen.
+static const uint16_t GOLDEN_ROWS = 135;
+
+static const uint32_t GOLDEN_WAITING[GOLDEN_ROWS] = {
+  0xA4C0E245, 0xE1F680E5, 0x05D57765, 0x828CE3C5, 0x7FA99795, 0x3614F437,
+  0x8E9EAC92, 0x0B6B174C, 0x1DD1EFF4, 0x0FF159F3, 0xE2D49F43, 0x2414AF28,
+  0x4F270641, 0x341F6BF3, 0x054F2D92, 0x246BBE88, 0xD853DF24, 0x05F9E5F0,
+  0xC33BFF85, 0x7CE2CB05, 0x98CBD805, 0x0768F9C5, 0x7D790DC5, 0x31575385,
+  0x6AC979C5, 0x053D5F45, 0x053D5F45, 0x053D5F45, 0x053D5F45, 0x053D5F45,
+  0x053D5F45, 0x053D5F45, 0x053D5F45, 0x053D5F45, 0x053D5F45, 0x053D5F45,
+  0xD31F763D, 0xE54268B1, 0x076ACB55, 0x1BDC56FE, 0xF38C6242, 0x12383677,
+  0x2B84E17C, 0x770870DE, 0xBB4213ED, 0xE1F37300, 0x053D5F45, 0x053D5F45,
+  0x053D5F45, 0x053D5F45, 0x053D5F45, 0x053D5F45, 0x053D5F45, 0x053D5F45,
+  0x053D5F45, 0x053D5F45, 0x053D5F45, 0x053D5F45, 0x053D5F45, 0x053D5F45,
+  0x053D5F45, 0x5903D8CD, 0x876919D1, 0xB4C2EFD5, 0xF0C8CB35, 0xF5010C1D,
+  0xE5CBF54F, 0x123DEBA5, 0x0956AE75, 0x60FFFB67, 0x4A318D19, 0x8CCAAEA1,
+  0x8CCAAEA1, 0x334F3A33, 0x053D5F45, 0x053D5F45, 0x053D5F45, 0x053D5F45,
+  0x053D5F45, 0x053D5F45, 0x053D5F45, 0x50677C3D, 0xAB2250EB, 0xD952E4D7,
+  0xA2408C2F, 0x812690C5, 0xF17A9A8F, 0x5CE0CF8F, 0xBE1A4541, 0x5BC7043F,
+  0xA8E3B8B9, 0x053D5F45, 0x053D5F45, 0x053D5F45, 0x053D5F45, 0x053D5F45,
+  0x053D5F45, 0x053D5F45, 0x053D5F45, 0x053D5F45, 0x053D5F45, 0x053D5F45,
+  0x053D5F45, 0x053D5F45, 0x053D5F45, 0x053D5F45, 0x053D5F45, 0x053D5F45,
+  0x053D5F45, 0x053D5F45, 0x053D5F45, 0x053D5F45, 0x053D5F45, 0x053D5F45,
+  0x053D5F45, 0x053D5F45, 0x053D5F45, 0x053D5F45, 0x053D5F45, 0x053D5F45,
+  0x053D5F45, 0x053D5F45, 0x053D5F45, 0x053D5F45, 0x053D5F45, 0x053D5F45,
+  0x053D5F45, 0x053D5F45, 0x053D5F45, 0x053D5F45, 0x053D5F45, 0x053D5F45,
+  0x053D5F45, 0x053D5F45, 0x053D5F45,
+};
+
+static const uint32_t GOLDEN_CONNECTED[GOLDEN_ROWS] = {
+  0xA4C0E245, 0xE1F680E5, 0x05D57765, 0x828CE3C5, 0x7FA99795, 0xEB9B5B82,
+  0xCDAFB9D3, 0x671C40E5, 0x6F379381, 0xA94386D2, 0xA3C3DD92, 0x48368441,
+  0xE0F5B770, 0xC36A622A, 0x1A75EA4B, 0xE9DF3EA9, 0x9B9B52B1, 0x69BCC3B1,
+  0xC33BFF85, 0x7CE2CB05, 0x98CBD805, 0x0768F9C5, 0x7D790DC5, 0x31575385,
+  0x6AC979C5, 0x053D5F45, 0x053D5F45, 0x053D5F45, 0x053D5F45, 0x053D5F45,
+  0x053D5F45, 0x053D5F45, 0x053D5F45, 0x053D5F45, 0x053D5F45, 0x053D5F45,
+  0xD31F763D, 0x7CB2B7C9, 0x18D38A28, 0x6E3BAF87, 0x5C9F64D2, 0x7584B686,
+  0xA5F5808C, 0x3EB5D107, 0x97F1A1B8, 0xEF382A75, 0x053D5F45, 0x053D5F45,
+  0x053D5F45, 0x053D5F45, 0x053D5F45, 0x053D5F45, 0x053D5F45, 0x053D5F45,
+  0x053D5F45, 0x053D5F45, 0x053D5F45, 0x053D5F45, 0x053D5F45, 0x053D5F45,
+  0x053D5F45, 0xF7AEC0D3, 0x108FF7E1, 0x4190864D, 0x846910F5, 0xFB2003C5,
+  0xFEA90AF7, 0xE112709D, 0xFD648069, 0x484150C5, 0xD728779B, 0x107DEDDD,
+  0x107DEDDD, 0x7A9289F1, 0x053D5F45, 0x053D5F45, 0x053D5F45, 0x053D5F45,
+  0x053D5F45, 0x053D5F45, 0x053D5F45, 0x053D5F45, 0x053D5F45, 0x053D5F45,
+  0x053D5F45, 0x053D5F45, 0x96AE2960, 0x6CD89740, 0x3494489D, 0xFDAEF0B0,
+  0x5121DEA8, 0x32D80025, 0x43110868, 0x40DD5628, 0xB54A3168, 0x2868FF1D,
+  0x053D5F45, 0x053D5F45, 0x053D5F45, 0x053D5F45, 0x053D5F45, 0x053D5F45,
+  0x053D5F45, 0x053D5F45, 0x053D5F45, 0x053D5F45, 0x053D5F45, 0x053D5F45,
+  0x3D3DB72B, 0x84A149A1, 0x2A24E6E9, 0x28ADDB61, 0x6AD4BE89, 0x84A149A1,
+  0x2A24E6E9, 0x28ADDB61, 0x6AD4BE89, 0x84A149A1, 0x2A24E6E9, 0x28ADDB61,
+  0x6AD4BE89, 0x84A149A1, 0x3D3DB72B, 0x053D5F45, 0x053D5F45, 0x053D5F45,
+  0x053D5F45, 0x053D5F45, 0x053D5F45, 0x053D5F45, 0x053D5F45, 0x053D5F45,
+  0x053D5F45, 0x053D5F45, 0x053D5F45,
+};
+
+static const uint32_t GOLDEN_COUNTDOWN_TICK[GOLDEN_ROWS] = {
+  0xA4C0E245, 0xE1F680E5, 0x05D57765, 0x828CE3C5, 0x7FA99795, 0xEB9B5B82,
+  0xCDAFB9D3, 0x671C40E5, 0x6F379381, 0xA94386D2, 0xA3C3DD92, 0x48368441,
+  0xE0F5B770, 0xC36A622A, 0x1A75EA4B, 0xE9DF3EA9, 0x9B9B52B1, 0x69BCC3B1,
+  0xC33BFF85, 0x7CE2CB05, 0x98CBD805, 0x0768F9C5, 0x7D790DC5, 0x31575385,
+  0x6AC979C5, 0x053D5F45, 0x053D5F45, 0x053D5F45, 0x053D5F45, 0x053D5F45,
+  0x053D5F45, 0x053D5F45, 0x053D5F45, 0x053D5F45, 0x053D5F45, 0x053D5F45,
+  0xD31F763D, 0x7CB2B7C9, 0x18D38A28, 0x6E3BAF87, 0x5C9F64D2, 0x7584B686,
+  0xA5F5808C, 0x3EB5D107, 0x97F1A1B8, 0xEF382A75, 0x053D5F45, 0x053D5F45,
+  0x053D5F45, 0x053D5F45, 0x053D5F45, 0x053D5F45, 0x053D5F45, 0x053D5F45,
+  0x053D5F45, 0x053D5F45, 0x053D5F45, 0x053D5F45, 0x053D5F45, 0x053D5F45,
+  0x053D5F45, 0xF7AEC0D3, 0x108FF7E1, 0x4190864D, 0x846910F5, 0xFB2003C5,
+  0xFEA90AF7, 0xE112709D, 0xFD648069, 0x484150C5, 0xD728779B, 0x107DEDDD,
+  0x107DEDDD, 0x7A9289F1, 0x053D5F45, 0x053D5F45, 0x053D5F45, 0x053D5F45,
+  0x053D5F45, 0x053D5F45, 0x053D5F45, 0x053D5F45, 0x053D5F45, 0x053D5F45,
+  0x053D5F45, 0x053D5F45, 0xE3DC2C9D, 0x9592CB70, 0xA4FD2DBD, 0x3ED16B10,
+  0x02D4B115, 0x54EAE1E0, 0xCC9266B0, 0x9ECCDDF0, 0x04F31A20, 0x13D94375,
+  0x053D5F45, 0x053D5F45, 0x053D5F45, 0x053D5F45, 0x053D5F45, 0x053D5F45,
+  0x053D5F45, 0x053D5F45, 0x053D5F45, 0x053D5F45, 0x053D5F45, 0x053D5F45,
+  0x3D3DB72B, 0xB4745930, 0x63BC6458, 0x137001E8, 0x52602250, 0xB4745930,
+  0x63BC6458, 0x137001E8, 0x52602250, 0xB4745930, 0x63BC6458, 0x137001E8,
+  0x52602250, 0xB4745930, 0x3D3DB72B, 0x053D5F45, 0x053D5F45, 0x053D5F45,
+  0x053D5F45, 0x053D5F45, 0x053D5F45, 0x053D5F45, 0x053D5F45, 0x053D5F45,
+  0x053D5F45, 0x053D5F45, 0x053D5F45,
+};
+
+static const uint32_t GOLDEN_MOVING[GOLDEN_ROWS] = {
+  0xA4C0E245, 0xE1F680E5, 0x05D57765, 0x828CE3C5, 0x7FA99795, 0xEB9B5B82,
+  0xCDAFB9D3, 0x671C40E5, 0x6F379381, 0xA94386D2, 0xA3C3DD92, 0x48368441,
+  0xE0F5B770, 0xC36A622A, 0x1A75EA4B, 0xE9DF3EA9, 0x9B9B52B1, 0x69BCC3B1,
+  0xC33BFF85, 0x7CE2CB05, 0x98CBD805, 0x0768F9C5, 0x7D790DC5, 0x31575385,
+  0x6AC979C5, 0x053D5F45, 0x053D5F45, 0x053D5F45, 0x053D5F45, 0x053D5F45,
+  0x053D5F45, 0x053D5F45, 0x053D5F45, 0x053D5F45, 0x053D5F45, 0x053D5F45,
+  0xD31F763D, 0x55197679, 0x65E6C5E5, 0x45CC06BF, 0x708F8873, 0x53CEAAD7,
+  0xC9F36629, 0x931A27AF, 0x8D24FC6D, 0xCA5B12FD, 0x053D5F45, 0x053D5F45,
+  0x053D5F45, 0x053D5F45, 0x053D5F45, 0x053D5F45, 0x053D5F45, 0x053D5F45,
+  0x053D5F45, 0x053D5F45, 0x053D5F45, 0x053D5F45, 0x053D5F45, 0x053D5F45,
+  0x053D5F45, 0xF7AEC0D3, 0x108FF7E1, 0x4190864D, 0x846910F5, 0xFB2003C5,
+  0xFEA90AF7, 0xE112709D, 0xFD648069, 0x484150C5, 0xD728779B, 0x107DEDDD,
+  0x107DEDDD, 0x7A9289F1, 0x053D5F45, 0x053D5F45, 0x053D5F45, 0x053D5F45,
+  0x053D5F45, 0x053D5F45, 0x053D5F45, 0x053D5F45, 0x053D5F45, 0x053D5F45,
+  0x053D5F45, 0x053D5F45, 0xE3DC2C9D, 0x9592CB70, 0xA4FD2DBD, 0x3ED16B10,
+  0x02D4B115, 0x54EAE1E0, 0xCC9266B0, 0x9ECCDDF0, 0x04F31A20, 0x13D94375,
+  0x053D5F45, 0x053D5F45, 0x053D5F45, 0x053D5F45, 0x053D5F45, 0x053D5F45,
+  0x053D5F45, 0x053D5F45, 0x053D5F45, 0x053D5F45, 0x053D5F45, 0x053D5F45,
+  0x3D3DB72B, 0xB4745930, 0x63BC6458, 0x137001E8, 0x52602250, 0xB4745930,
+  0x63BC6458, 0x137001E8, 0x52602250, 0xB4745930, 0x63BC6458, 0x137001E8,
+  0x52602250, 0xB4745930, 0x3D3DB72B, 0x053D5F45, 0x053D5F45, 0x053D5F45,
+  0x053D5F45, 0x053D5F45, 0x053D5F45, 0x053D5F45, 0x053D5F45, 0x053D5F45,
+  0x053D5F45, 0x053D5F45, 0x053D5F45,
+};
+
+static const uint32_t GOLDEN_WIFI_INFO[GOLDEN_ROWS] = {
+  0x053D5F45, 0x9F4E103D, 0x9F4E103D, 0x6B0F2755, 0x3E2915F3, 0xC52537C3,
+  0x55B7DED3, 0xAA573A8D, 0x15640BC3, 0x9D5938B3, 0x568973E3, 0xE2537919,
+  0x735FE227, 0x66B07695, 0x66B07695, 0x66B07695, 0x66B07695, 0x0ACD47C5,
+  0x0ACD47C5, 0x0ACD47C5, 0x84A16E4F, 0x9330B04F, 0x9330B04F, 0x9330B04F,
+  0x9330B04F, 0x40CB7527, 0x7C296CD1, 0x7C296CD1, 0x7C296CD1, 0xC646A09D,
+  0xC646A09D, 0xC646A09D, 0xE4432B81, 0x1C17DFB1, 0x1C17DFB1, 0x0B77290F,
+  0x0B77290F, 0x365CC067, 0xA276ECE7, 0xA276ECE7, 0xA276ECE7, 0xFC8EA72D,
+  0xFC8EA72D, 0xFC8EA72D, 0x979FAFF9, 0x144C04B1, 0x144C04B1, 0x5403B87F,
+  0x5403B87F, 0x907FB2D7, 0x52BA750B, 0x52BA750B, 0x52BA750B, 0x079C00C9,
+  0x079C00C9, 0x079C00C9, 0x2549FCC7, 0x3D207EDF, 0x3D207EDF, 0xCC7ABCF5,
+  0xCC7ABCF5, 0x8FE89BED, 0xA7B0ABAF, 0xA7B0ABAF, 0xA7B0ABAF, 0xDA489467,
+  0xDA489467, 0xDA489467, 0xC5B12F35, 0xC1DCEE2D, 0xC1DCEE2D, 0xF49D61BD,
+  0xF49D61BD, 0x94A015DD, 0x77A958A9, 0x77A958A9, 0x77A958A9, 0xD5811F37,
+  0xD5811F37, 0xD5811F37, 0x29F5E2B7, 0x02E53B87, 0x02E53B87, 0x3F25A9E9,
+  0x3F25A9E9, 0x6FD3A301, 0xA5C1418B, 0xA5C1418B, 0xA5C1418B, 0x577F1649,
+  0x577F1649, 0x577F1649, 0x5F24847D, 0x6EC08245, 0x6EC08245, 0x19EE2EC3,
+  0x19EE2EC3, 0x6CBF72FB, 0xB7B2AE25, 0xB7B2AE25, 0xB7B2AE25, 0x9708A02F,
+  0x9708A02F, 0x9708A02F, 0x9708A02F, 0xB14EEB4F, 0xB14EEB4F, 0x377AC4C5,
+  0x377AC4C5, 0x146DA8D5, 0xFABBFF99, 0xE0100A7D, 0x809FD845, 0x6472F02B,
+  0x163FCE8F, 0x7903102F, 0x68084E77, 0x79029AFF, 0xD5D511E3, 0xFF109E6F,
+  0xAE1AB829, 0xCDF3D461, 0xEDA1BE9B, 0xC6BDB5B5, 0xC6BDB5B5, 0x9F4E103D,
+  0x6F903E88, 0xBD2A9C05, 0xDE4B6500, 0x06D579D5, 0x8D82A1CD, 0x28B15008,
+  0x9F4E103D, 0x053D5F45, 0x053D5F45,
+};
+
+struct GoldenScreen {
+  const char* name;
+  const uint32_t* rows;
+};
+
+static const GoldenScreen GOLDEN_SCREENS[] = {
+  {"waiting", GOLDEN_WAITING},
+  {"connected", GOLDEN_CONNECTED},
+  {"countdown_tick", GOLDEN_COUNTDOWN_TICK},
+  {"moving", GOLDEN_MOVING},
+  {"wifi_info", GOLDEN_WIFI_INFO},
+};
+
+#endif
@@ -0,0 +1,340 @@
+#ifndef TASKS_H
+#define TASKS_H
+
+#include <stdint.h>
+
+#ifdef ARDUINO
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#include <freertos/queue.h>
+#include <freertos/semphr.h>
+#include <freertos/event_groups.h>
+#include <esp_timer.h>
+#else
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#endif
+
+// Tasks and the primitives they talk through: FreeRTOS on the device,
+// std::thread off it, so the same task code can be run and tested on a PC.
+//
+// Everything is allocated statically (no heap after begin()). Timeouts are
+// in milliseconds; TASK_WAIT_FOREVER blocks until the event arrives.
+static const uint32_t TASK_WAIT_FOREVER = 0xFFFFFFFF;
+
+// ESP32 cores: the radio stacks run on the protocol core (0), the Arduino
+// loop on the application core (1). Ignored off the device.
+static const int8_t TASK_CORE_PROTOCOL = 0;
+static const int8_t TASK_CORE_APP = 1;
+
+class Task {
+public:
+  typedef void (*Function)(void* arg);
+
+  // Start fn(arg) on its own task pinned to core; it must never return
+  static bool start(const char* name, Function fn, void* arg, uint32_t stackBytes, uint8_t priority, int8_t core) {
+#ifdef ARDUINO
+    return xTaskCreatePinnedToCore(fn, name, stackBytes, arg, priority, nullptr, core) == pdPASS;
+#else
+    (void)name; (void)stackBytes; (void)priority; (void)core;
+    std::thread(fn, arg).detach();
+    return true;
+#endif
+  }
+
+  // Least stack the calling task has had free since it started, in bytes
+  // (ESP-IDF sizes stacks in bytes); 0 off the device
+  static uint32_t stackUnused() {
+#ifdef ARDUINO
+    return uxTaskGetStackHighWaterMark(nullptr);
+#else
+    return 0;
+#endif
+  }
+
+  static void sleep(uint32_t ms) {
+#ifdef ARDUINO
+    vTaskDelay(ticks(ms));
+#else
+    std::this_thread::sleep_for(std::chrono::milliseconds(ms));
+#endif
+  }
+
+  // End the calling task (the Arduino loop task once setup() has handed
+  // over); off the device the caller just blocks
+  static void end() {
+#ifdef ARDUINO
+    vTaskDelete(nullptr);
+#else
+    for (;;) std::this_thread::sleep_for(std::chrono::hours(1));
+#endif
+  }
+
+#ifdef ARDUINO
+  static TickType_t ticks(uint32_t ms) {
+    return ms == TASK_WAIT_FOREVER ? portMAX_DELAY : pdMS_TO_TICKS(ms);
+  }
+#endif
+};
+
+// Up to 24 flags a task can block on (a FreeRTOS event group)
+class EventFlags {
+private:
+#ifdef ARDUINO
+  StaticEventGroup_t control;
+  EventGroupHandle_t handle = nullptr;
+#else
+  std::mutex lock;
+  std::condition_variable changed;
+  uint32_t bits = 0;
+#endif
+
+public:
+  bool begin() {
+#ifdef ARDUINO
+    if (!handle) handle = xEventGroupCreateStatic(&control);
+    return handle != nullptr;
+#else
+    return true;
+#endif
+  }
+
+  void set(uint32_t flags) {
+#ifdef ARDUINO
+    xEventGroupSetBits(handle, flags);
+#else
+    std::lock_guard<std::mutex> guard(lock);
+    bits |= flags;
+    changed.notify_all();
+#endif
+  }
+
+  void clear(uint32_t flags) {
+#ifdef ARDUINO
+    xEventGroupClearBits(handle, flags);
+#else
+    std::lock_guard<std::mutex> guard(lock);
+    bits &= ~flags;
+#endif
+  }
+
+  // Block until any of flags is set (all of them with waitAll) or the
+  // timeout passes. Returns the flags as they were, the awaited ones are
+  // then cleared; a timeout returns without the awaited flags.
+  uint32_t wait(uint32_t flags, uint32_t timeoutMs, bool waitAll = false) {
+#ifdef ARDUINO
+    return xEventGroupWaitBits(handle, flags, pdTRUE, waitAll ? pdTRUE : pdFALSE, Task::ticks(timeoutMs));
+#else
+    std::unique_lock<std::mutex> guard(lock);
+    auto ready = [&]() { return waitAll ? (bits & flags) == flags : (bits & flags) != 0; };
+    if (timeoutMs == TASK_WAIT_FOREVER) {
+      changed.wait(guard, ready);
+    } else {
+      changed.wait_for(guard, std::chrono::milliseconds(timeoutMs), ready);
+    }
+    uint32_t result = bits;
+    if (ready()) bits &= ~flags;
+    return result;
+#endif
+  }
+};
+
+// Fixed-size queue of N messages, copied in and out
+template <typename T, uint8_t N>
+class MessageQueue {
+private:
+#ifdef ARDUINO
+  StaticQueue_t control;
+  uint8_t storage[N * sizeof(T)];
+  QueueHandle_t handle = nullptr;
+#else
+  std::mutex lock;
+  std::condition_variable changed;
+  T items[N];
+  uint8_t head = 0;
+  uint8_t count = 0;
+#endif
+
+public:
+  bool begin() {
+#ifdef ARDUINO
+    if (!handle) handle = xQueueCreateStatic(N, sizeof(T), storage, &control);
+    return handle != nullptr;
+#else
+    return true;
+#endif
+  }
+
+  // False if the queue stayed full for timeoutMs (0: do not wait)
+  bool send(const T& item, uint32_t timeoutMs = 0) {
+#ifdef ARDUINO
+    return xQueueSend(handle, &item, Task::ticks(timeoutMs)) == pdTRUE;
+#else
+    std::unique_lock<std::mutex> guard(lock);
+    auto room = [&]() { return count < N; };
+    if (timeoutMs == TASK_WAIT_FOREVER) {
+      changed.wait(guard, room);
+    } else if (!changed.wait_for(guard, std::chrono::milliseconds(timeoutMs), room)) {
+      return false;
+    }
+    items[(head + count++) % N] = item;
+    changed.notify_all();
+    return true;
+#endif
+  }
+
+  // False if nothing arrived within timeoutMs
+  bool receive(T& item, uint32_t timeoutMs) {
+#ifdef ARDUINO
+    return xQueueReceive(handle, &item, Task::ticks(timeoutMs)) == pdTRUE;
+#else
+    std::unique_lock<std::mutex> guard(lock);
+    auto ready = [&]() { return count > 0; };
+    if (timeoutMs == TASK_WAIT_FOREVER) {
+      changed.wait(guard, ready);
+    } else if (!changed.wait_for(guard, std::chrono::milliseconds(timeoutMs), ready)) {
+      return false;
+    }
+    item = items[head];
+    head = (head + 1) % N;
+    count--;
+    changed.notify_all();
+    return true;
+#endif
+  }
+};
+
+// Sets flags on an EventFlags after a delay given in microseconds: a
+// one-shot esp_timer on the device, so the waiting task wakes on time
+// instead of on the next 1 ms tick. Restarting replaces the pending one.
+class DeadlineTimer {
+private:
+  EventFlags* target = nullptr;
+  uint32_t flags = 0;
+#ifdef ARDUINO
+  esp_timer_handle_t handle = nullptr;
+
+  static void expired(void* arg) {
+    DeadlineTimer* timer = (DeadlineTimer*)arg;
+    timer->target->set(timer->flags);
+  }
+#else
+  std::mutex lock;
+  std::condition_variable changed;
+  std::chrono::steady_clock::time_point when;
+  bool armed = false;
+  bool started = false;
+
+  void run() {
+    std::unique_lock<std::mutex> guard(lock);
+    for (;;) {
+      if (!armed) {
+        changed.wait(guard);
+      } else if (changed.wait_until(guard, when) == std::cv_status::timeout && armed &&
+                 std::chrono::steady_clock::now() >= when) {
+        armed = false;
+        target->set(flags);
+      }
+    }
+  }
+#endif
+
+public:
+  bool begin(EventFlags* events, uint32_t bits) {
+    target = events;
+    flags = bits;
+#ifdef ARDUINO
+    if (handle) return true;
+    esp_timer_create_args_t args = {};
+    args.callback = expired;
+    args.arg = this;
+    args.name = "deadline";
+    return esp_timer_create(&args, &handle) == ESP_OK;
+#else
+    if (!started) {
+      started = true;
+      std::thread([this]() { run(); }).detach();
+    }
+    return true;
+#endif
+  }
+
+  void start(uint64_t delayUs) {
+#ifdef ARDUINO
+    esp_timer_stop(handle);  // fails harmlessly when it is not running
+    esp_timer_start_once(handle, delayUs);
+#else
+    std::lock_guard<std::mutex> guard(lock);
+    when = std::chrono::steady_clock::now() + std::chrono::microseconds(delayUs);
+    armed = true;
+    changed.notify_all();
+#endif
+  }
+
+  void stop() {
+#ifdef ARDUINO
+    esp_timer_stop(handle);
+#else
+    std::lock_guard<std::mutex> guard(lock);
+    armed = false;
+    changed.notify_all();
+#endif
+  }
+};
+
+// Mutual exclusion between tasks; FreeRTOS mutexes inherit priority
+class Mutex {
+private:
+#ifdef ARDUINO
+  StaticSemaphore_t control;
+  SemaphoreHandle_t handle = nullptr;
+#else
+  std::mutex mutex;
+#endif
+
+public:
+  bool begin() {
+#ifdef ARDUINO
+    if (!handle) handle = xSemaphoreCreateMutexStatic(&control);
+    return handle != nullptr;
+#else
+    return true;
+#endif
+  }
+
+  void lock() {
+#ifdef ARDUINO
+    xSemaphoreTake(handle, portMAX_DELAY);
+#else
+    mutex.lock();
+#endif
+  }
+
+  void unlock() {
+#ifdef ARDUINO
+    xSemaphoreGive(handle);
+#else
+    mutex.unlock();
+#endif
+  }
+};
+
+// Holds a Mutex for the enclosing scope; a null mutex is not locked
+class LockGuard {
+private:
+  Mutex* mutex;
+
+public:
+  explicit LockGuard(Mutex* m) : mutex(m) {
+    if (mutex) mutex->lock();
+  }
+  ~LockGuard() {
+    if (mutex) mutex->unlock();
+  }
+  LockGuard(const LockGuard&) = delete;
+  LockGuard& operator=(const LockGuard&) = delete;
+};
+
+#endif
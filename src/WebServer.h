@@ -3,12 +3,37 @@
 
 #include <WiFi.h>
 #include "Config.h"
+#include "GUI_Paint.h"
+#include "DisplayMirror.h"
+#include "AssetStore.h"
+#include "Tasks.h"
+#include "JiggleScheduler.h"
+#include "PowerManager.h"
+#include "WeekSchedule.h"
+#include "Profiler.h"
+#include "LifetimeStats.h"
+#include "ActivityHistory.h"
 
 class JigglerWebServer {
+public:
+  // Version of the settings page and the routes it calls. Bump it when a
+  // change to one needs the other; tools/pack_assets.py stamps it into the
+  // asset archive, and an archived page of another version is not served.
+  static const uint32_t PAGE_VERSION = 1;
+  
 private:
   WiFiServer* server;
   ConfigManager* configManager;
   bool apActive;
+  void (*notifyCallback)(const char* message);  // shows a short on-screen notice
+  DisplayMirror* mirror;                        // takes over /ws connections
+  const AssetStore* assets;                     // page from the assets partition, when flashed
+  Mutex* displayLock;                           // held while reading the screen or the mirror
+  const JiggleScheduler* scheduler;             // jiggle timing for /api/timing
+  PowerManager* power;                          // kept awake while serving
+  WallClock* clock;                             // set from the browser for the schedule
+  LifetimeStats* lifetime;                      // flushed before a restart
+  ActivityHistory* history;                     // exported by /api/history
   
   const char* getIndexHTML() {
     return R"rawliteral(
@@ -68,7 +93,7 @@ private:
       font-weight: 500;
       font-size: 14px;
     }
-    input[type="text"], input[type="number"], input[type="password"] {
+    input[type="text"], input[type="number"], input[type="password"], textarea {
       width: 100%;
       padding: 12px;
       margin-bottom: 15px;
@@ -77,7 +102,7 @@ private:
       font-size: 14px;
       transition: border-color 0.3s;
     }
-    input:focus {
+    input:focus, textarea:focus {
       outline: none;
       border-color: #667eea;
     }
@@ -132,6 +157,27 @@ private:
       font-size: 13px;
       color: #555;
     }
+    #screen {
+      width: 100%;
+      background: #000;
+      border-radius: 4px;
+      image-rendering: pixelated;
+    }
+    .activity {
+      width: 100%;
+      background: #fff;
+      border-radius: 4px;
+      margin-bottom: 5px;
+    }
+    textarea {
+      font-family: monospace;
+      resize: vertical;
+    }
+    .pattern-status {
+      font-size: 13px;
+      color: #555;
+      margin-top: 10px;
+    }
     .success-message {
       background: #d4edda;
       color: #155724;
@@ -155,6 +201,55 @@ private:
       ✓ Settings saved successfully!
     </div>
     
+    <div class="section">
+      <div class="section-title">Live Screen</div>
+      <canvas id="screen" width="240" height="135"></canvas>
+    </div>
+    
+    <div class="section">
+      <div class="section-title">Activity</div>
+      <label>Last 24 hours, per quarter hour</label>
+      <canvas id="activityDay" class="activity" width="480" height="60"></canvas>
+      <div id="activityDayText" class="pattern-status"></div>
+      <label>Last 7 days, per hour</label>
+      <canvas id="activityWeek" class="activity" width="504" height="60"></canvas>
+      <div id="activityWeekText" class="pattern-status"></div>
+    </div>
+    
+    <div class="section">
+      <div class="section-title">Custom Pattern</div>
+      
+      <div class="checkbox-group">
+        <input type="checkbox" id="customPattern" name="customPattern">
+        <label for="customPattern" style="margin-bottom: 0;">Play This Pattern Instead</label>
+      </div>
+      
+      <label for="pattern">Commands: move X Y, scroll N, click [left|right|middle], wait MS, repeat N ... end; a number may be a range like 2..5</label>
+      <textarea id="pattern" name="pattern" rows="8" spellcheck="false" placeholder="repeat 2&#10;  move 3 0&#10;  wait 50..150&#10;  move -3 0&#10;  wait 50&#10;end"></textarea>
+      
+      <div id="patternStatus" class="pattern-status"></div>
+      <div class="btn-group">
+        <button type="button" class="btn-primary" onclick="savePattern()">Save Pattern</button>
+      </div>
+    </div>
+    
+    <div class="section">
+      <div class="section-title">Schedule</div>
+      
+      <div class="checkbox-group">
+        <input type="checkbox" id="scheduleOn" name="scheduleOn">
+        <label for="scheduleOn" style="margin-bottom: 0;">Jiggle Only At These Times</label>
+      </div>
+      
+      <label for="schedule">Windows: days HH:MM-HH:MM, quarter hours, one per line; days like Mon, Mon-Fri, Sat,Sun or daily; "except" takes time out</label>
+      <textarea id="schedule" name="schedule" rows="5" spellcheck="false" placeholder="Mon-Fri 08:30-18:00&#10;except Mon-Fri 12:00-13:00"></textarea>
+      
+      <div id="scheduleStatus" class="pattern-status"></div>
+      <div class="btn-group">
+        <button type="button" class="btn-primary" onclick="saveSchedule()">Save Schedule</button>
+      </div>
+    </div>
+    
     <form id="configForm">
       <div class="section">
         <div class="section-title">Jiggle Settings</div>
@@ -162,6 +257,9 @@ private:
         <label for="interval">Jiggle Interval (seconds)</label>
         <input type="number" id="interval" name="interval" min="5" max="300" value="30" required>
         
+        <label for="jitter">Interval Jitter (± seconds)</label>
+        <input type="number" id="jitter" name="jitter" min="0" max="100" value="0" required>
+        
         <label for="distance">Move Distance (pixels)</label>
         <input type="number" id="distance" name="distance" min="1" max="20" value="2" required>
         
@@ -177,6 +275,19 @@ private:
           <label for="randMax">Random Max Distance</label>
           <input type="number" id="randMax" name="randMax" min="1" max="20" value="5">
         </div>
+        
+        <div class="checkbox-group">
+          <input type="checkbox" id="curved" name="curved">
+          <label for="curved" style="margin-bottom: 0;">Use Curved Movements</label>
+        </div>
+        
+        <div id="curveSettings" style="display: none;">
+          <label for="curveMs">Curve Duration (milliseconds)</label>
+          <input type="number" id="curveMs" name="curveMs" min="200" max="5000" value="800">
+          
+          <label for="curveAmp">Curve Size (pixels)</label>
+          <input type="number" id="curveAmp" name="curveAmp" min="2" max="100" value="20">
+        </div>
       </div>
       
       <div class="section">
@@ -184,6 +295,11 @@ private:
         
         <label for="deviceName">BLE Device Name</label>
         <input type="text" id="deviceName" name="deviceName" maxlength="31" value="Mouse Jiggler" required>
+        
+        <div class="checkbox-group">
+          <input type="checkbox" id="bigDigits" name="bigDigits">
+          <label for="bigDigits" style="margin-bottom: 0;">Large Countdown Digits</label>
+        </div>
       </div>
       
       <div class="section">
@@ -209,14 +325,20 @@ private:
       .then(r => r.json())
       .then(data => {
         document.getElementById('interval').value = data.interval / 1000;
+        document.getElementById('jitter').value = data.jitter / 1000;
         document.getElementById('distance').value = data.distance;
         document.getElementById('random').checked = data.random;
         document.getElementById('randMin').value = data.randMin;
         document.getElementById('randMax').value = data.randMax;
+        document.getElementById('curved').checked = data.curved;
+        document.getElementById('curveMs').value = data.curveMs;
+        document.getElementById('curveAmp').value = data.curveAmp;
+        document.getElementById('bigDigits').checked = data.bigDigits;
         document.getElementById('deviceName').value = data.deviceName;
         document.getElementById('wifiSSID').value = data.wifiSSID;
         document.getElementById('wifiPassword').value = data.wifiPassword;
         toggleRandomSettings();
+        toggleCurveSettings();
       });
     
     // Toggle random settings visibility
@@ -227,16 +349,28 @@ private:
       randomSettings.style.display = document.getElementById('random').checked ? 'block' : 'none';
     }
     
+    document.getElementById('curved').addEventListener('change', toggleCurveSettings);
+    
+    function toggleCurveSettings() {
+      const curveSettings = document.getElementById('curveSettings');
+      curveSettings.style.display = document.getElementById('curved').checked ? 'block' : 'none';
+    }
+    
     // Handle form submission
     document.getElementById('configForm').addEventListener('submit', function(e) {
       e.preventDefault();
       
       const formData = {
         interval: parseInt(document.getElementById('interval').value) * 1000,
+        jitter: parseInt(document.getElementById('jitter').value) * 1000,
         distance: parseInt(document.getElementById('distance').value),
         random: document.getElementById('random').checked,
         randMin: parseInt(document.getElementById('randMin').value),
         randMax: parseInt(document.getElementById('randMax').value),
+        curved: document.getElementById('curved').checked,
+        curveMs: parseInt(document.getElementById('curveMs').value),
+        curveAmp: parseInt(document.getElementById('curveAmp').value),
+        bigDigits: document.getElementById('bigDigits').checked,
         deviceName: document.getElementById('deviceName').value,
         wifiSSID: document.getElementById('wifiSSID').value,
         wifiPassword: document.getElementById('wifiPassword').value
@@ -260,6 +394,178 @@ private:
       });
     });
     
+    // Custom pattern: the device compiles the text and keeps the bytecode
+    fetch('/api/pattern')
+      .then(r => r.json())
+      .then(data => {
+        document.getElementById('customPattern').checked = data.enabled;
+        document.getElementById('pattern').value = data.source;
+        if (data.bytes) showPatternStatus(data.bytes + ' bytes, up to ' + data.duration + ' ms', false);
+      });
+    
+    function showPatternStatus(text, error) {
+      const status = document.getElementById('patternStatus');
+      status.textContent = text;
+      status.style.color = error ? '#c62828' : '#555';
+    }
+    
+    function savePattern() {
+      const enabled = document.getElementById('customPattern').checked ? 1 : 0;
+      fetch('/api/pattern?enabled=' + enabled, {
+        method: 'POST',
+        headers: {'Content-Type': 'text/plain'},
+        body: document.getElementById('pattern').value
+      })
+      .then(r => r.json())
+      .then(data => {
+        if (data.success) {
+          showPatternStatus('Saved: ' + data.bytes + ' bytes, up to ' + data.duration + ' ms', false);
+        } else {
+          showPatternStatus((data.line ? 'Line ' + data.line + ': ' : '') + data.error, true);
+        }
+      });
+    }
+    
+    // Schedule: the device has no clock of its own, so give it this one
+    fetch('/api/time?epoch=' + Math.floor(Date.now() / 1000) + '&offset=' + -new Date().getTimezoneOffset(), {method: 'POST'})
+      .then(() => fetch('/api/schedule'))
+      .then(r => r.json())
+      .then(data => {
+        document.getElementById('scheduleOn').checked = data.enabled;
+        document.getElementById('schedule').value = data.rules;
+        showScheduleStatus(data);
+      });
+    
+    function showScheduleStatus(data) {
+      const status = document.getElementById('scheduleStatus');
+      status.textContent = data.success === false
+        ? (data.line ? 'Line ' + data.line + ': ' : '') + data.error
+        : data.hours + ' hours a week' + (data.enabled ? (data.open ? ', jiggling now' : ', paused now') : '');
+      status.style.color = data.success === false ? '#c62828' : '#555';
+    }
+    
+    function saveSchedule() {
+      const enabled = document.getElementById('scheduleOn').checked ? 1 : 0;
+      fetch('/api/schedule?enabled=' + enabled, {
+        method: 'POST',
+        headers: {'Content-Type': 'text/plain'},
+        body: document.getElementById('schedule').value
+      })
+      .then(r => r.json())
+      .then(showScheduleStatus);
+    }
+    
+    // Live screen: each message is one rectangle, u16 x, y, w, h then
+    // RLE RGB565 (token < 128: repeat next pixel t+1 times, else t-127 literals)
+    function startMirror() {
+      const canvas = document.getElementById('screen');
+      const ctx = canvas.getContext('2d');
+      const ws = new WebSocket('ws://' + location.host + '/ws');
+      ws.binaryType = 'arraybuffer';
+      ws.onmessage = function(e) {
+        const v = new DataView(e.data);
+        const x = v.getUint16(0, true), y = v.getUint16(2, true);
+        const w = v.getUint16(4, true), h = v.getUint16(6, true);
+        if (!w || !h) return;
+        const img = ctx.createImageData(w, h);
+        const out = img.data;
+        let pos = 8, o = 0;
+        const put = function(c) {
+          out[o++] = (c >> 8) & 0xF8 | c >> 13;
+          out[o++] = (c >> 3) & 0xFC | (c >> 9) & 3;
+          out[o++] = (c << 3) & 0xF8 | (c >> 2) & 7;
+          out[o++] = 255;
+        };
+        while (pos < v.byteLength && o < out.length) {
+          const t = v.getUint8(pos++);
+          if (t < 128) {
+            const c = v.getUint16(pos, true);
+            pos += 2;
+            for (let i = 0; i <= t; i++) put(c);
+          } else {
+            for (let i = 0; i < t - 127; i++, pos += 2) put(v.getUint16(pos, true));
+          }
+        }
+        ctx.putImageData(img, x, y);
+      };
+      ws.onclose = function() { setTimeout(startMirror, 3000); };
+    }
+    startMirror();
+    
+    // Activity: a 16 byte header, then for the minutes and the hours each
+    // field (jiggles, connected seconds, disconnects, weakest and mean RSSI
+    // as -dBm) as a column of zigzag varint deltas, oldest first
+    function loadActivity() {
+      fetch('/api/history')
+        .then(r => r.arrayBuffer())
+        .then(buf => {
+          const v = new DataView(buf);
+          if (v.byteLength < 16 || v.getUint8(0) != 65 || v.getUint8(1) != 72) return;
+          const fields = v.getUint8(3);
+          let pos = 16;
+          const ring = function(n) {
+            const columns = [];
+            for (let f = 0; f < fields; f++) {
+              const column = [];
+              for (let i = 0, value = 0; i < n; i++) {
+                let z = 0, shift = 0, b;
+                do {
+                  b = v.getUint8(pos++);
+                  z += (b & 127) * Math.pow(2, shift);
+                  shift += 7;
+                } while (b & 128);
+                value += z % 2 ? -(z + 1) / 2 : z / 2;
+                column.push(value);
+              }
+              columns.push(column);
+            }
+            return columns;
+          };
+          const minutes = ring(v.getUint16(4, true));
+          const hours = ring(v.getUint16(6, true));
+          showActivity('activityDay', minutes, 60, 15, 96, 'Last 24 h');
+          showActivity('activityWeek', hours, 3600, 1, 168, 'Last 7 days');
+        });
+    }
+    
+    // One bar per `per` buckets of `seconds`, newest on the right: the
+    // connected share, green when it jiggled, a red tick for disconnects
+    function showActivity(id, columns, seconds, per, bars, title) {
+      const canvas = document.getElementById(id);
+      const ctx = canvas.getContext('2d');
+      const n = columns[0].length;
+      const span = per * seconds;
+      const w = canvas.width / bars, h = canvas.height;
+      let jiggles = 0, connected = 0, drops = 0, worst = 0, sum = 0, readings = 0;
+      ctx.clearRect(0, 0, canvas.width, h);
+      for (let bar = 0; bar < bars; bar++) {
+        let j = 0, c = 0, d = 0;
+        for (let k = 0; k < per; k++) {
+          const i = n - 1 - (bar * per + k);
+          if (i < 0) break;
+          j += columns[0][i];
+          c += columns[1][i];
+          d += columns[2][i];
+          worst = Math.max(worst, columns[3][i]);
+          if (columns[4][i]) sum += columns[4][i], readings++;
+        }
+        jiggles += j, connected += c, drops += d;
+        const x = canvas.width - (bar + 1) * w;
+        const bh = Math.round(Math.min(c / span, 1) * (h - 4));
+        ctx.fillStyle = j ? '#4caf50' : '#9fa8da';
+        ctx.fillRect(x, h - bh, w - 1, bh);
+        if (d) {
+          ctx.fillStyle = '#c62828';
+          ctx.fillRect(x, 0, w - 1, 3);
+        }
+      }
+      document.getElementById(id + 'Text').textContent = title + ': ' + jiggles + ' jiggles, connected ' +
+        Math.floor(connected / 3600) + ' h ' + Math.floor(connected % 3600 / 60) + ' min, ' + drops + ' disconnects' +
+        (readings ? ', RSSI ' + -Math.round(sum / readings) + ' dBm (weakest ' + -worst + ')' : '');
+    }
+    loadActivity();
+    setInterval(loadActivity, 60000);
+    
     function resetDefaults() {
       if (confirm('Reset all settings to defaults?')) {
         fetch('/api/reset', {method: 'POST'})
@@ -273,7 +579,7 @@ private:
   }
   
 public:
-  JigglerWebServer() : server(nullptr), configManager(nullptr), apActive(false) {}
+  JigglerWebServer() : server(nullptr), configManager(nullptr), apActive(false), notifyCallback(nullptr), mirror(nullptr), assets(nullptr), displayLock(nullptr), scheduler(nullptr), power(nullptr), clock(nullptr), lifetime(nullptr), history(nullptr) {}
   ~JigglerWebServer() {
     if (server) {
       delete server;
@@ -284,7 +590,7 @@ public:
     configManager = cm;
     
     // Start WiFi AP
-    JigglerConfig& cfg = configManager->getConfig();
+    JigglerConfig cfg = configManager->getConfig();
     WiFi.mode(WIFI_AP);
     WiFi.softAP(cfg.wifiSSID, cfg.wifiPassword);
     
@@ -309,6 +615,8 @@ public:
     
     WiFiClient client = server->available();
     if (!client) return;
+    PowerGuard awake(power, POWER_HTTP);
+    PROFILE_SCOPE(PROF_HTTP);
     
     Serial.println("New client connected");
     String requestPath = "";
@@ -316,6 +624,7 @@ public:
     String requestBody = "";
     bool isPost = false;
     int contentLength = 0;
+    String webSocketKey = "";
     bool headersEnded = false;
     bool firstLine = true;
     
@@ -328,6 +637,13 @@ public:
             if (currentLine.length() == 0) {
               headersEnded = true;
               
+              // WebSocket upgrade: the mirror keeps the connection open
+              if (mirror && webSocketKey.length() > 0 && requestPath.startsWith("GET /ws ")) {
+                LockGuard lock(displayLock);
+                if (mirror->accept(client, webSocketKey)) return;
+                break;
+              }
+              
               // Read POST body if present
               if (isPost && contentLength > 0) {
                 Serial.print("Reading POST body, Content-Length: ");
@@ -360,6 +676,10 @@ public:
               if (currentLine.startsWith("Content-Length: ")) {
                 contentLength = currentLine.substring(16).toInt();
               }
+              if (currentLine.startsWith("Sec-WebSocket-Key: ")) {
+                webSocketKey = currentLine.substring(19);
+                webSocketKey.trim();
+              }
               currentLine = "";
             }
           } else if (c != '\r') {
@@ -375,7 +695,133 @@ public:
   }
   
 private:
+  // Response bytes per write: one TCP segment, so the stack never has to
+  // split or coalesce what we hand it
+#ifdef CONFIG_LWIP_TCP_MSS
+  static const size_t CHUNK_SIZE = CONFIG_LWIP_TCP_MSS;
+#else
+  static const size_t CHUNK_SIZE = 1436;
+#endif
+  
+  static void putLE16(uint8_t* p, uint16_t v) {
+    p[0] = v;
+    p[1] = v >> 8;
+  }
+  
+  static void putLE32(uint8_t* p, uint32_t v) {
+    putLE16(p, v);
+    putLE16(p + 2, v >> 16);
+  }
+  
+  // Stream the screen as a top-down 16 bit RGB565 BMP. Rows are rebuilt one
+  // at a time from the display list, so only a line buffer and one chunk
+  // are needed, never a copy of the image. The display lock is held only
+  // while a row is read, never while the client takes it, so a slow client
+  // does not hold up the UI; a redraw during the transfer can show up in
+  // the rows after it.
+  void sendScreenshot(WiFiClient& client) {
+    static const uint32_t HEADER_SIZE = 14 + 40 + 12;  // file, info, RGB masks
+    uint16_t line[320 + 1];  // room for the row padding
+    uint16_t width, height;
+    bool available;
+    {
+      LockGuard lock(displayLock);
+      width = Paint.Width;
+      height = Paint.Height;
+      available = width <= 320 && Paint_ReadLine(0, line);
+    }
+    uint32_t stride = ((uint32_t)width * 2 + 3) & ~3UL;
+    
+    if (!available) {
+      client.println("HTTP/1.1 503 Service Unavailable");
+      client.println("Content-type:text/plain");
+      client.println();
+      client.print("Screen not available");
+      return;
+    }
+    
+    uint32_t imageSize = stride * height;
+    client.println("HTTP/1.1 200 OK");
+    client.println("Content-type:image/bmp");
+    client.println("Content-Length: " + String(HEADER_SIZE + imageSize));
+    client.println("Cache-Control: no-store");
+    client.println("Connection: close");
+    client.println();
+    
+    uint8_t chunk[CHUNK_SIZE];
+    memset(chunk, 0, HEADER_SIZE);
+    chunk[0] = 'B';
+    chunk[1] = 'M';
+    putLE32(chunk + 2, HEADER_SIZE + imageSize);
+    putLE32(chunk + 10, HEADER_SIZE);
+    putLE32(chunk + 14, 40);
+    putLE32(chunk + 18, width);
+    putLE32(chunk + 22, (uint32_t)-(int32_t)height);  // negative: top row first
+    putLE16(chunk + 26, 1);
+    putLE16(chunk + 28, 16);
+    putLE32(chunk + 30, 3);  // BI_BITFIELDS
+    putLE32(chunk + 34, imageSize);
+    putLE32(chunk + 38, 2835);  // 72 DPI
+    putLE32(chunk + 42, 2835);
+    putLE32(chunk + 54, 0xF800);
+    putLE32(chunk + 58, 0x07E0);
+    putLE32(chunk + 62, 0x001F);
+    size_t used = HEADER_SIZE;
+    
+    for (uint16_t y = 0; y < height; y++) {
+      if (y > 0) {
+        LockGuard lock(displayLock);
+        Paint_ReadLine(y, line);
+      }
+      
+      // The ESP32 is little endian, so the line buffer is already in BMP
+      // byte order; rows are split across chunks as they come
+      line[width] = 0;
+      const uint8_t* src = (const uint8_t*)line;
+      for (uint32_t left = stride; left > 0; ) {
+        size_t n = min((size_t)left, CHUNK_SIZE - used);
+        memcpy(chunk + used, src, n);
+        used += n;
+        src += n;
+        left -= n;
+        if (used == CHUNK_SIZE) {
+          client.write(chunk, used);
+          used = 0;
+        }
+      }
+    }
+    if (used) client.write(chunk, used);
+  }
+  
+  // Stream the activity history in its export format (ActivityHistory.h).
+  // The length is only known at the end, so the connection closing ends
+  // the body.
+  void sendHistory(WiFiClient& client) {
+    client.println("HTTP/1.1 200 OK");
+    client.println("Content-type:application/octet-stream");
+    client.println("Cache-Control: no-store");
+    client.println("Connection: close");
+    client.println();
+    
+    uint8_t chunk[CHUNK_SIZE];
+    ActivityHistory::Cursor cursor;
+    history->startExport(cursor);
+    for (size_t n; (n = history->exportChunk(cursor, chunk, CHUNK_SIZE)) > 0; ) {
+      client.write(chunk, n);
+    }
+  }
+  
   void handleRequest(WiFiClient& client, String& requestLine, String& body, bool isPost) {
+    // Binary responses send their own status line and headers
+    if (requestLine.indexOf("GET /api/screenshot") >= 0) {
+      sendScreenshot(client);
+      return;
+    }
+    if (requestLine.indexOf("GET /api/history") >= 0 && history) {
+      sendHistory(client);
+      return;
+    }
+    
     // Send headers
     client.println("HTTP/1.1 200 OK");
     
@@ -383,13 +829,91 @@ private:
     if (requestLine.indexOf("GET / ") >= 0) {
       client.println("Content-type:text/html");
       client.println();
-      client.print(getIndexHTML());
+      uint32_t size;
+      const uint8_t* page = hasAssetPage() ? assets->find("web/index.html", &size) : nullptr;
+      if (page) {
+        client.write(page, size);
+      } else {
+        client.print(getIndexHTML());
+      }
+    }
+    else if (requestLine.indexOf("GET /api/timing") >= 0 && scheduler) {
+      client.println("Content-type:application/json");
+      client.println();
+      
+      // Copied unguarded from the BLE task: counts may be one jiggle apart
+      JiggleTiming timing = scheduler->getTiming();
+      String json = "{";
+      json += "\"interval\":" + String(scheduler->getInterval()) + ",";
+      json += "\"jitter\":" + String(scheduler->getJitter()) + ",";
+      json += "\"fired\":" + String(timing.fired) + ",";
+      json += "\"skipped\":" + String(timing.skipped) + ",";
+      json += "\"maxLateUs\":" + String(timing.maxLateUs) + ",";
+      json += "\"meanLateUs\":" + String(timing.fired ? (uint32_t)(timing.totalLateUs / timing.fired) : 0) + ",";
+      json += "\"buckets\":[";
+      for (uint8_t i = 0; i < JiggleTiming::BUCKETS; i++) {
+        json += String(i ? "," : "") + String(timing.buckets[i]);
+      }
+      json += "]}";
+      client.print(json);
+    }
+    else if (requestLine.indexOf("GET /api/power") >= 0 && power) {
+      client.println("Content-type:application/json");
+      client.println();
+      
+      int64_t now = PowerManager::now();
+      uint32_t awake = power->awakePermille(now);
+      String json = "{";
+      json += "\"lightSleep\":" + String(power->isSleepEnabled() ? "true" : "false") + ",";
+      json += "\"awakePercent\":" + String(awake / 10) + "." + String(awake % 10) + ",";
+      json += "\"wakeupsPerHour\":" + String(power->wakeupsPerHour(now)) + ",";
+      json += "\"seconds\":" + String(power->statsSeconds(now));
+      json += "}";
+      client.print(json);
+    }
+#ifdef PROFILE_SCOPES
+    else if (requestLine.indexOf("GET /api/stats") >= 0) {
+      client.println("Content-type:application/json");
+      client.println();
+      
+      ProfileStats stats[PROF_COUNT];
+      int64_t since = Profiler::instance().copy(stats);
+      String json = "{";
+      json += "\"seconds\":" + String((uint32_t)((Profiler::now() - since) / 1000000)) + ",";
+      json += "\"scopes\":[";
+      for (uint8_t i = 0; i < PROF_COUNT; i++) {
+        json += String(i ? "," : "") + "{\"name\":\"" + Profiler::name(i) + "\",";
+        json += "\"calls\":" + String(stats[i].calls) + ",";
+        json += "\"totalUs\":" + String((double)stats[i].totalUs, 0) + ",";
+        json += "\"maxUs\":" + String(stats[i].maxUs) + ",";
+        json += "\"buckets\":[";
+        for (uint8_t b = 0; b < ProfileStats::BUCKETS; b++) {
+          json += String(b ? "," : "") + String(stats[i].buckets[b]);
+        }
+        json += "]}";
+      }
+      json += "]}";
+      client.print(json);
+    }
+#endif
+    else if (requestLine.indexOf("GET /api/lifetime") >= 0 && lifetime) {
+      client.println("Content-type:application/json");
+      client.println();
+      
+      LifetimeCounters counters = lifetime->get(PowerManager::now());
+      String json = "{";
+      json += "\"jiggles\":" + String(counters.jiggles) + ",";
+      json += "\"connectedSeconds\":" + String(counters.connectedSeconds) + ",";
+      json += "\"connections\":" + String(counters.connections) + ",";
+      json += "\"reboots\":" + String(counters.reboots);
+      json += "}";
+      client.print(json);
     }
     else if (requestLine.indexOf("GET /api/config") >= 0) {
       client.println("Content-type:application/json");
       client.println();
       
-      JigglerConfig& cfg = configManager->getConfig();
+      JigglerConfig cfg = configManager->getConfig();
       Serial.println("Sending config:");
       Serial.print("  Interval: ");
       Serial.println(cfg.jiggleInterval);
@@ -400,16 +924,127 @@ private:
       
       String json = "{";
       json += "\"interval\":" + String(cfg.jiggleInterval) + ",";
+      json += "\"jitter\":" + String(cfg.jiggleJitter) + ",";
       json += "\"distance\":" + String(cfg.moveDistance) + ",";
       json += "\"random\":" + String(cfg.randomMoves ? "true" : "false") + ",";
       json += "\"randMin\":" + String(cfg.randomMinDistance) + ",";
       json += "\"randMax\":" + String(cfg.randomMaxDistance) + ",";
+      json += "\"curved\":" + String(cfg.curvedMoves ? "true" : "false") + ",";
+      json += "\"curveMs\":" + String(cfg.curveDuration) + ",";
+      json += "\"curveAmp\":" + String(cfg.curveAmplitude) + ",";
+      json += "\"bigDigits\":" + String(cfg.bigCountdown ? "true" : "false") + ",";
       json += "\"deviceName\":\"" + String(cfg.deviceName) + "\",";
       json += "\"wifiSSID\":\"" + String(cfg.wifiSSID) + "\",";
       json += "\"wifiPassword\":\"" + String(cfg.wifiPassword) + "\"";
       json += "}";
       client.print(json);
     }
+    else if (requestLine.indexOf("GET /api/pattern") >= 0) {
+      client.println("Content-type:application/json");
+      client.println();
+      
+      JigglerConfig cfg = configManager->getConfig();
+      MotionPattern::Info info = {0, 0};
+      MotionPattern::check(cfg.pattern, cfg.patternLength, &info);
+      static char source[MotionPattern::MAX_SOURCE];  // one request at a time
+      MotionPattern::decompile(cfg.pattern, cfg.patternLength, source, sizeof(source));
+      
+      String json = "{";
+      json += "\"enabled\":" + String(cfg.customPattern ? "true" : "false") + ",";
+      json += "\"bytes\":" + String(cfg.patternLength) + ",";
+      json += "\"duration\":" + String(info.duration) + ",";
+      json += "\"source\":\"";
+      for (const char* p = source; *p; p++) {
+        if (*p == '\n') json += "\\n";
+        else json += *p;
+      }
+      json += "\"}";
+      client.print(json);
+    }
+    else if (requestLine.indexOf("POST /api/pattern") >= 0 && isPost) {
+      client.println("Content-type:application/json");
+      client.println();
+      
+      // Source text is the body; compiled here, only the bytecode is kept
+      JigglerConfig newConfig = configManager->getConfig();
+      newConfig.customPattern = requestLine.indexOf("enabled=1") >= 0;
+      MotionPattern::Result result = MotionPattern::compile(body.c_str(), newConfig.pattern, sizeof(newConfig.pattern));
+      bool empty = result.length == 0 && result.line == 0;
+      if (!result.ok && !(empty && !newConfig.customPattern)) {
+        client.print("{\"success\":false,\"line\":" + String(result.line) + ",\"error\":\"" + String(result.error) + "\"}");
+        client.println();
+        return;
+      }
+      newConfig.patternLength = result.length;
+      
+      configManager->setConfig(newConfig);
+      if (notifyCallback) notifyCallback("Pattern saved");
+      client.print("{\"success\":true,\"bytes\":" + String(result.length) +
+                   ",\"duration\":" + String(result.info.duration) + "}");
+      Serial.print("Pattern saved, bytes: ");
+      Serial.println(result.length);
+    }
+    else if (requestLine.indexOf("POST /api/time") >= 0 && isPost && clock) {
+      client.println("Content-type:application/json");
+      client.println();
+      
+      // Seconds since 1970 UTC and the browser's offset east of UTC
+      int epochPos = requestLine.indexOf("epoch=");
+      int offsetPos = requestLine.indexOf("offset=");
+      if (epochPos < 0 || offsetPos < 0) {
+        client.print("{\"success\":false}");
+      } else {
+        int64_t epoch = atoll(requestLine.c_str() + epochPos + 6);
+        clock->setTime(epoch, requestLine.substring(offsetPos + 7).toInt(), PowerManager::now());
+        client.print("{\"success\":true}");
+      }
+    }
+    else if (requestLine.indexOf("GET /api/schedule") >= 0) {
+      client.println("Content-type:application/json");
+      client.println();
+      
+      JigglerConfig cfg = configManager->getConfig();
+      static char rules[2048];  // one request at a time; only a very ragged week is cut short
+      WeekSchedule::decompile(cfg.schedule, rules, sizeof(rules));
+      bool clockSet = clock && clock->isSet();
+      bool open = !cfg.scheduleEnabled || !clock || WeekSchedule::isOpenAt(cfg.schedule, *clock, PowerManager::now());
+      
+      String json = "{";
+      json += "\"enabled\":" + String(cfg.scheduleEnabled ? "true" : "false") + ",";
+      json += "\"hours\":" + String(WeekSchedule::openSlots(cfg.schedule) / 4.0f, 2) + ",";
+      json += "\"clockSet\":" + String(clockSet ? "true" : "false") + ",";
+      json += "\"open\":" + String(open ? "true" : "false") + ",";
+      json += "\"rules\":\"";
+      for (const char* p = rules; *p; p++) {
+        if (*p == '\n') json += "\\n";
+        else json += *p;
+      }
+      json += "\"}";
+      client.print(json);
+    }
+    else if (requestLine.indexOf("POST /api/schedule") >= 0 && isPost) {
+      client.println("Content-type:application/json");
+      client.println();
+      
+      // Rules are the body; only the compiled week is kept
+      JigglerConfig newConfig = configManager->getConfig();
+      newConfig.scheduleEnabled = requestLine.indexOf("enabled=1") >= 0;
+      WeekSchedule::Result result = WeekSchedule::compile(body.c_str(), newConfig.schedule);
+      if (!result.ok) {
+        client.print("{\"success\":false,\"line\":" + String(result.line) + ",\"error\":\"" + String(result.error) + "\"}");
+        client.println();
+        return;
+      }
+      
+      configManager->setConfig(newConfig);
+      if (notifyCallback) notifyCallback("Schedule saved");
+      bool open = !newConfig.scheduleEnabled || !clock || WeekSchedule::isOpenAt(newConfig.schedule, *clock, PowerManager::now());
+      client.print("{\"success\":true,\"enabled\":" + String(newConfig.scheduleEnabled ? "true" : "false") +
+                   ",\"hours\":" + String(WeekSchedule::openSlots(newConfig.schedule) / 4.0f, 2) +
+                   ",\"open\":" + String(open ? "true" : "false") + "}");
+      Serial.print("Schedule saved, open quarter hours: ");
+      Serial.println(WeekSchedule::openSlots(newConfig.schedule));
+    }
     else if (requestLine.indexOf("POST /api/config") >= 0 && isPost) {
       client.println("Content-type:application/json");
       client.println();
@@ -421,6 +1056,9 @@ private:
       if ((pos = body.indexOf("\"interval\":")) >= 0) {
         newConfig.jiggleInterval = body.substring(pos + 11).toInt();
       }
+      if ((pos = body.indexOf("\"jitter\":")) >= 0) {
+        newConfig.jiggleJitter = body.substring(pos + 9).toInt();
+      }
       if ((pos = body.indexOf("\"distance\":")) >= 0) {
         newConfig.moveDistance = body.substring(pos + 11).toInt();
       }
@@ -435,6 +1073,22 @@ private:
       if ((pos = body.indexOf("\"randMax\":")) >= 0) {
         newConfig.randomMaxDistance = body.substring(pos + 10).toInt();
       }
+      if ((pos = body.indexOf("\"curved\":true")) >= 0) {
+        newConfig.curvedMoves = true;
+      } else if ((pos = body.indexOf("\"curved\":false")) >= 0) {
+        newConfig.curvedMoves = false;
+      }
+      if ((pos = body.indexOf("\"curveMs\":")) >= 0) {
+        newConfig.curveDuration = body.substring(pos + 10).toInt();
+      }
+      if ((pos = body.indexOf("\"curveAmp\":")) >= 0) {
+        newConfig.curveAmplitude = body.substring(pos + 11).toInt();
+      }
+      if ((pos = body.indexOf("\"bigDigits\":true")) >= 0) {
+        newConfig.bigCountdown = true;
+      } else if ((pos = body.indexOf("\"bigDigits\":false")) >= 0) {
+        newConfig.bigCountdown = false;
+      }
       if ((pos = body.indexOf("\"deviceName\":\"")) >= 0) {
         int endPos = body.indexOf("\"", pos + 14);
         body.substring(pos + 14, endPos).toCharArray(newConfig.deviceName, sizeof(newConfig.deviceName));
@@ -449,6 +1103,7 @@ private:
       }
       
       configManager->setConfig(newConfig);
+      if (notifyCallback) notifyCallback("Saved");
       
       client.print("{\"success\":true,\"message\":\"Rebooting...\"}");
       Serial.println("Configuration updated via web interface");
@@ -456,6 +1111,7 @@ private:
       
       delay(100);  // Give time for response to send
       client.stop();
+      if (lifetime) lifetime->flush(PowerManager::now());  // counts since the last commit
       delay(2000);  // Wait 2 seconds
       ESP.restart();  // Reboot device
     }
@@ -464,6 +1120,7 @@ private:
       client.println();
       
       configManager->resetToDefaults();
+      if (notifyCallback) notifyCallback("Defaults restored");
       client.print("{\"success\":true}");
       Serial.println("Configuration reset to defaults");
     }
@@ -482,6 +1139,57 @@ public:
     return apActive;
   }
   
+  // Called with a short message after settings are saved or reset
+  void onNotify(void (*callback)(const char* message)) {
+    notifyCallback = callback;
+  }
+  
+  // Live screen for the page; the mirror still needs tick() from loop()
+  void setMirror(DisplayMirror* m) {
+    mirror = m;
+  }
+  
+  // Serve the settings page from the asset archive instead of the built-in
+  // copy, when it was packed for this firmware's PAGE_VERSION
+  void setAssets(const AssetStore* a) {
+    assets = a;
+  }
+  
+  bool hasAssetPage() const {
+    return assets && assets->getPageVersion() == PAGE_VERSION && assets->entry("web/index.html");
+  }
+  
+  // Jiggle timing for /api/timing; the route is off without one
+  void setScheduler(const JiggleScheduler* s) {
+    scheduler = s;
+  }
+  
+  // Held awake while a request is served; also serves /api/power
+  void setPower(PowerManager* p) {
+    power = p;
+  }
+  
+  // Lifetime counters for /api/lifetime, saved before the restart after a
+  // settings change
+  void setLifetime(LifetimeStats* l) {
+    lifetime = l;
+  }
+  
+  // Per-minute and per-hour activity for /api/history and the page's charts
+  void setHistory(ActivityHistory* h) {
+    history = h;
+  }
+  
+  // Local time for the schedule, set by the page; /api/time is off without one
+  void setClock(WallClock* c) {
+    clock = c;
+  }
+  
+  // Lock of the task that draws; without one the screen is read unguarded
+  void setDisplayLock(Mutex* lock) {
+    displayLock = lock;
+  }
+  
   String getIPAddress() {
     return WiFi.softAPIP().toString();
   }
@@ -0,0 +1,288 @@
+#ifndef WEEK_SCHEDULE_H
+#define WEEK_SCHEDULE_H
+
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include "Tasks.h"
+
+// Local time from the browser: the config page sends its clock when it
+// loads, and the device counts on from there (it has no RTC). Until then
+// the time is unknown.
+class WallClock {
+private:
+  Mutex mutex;
+  bool set = false;
+  int64_t localAtZero = 0;  // local time in us since 1970 when uptime was 0
+
+public:
+  void begin() { mutex.begin(); }
+
+  // epochSeconds: UTC; utcOffsetMinutes: east of Greenwich, e.g. 60 for CET
+  void setTime(int64_t epochSeconds, int16_t utcOffsetMinutes, int64_t nowUs) {
+    LockGuard guard(&mutex);
+    localAtZero = (epochSeconds + utcOffsetMinutes * 60LL) * 1000000 - nowUs;
+    set = true;
+  }
+
+  bool isSet() {
+    LockGuard guard(&mutex);
+    return set;
+  }
+
+  // Local time at nowUs in us since 1970; false while it is unknown
+  bool localUs(int64_t nowUs, int64_t& us) {
+    LockGuard guard(&mutex);
+    if (!set) return false;
+    us = localAtZero + nowUs;
+    return true;
+  }
+
+  // Day of the week (0 Monday .. 6 Sunday) and minute of the day; false
+  // while the time is unknown
+  bool local(int64_t nowUs, uint8_t& day, uint16_t& minute) {
+    int64_t us;
+    if (!localUs(nowUs, us)) return false;
+    int64_t seconds = us / 1000000;
+    if (seconds < 0) return false;
+    int64_t days = seconds / 86400;
+    day = (days + 3) % 7;  // 1 Jan 1970 was a Thursday
+    minute = seconds % 86400 / 60;
+    return true;
+  }
+};
+
+// When jiggling is allowed, as one bit per quarter hour of the week (7 x 96
+// bits, 84 bytes), compiled from rules such as
+//
+//   Mon-Fri 08:30-18:00
+//   except Mon-Fri 12:00-13:00   # lunch
+//
+// One rule per line (or ';'): days, then a start-end time on the quarter
+// hour. Days are Mon..Sun, a range such as Mon-Fri, a list such as
+// Mon,Wed,Fri-Sun, or "daily". A window ending before it starts runs past
+// midnight into the next day; "24:00" is the end of the day. Rules apply in
+// order, "except" takes time out again. '#' starts a comment.
+class WeekSchedule {
+public:
+  static const uint8_t SLOTS_PER_DAY = 96;
+  static const uint16_t SLOTS = 7 * SLOTS_PER_DAY;
+  static const uint8_t BYTES = SLOTS / 8;
+
+  struct Result {
+    bool ok;
+    uint16_t line;  // of the error, 0 if it is about all the rules
+    const char* error;
+  };
+
+  // The hot-path check: one bit
+  static bool isOpen(const uint8_t* bits, uint8_t day, uint16_t minute) {
+    uint16_t slot = day * SLOTS_PER_DAY + minute / 15;
+    return (bits[slot >> 3] >> (slot & 7)) & 1;
+  }
+
+  // Whether the clock's local time at nowUs is open; open while the time
+  // is unknown, so a device that was never given the time still jiggles
+  static bool isOpenAt(const uint8_t* bits, WallClock& clock, int64_t nowUs) {
+    uint8_t day;
+    uint16_t minute;
+    return !clock.local(nowUs, day, minute) || isOpen(bits, day, minute);
+  }
+
+  // Open quarter hours in the week
+  static uint16_t openSlots(const uint8_t* bits) {
+    uint16_t n = 0;
+    for (uint8_t i = 0; i < BYTES; i++) {
+      for (uint8_t b = bits[i]; b; b &= b - 1) n++;
+    }
+    return n;
+  }
+
+private:
+  static const char* const* dayNames() {
+    static const char* const names[7] = {"Mon", "Tue", "Wed", "Thu", "Fri", "Sat", "Sun"};
+    return names;
+  }
+
+  static void setSlot(uint8_t* bits, uint16_t slot, bool open) {
+    if (open) {
+      bits[slot >> 3] |= 1 << (slot & 7);
+    } else {
+      bits[slot >> 3] &= ~(1 << (slot & 7));
+    }
+  }
+
+  static bool dayAt(const char*& p, uint8_t& day) {
+    for (uint8_t d = 0; d < 7; d++) {
+      if (strncmp(p, dayNames()[d], 3) == 0) {
+        day = d;
+        p += 3;
+        return true;
+      }
+    }
+    return false;
+  }
+
+  // Quarter hour of "H:MM" or "HH:MM", 0..96
+  static const char* timeAt(const char*& p, uint8_t& slot) {
+    int hours = 0, minutes = 0, digits = 0;
+    while (*p >= '0' && *p <= '9' && digits < 2) hours = hours * 10 + (*p++ - '0'), digits++;
+    if (digits == 0 || *p++ != ':') return "bad time";
+    for (digits = 0; *p >= '0' && *p <= '9' && digits < 2; digits++) minutes = minutes * 10 + (*p++ - '0');
+    if (digits != 2 || minutes > 59 || hours > 24 || (hours == 24 && minutes)) return "bad time";
+    if (minutes % 15) return "times must be on the quarter hour";
+    slot = hours * 4 + minutes / 15;
+    return nullptr;
+  }
+
+  // One rule from p up to end
+  static const char* rule(const char* p, const char* end, uint8_t* bits) {
+    while (p < end && (*p == ' ' || *p == '\t')) p++;
+    bool open = true;
+    if (end - p > 7 && strncmp(p, "except ", 7) == 0) {
+      open = false;
+      p += 7;
+      while (p < end && *p == ' ') p++;
+    }
+
+    uint8_t days = 0;  // bit per day
+    if (end - p >= 5 && strncmp(p, "daily", 5) == 0) {
+      days = 0x7F;
+      p += 5;
+    } else {
+      for (;;) {
+        uint8_t first, last;
+        if (!dayAt(p, first)) return "unknown day";
+        last = first;
+        if (*p == '-' && !(p[1] >= '0' && p[1] <= '9')) {
+          p++;
+          if (!dayAt(p, last)) return "unknown day";
+        }
+        for (uint8_t d = first;; d = (d + 1) % 7) {
+          days |= 1 << d;
+          if (d == last) break;
+        }
+        if (*p != ',') break;
+        p++;
+      }
+    }
+    if (p >= end || *p != ' ') return "expected a time like 08:30-18:00";
+    while (p < end && *p == ' ') p++;
+
+    uint8_t start, stop;
+    const char* error;
+    if ((error = timeAt(p, start))) return error;
+    if (*p++ != '-') return "expected a time like 08:30-18:00";
+    if ((error = timeAt(p, stop))) return error;
+    while (p < end && (*p == ' ' || *p == '\t' || *p == '\r')) p++;
+    if (p != end) return "unexpected text after the time";
+    if (start == stop) return "window is empty";
+    if (start == SLOTS_PER_DAY) return "window starts at 24:00";
+
+    for (uint8_t d = 0; d < 7; d++) {
+      if (!(days & (1 << d))) continue;
+      // Past midnight: the end is on the next day
+      uint16_t from = d * SLOTS_PER_DAY + start;
+      uint16_t to = d * SLOTS_PER_DAY + stop + (stop < start ? SLOTS_PER_DAY : 0);
+      for (uint16_t s = from; s < to; s++) setSlot(bits, s % SLOTS, open);
+    }
+    return nullptr;
+  }
+
+public:
+  // Compile rules into bits (BYTES). An error leaves bits undefined.
+  static Result compile(const char* rules, uint8_t* bits) {
+    Result result = {false, 0, nullptr};
+    memset(bits, 0, BYTES);
+    uint16_t line = 1;
+    bool any = false;
+
+    for (const char* p = rules; *p;) {
+      const char* end = p;
+      while (*end && *end != '\n' && *end != ';' && *end != '#') end++;
+      const char* next = end;
+      if (*next == '#') {
+        while (*next && *next != '\n') next++;
+      }
+      const char* last = end;
+      while (last > p && (last[-1] == ' ' || last[-1] == '\t' || last[-1] == '\r')) last--;
+      const char* first = p;
+      while (first < last && (*first == ' ' || *first == '\t')) first++;
+
+      if (first < last) {
+        const char* error = rule(first, last, bits);
+        if (error) {
+          result.line = line;
+          result.error = error;
+          return result;
+        }
+        any = true;
+      }
+      if (*next == '\n') line++;
+      p = *next ? next + 1 : next;
+    }
+
+    if (!any) {
+      result.error = "no rules";
+    } else if (openSlots(bits) == 0) {
+      result.error = "the rules leave no time to jiggle";
+    } else {
+      result.ok = true;
+    }
+    return result;
+  }
+
+  // Rules that give back bits, one line per window: days with the same
+  // windows share their lines. Returns the characters written (the text
+  // is cut at size).
+  static size_t decompile(const uint8_t* bits, char* out, size_t size) {
+    size_t used = 0;
+    uint8_t done = 0;  // days already written
+    if (size) out[0] = '\0';
+
+    for (uint8_t d = 0; d < 7; d++) {
+      if (done & (1 << d)) continue;
+      uint8_t same = 0;
+      for (uint8_t e = d; e < 7; e++) {
+        bool equal = true;
+        for (uint8_t s = 0; s < SLOTS_PER_DAY && equal; s++) {
+          equal = isOpen(bits, d, s * 15) == isOpen(bits, e, s * 15);
+        }
+        if (equal) same |= 1 << e;
+      }
+      done |= same;
+
+      char days[40];
+      size_t n = 0;
+      if (same == 0x7F) {
+        n = snprintf(days, sizeof(days), "daily");
+      } else {
+        for (uint8_t e = 0; e < 7; e++) {
+          if (!(same & (1 << e))) continue;
+          uint8_t f = e;
+          while (f + 1 < 7 && (same & (1 << (f + 1)))) f++;
+          n += snprintf(days + n, sizeof(days) - n, "%s%s", n ? "," : "", dayNames()[e]);
+          if (f > e) n += snprintf(days + n, sizeof(days) - n, "-%s", dayNames()[f]);
+          e = f;
+        }
+      }
+
+      for (uint8_t s = 0; s < SLOTS_PER_DAY; s++) {
+        if (!isOpen(bits, d, s * 15)) continue;
+        uint8_t t = s;
+        while (t < SLOTS_PER_DAY && isOpen(bits, d, t * 15)) t++;
+        int written = snprintf(out + used, size > used ? size - used : 0, "%s %02u:%02u-%02u:%02u\n", days,
+                               s / 4, s % 4 * 15, t / 4, t % 4 * 15);
+        if (written < 0 || used + written >= size) {
+          if (size) out[used] = '\0';
+          return used;
+        }
+        used += written;
+        s = t;
+      }
+    }
+    return used;
+  }
+};
+
+#endif
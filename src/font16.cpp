@@ -37,6 +37,9 @@
 
 /* Includes ------------------------------------------------------------------*/
 #include "fonts.h"
+
+// Compiled out when font_subset.cpp provides a packed copy (FONT_SUBSET)
+#ifndef FONT_SUBSET
 // 
 //  Font data for Courier New 12pt
 // 
@@ -1760,4 +1763,6 @@ sFONT Font16 = {
   16, /* Height */
 };
 
+#endif /* FONT_SUBSET */
+
 /************************ (C) COPYRIGHT STMicroelectronics *****END OF FILE****/
@@ -38,6 +38,9 @@
 /* Includes ------------------------------------------------------------------*/
 #include "fonts.h"
 
+// Compiled out when font_subset.cpp provides a packed copy (FONT_SUBSET)
+#ifndef FONT_SUBSET
+
 // Character bitmaps for Courier New 15pt
 const uint8_t Font20_Table[] PROGMEM = 
 {
@@ -2139,4 +2142,6 @@ sFONT Font20 = {
   20, /* Height */
 };
 
+#endif /* FONT_SUBSET */
+
 /************************ (C) COPYRIGHT STMicroelectronics *****END OF FILE****/
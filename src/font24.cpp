@@ -38,6 +38,9 @@
 /* Includes ------------------------------------------------------------------*/
 #include "fonts.h"
 
+// Compiled out when font_subset.cpp provides a packed copy (FONT_SUBSET)
+#ifndef FONT_SUBSET
+
 const uint8_t Font24_Table [] PROGMEM = 
 {
   // @0 ' ' (17 pixels wide)
@@ -2517,4 +2520,6 @@ sFONT Font24 = {
   24, /* Height */
 };
 
+#endif /* FONT_SUBSET */
+
 /************************ (C) COPYRIGHT STMicroelectronics *****END OF FILE****/
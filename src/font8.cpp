@@ -38,6 +38,9 @@
 /* Includes ------------------------------------------------------------------*/
 #include "fonts.h"
 
+// Compiled out when font_subset.cpp provides a packed copy (FONT_SUBSET)
+#ifndef FONT_SUBSET
+
 // 
 //  Font data for Courier New 12pt
 // 
@@ -1001,4 +1004,6 @@ sFONT Font8 = {
   8, /* Height */
 };
 
+#endif /* FONT_SUBSET */
+
 /************************ (C) COPYRIGHT STMicroelectronics *****END OF FILE****/
@@ -58,7 +58,8 @@ typedef struct _tFont
   const uint8_t *table;
   uint16_t Width;
   uint16_t Height;
-  
+  const uint8_t *Remap;   // glyph index for each of ' '..'~', NULL: all 95 in order
+  uint8_t Packed;         // rows packed back to back, no padding bits per row
 } sFONT;
 
 
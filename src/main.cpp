@@ -12,21 +12,127 @@
 #include <Arduino.h>
 #include <SPI.h>
 #include <BleMouse.h>
+#include <esp_timer.h>
+#include <BLEDevice.h>
 #include "LCD_Driver.h"
 #include "GUI_Paint.h"
 #include "Config.h"
 #include "WebServer.h"
+#include "ProgressAnimator.h"
+#include "QRCode.h"
+#include "DisplayMirror.h"
+#include "RenderBench.h"
+#include "ScreenCheck.h"
+#include "PixelCheck.h"
+#include "AssetStore.h"
+#include "Tasks.h"
+#include "MotionExecutor.h"
+#include "MotionPattern.h"
+#include "MotionCurve.h"
+#include "JiggleScheduler.h"
+#include "PowerManager.h"
+#include "WeekSchedule.h"
+#include "BootTrace.h"
+#include "Profiler.h"
+#include "LifetimeStats.h"
+#include "ActivityHistory.h"
 
 // Configuration manager
 ConfigManager configManager;
 JigglerWebServer webServer;
 
+// Live screen copy for the config page
+DisplayMirror displayMirror;
+
+// Fonts, images and the settings page from the "assets" flash partition
+AssetStore assets;
+
 // BLE Mouse instance - will be reinitialized with config
 BleMouse* bleMouse = nullptr;
 
-// Runtime variables
-unsigned long lastJiggleTime = 0;
+// Runtime variables, as the UI task last heard from the BLE task
+unsigned long nextJiggleAt = 0;  // millis() of the next jiggle
 bool isJiggling = false;
+bool isMoving = false;  // a jiggle pattern is playing
+bool isPaused = false;  // connected, but outside the schedule's windows
+
+// Plays jiggle patterns on the BLE task, one report per deadline
+MotionExecutor motion;
+
+// Jiggle deadlines and how late they fired; run by the BLE task, which the
+// timer wakes at each deadline
+JiggleScheduler scheduler;
+DeadlineTimer jiggleTimer;
+
+// Clock scaling and light sleep while no task has work (see PowerManager.h)
+PowerManager power;
+
+// Local time for the weekly schedule, set by the config page
+WallClock wallClock;
+
+// Boot phases, printed once boot is done and on the "boot" command
+BootTrace bootTrace;
+
+// Jiggles, connected time, connections and reboots over the device's life
+LifetimeStats lifetime;
+
+// Per-minute and per-hour activity for the page's charts (/api/history)
+ActivityHistory history;
+
+// The connected host, for RSSI reads; BleMouse does not expose it, so it
+// comes from the GATTS connect event
+esp_bd_addr_t peerAddress;
+volatile bool peerKnown = false;
+
+// Tasks (see startTasks()): the BLE task owns the mouse, the UI task owns the
+// screen state and draws it, the HTTP task serves the web page and the
+// serial console. They only share what is below.
+enum UiEventType : uint8_t {
+  UI_CONNECTED,     // time: next jiggle
+  UI_DISCONNECTED,
+  UI_JIGGLE_START,  // a pattern started playing; time: next jiggle
+  UI_JIGGLE_DONE,   // value: jiggles so far, time: next jiggle
+  UI_PAUSED,        // the schedule closed
+  UI_RESUMED,       // the schedule opened; time: next jiggle
+  UI_TOAST,         // show text for value ms
+  UI_COMMAND,       // serial console command, value: SerialCommand
+  UI_WIFI_READY,    // the AP is up: time for the setup screen
+};
+
+enum SerialCommand : uint8_t {
+  CMD_BENCH,
+  CMD_CHECK,
+  CMD_GOLDEN,
+};
+
+struct UiEvent {
+  UiEventType type;
+  uint32_t value;
+  unsigned long time;
+  const char* text;  // static string
+};
+
+// Deep enough to hold the jiggles of a benchmark run; senders never wait
+MessageQueue<UiEvent, 16> uiEvents;
+
+// Wakes the BLE task when the settings change or a jiggle is due
+EventFlags bleEvents;
+const uint32_t BLE_CONFIG_CHANGED = 1 << 0;
+const uint32_t BLE_JIGGLE_DUE = 1 << 1;
+
+// Held by whoever touches Paint: the UI task, and the HTTP task while it
+// reads the screen back for /api/screenshot and the live mirror
+Mutex displayLock;
+
+const unsigned long BLE_POLL_MS = 250;   // connection check; BleMouse has no connect callback
+const unsigned long HTTP_POLL_MS = 20;   // WiFiServer and USB serial cannot be waited on
+const unsigned long RSSI_READ_MS = 10000;  // signal strength samples for the history
+const unsigned long BOOT_REPORT_MS = 5000;  // boot timeline printed by then, even with a phase missing
+
+// The BLE task commits to NVS (the lifetime counters, and the settings on a
+// restart) and holds a copy of the settings; both need more than 4 KB
+const uint32_t BLE_STACK_BYTES = 8192;
+volatile uint32_t bleStackUnused = 0;  // BLE stack never used so far, for `timing`; 0 off the device
 
 // LCD available flag
 bool lcdAvailable = true;
@@ -34,12 +140,18 @@ bool lcdAvailable = true;
 // WiFi status
 bool wifiDisplayed = false;
 
+// Setup screen QR codes (join the AP, open the settings page), encoded once
+// at boot; changing the settings reboots the device
+QRCode wifiQR;
+QRCode urlQR;
+const unsigned long WIFI_INFO_TIME = 15000;  // setup screen stays up this long without a host
+unsigned long wifiInfoShownAt = 0;
+
 // Status states
 enum DisplayState {
   STATE_INITIALIZING,
   STATE_WAITING,
   STATE_CONNECTED,
-  STATE_JIGGLING,
   STATE_WIFI_INFO
 };
 
@@ -49,11 +161,47 @@ unsigned long jiggleCount = 0;
 unsigned long lastDrawnJiggleCount = 0;
 unsigned long nextJiggleIn = 0;
 unsigned long lastDrawnNextJiggleIn = 0;
-int lastDrawnProgress = -1;  // Track last drawn progress percentage
+
+// Progress bar interior (inside the 1 px border) and its tween animation
+const int BAR_X = 14;
+const int BAR_Y = 109;
+const int BAR_WIDTH = LCD_HEIGHT - 29;  // Use LCD_HEIGHT for rotated width
+const int BAR_HEIGHT = 13;
+ProgressAnimator progressBar(BAR_X, BAR_Y, BAR_WIDTH, BAR_HEIGHT, 0x0010);
+
+// Header bar: light to deep blue, dithered
+const PAINT_GRADIENT headerGradient = {GRADIENT_VERTICAL, 2, 0, 24, {0x04DF, 0x000C, 0}};
+
+// Per-frame timing on serial; off while bench/check print their results
+bool logFrames = true;
+
+// Jiggle interval the countdown and bar are drawn for, when not the saved
+// one (0); runScreenCheck() draws with the default
+unsigned long intervalOverride = 0;
+
+// Toast overlay: shown over whatever screen is up, removed on its own
+unsigned long toastUntil = 0;
+
+// Numeric fields on the connected screen; only changed digits are redrawn
+PAINT_NUMFIELD jiggleCountField;
+PAINT_NUMFIELD countdownField;
+
+// Optional large countdown: seven-segment glyphs cached once at boot
+PAINT_DIGITS countdownDigits;
+bool bigCountdown = false;
 
 // Function declarations
-void performJiggle();
-void performRandomJiggle();
+void onGapEvent(esp_gap_ble_cb_event_t event, esp_ble_gap_cb_param_t* param);
+void onGattsEvent(esp_gatts_cb_event_t event, esp_gatt_if_t gattsIf, esp_ble_gatts_cb_param_t* param);
+void startDisplay();
+void startTasks();
+void bleTask(void* arg);
+void uiTask(void* arg);
+void httpTask(void* arg);
+void handleUiEvent(const UiEvent& event);
+void updateScreen(unsigned long now);
+void startJiggle(const JigglerConfig& config);
+void drawStatusValue(bool moving, bool paused);
 void updateDisplay(bool forceFullRedraw = false);
 void drawHeader();
 void drawConnectionStatus(bool connected);
@@ -62,202 +210,522 @@ void drawProgressBar(int percentage);
 void drawStatusIcon(bool connected);
 void drawWiFiIcon();
 void updateCountdownOnly();
+void showSplash();
 void showWiFiInfo();
+void encodeSetupCodes();
+void showToast(const char* message, unsigned long durationMs);
+void handleSerial();
+void printTiming();
+void printPower();
+void printBoot();
+void printStats();
+void printLifetime();
+void runBenchmarks();
+bool runScreenCheck(bool generate);
+void updateToast(unsigned long now);
 
 void setup() {
+  bootTrace.begin();
+  bootTrace.mark("setup", esp_timer_get_time());
   Serial.begin(115200);
-  delay(1000);
   Serial.println("Starting BLE Mouse Jiggler...");
   
   // Load configuration
+  uint8_t phase = bootTrace.start("nvs", esp_timer_get_time());
   configManager.begin();
-  JigglerConfig& config = configManager.getConfig();
+  JigglerConfig config = configManager.getConfig();
+  lifetime.begin(esp_timer_get_time());
+  history.begin(esp_timer_get_time());
+  bootTrace.end(phase, esp_timer_get_time());
   Serial.println("Configuration loaded");
   
-  // Initialize LCD
-  Config_Init();
-  Serial.println("Config initialized");
+  // BLE first: a host is waiting for its advertising, and the stack starts
+  // on a task of its own while the rest of the boot goes on
+  Serial.println("Starting BLE...");
+  BLEDevice::setCustomGapHandler(onGapEvent);
+  BLEDevice::setCustomGattsHandler(onGattsEvent);
+  phase = bootTrace.start("ble_begin", esp_timer_get_time());
+  bleMouse = new BleMouse(config.deviceName, "ESP32-S3-GEEK", 100);
+  bleMouse->begin();
+  bootTrace.end(phase, esp_timer_get_time());
   
-  LCD_Init();
-  Serial.println("LCD initialized");
+  // Assets partition (tools/pack_assets.py); the linked-in copies stay as
+  // the fallback when it has not been flashed
+  if (assets.begin()) {
+    sFONT* fonts[] = {&Font8, &Font16, &Font20, &Font24};
+    uint8_t mapped = 0;
+    for (sFONT* font : fonts) mapped += assets.useFont(font);
+    Serial.printf("Assets v%lu mapped (%u entries, %lu bytes)%s\n", (unsigned long)assets.getVersion(),
+                  assets.getCount(), (unsigned long)assets.getSize(), mapped == 4 ? "" : ", some fonts built-in");
+  } else {
+    Serial.println("No assets partition, using built-in assets");
+  }
   
-  LCD_SetBacklight(100);
-  Serial.println("Backlight set");
+  webServer.onNotify([](const char* message) {
+    uiEvents.send({UI_TOAST, 2000, 0, message});
+    bleEvents.set(BLE_CONFIG_CHANGED);
+  });
+  webServer.setMirror(&displayMirror);
+  webServer.setAssets(&assets);
+  if (assets.isValid() && !webServer.hasAssetPage()) {
+    Serial.printf("Assets page v%lu is not for this firmware (v%lu), using the built-in page\n",
+                  (unsigned long)assets.getPageVersion(), (unsigned long)JigglerWebServer::PAGE_VERSION);
+  }
+  webServer.setLifetime(&lifetime);
+  webServer.setHistory(&history);
   
-  Paint_NewImage(LCD_WIDTH, LCD_HEIGHT, 90, WHITE);
-  Serial.println("Paint image created");
+  // The WiFi AP (HTTP task) and the LCD (UI task) come up side by side
+  startTasks();
+  Serial.println("Setup complete!");
+}
+
+// First advertisement sent: BLE is up as far as a host can tell. Also
+// takes the RSSI reads the BLE task asks for. Called on the BLE stack's
+// task for every GAP event.
+void onGapEvent(esp_gap_ble_cb_event_t event, esp_ble_gap_cb_param_t* param) {
+  static bool advertising = false;
+  if (event == ESP_GAP_BLE_ADV_START_COMPLETE_EVT && !advertising &&
+      param->adv_start_cmpl.status == ESP_BT_STATUS_SUCCESS) {
+    advertising = true;
+    bootTrace.mark("ble_advertising", esp_timer_get_time());
+  } else if (event == ESP_GAP_BLE_READ_RSSI_COMPLETE_EVT &&
+             param->read_rssi_cmpl.status == ESP_BT_STATUS_SUCCESS) {
+    history.addRssi(param->read_rssi_cmpl.rssi, esp_timer_get_time());
+  }
+}
+
+// Who connected, for the RSSI reads; BleMouse's own server callbacks
+// still run
+void onGattsEvent(esp_gatts_cb_event_t event, esp_gatt_if_t gattsIf, esp_ble_gatts_cb_param_t* param) {
+  if (event == ESP_GATTS_CONNECT_EVT) {
+    memcpy(peerAddress, param->connect.remote_bda, sizeof(peerAddress));
+    peerKnown = true;
+  } else if (event == ESP_GATTS_DISCONNECT_EVT) {
+    peerKnown = false;
+  }
+}
+
+// LCD bring-up and the splash, first thing on the UI task; the splash stays
+// up until the WiFi AP is ready (UI_WIFI_READY)
+void startDisplay() {
+  JigglerConfig config = configManager.getConfig();
   
+  uint8_t phase = bootTrace.start("lcd_init", esp_timer_get_time());
+  Config_Init();
+  LCD_Init();
+  Paint_NewImage(LCD_WIDTH, LCD_HEIGHT, 90, WHITE);
   Paint_SetRotate(90);
-  Serial.println("Rotation set");
-  
-  // Beautiful startup screen
-  LCD_Clear(0x001F);  // Deep blue background
-  Serial.println("LCD cleared");
-  
-  // Draw startup screen - left aligned
-  Serial.println("Drawing startup screen...");
-  Paint_DrawString_EN(5, 15, "MOUSE JIGGLER", &Font16, 0x001F, 0xFFFF);
-  Paint_DrawString_EN(5, 40, "ESP32-S3-GEEK", &Font16, 0x001F, 0x07FF);
-  
-  // Author info
-  Paint_DrawString_EN(5, 70, "YEVHENII RODIN", &Font16, 0x001F, 0xFFE0);
-  Paint_DrawString_EN(5, 95, "BLARODIN@GMAIL.COM", &Font16, 0x001F, 0xFFE0);
-  
-  delay(2000);
-  
-  // Start WiFi AP and web server
-  Serial.println("Starting WiFi AP...");
-  webServer.begin(&configManager);
+  bootTrace.end(phase, esp_timer_get_time());
+  Serial.println("LCD initialized");
   
-  // Show WiFi info on display
-  showWiFiInfo();
-  delay(3000);
+  // Strip renderer: one small SRAM strip instead of a full framebuffer
+  if (Paint_SetFrameBudget(PAINT_STRIP_BYTES_DFT, PAINT_LIST_BYTES_DFT)) {
+    Serial.printf("Strip renderer ready (%u lines per strip)\n", sPaint_frame.StripLines);
+  } else {
+    Serial.println("Strip renderer unavailable, drawing directly");
+  }
   
-  // Initialize BLE Mouse with configured name
-  Serial.println("Starting BLE...");
-  bleMouse = new BleMouse(config.deviceName, "ESP32-S3-GEEK", 100);
-  bleMouse->begin();
-  Serial.println("BLE Mouse Jiggler started!");
-  Serial.println("Waiting for connection...");
+  // Large countdown digits, 28x44 each (about 34 KB for all glyphs)
+  if (config.bigCountdown) {
+    bigCountdown = Paint_Digits_Init(&countdownDigits, 28, 44, 0x0010, 0xFFE0);
+    Serial.println(bigCountdown ? "Large countdown digits ready" : "Large countdown digits unavailable");
+  }
   
-  currentState = STATE_WAITING;
+  currentState = STATE_INITIALIZING;
   updateDisplay(true);
-  Serial.println("Setup complete!");
+  LCD_SetBacklight(100);  // after the first frame, so the panel's power-on contents never show
+  bootTrace.mark("first_frame", esp_timer_get_time());
+  
+  Paint_SetFlushHook([](UWORD xStart, UWORD yStart, UWORD xEnd, UWORD yEnd) {
+    displayMirror.markDirty(xStart, yStart, xEnd, yEnd);
+  });
 }
 
+// Everything runs in the tasks started from setup()
 void loop() {
-  static unsigned long lastDisplayUpdate = 0;
-  unsigned long currentTime = millis();
+  Task::end();
+}
+
+// BLE/HID on the protocol core next to the radio stack; drawing and the web
+// server on the application core, drawing first. The HTTP task is started
+// before the UI task since the AP takes longest to come up; the LCD is
+// brought up while it waits.
+void startTasks() {
+  uiEvents.begin();
+  bleEvents.begin();
+  displayLock.begin();
+  webServer.setDisplayLock(&displayLock);
+  webServer.setScheduler(&scheduler);
+  webServer.setPower(&power);
+  wallClock.begin();
+  webServer.setClock(&wallClock);
+  history.setClock(&wallClock);
   
-  // Handle web server requests
-  webServer.handleClient();
+  // 80 MHz and light sleep between jiggles, 240 MHz while drawing or serving
+  bool sleeps = power.begin(240, 80, true, PowerManager::now());
+  Serial.println(sleeps ? "Automatic light sleep enabled" : "Light sleep not available in this build");
   
-  // Get current configuration
-  JigglerConfig& config = configManager.getConfig();
+  bool started = Task::start("ble", bleTask, nullptr, BLE_STACK_BYTES, 3, TASK_CORE_PROTOCOL) &&
+                 Task::start("http", httpTask, nullptr, 8192, 1, TASK_CORE_APP) &&
+                 Task::start("ui", uiTask, nullptr, 8192, 2, TASK_CORE_APP);
+  if (!started) {
+    Serial.println("Failed to start tasks");
+  }
+}
+
+// Watch the connection and jiggle on time. Sleeps until the next jiggle
+// (woken by jiggleTimer) or pattern step is due, at most BLE_POLL_MS while
+// the connection has to be checked; that check also catches the schedule
+// opening or closing. Works from its own copy of the settings, taken again
+// when the web server saves new ones (BLE_CONFIG_CHANGED).
+void bleTask(void* arg) {
+  JigglerConfig config = configManager.getConfig();
+  bool connected = false;
+  uint32_t jiggles = lifetime.get(esp_timer_get_time()).jiggles;  // shown on screen
+  int64_t armedFor = -1;  // deadline jiggleTimer is set for
+  int64_t rssiReadAt = 0;
+  bool moving = false;    // holding POWER_MOTION
   
-  // Check if BLE mouse is connected
-  if (bleMouse && bleMouse->isConnected()) {
-    if (!isJiggling) {
-      isJiggling = true;
-      lastJiggleTime = currentTime;  // Reset timer on connection
-      Serial.println("Mouse connected! Jiggler active.");
-      currentState = STATE_CONNECTED;
-      updateDisplay(true);  // Full redraw on state change
+  scheduler.setSeed(random(1, 0x7FFFFFFF));
+  jiggleTimer.begin(&bleEvents, BLE_JIGGLE_DUE);
+  motion.setOutput([](const MotionStep& step, void*) {
+    if (step.click) bleMouse->click(step.click);
+    if (step.x || step.y || step.wheel) bleMouse->move(step.x, step.y, step.wheel);
+  }, nullptr);
+  
+  for (;;) {
+    scheduler.setInterval(config.jiggleInterval, config.jiggleJitter);
+    int64_t now = esp_timer_get_time();
+    bool open = !config.scheduleEnabled || WeekSchedule::isOpenAt(config.schedule, wallClock, now);
+    if (bleMouse->isConnected() != connected) {
+      connected = !connected;
+      motion.cancel();
+      if (connected && open) {
+        scheduler.start(now);  // first jiggle one interval after connecting
+      } else {
+        scheduler.stop();
+        jiggleTimer.stop();
+        armedFor = -1;
+      }
+      lifetime.setConnected(connected, now);
+      history.setConnected(connected, now);
+      Serial.println(connected ? "Mouse connected! Jiggler active." : "Mouse disconnected. Waiting for connection...");
+      uiEvents.send({connected ? UI_CONNECTED : UI_DISCONNECTED, jiggles, (unsigned long)(scheduler.deadline() / 1000), nullptr});
+      if (connected && !open) uiEvents.send({UI_PAUSED, jiggles, 0, nullptr});
+    } else if (connected && open != scheduler.isRunning() && !motion.isRunning()) {
+      // A window of the schedule opened or closed; a playing jiggle finishes first
+      if (open) {
+        scheduler.start(now);
+      } else {
+        scheduler.stop();
+        jiggleTimer.stop();
+        armedFor = -1;
+      }
+      Serial.println(open ? "Schedule open, jiggling resumed" : "Outside the schedule, jiggling paused");
+      uiEvents.send({open ? UI_RESUMED : UI_PAUSED, jiggles, (unsigned long)(scheduler.deadline() / 1000), nullptr});
     }
     
-    // Check if it's time to jiggle
-    if (currentTime - lastJiggleTime >= config.jiggleInterval) {
-      if (config.randomMoves) {
-        performRandomJiggle();
-      } else {
-        performJiggle();
+    if (motion.isRunning()) {
+      PROFILE_SCOPE(PROF_JIGGLE);
+      if (motion.tick(now / 1000)) {
+        Serial.println("Jiggle complete!");
+        jiggles++;
+        lifetime.jiggled();
+        history.jiggled(now);
+        uiEvents.send({UI_JIGGLE_DONE, jiggles, (unsigned long)(scheduler.deadline() / 1000), nullptr});
       }
-      lastJiggleTime = currentTime;
-      jiggleCount++;
+    } else if (scheduler.isDue(now)) {
+      PROFILE_SCOPE(PROF_JIGGLE);
+      scheduler.fired(now);
+      startJiggle(config);
+      uiEvents.send({UI_JIGGLE_START, jiggles, (unsigned long)(scheduler.deadline() / 1000), nullptr});
+      motion.tick(now / 1000);
     }
     
-    // Update display every second when connected (only countdown and progress)
-    if (currentTime - lastDisplayUpdate >= 1000) {
-      nextJiggleIn = (config.jiggleInterval - (currentTime - lastJiggleTime)) / 1000;
-      if (currentState != STATE_JIGGLING) {
-        updateCountdownOnly();  // Only update dynamic parts
+    // Stay out of light sleep while a pattern plays, so reports go out on time
+    if (motion.isRunning() != moving) {
+      moving = !moving;
+      if (moving) {
+        power.acquire(POWER_MOTION, PowerManager::now());
+      } else {
+        power.release(POWER_MOTION, PowerManager::now());
       }
-      lastDisplayUpdate = currentTime;
     }
-  } else {
-    if (isJiggling) {
+    
+    lifetime.tick(now);  // commits at most every LifetimeStats::COMMIT_INTERVAL_MS
+    history.tick(now);
+    
+    bleStackUnused = Task::stackUnused();  // a high-water mark: includes the NVS commits above
+    
+    // The answer comes back as a GAP event (onGapEvent)
+    if (connected && peerKnown && now >= rssiReadAt) {
+      rssiReadAt = now + RSSI_READ_MS * 1000;
+      esp_ble_gap_read_rssi(peerAddress);
+    }
+    
+    if (scheduler.isRunning() && scheduler.deadline() != armedFor) {
+      armedFor = scheduler.deadline();
+      jiggleTimer.start(scheduler.usUntilDue(esp_timer_get_time()));
+    }
+    uint32_t events = bleEvents.wait(BLE_CONFIG_CHANGED | BLE_JIGGLE_DUE, motion.msUntilNext(millis(), BLE_POLL_MS));
+    if (events & BLE_CONFIG_CHANGED) config = configManager.getConfig();
+  }
+}
+
+// Milliseconds between jiggles, as the UI draws them
+unsigned long displayInterval() {
+  return intervalOverride ? intervalOverride : configManager.getConfig().jiggleInterval;
+}
+
+// Seconds until the next jiggle, as the countdown shows them
+unsigned long countdownAt(unsigned long now) {
+  unsigned long interval = displayInterval();
+  long left = (long)(nextJiggleAt - now);
+  if (left <= 0) return 0;
+  return ((unsigned long)left < interval ? left : interval) / 1000;  // jitter can make it longer
+}
+
+// How long the UI task can sleep before something on screen is due
+unsigned long uiWaitMs(unsigned long now) {
+  unsigned long wait = TASK_WAIT_FOREVER;
+  if (currentState == STATE_WIFI_INFO && !isJiggling) {
+    long left = (long)(wifiInfoShownAt + WIFI_INFO_TIME - now);
+    wait = left > 0 ? left : 0;
+  }
+  if (isJiggling) {
+    // The countdown digits change when the time left drops below a whole second
+    long left = (long)(nextJiggleAt - now);
+    if (left > 0 && (unsigned long)(left % 1000 + 1) < wait) {
+      wait = left % 1000 + 1;
+    }
+    if (currentState == STATE_CONNECTED && lastDrawnState == STATE_CONNECTED) {
+      wait = progressBar.msUntilNextFrame(now, wait);
+    }
+  }
+  if (toastUntil) {
+    long left = (long)(toastUntil - now);
+    if (left <= 0) return 0;
+    if ((unsigned long)left < wait) wait = left;
+  }
+  return wait;
+}
+
+// Draw what the other tasks report, and what falls due on the clock
+void uiTask(void* arg) {
+  {
+    LockGuard lock(&displayLock);
+    PowerGuard awake(&power, POWER_RENDER);
+    startDisplay();
+  }
+  for (;;) {
+    UiEvent event;
+    bool received = uiEvents.receive(event, uiWaitMs(millis()));
+    
+    LockGuard lock(&displayLock);
+    PowerGuard awake(&power, POWER_RENDER);
+    if (received) handleUiEvent(event);
+    updateScreen(millis());
+  }
+}
+
+void handleUiEvent(const UiEvent& event) {
+  switch (event.type) {
+    case UI_CONNECTED:
+      isJiggling = true;
+      isPaused = false;
+      jiggleCount = event.value;
+      nextJiggleAt = event.time;
+      nextJiggleIn = countdownAt(millis());
+      currentState = STATE_CONNECTED;
+      updateDisplay(true);  // Full redraw on state change
+      showToast("Host connected", 2000);
+      break;
+    case UI_DISCONNECTED:
       isJiggling = false;
-      Serial.println("Mouse disconnected. Waiting for connection...");
+      isMoving = false;
+      if (isPaused) {
+        isPaused = false;
+        LCD_SetBacklight(100);
+      }
       currentState = STATE_WAITING;
-      updateDisplay(true);  // Full redraw on state change
-    }
+      updateDisplay(true);
+      break;
+    case UI_PAUSED:
+      // Nothing to count down to: the UI task sleeps until the next event
+      if (!isJiggling) break;
+      isPaused = true;
+      isMoving = false;
+      nextJiggleAt = millis();
+      nextJiggleIn = 0;
+      updateDisplay(true);
+      LCD_SetBacklight(0);
+      break;
+    case UI_RESUMED:
+      if (!isJiggling) break;
+      isPaused = false;
+      nextJiggleAt = event.time;
+      nextJiggleIn = countdownAt(millis());
+      updateDisplay(true);
+      LCD_SetBacklight(100);
+      break;
+    case UI_JIGGLE_START:
+    case UI_JIGGLE_DONE:
+      if (!isJiggling) break;
+      isMoving = event.type == UI_JIGGLE_START;
+      jiggleCount = event.value;
+      nextJiggleAt = event.time;
+      nextJiggleIn = countdownAt(millis());
+      if (currentState == STATE_CONNECTED && lastDrawnState == STATE_CONNECTED) {
+        // Only the status word; count, countdown and bar follow in updateScreen()
+        Paint_BeginUpdate();
+        drawStatusValue(isMoving, isPaused);
+        Paint_EndFrame();
+      }
+      break;
+    case UI_TOAST:
+      showToast(event.text, event.value);
+      break;
+    case UI_WIFI_READY:
+      // The URL code needs the AP's address; a host that connected first
+      // keeps its screen
+      encodeSetupCodes();
+      if (currentState == STATE_INITIALIZING) {
+        currentState = STATE_WIFI_INFO;
+        updateDisplay(true);
+        wifiInfoShownAt = millis();
+      }
+      break;
+    case UI_COMMAND:
+      if (event.value == CMD_BENCH) {
+        runBenchmarks();
+      } else {
+        runScreenCheck(event.value == CMD_GOLDEN);
+      }
+      break;
   }
-  
-  // Small delay to prevent overwhelming the CPU
-  delay(100);
 }
 
-void performJiggle() {
-  JigglerConfig& config = configManager.getConfig();
-  
-  // Move mouse in a small square pattern to create subtle movement
-  DisplayState prevState = currentState;
-  currentState = STATE_JIGGLING;
-  
-  Serial.println("Jiggling mouse (square pattern)...");
-  updateDisplay(true);  // Full redraw for jiggling state
-  
-  // Move right
-  bleMouse->move(config.moveDistance, 0);
-  delay(50);
-  
-  // Move down
-  bleMouse->move(0, config.moveDistance);
-  delay(50);
-  
-  // Move left (return to approximately original position)
-  bleMouse->move(-config.moveDistance, 0);
-  delay(50);
+void updateScreen(unsigned long now) {
+  if (currentState == STATE_WIFI_INFO && !isJiggling && now - wifiInfoShownAt >= WIFI_INFO_TIME) {
+    currentState = STATE_WAITING;
+    updateDisplay(true);
+  }
   
-  // Move up (return to approximately original position)
-  bleMouse->move(0, -config.moveDistance);
-  delay(50);
+  if (isJiggling) {
+    // Progress bar animation frames (no-op when the bar is at rest)
+    if (currentState == STATE_CONNECTED && lastDrawnState == STATE_CONNECTED && progressBar.isAnimating()) {
+      PROFILE_SCOPE(PROF_PROGRESS_BAR);
+      progressBar.tick(now);
+    }
+    
+    // Countdown and progress only; no-op until the seconds change
+    nextJiggleIn = countdownAt(now);
+    updateCountdownOnly();
+  }
   
-  Serial.println("Jiggle complete!");
-  currentState = STATE_CONNECTED;
-  updateDisplay(true);  // Full redraw back to connected state
+  updateToast(now);
 }
 
-void performRandomJiggle() {
-  JigglerConfig& config = configManager.getConfig();
-  
-  currentState = STATE_JIGGLING;
-  Serial.println("Jiggling mouse (random pattern)...");
-  updateDisplay(true);
-  
-  // Generate random movements
-  int dx1 = random(config.randomMinDistance, config.randomMaxDistance + 1);
-  int dy1 = random(config.randomMinDistance, config.randomMaxDistance + 1);
+// Web requests, the live mirror and the serial console, after bringing up
+// the WiFi AP
+void httpTask(void* arg) {
+  uint8_t phase = bootTrace.start("softap", esp_timer_get_time());
+  webServer.begin(&configManager);
+  bootTrace.end(phase, esp_timer_get_time());
+  uiEvents.send({UI_WIFI_READY, 0, 0, nullptr});
+  bool bootPrinted = false;
   
-  // Random direction
-  if (random(0, 2)) dx1 = -dx1;
-  if (random(0, 2)) dy1 = -dy1;
+  for (;;) {
+    webServer.handleClient();
+    handleSerial();
+    {
+      LockGuard lock(&displayLock);
+      displayMirror.tick(millis());
+    }
+    if (!bootPrinted && ((bootTrace.isDone("ble_advertising") && bootTrace.isDone("first_frame")) ||
+                         millis() >= BOOT_REPORT_MS)) {
+      printBoot();
+      bootPrinted = true;
+    }
+    Task::sleep(HTTP_POLL_MS);
+  }
+}
+
+// Queue the moves of one jiggle; played by the BLE task, shown by the UI task
+void startJiggle(const JigglerConfig& config) {
+  MotionStep steps[5];
+  uint8_t count;
   
-  // First move
-  bleMouse->move(dx1, dy1);
-  delay(100);
+  if (config.customPattern && config.patternLength) {
+    // User pattern, run from a copy so saving a new one cannot change it midway
+    static PatternRunner runner;
+    if (runner.begin(config.pattern, config.patternLength, random(1, 0x7FFFFFFF)) &&
+        motion.play(runner, millis())) {
+      Serial.println("Jiggling mouse (custom pattern)...");
+      return;
+    }
+  }
   
-  // Return to origin (approximately)
-  bleMouse->move(-dx1, -dy1);
-  delay(50);
+  if (config.curvedMoves) {
+    // Curved path through random points, generated report by report
+    static CurveRunner curve;
+    curve.begin(constrain(config.curveDuration, CurveRunner::MIN_DURATION, CurveRunner::MAX_DURATION),
+                constrain(config.curveAmplitude, CurveRunner::MIN_AMPLITUDE, CurveRunner::MAX_AMPLITUDE),
+                random(1, 0x7FFFFFFF));
+    motion.play(curve, millis());
+    Serial.println("Jiggling mouse (curved path)...");
+    return;
+  }
   
-  Serial.println("Random jiggle complete!");
-  currentState = STATE_CONNECTED;
-  updateDisplay(true);
+  if (config.randomMoves) {
+    // Random distance and direction, then back to the origin
+    int dx = random(config.randomMinDistance, config.randomMaxDistance + 1);
+    int dy = random(config.randomMinDistance, config.randomMaxDistance + 1);
+    if (random(0, 2)) dx = -dx;
+    if (random(0, 2)) dy = -dy;
+    count = MotionExecutor::outAndBack(steps, constrain(dx, -127, 127), constrain(dy, -127, 127));
+    Serial.println("Jiggling mouse (random pattern)...");
+  } else {
+    // Small square that ends where it started
+    count = MotionExecutor::square(steps, constrain(config.moveDistance, -127, 127));
+    Serial.println("Jiggling mouse (square pattern)...");
+  }
+  motion.play(steps, count, millis());
 }
 
 // Beautiful display update with status, progress, and info
 void updateDisplay(bool forceFullRedraw) {
   // Only do full redraw if state changed or forced
   if (forceFullRedraw || currentState != lastDrawnState) {
+    PROFILE_SCOPE(PROF_DISPLAY);
+    if (currentState == STATE_INITIALIZING) {
+      showSplash();
+      lastDrawnState = currentState;
+      return;
+    }
+    if (currentState == STATE_WIFI_INFO) {
+      showWiFiInfo();
+      lastDrawnState = currentState;
+      return;
+    }
+    
+    // Record the whole screen, then push it strip by strip (no visible clear)
+    Paint_BeginFrame();
+    
     // Clear with gradient-like effect using different shades
-    LCD_Clear(0x0010);  // Dark blue-black background
+    Paint_Clear(0x0010);  // Dark blue-black background
     
     // Draw decorative header bar - fill completely (240 pixels wide when rotated 90)
-    for (int y = 0; y < 25; y++) {
-      for (int x = 0; x < LCD_HEIGHT; x++) {
-        Paint_SetPixel(x, y, 0x001F);
-      }
-    }
+    Paint_DrawGradient(0, 0, LCD_HEIGHT, 25, &headerGradient);
     
-    // Title in header
-    Paint_DrawString_EN(20, 5, "MOUSE JIGGLER", &Font16, 0x001F, 0xFFFF);
+    // Title in header (transparent background over the gradient)
+    Paint_DrawString_EN(20, 5, "MOUSE JIGGLER", &Font16, FONT_BACKGROUND, 0xFFFF);
     
     // Draw WiFi icon
     drawWiFiIcon();
     
     // Draw status icon/indicator
-    drawStatusIcon(bleMouse ? bleMouse->isConnected() : false);
+    drawStatusIcon(isJiggling);  // Connection as loop() last saw it
     
     // Main content area
     if (currentState == STATE_WAITING) {
@@ -270,33 +738,56 @@ void updateDisplay(bool forceFullRedraw) {
     else if (currentState == STATE_CONNECTED) {
       // Connection status
       Paint_DrawString_EN(15, 35, "Status:", &Font16, 0x0010, 0x07FF);
-      Paint_DrawString_EN(80, 35, " ACTIVE", &Font16, 0x0010, 0x07E0);  // Green with space
+      drawStatusValue(isMoving, isPaused);
       
-      // Jiggle count
-      char countStr[32];
-      sprintf(countStr, "Jiggles: %lu", jiggleCount);
-      Paint_DrawString_EN(15, 60, countStr, &Font16, 0x0010, 0xFFFF);
+      unsigned long interval = displayInterval() / 1000;
       
-      // Next jiggle countdown
-      char timeStr[32];
-      sprintf(timeStr, "Next in: %lus", nextJiggleIn);
-      Paint_DrawString_EN(15, 85, timeStr, &Font16, 0x0010, 0xFFE0);
+      // Countdown is right aligned to the widest value it can show
+      char maxStr[PAINT_NUM_MAX + 1];
+      UBYTE countdownWidth = Paint_UIntToStr(maxStr, interval);
+      
+      if (bigCountdown) {
+        // Counter on the left, large countdown on the right above the bar
+        Paint_DrawString_EN(15, 58, "Jiggles:", &Font16, 0x0010, 0xFFFF);
+        Paint_NumField_Init(&jiggleCountField, 15, 80, 10, PAINT_ALIGN_LEFT, &Font16, 0x0010, 0xFFFF);
+        Paint_DrawNumField(&jiggleCountField, jiggleCount, 0);
+        
+        int suffixX = LCD_HEIGHT - 15 - Font16.Width;
+        int digitsX = suffixX - countdownWidth * countdownDigits.Width;
+        Paint_NumField_InitDigits(&countdownField, digitsX, 58, countdownWidth, PAINT_ALIGN_RIGHT, &countdownDigits);
+        Paint_DrawNumField(&countdownField, nextJiggleIn, 0);
+        Paint_DrawChar(suffixX, 58 + countdownDigits.Height - Font16.Height, 's', &Font16, 0x0010, 0xFFE0);
+      } else {
+        // Jiggle count (labels are 9 characters, numbers start at x=114)
+        Paint_DrawString_EN(15, 60, "Jiggles: ", &Font16, 0x0010, 0xFFFF);
+        Paint_NumField_Init(&jiggleCountField, 114, 60, 10, PAINT_ALIGN_LEFT, &Font16, 0x0010, 0xFFFF);
+        Paint_DrawNumField(&jiggleCountField, jiggleCount, 0);
+        
+        Paint_DrawString_EN(15, 85, "Next in: ", &Font16, 0x0010, 0xFFE0);
+        Paint_NumField_Init(&countdownField, 114, 85, countdownWidth, PAINT_ALIGN_RIGHT, &Font16, 0x0010, 0xFFE0);
+        Paint_DrawNumField(&countdownField, nextJiggleIn, 0);
+        Paint_DrawChar(114 + countdownWidth * Font16.Width, 85, 's', &Font16, 0x0010, 0xFFE0);
+      }
       
       // Progress bar
-      JigglerConfig& config = configManager.getConfig();
-      int progress = 100 - ((nextJiggleIn * 100) / (config.jiggleInterval / 1000));
+      int progress = 100 - ((nextJiggleIn * 100) / interval);
       drawProgressBar(progress);
     }
-    else if (currentState == STATE_JIGGLING) {
-      Paint_DrawString_EN(15, 40, "Status:", &Font16, 0x0010, 0x07FF);
-      Paint_DrawString_EN(15, 65, "JIGGLING!", &Font20, 0x0010, 0xF800);  // Red
-      Paint_DrawString_EN(25, 95, "Moving...", &Font16, 0x0010, 0xFFE0);
+    
+    Paint_EndFrame();
+    if (logFrames) {
+      Serial.printf("Frame: %lu us (raster %lu us, %u strips, %u list entries)\n",
+                    (unsigned long)sPaint_frame.FrameTime, (unsigned long)sPaint_frame.RasterTime,
+                    sPaint_frame.Strips, sPaint_frame.Commands);
+      const AnimatorStats& anim = progressBar.getStats();
+      Serial.printf("Bar animation: %u fps, %lu frames, %lu dropped, %lu over budget\n",
+                    anim.fps, (unsigned long)anim.frames, (unsigned long)anim.dropped,
+                    (unsigned long)anim.budgetLimited);
     }
     
     lastDrawnState = currentState;
     lastDrawnJiggleCount = jiggleCount;
     lastDrawnNextJiggleIn = nextJiggleIn;
-    lastDrawnProgress = -1;  // Reset progress tracker on full redraw
   }
 }
 
@@ -306,38 +797,42 @@ void updateCountdownOnly() {
   
   // Only update if values changed
   if (nextJiggleIn != lastDrawnNextJiggleIn || jiggleCount != lastDrawnJiggleCount) {
-    // Clear and update only the numeric values, not the labels
+    PROFILE_SCOPE(PROF_COUNTDOWN);
+    // Redraw only the digits that changed, not the labels
+    Paint_BeginUpdate();
     
     if (jiggleCount != lastDrawnJiggleCount) {
-      // Clear only the number area ("Jiggles: " takes ~95 pixels)
-      Paint_DrawRectangle(110, 60, LCD_HEIGHT - 15, 75, 0x0010, DOT_PIXEL_1X1, DRAW_FILL_FULL);
-      
-      // Draw only the number
-      char countStr[16];
-      sprintf(countStr, "%lu", jiggleCount);
-      Paint_DrawString_EN(110, 60, countStr, &Font16, 0x0010, 0xFFFF);
+      Paint_DrawNumField(&jiggleCountField, jiggleCount, 0);
     }
     
     if (nextJiggleIn != lastDrawnNextJiggleIn) {
-      // Clear the number area wider to handle 2-digit to 1-digit transitions
-      Paint_DrawRectangle(110, 85, LCD_HEIGHT - 15, 100, 0x0010, DOT_PIXEL_1X1, DRAW_FILL_FULL);
-      
-      // Draw only the number with 's' - aligned with jiggle counter
-      char timeStr[16];
-      sprintf(timeStr, "%lus", nextJiggleIn);
-      Paint_DrawString_EN(110, 85, timeStr, &Font16, 0x0010, 0xFFE0);
+      Paint_DrawNumField(&countdownField, nextJiggleIn, 0);
       
-      // Update progress bar
-      JigglerConfig& config = configManager.getConfig();
-      int progress = 100 - ((nextJiggleIn * 100) / (config.jiggleInterval / 1000));
-      drawProgressBar(progress);
+      // Tween the progress bar; frames are drawn from the UI task
+      int progress = 100 - ((nextJiggleIn * 100) / (displayInterval() / 1000));
+      progressBar.animateTo(progress, millis());
     }
     
+    Paint_EndFrame();  // Pushes only the touched areas
+    
     lastDrawnJiggleCount = jiggleCount;
     lastDrawnNextJiggleIn = nextJiggleIn;
   }
 }
 
+// Status word of the connected screen: green while idle, red while a
+// jiggle plays, yellow outside the schedule. Same width every way, so it
+// can be redrawn on its own.
+void drawStatusValue(bool moving, bool paused) {
+  if (paused) {
+    Paint_DrawString_EN(80, 35, " PAUSED", &Font16, 0x0010, 0xFFE0);
+  } else if (moving) {
+    Paint_DrawString_EN(80, 35, " MOVING", &Font16, 0x0010, 0xF800);
+  } else {
+    Paint_DrawString_EN(80, 35, " ACTIVE", &Font16, 0x0010, 0x07E0);
+  }
+}
+
 void drawStatusIcon(bool connected) {
   // Draw a status indicator circle in top right (use LCD_HEIGHT for rotated width)
   int cx = LCD_HEIGHT - 15;
@@ -346,13 +841,11 @@ void drawStatusIcon(bool connected) {
   
   uint16_t color = connected ? 0x07E0 : 0xF800;  // Green if connected, red if not
   
-  // Draw filled circle
+  // Draw filled circle, one horizontal span per row
   for (int y = -radius; y <= radius; y++) {
-    for (int x = -radius; x <= radius; x++) {
-      if (x*x + y*y <= radius*radius) {
-        Paint_DrawPoint(cx + x, cy + y, color, DOT_PIXEL_1X1, DOT_FILL_AROUND);
-      }
-    }
+    int x = 0;
+    while ((x + 1) * (x + 1) + y * y <= radius * radius) x++;
+    Paint_DrawLine(cx - x, cy + y, cx + x, cy + y, color, DOT_PIXEL_1X1, LINE_STYLE_SOLID);
   }
 }
 
@@ -368,89 +861,417 @@ void drawWiFiIcon() {
   Paint_DrawLine(x - 4, y + 2, x + 6, y + 2, color, DOT_PIXEL_1X1, LINE_STYLE_SOLID);
 }
 
+// Append a WIFI: field value, escaping the characters the format reserves
+void appendEscaped(String& out, const char* text) {
+  for (; *text; text++) {
+    if (strchr("\\;,:\"", *text)) out += '\\';
+    out += *text;
+  }
+}
+
+// Build the setup QR payloads from the configuration and encode them
+void encodeSetupCodes() {
+  JigglerConfig config = configManager.getConfig();
+  
+  String join = "WIFI:S:";
+  appendEscaped(join, config.wifiSSID);
+  join += ";T:WPA;P:";
+  appendEscaped(join, config.wifiPassword);
+  join += ";;";
+  
+  String url = "http://" + webServer.getIPAddress();
+  
+  unsigned long start = micros();
+  wifiQR.encode(join.c_str());
+  urlQR.encode(url.c_str());
+  Serial.printf("Setup QR codes: WiFi %u-%c, URL %u-%c (%lu us)\n",
+                wifiQR.getVersion(), wifiQR.getEccLevel(), urlQR.getVersion(), urlQR.getEccLevel(),
+                micros() - start);
+}
+
+// Draw a QR code on a light tile with a 2 module quiet zone, returns the tile size
+int drawQRTile(const QRCode& qr, int x, int y, int scale) {
+  int tile = (qr.getSize() + 4) * scale;
+  Paint_ClearWindows(x, y, x + tile, y + tile, 0xFFFF);
+  Paint_DrawBitmap(x + 2 * scale, y + 2 * scale, qr.getBitmap(), scale, 0xFFFF, 0x0000);
+  return tile;
+}
+
+// Boot screen, up while the radios start
+void showSplash() {
+  Paint_BeginFrame();
+  Paint_Clear(0x001F);  // Deep blue background
+  
+  // Left aligned
+  Paint_DrawString_EN(5, 15, "MOUSE JIGGLER", &Font16, 0x001F, 0xFFFF);
+  Paint_DrawString_EN(5, 40, "ESP32-S3-GEEK", &Font16, 0x001F, 0x07FF);
+  
+  // Author info
+  Paint_DrawString_EN(5, 70, "YEVHENII RODIN", &Font16, 0x001F, 0xFFE0);
+  Paint_DrawString_EN(5, 95, "BLARODIN@GMAIL.COM", &Font16, 0x001F, 0xFFE0);
+  Paint_EndFrame();
+}
+
 void showWiFiInfo() {
-  JigglerConfig& config = configManager.getConfig();
+  JigglerConfig config = configManager.getConfig();
   String ip = webServer.getIPAddress();
   
-  // Show 2 screens alternating
-  for (int screen = 0; screen < 2; screen++) {
-    LCD_Clear(0x0010);
+  Paint_BeginFrame();
+  Paint_Clear(0x0010);
+  
+  if (wifiQR.isValid() && urlQR.isValid()) {
+    // Left: join the access point, as large as the screen height allows
+    int scale = min(4, LCD_WIDTH / (wifiQR.getSize() + 4));
+    int tile = drawQRTile(wifiQR, 0, (LCD_WIDTH - (wifiQR.getSize() + 4) * scale) / 2, scale);
     
-    // Draw header bar
-    for (int y = 0; y < 25; y++) {
-      for (int x = 0; x < LCD_HEIGHT; x++) {
-        Paint_SetPixel(x, y, 0x001F);
-      }
-    }
+    // Right: the settings page, between lines of text
+    int colX = tile + 6;
+    int colWidth = LCD_HEIGHT - colX - 2;
+    int urlScale = min(3, min(colWidth, LCD_WIDTH - 48) / (urlQR.getSize() + 4));
+    int urlTile = (urlQR.getSize() + 4) * urlScale;
     
-    if (screen == 0) {
-      // Screen 1: WiFi credentials
-      Paint_DrawString_EN(20, 5, "WiFi Network", &Font16, 0x001F, 0xFFFF);
-      
-      Paint_DrawString_EN(15, 35, "SSID:", &Font16, 0x0010, 0x07FF);
-      Paint_DrawString_EN(15, 55, config.wifiSSID, &Font16, 0x0010, 0xFFFF);
-      
-      Paint_DrawString_EN(15, 80, "Password:", &Font16, 0x0010, 0x07FF);
-      Paint_DrawString_EN(15, 100, config.wifiPassword, &Font16, 0x0010, 0xFFFF);
-    } else {
-      // Screen 2: IP address
-      Paint_DrawString_EN(25, 5, "Open Browser", &Font16, 0x001F, 0xFFFF);
-      
-      Paint_DrawString_EN(15, 40, "Connect to:", &Font16, 0x0010, 0x07FF);
-      Paint_DrawString_EN(15, 65, ip.c_str(), &Font16, 0x0010, 0x07E0);
-      
-      Paint_DrawString_EN(15, 95, "http://", &Font16, 0x0010, 0xFFE0);
-      Paint_DrawString_EN(80, 95, ip.c_str(), &Font16, 0x0010, 0xFFE0);
-    }
+    Paint_DrawString_EN(colX, 2, "<- WiFi", &Font16, 0x0010, 0xFFFF);
+    drawQRTile(urlQR, colX + (colWidth - urlTile) / 2, 20, urlScale);
+    Paint_DrawString_EN(colX, 22 + urlTile, "Settings", &Font16, 0x0010, 0x07FF);
+    Paint_DrawString_EN(colX, 39 + urlTile, ip.c_str(), &Font8, 0x0010, 0xFFE0);
+  } else {
+    // Payload too long for a QR code: credentials as text
+    Paint_DrawGradient(0, 0, LCD_HEIGHT, 25, &headerGradient);
+    Paint_DrawString_EN(20, 5, "WiFi Network", &Font16, FONT_BACKGROUND, 0xFFFF);
     
-    delay(1500);  // Show each screen for 1.5 seconds
+    Paint_DrawString_EN(15, 30, "SSID:", &Font16, 0x0010, 0x07FF);
+    Paint_DrawString_EN(80, 30, config.wifiSSID, &Font16, 0x0010, 0xFFFF);
+    Paint_DrawString_EN(15, 55, "Pass:", &Font16, 0x0010, 0x07FF);
+    Paint_DrawString_EN(80, 55, config.wifiPassword, &Font16, 0x0010, 0xFFFF);
+    
+    Paint_DrawString_EN(15, 85, "Open:", &Font16, 0x0010, 0x07FF);
+    Paint_DrawString_EN(15, 105, "http://", &Font16, 0x0010, 0xFFE0);
+    Paint_DrawString_EN(92, 105, ip.c_str(), &Font16, 0x0010, 0xFFE0);
   }
+  
+  Paint_EndFrame();
 }
 
 void drawProgressBar(int percentage) {
+  PROFILE_SCOPE(PROF_PROGRESS_BAR);
   if (percentage < 0) percentage = 0;
   if (percentage > 100) percentage = 100;
   
-  // Skip redraw if percentage hasn't changed
-  if (percentage == lastDrawnProgress) return;
+  // Full redraw only: border, then the fill at its current value. Later
+  // changes are tweened by progressBar one column range at a time.
+  Paint_DrawRectangle(BAR_X, BAR_Y, BAR_X + BAR_WIDTH + 1, BAR_Y + BAR_HEIGHT + 1, 0x07FF, DOT_PIXEL_1X1, DRAW_FILL_EMPTY);
+  progressBar.reset(percentage);
+}
+
+// Show a message box over the current screen. Only the box is pushed, and
+// when it expires only the area under it is repainted from the screen below.
+void showToast(const char* message, unsigned long durationMs) {
+  // Replace a toast that is still up
+  if (toastUntil && !Paint_ClearOverlay()) {
+    updateDisplay(true);
+  }
+  toastUntil = 0;
   
-  int barX = 15;
-  int barY = 110;
-  int barWidth = LCD_HEIGHT - 30;  // Use LCD_HEIGHT for rotated width
-  int barHeight = 12;
+  int w = strlen(message) * Font16.Width + 20;
+  int h = 30;
+  int x = (LCD_HEIGHT - w) / 2;
+  int y = 45;
   
-  int oldFillWidth = (barWidth * lastDrawnProgress) / 100;
-  int newFillWidth = (barWidth * percentage) / 100;
+  if (!Paint_BeginOverlay(192, OVERLAY_NO_KEY)) {
+    return;  // No strip renderer: skip the toast rather than repaint the screen twice
+  }
+  Paint_ClearWindows(x, y, x + w, y + h, 0x0000);  // Translucent backdrop
+  Paint_DrawRectangle(x, y, x + w, y + h, 0x07FF, DOT_PIXEL_1X1, DRAW_FILL_EMPTY);
+  Paint_DrawString_EN(x + 10, y + 8, message, &Font16, FONT_BACKGROUND, 0xFFFF);
+  Paint_EndFrame();
   
-  // Only redraw on first call (full redraw) or when bar is shrinking
-  if (lastDrawnProgress < 0 || newFillWidth < oldFillWidth) {
-    // Clear only the portion that needs clearing (from new position to end)
-    if (newFillWidth < barWidth) {
-      Paint_DrawRectangle(barX + newFillWidth, barY, barX + barWidth, barY + barHeight, 0x0010, DOT_PIXEL_1X1, DRAW_FILL_FULL);
+  toastUntil = millis() + durationMs;
+  if (toastUntil == 0) toastUntil = 1;
+}
+
+void updateToast(unsigned long now) {
+  if (toastUntil && (long)(now - toastUntil) >= 0) {
+    toastUntil = 0;
+    if (!Paint_ClearOverlay()) {
+      updateDisplay(true);  // Base layer was lost, repaint everything
     }
   }
+}
+
+// Serial console commands, one per line
+void handleSerial() {
+  static char line[32];
+  static uint8_t length = 0;
   
-  // Draw border (only on first draw)
-  if (lastDrawnProgress < 0) {
-    Paint_DrawRectangle(barX - 1, barY - 1, barX + barWidth + 1, barY + barHeight + 1, 0x07FF, DOT_PIXEL_1X1, DRAW_FILL_EMPTY);
+  while (Serial.available()) {
+    char c = Serial.read();
+    if (c != '\n' && c != '\r') {
+      if (length < sizeof(line) - 1) line[length++] = c;
+      continue;
+    }
+    if (length == 0) continue;
+    line[length] = '\0';
+    length = 0;
+    
+    // Drawn by the UI task
+    if (strcmp(line, "bench") == 0) {
+      uiEvents.send({UI_COMMAND, CMD_BENCH, 0, nullptr});
+    } else if (strcmp(line, "check") == 0) {
+      uiEvents.send({UI_COMMAND, CMD_CHECK, 0, nullptr});
+    } else if (strcmp(line, "golden") == 0) {
+      uiEvents.send({UI_COMMAND, CMD_GOLDEN, 0, nullptr});
+    } else if (strcmp(line, "timing") == 0) {
+      printTiming();
+    } else if (strcmp(line, "power") == 0) {
+      printPower();
+    } else if (strcmp(line, "boot") == 0) {
+      printBoot();
+    } else if (strcmp(line, "stats") == 0) {
+      printStats();
+    } else if (strcmp(line, "lifetime") == 0) {
+      printLifetime();
+    } else {
+      Serial.printf("Unknown command: %s (try: bench, check, golden, timing, power, boot, stats, lifetime)\n", line);
+    }
   }
-  
-  // Draw filled portion
-  if (newFillWidth > 0) {
-    // Gradient effect: change color based on progress
-    uint16_t barColor;
-    if (percentage < 33) {
-      barColor = 0x07E0;  // Green
-    } else if (percentage < 66) {
-      barColor = 0xFFE0;  // Yellow
+}
+
+// How late jiggles fired since boot, as "timing," CSV: a summary line,
+// then one line per non-empty histogram bucket (lateness from <from_us>),
+// then the BLE task's stack: bytes never used, of its size
+void printTiming() {
+  JiggleTiming timing = scheduler.getTiming();  // unguarded copy, see /api/timing
+  Serial.printf("timing,summary,%lu,%lu,%lu,%lu\n", (unsigned long)timing.fired,
+                (unsigned long)timing.skipped, (unsigned long)timing.maxLateUs,
+                (unsigned long)(timing.fired ? timing.totalLateUs / timing.fired : 0));
+  for (uint8_t i = 0; i < JiggleTiming::BUCKETS; i++) {
+    if (timing.buckets[i]) {
+      Serial.printf("timing,bucket,%lu,%lu\n", (unsigned long)JiggleTiming::bucketStartUs(i),
+                    (unsigned long)timing.buckets[i]);
+    }
+  }
+  Serial.printf("timing,ble_stack,%lu,%lu\n", (unsigned long)bleStackUnused, (unsigned long)BLE_STACK_BYTES);
+}
+
+// Power stats since boot as one "power," CSV line: light sleep enabled,
+// awake percent, wakeups per hour, seconds covered
+void printPower() {
+  int64_t now = PowerManager::now();
+  uint32_t awake = power.awakePermille(now);
+  Serial.printf("power,%d,%lu.%lu,%lu,%lu\n", power.isSleepEnabled() ? 1 : 0, (unsigned long)(awake / 10),
+                (unsigned long)(awake % 10), (unsigned long)power.wakeupsPerHour(now),
+                (unsigned long)power.statsSeconds(now));
+}
+
+// Boot timeline as "boot," CSV: one line per phase in the order they
+// started, <phase>,<start_us>,<duration_us> (empty while it runs)
+void printBoot() {
+  BootTrace::Phase phases[BootTrace::MAX_PHASES];
+  uint8_t count = bootTrace.copy(phases);
+  for (uint8_t i = 0; i < count; i++) {
+    if (phases[i].endUs < 0) {
+      Serial.printf("boot,%s,%lu,\n", phases[i].name, (unsigned long)phases[i].startUs);
     } else {
-      barColor = 0xF800;  // Red
+      Serial.printf("boot,%s,%lu,%lu\n", phases[i].name, (unsigned long)phases[i].startUs,
+                    (unsigned long)(phases[i].endUs - phases[i].startUs));
     }
-    
-    for (int y = 0; y < barHeight; y++) {
-      Paint_DrawLine(barX, barY + y, barX + newFillWidth, barY + y, barColor, DOT_PIXEL_1X1, LINE_STYLE_SOLID);
+  }
+}
+
+// Lifetime counters as one "lifetime," CSV line: jiggles, connected
+// seconds, connections, reboots (this boot included)
+void printLifetime() {
+  LifetimeCounters counters = lifetime.get(esp_timer_get_time());
+  Serial.printf("lifetime,%lu,%lu,%lu,%lu\n", (unsigned long)counters.jiggles,
+                (unsigned long)counters.connectedSeconds, (unsigned long)counters.connections,
+                (unsigned long)counters.reboots);
+}
+
+// Time spent in each PROFILE_SCOPE since boot as "stats," CSV: one line
+// per scope (<share> in tenths of a percent of the time covered, which
+// nested scopes count twice), then its non-empty histogram buckets
+void printStats() {
+#ifdef PROFILE_SCOPES
+  ProfileStats stats[PROF_COUNT];
+  int64_t covered = Profiler::now() - Profiler::instance().copy(stats);
+  for (uint8_t i = 0; i < PROF_COUNT; i++) {
+    const ProfileStats& s = stats[i];
+    Serial.printf("stats,scope,%s,%lu,%llu,%lu,%lu,%lu\n", Profiler::name(i), (unsigned long)s.calls,
+                  (unsigned long long)s.totalUs, (unsigned long)(s.calls ? s.totalUs / s.calls : 0),
+                  (unsigned long)s.maxUs, (unsigned long)(covered > 0 ? s.totalUs * 1000 / covered : 0));
+    for (uint8_t b = 0; b < ProfileStats::BUCKETS; b++) {
+      if (s.buckets[b]) {
+        Serial.printf("stats,bucket,%s,%lu,%lu\n", Profiler::name(i), (unsigned long)ProfileStats::bucketStartUs(b),
+                      (unsigned long)s.buckets[b]);
+      }
+    }
+  }
+#else
+  Serial.println("Profiling is not built in (add -DPROFILE_SCOPES to build_flags)");
+#endif
+}
+
+// Time every drawing primitive and every screen, printing "bench," CSV
+// lines, then put the current screen back
+void runBenchmarks() {
+  if (!lcdAvailable) return;
+  Serial.println("Running render benchmarks...");
+  
+  // Take the toast down so it does not add to every frame
+  if (toastUntil) {
+    toastUntil = 0;
+    Paint_ClearOverlay();
+  }
+  
+  DisplayState savedState = currentState;
+  unsigned long savedNextJiggleIn = nextJiggleIn;
+  logFrames = false;
+  RenderBench bench;
+  RenderBench::printHeader();
+  bench.primitives(bigCountdown ? &countdownDigits : nullptr);
+  bench.kernels();
+  bench.numbers();
+  
+  static const struct { DisplayState state; const char* name; } screens[] = {
+    {STATE_WAITING, "screen_waiting"},
+    {STATE_CONNECTED, "screen_connected"},
+    {STATE_WIFI_INFO, "screen_wifi_info"},
+  };
+  for (const auto& screen : screens) {
+    currentState = screen.state;
+    bench.measure(screen.name, "screen", 3, []() { updateDisplay(true); });
+  }
+  
+  // One second of the connected screen: the countdown digits, then the
+  // bar tween it starts, run on a simulated clock so no time is spent waiting
+  unsigned long interval = displayInterval() / 1000;
+  currentState = STATE_CONNECTED;
+  nextJiggleIn = interval;
+  updateDisplay(true);
+  bench.measure("countdown_tick", "update", 10, [interval]() {
+    nextJiggleIn = nextJiggleIn > 0 ? nextJiggleIn - 1 : interval;
+    updateCountdownOnly();
+  });
+  bench.measure("bar_tween", "update", 10, [interval]() {
+    nextJiggleIn = nextJiggleIn > 0 ? nextJiggleIn - 1 : interval;
+    unsigned long now = millis();
+    progressBar.animateTo(100 - (nextJiggleIn * 100) / interval, now);
+    while (progressBar.isAnimating()) {
+      now += 5;
+      progressBar.tick(now);
     }
+  });
+  // Cost of generating curved-path reports, 1000 per iteration, so <us> is
+  // nanoseconds per report (path setup included, as at each jiggle)
+  bench.measure("curve_1000_reports", "motion", 10, []() {
+    static CurveRunner curve;
+    static uint32_t seed = 1;
+    MotionStep step;
+    for (uint16_t n = 0; n < 1000;) {
+      curve.begin(CurveRunner::MAX_DURATION, CurveRunner::MAX_AMPLITUDE, seed++);
+      while (n < 1000 && curve.next(step)) n++;
+    }
+  });
+  bool moving = isMoving;
+  bench.measure("jiggle_status", "update", 10, [&moving]() {
+    moving = !moving;
+    Paint_BeginUpdate();
+    drawStatusValue(moving, false);
+    Paint_EndFrame();
+  });
+  
+  currentState = savedState;
+  nextJiggleIn = savedNextJiggleIn;
+  logFrames = true;
+  updateDisplay(true);
+  Serial.println("Benchmarks done");
+}
+
+// Draw every screen in a fixed state and compare it pixel for pixel with
+// ScreenGolden.h ("check"), or print a new ScreenGolden.h ("golden").
+// The countdown is drawn for the default interval meanwhile, without
+// touching the saved settings. The WiFi screen is only checked with the
+// default SSID and password, since its QR code is encoded from them at boot.
+bool runScreenCheck(bool generate) {
+  if (!lcdAvailable) return false;
+  
+  if (toastUntil) {
+    toastUntil = 0;
+    Paint_ClearOverlay();
   }
   
-  lastDrawnProgress = percentage;
+  JigglerConfig config = configManager.getConfig();
+  DisplayState savedState = currentState;
+  bool savedJiggling = isJiggling;
+  bool savedMoving = isMoving;
+  bool savedPaused = isPaused;
+  bool savedBigCountdown = bigCountdown;
+  unsigned long savedJiggleCount = jiggleCount;
+  unsigned long savedNextJiggleIn = nextJiggleIn;
+  
+  JigglerConfig defaults = ConfigManager::defaults();
+  intervalOverride = defaults.jiggleInterval;
+  bigCountdown = false;
+  jiggleCount = 42;
+  nextJiggleIn = 17;
+  
+  logFrames = false;
+  ScreenCheck check(generate);
+  check.begin();
+  
+  // The pixel kernels first: every screen depends on them
+  if (!generate && !PixelCheck().run()) check.fail();
+  
+  isJiggling = false;
+  isMoving = false;
+  isPaused = false;
+  currentState = STATE_WAITING;
+  updateDisplay(true);
+  check.screen("waiting");
+  
+  isJiggling = true;
+  currentState = STATE_CONNECTED;
+  updateDisplay(true);
+  check.screen("connected");
+  
+  // One second later: changed digits, bar tweened on a simulated clock
+  nextJiggleIn = 16;
+  updateCountdownOnly();
+  unsigned long now = millis();
+  while (progressBar.isAnimating()) {
+    now += 5;
+    progressBar.tick(now);
+  }
+  check.screen("countdown_tick");
+  
+  // A jiggle starts: only the status word changes
+  isMoving = true;
+  Paint_BeginUpdate();
+  drawStatusValue(true, false);
+  Paint_EndFrame();
+  check.screen("moving");
+  isMoving = false;
+  
+  if (strcmp(config.wifiSSID, defaults.wifiSSID) == 0 &&
+      strcmp(config.wifiPassword, defaults.wifiPassword) == 0) {
+    currentState = STATE_WIFI_INFO;
+    updateDisplay(true);
+    check.screen("wifi_info");
+  } else {
+    check.skip("wifi_info", "WiFi settings changed");
+  }
+  
+  bool passed = check.finish();
+  
+  intervalOverride = 0;
+  currentState = savedState;
+  isJiggling = savedJiggling;
+  isMoving = savedMoving;
+  isPaused = savedPaused;
+  bigCountdown = savedBigCountdown;
+  jiggleCount = savedJiggleCount;
+  nextJiggleIn = savedNextJiggleIn;
+  logFrames = true;
+  updateDisplay(true);
+  return passed;
 }
@@ -0,0 +1,38 @@
+#ifndef TEST_CHECK_H
+#define TEST_CHECK_H
+
+// Minimal assertions for the host tests. A failed check prints where and
+// what, and the test keeps going; testResult() is the exit code.
+
+#include <stdio.h>
+
+inline int& testFailures() {
+  static int failures = 0;
+  return failures;
+}
+
+#define CHECK(cond)                                                     \
+  do {                                                                  \
+    if (!(cond)) {                                                      \
+      printf("%s:%d: CHECK(%s) failed\n", __FILE__, __LINE__, #cond);   \
+      testFailures()++;                                                 \
+    }                                                                   \
+  } while (0)
+
+#define CHECK_EQ(actual, expected)                                      \
+  do {                                                                  \
+    long long a_ = (long long)(actual);                                 \
+    long long e_ = (long long)(expected);                               \
+    if (a_ != e_) {                                                     \
+      printf("%s:%d: %s is %lld, expected %lld\n", __FILE__, __LINE__,  \
+             #actual, a_, e_);                                          \
+      testFailures()++;                                                 \
+    }                                                                   \
+  } while (0)
+
+inline int testResult(const char* name) {
+  printf("%s: %s (%d failed)\n", name, testFailures() ? "FAIL" : "ok", testFailures());
+  return testFailures() ? 1 : 0;
+}
+
+#endif
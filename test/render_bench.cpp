@@ -0,0 +1,57 @@
+// Render benchmarks on the host: the firmware's own "bench" command
+// (runBenchmarks() in main.cpp, RenderBench.h) against the emulated panel,
+// timed on the wall clock.
+//
+//   render_bench [output.csv]
+//
+// Prints the bench CSV (see README.md) and writes it to output.csv if
+// given. The pixel, byte and window counts are the same as on the device;
+// only <us> depends on the machine. Fails if the LCD driver's counters
+// disagree with the bytes the panel actually received.
+
+#include "Check.h"
+#include "HostPanel.h"
+#include "LCD_Driver.h"
+#include "Config.h"
+#include "WebServer.h"
+
+extern ConfigManager configManager;
+extern JigglerWebServer webServer;
+void startDisplay();
+void encodeSetupCodes();
+void runBenchmarks();
+
+int main(int argc, char** argv) {
+  Serial.setEcho(false);
+  hostUseRealClock(true);
+  configManager.begin();
+  webServer.begin(&configManager);
+  startDisplay();
+  encodeSetupCodes();
+
+  LCD_BUS_STATS start = LCD_Bus;
+  hostPanel.resetCounters();
+  Serial.output().clear();
+  runBenchmarks();
+
+  FILE* csv = argc > 1 ? fopen(argv[1], "w") : nullptr;
+  if (argc > 1 && !csv) printf("Cannot write %s\n", argv[1]);
+  const std::string& output = Serial.output();
+  for (size_t at = 0, end; at < output.size(); at = end + 1) {
+    end = output.find('\n', at);
+    if (end == std::string::npos) end = output.size();
+    std::string line = output.substr(at, end - at);
+    if (!line.empty() && line.back() == '\r') line.pop_back();
+    if (line.compare(0, 6, "bench,") != 0) continue;
+    puts(line.c_str());
+    if (csv) fprintf(csv, "%s\n", line.c_str());
+  }
+  if (csv) fclose(csv);
+
+  CHECK(output.find("Benchmarks done") != std::string::npos);
+  CHECK_EQ(LCD_Bus.Bytes - start.Bytes, hostPanel.bytes);
+  CHECK_EQ(LCD_Bus.PixelBytes - start.PixelBytes, hostPanel.pixelBytes);
+  CHECK_EQ(LCD_Bus.Windows - start.Windows, hostPanel.windows);
+  CHECK_EQ(hostPanel.outside, 0);
+  return testResult("render_bench");
+}
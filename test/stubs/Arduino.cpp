@@ -0,0 +1,135 @@
+// Arduino core, SPI and panel state for the host test build
+
+#include <Arduino.h>
+#include <SPI.h>
+#include <stdarg.h>
+#include <chrono>
+#include <thread>
+#include "HostPanel.h"
+
+HostSerial Serial;
+SPIClass SPI;
+HostPanel hostPanel;
+
+// Clock
+
+static uint64_t simulatedUs = 0;
+static bool realClock = false;
+
+uint64_t hostMicros() {
+  if (!realClock) return simulatedUs;
+  static const auto start = std::chrono::steady_clock::now();
+  return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count();
+}
+
+void hostAdvance(uint64_t us) {
+  simulatedUs += us;
+}
+
+void hostUseRealClock(bool on) {
+  realClock = on;
+}
+
+void delay(unsigned long ms) {
+  if (realClock) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(ms));
+  } else {
+    hostAdvance((uint64_t)ms * 1000);
+  }
+}
+
+// GPIO
+
+static const uint8_t PIN_DC = 8;  // DEV_DC_PIN
+static const uint8_t PIN_CS = 10;  // DEV_CS_PIN
+static uint8_t pins[64];
+
+void pinMode(uint8_t, uint8_t) {}
+
+void digitalWrite(uint8_t pin, uint8_t value) {
+  if (pin >= sizeof(pins)) return;
+  if (pin == PIN_CS && pins[pin] && !value) hostPanel.selects++;
+  pins[pin] = value;
+}
+
+int digitalRead(uint8_t pin) {
+  return pin < sizeof(pins) ? pins[pin] : LOW;
+}
+
+void analogWrite(uint8_t, int) {}
+
+// Serial
+
+size_t HostSerial::printf(const char* format, ...) {
+  char buffer[512];
+  va_list args;
+  va_start(args, format);
+  int length = vsnprintf(buffer, sizeof(buffer), format, args);
+  va_end(args);
+  if (length < 0) return 0;
+  if ((size_t)length >= sizeof(buffer)) length = sizeof(buffer) - 1;
+  put(buffer, length);
+  return length;
+}
+
+// Panel
+
+static uint8_t command;
+static uint8_t parameter;      // parameter bytes since the command
+static uint16_t window[4];     // x0, x1, y0, y1
+static uint16_t cursorX, cursorY;
+static uint8_t highByte;
+static bool haveHighByte;
+
+void HostPanel::resetCounters() {
+  bytes = pixelBytes = commands = selects = windows = outside = 0;
+}
+
+void HostPanel::fill(uint16_t color) {
+  for (uint16_t y = 0; y < ROWS; y++) {
+    for (uint16_t x = 0; x < COLUMNS; x++) memory[y][x] = color;
+  }
+}
+
+static void writePixel(uint16_t color) {
+  if (cursorX < HostPanel::COLUMNS && cursorY < HostPanel::ROWS) {
+    hostPanel.memory[cursorY][cursorX] = color;
+  } else {
+    hostPanel.outside++;
+  }
+  if (++cursorX > window[1]) {
+    cursorX = window[0];
+    if (++cursorY > window[3]) cursorY = window[2];
+  }
+}
+
+void hostSpiWrite(uint8_t data) {
+  hostPanel.bytes++;
+  if (!pins[PIN_DC]) {
+    command = data;
+    parameter = 0;
+    hostPanel.commands++;
+    if (command == 0x2C) {
+      cursorX = window[0];
+      cursorY = window[2];
+      haveHighByte = false;
+    }
+    return;
+  }
+
+  if (command == 0x2A || command == 0x2B) {
+    if (parameter < 4) {
+      uint16_t& edge = window[(command == 0x2B ? 2 : 0) + parameter / 2];
+      edge = parameter & 1 ? (edge & 0xFF00) | data : (uint16_t)(data << 8);
+    }
+    if (++parameter == 4 && command == 0x2B) hostPanel.windows++;
+  } else if (command == 0x2C) {
+    hostPanel.pixelBytes++;
+    if (haveHighByte) {
+      writePixel((uint16_t)(highByte << 8) | data);
+    } else {
+      highByte = data;
+    }
+    haveHighByte = !haveHighByte;
+  }
+}
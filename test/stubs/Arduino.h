@@ -0,0 +1,112 @@
+#ifndef HOST_ARDUINO_H
+#define HOST_ARDUINO_H
+
+// The parts of the Arduino core the firmware uses, for the host test build.
+// Time is simulated: it only moves when a test (or delay()) advances it,
+// unless hostUseRealClock() is called.
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include <math.h>
+#include <algorithm>
+#include <string>
+#include "WString.h"
+
+using std::max;
+using std::min;
+
+#define HIGH 1
+#define LOW 0
+#define INPUT 0
+#define OUTPUT 1
+
+#define constrain(v, lo, hi) ((v) < (lo) ? (lo) : ((v) > (hi) ? (hi) : (v)))
+
+// Clock
+uint64_t hostMicros();
+void hostAdvance(uint64_t us);
+void hostUseRealClock(bool on);
+
+inline unsigned long micros() { return (unsigned long)hostMicros(); }
+inline unsigned long millis() { return (unsigned long)(hostMicros() / 1000); }
+void delay(unsigned long ms);
+inline void delayMicroseconds(unsigned int us) { hostAdvance(us); }
+
+// GPIO, recorded per pin
+void pinMode(uint8_t pin, uint8_t mode);
+void digitalWrite(uint8_t pin, uint8_t value);
+int digitalRead(uint8_t pin);
+void analogWrite(uint8_t pin, int value);
+
+// Same sequence on every run
+inline long random(long max) { return max > 0 ? rand() % max : 0; }
+inline long random(long min, long max) { return max > min ? min + rand() % (max - min) : min; }
+inline void randomSeed(unsigned long seed) { srand(seed); }
+
+// Output goes to stdout, and is also kept in output() for tests to read.
+// Input is fed by the test.
+class HostSerial {
+private:
+  std::string out;
+  std::string in;
+  bool echo = true;
+
+  void put(const char* text, size_t length) {
+    out.append(text, length);
+    if (echo) fwrite(text, 1, length, stdout);
+  }
+
+public:
+  void begin(unsigned long) {}
+
+  size_t write(uint8_t c) {
+    char ch = c;
+    put(&ch, 1);
+    return 1;
+  }
+  size_t write(const uint8_t* data, size_t length) {
+    put((const char*)data, length);
+    return length;
+  }
+
+  size_t print(const char* text) {
+    put(text, strlen(text));
+    return strlen(text);
+  }
+  size_t print(const String& text) { return print(text.c_str()); }
+  size_t print(char c) { return write((uint8_t)c); }
+  size_t print(long v) { return printf("%ld", v); }
+  size_t print(int v) { return print((long)v); }
+  size_t print(unsigned long v) { return printf("%lu", v); }
+  size_t print(unsigned int v) { return print((unsigned long)v); }
+  size_t print(double v, int digits = 2) { return printf("%.*f", digits, v); }
+
+  template <typename T>
+  size_t println(T v) {
+    size_t n = print(v);
+    return n + println();
+  }
+  size_t println() { return print("\r\n"); }
+
+  size_t printf(const char* format, ...) __attribute__((format(printf, 2, 3)));
+
+  int available() { return (int)in.size(); }
+  int read() {
+    if (in.empty()) return -1;
+    int c = (uint8_t)in[0];
+    in.erase(0, 1);
+    return c;
+  }
+
+  // Test side
+  void feed(const char* text) { in += text; }
+  std::string& output() { return out; }
+  void setEcho(bool on) { echo = on; }
+};
+
+extern HostSerial Serial;
+
+#endif
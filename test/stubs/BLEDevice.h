@@ -0,0 +1,78 @@
+#ifndef HOST_BLE_DEVICE_H
+#define HOST_BLE_DEVICE_H
+
+// The Bluedroid types and calls the firmware uses. Events are delivered
+// by the test through the registered handlers (BLEDevice::gapHandler()).
+
+#include <stdint.h>
+
+typedef uint8_t esp_bd_addr_t[6];
+
+typedef enum {
+  ESP_BT_STATUS_SUCCESS = 0,
+  ESP_BT_STATUS_FAIL,
+} esp_bt_status_t;
+
+typedef enum {
+  ESP_GAP_BLE_ADV_START_COMPLETE_EVT = 6,
+  ESP_GAP_BLE_READ_RSSI_COMPLETE_EVT = 20,
+} esp_gap_ble_cb_event_t;
+
+typedef union {
+  struct {
+    esp_bt_status_t status;
+  } adv_start_cmpl;
+  struct {
+    esp_bt_status_t status;
+    int8_t rssi;
+    esp_bd_addr_t remote_addr;
+  } read_rssi_cmpl;
+} esp_ble_gap_cb_param_t;
+
+typedef enum {
+  ESP_GATTS_CONNECT_EVT = 14,
+  ESP_GATTS_DISCONNECT_EVT = 15,
+} esp_gatts_cb_event_t;
+
+typedef uint8_t esp_gatt_if_t;
+
+typedef union {
+  struct {
+    uint16_t conn_id;
+    esp_bd_addr_t remote_bda;
+  } connect;
+  struct {
+    uint16_t conn_id;
+    esp_bd_addr_t remote_bda;
+  } disconnect;
+} esp_ble_gatts_cb_param_t;
+
+typedef void (*HostGapHandler)(esp_gap_ble_cb_event_t, esp_ble_gap_cb_param_t*);
+typedef void (*HostGattsHandler)(esp_gatts_cb_event_t, esp_gatt_if_t, esp_ble_gatts_cb_param_t*);
+
+class BLEDevice {
+public:
+  static HostGapHandler& gapHandler() {
+    static HostGapHandler handler = nullptr;
+    return handler;
+  }
+  static HostGattsHandler& gattsHandler() {
+    static HostGattsHandler handler = nullptr;
+    return handler;
+  }
+  static void setCustomGapHandler(HostGapHandler handler) { gapHandler() = handler; }
+  static void setCustomGattsHandler(HostGattsHandler handler) { gattsHandler() = handler; }
+};
+
+// Counted; the answer is a GAP event the test sends
+inline uint32_t& hostRssiReads() {
+  static uint32_t reads = 0;
+  return reads;
+}
+
+inline int esp_ble_gap_read_rssi(esp_bd_addr_t) {
+  hostRssiReads()++;
+  return 0;
+}
+
+#endif
@@ -0,0 +1,5 @@
+// BLE mouse stand-in state for the host test build
+
+#include <BleMouse.h>
+
+HostMouse hostMouse;
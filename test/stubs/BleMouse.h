@@ -0,0 +1,50 @@
+#ifndef HOST_BLE_MOUSE_H
+#define HOST_BLE_MOUSE_H
+
+// ESP32-BLE-Mouse stand-in: the test sets whether a host is connected, and
+// every report the firmware sends is recorded with its time
+
+#include <Arduino.h>
+#include <mutex>
+#include <vector>
+#include "BLEDevice.h"
+
+#define MOUSE_LEFT 1
+#define MOUSE_RIGHT 2
+#define MOUSE_MIDDLE 4
+
+struct HostReport {
+  uint64_t us;
+  int8_t x, y, wheel;
+  uint8_t click;
+};
+
+struct HostMouse {
+  volatile bool connected = false;
+  std::mutex lock;
+  std::vector<HostReport> reports;
+
+  void add(const HostReport& report) {
+    std::lock_guard<std::mutex> guard(lock);
+    reports.push_back(report);
+  }
+};
+
+extern HostMouse hostMouse;
+
+class BleMouse {
+public:
+  BleMouse(std::string deviceName = "", std::string manufacturer = "", uint8_t batteryLevel = 100) {}
+  void begin() {}
+  void end() {}
+  bool isConnected() { return hostMouse.connected; }
+  void move(signed char x, signed char y, signed char wheel = 0, signed char hWheel = 0) {
+    hostMouse.add({hostMicros(), x, y, wheel, 0});
+  }
+  void click(uint8_t buttons = MOUSE_LEFT) { hostMouse.add({hostMicros(), 0, 0, 0, buttons}); }
+  void press(uint8_t buttons = MOUSE_LEFT) {}
+  void release(uint8_t buttons = MOUSE_LEFT) {}
+  void setBatteryLevel(uint8_t) {}
+};
+
+#endif
@@ -0,0 +1,44 @@
+#ifndef HOST_PANEL_H
+#define HOST_PANEL_H
+
+#include <stdint.h>
+
+// The ST7789 behind the SPI stand-in: decodes the byte stream the LCD
+// driver sends (DC and CS from digitalWrite, bytes from SPI) into panel
+// memory, and counts the traffic independently of the driver's LCD_Bus.
+//
+// Only what the driver uses is modelled: CASET (0x2A) and RASET (0x2B) set
+// the window, RAMWR (0x2C) writes pixels high byte first, advancing across
+// the window and wrapping to its top. Other commands are counted and their
+// parameters ignored. Memory is 240 x 320, the 1.14" glass shows columns
+// 52-186 and rows 40-279 of it.
+struct HostPanel {
+  static const uint16_t COLUMNS = 240;
+  static const uint16_t ROWS = 320;
+  static const uint16_t VISIBLE_X = 52;
+  static const uint16_t VISIBLE_Y = 40;
+  static const uint16_t VISIBLE_COLUMNS = 135;
+  static const uint16_t VISIBLE_ROWS = 240;
+
+  uint16_t memory[ROWS][COLUMNS];
+
+  // Traffic since the last resetCounters()
+  uint64_t bytes;
+  uint64_t pixelBytes;   // bytes written to panel memory
+  uint64_t commands;
+  uint64_t selects;      // CS falling edges
+  uint64_t windows;      // RASET commands completed (the driver sends CASET first)
+  uint64_t outside;      // pixels written outside panel memory
+
+  void resetCounters();
+  void fill(uint16_t color);
+
+  // A pixel of the visible area, in memory orientation
+  uint16_t visible(uint16_t x, uint16_t y) const {
+    return memory[VISIBLE_Y + y][VISIBLE_X + x];
+  }
+};
+
+extern HostPanel hostPanel;
+
+#endif
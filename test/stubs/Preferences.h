@@ -0,0 +1,119 @@
+#ifndef HOST_PREFERENCES_H
+#define HOST_PREFERENCES_H
+
+// NVS stand-in: one process-wide store, keyed by namespace and key, that
+// outlives Preferences objects (as flash outlives a reboot) and counts the
+// writes to each key, so tests can check how often the firmware commits.
+
+#include <Arduino.h>
+#include <map>
+#include <string>
+#include <vector>
+
+class Preferences {
+public:
+  typedef std::map<std::string, std::vector<uint8_t>> Store;
+
+  // Every namespace; "<namespace>/<key>" -> bytes
+  static Store& store() {
+    static Store values;
+    return values;
+  }
+  static std::map<std::string, uint32_t>& writes() {
+    static std::map<std::string, uint32_t> counts;
+    return counts;
+  }
+  static uint32_t totalWrites() {
+    uint32_t total = 0;
+    for (const auto& entry : writes()) total += entry.second;
+    return total;
+  }
+  static void reset() {
+    store().clear();
+    writes().clear();
+  }
+
+private:
+  std::string space;
+  bool open = false;
+
+  std::string path(const char* key) const { return space + "/" + key; }
+
+  size_t put(const char* key, const void* data, size_t length) {
+    if (!open) return 0;
+    const uint8_t* bytes = (const uint8_t*)data;
+    store()[path(key)].assign(bytes, bytes + length);
+    writes()[path(key)]++;
+    return length;
+  }
+
+  const std::vector<uint8_t>* find(const char* key) const {
+    if (!open) return nullptr;
+    auto it = store().find(path(key));
+    return it == store().end() ? nullptr : &it->second;
+  }
+
+  template <typename T>
+  T get(const char* key, T fallback) const {
+    const std::vector<uint8_t>* value = find(key);
+    if (!value || value->size() != sizeof(T)) return fallback;
+    T v;
+    memcpy(&v, value->data(), sizeof(T));
+    return v;
+  }
+
+public:
+  bool begin(const char* name, bool readOnly = false) {
+    space = name;
+    open = true;
+    return true;
+  }
+  void end() { open = false; }
+
+  bool clear() {
+    if (!open) return false;
+    for (auto it = store().begin(); it != store().end();) {
+      it = it->first.compare(0, space.size() + 1, space + "/") == 0 ? store().erase(it) : std::next(it);
+    }
+    return true;
+  }
+  bool remove(const char* key) { return open && store().erase(path(key)) > 0; }
+  bool isKey(const char* key) const { return find(key) != nullptr; }
+
+  size_t putBool(const char* key, bool v) { return put(key, &v, 1); }
+  size_t putUChar(const char* key, uint8_t v) { return put(key, &v, sizeof(v)); }
+  size_t putUShort(const char* key, uint16_t v) { return put(key, &v, sizeof(v)); }
+  size_t putInt(const char* key, int32_t v) { return put(key, &v, sizeof(v)); }
+  size_t putUInt(const char* key, uint32_t v) { return put(key, &v, sizeof(v)); }
+  size_t putULong(const char* key, uint32_t v) { return put(key, &v, sizeof(v)); }
+  size_t putULong64(const char* key, uint64_t v) { return put(key, &v, sizeof(v)); }
+  size_t putString(const char* key, const char* v) { return put(key, v, strlen(v) + 1) - 1; }
+  size_t putBytes(const char* key, const void* v, size_t length) { return put(key, v, length); }
+
+  bool getBool(const char* key, bool fallback = false) const { return get<uint8_t>(key, fallback) != 0; }
+  uint8_t getUChar(const char* key, uint8_t fallback = 0) const { return get(key, fallback); }
+  uint16_t getUShort(const char* key, uint16_t fallback = 0) const { return get(key, fallback); }
+  int32_t getInt(const char* key, int32_t fallback = 0) const { return get(key, fallback); }
+  uint32_t getUInt(const char* key, uint32_t fallback = 0) const { return get(key, fallback); }
+  uint32_t getULong(const char* key, uint32_t fallback = 0) const { return get(key, fallback); }
+  uint64_t getULong64(const char* key, uint64_t fallback = 0) const { return get(key, fallback); }
+
+  size_t getString(const char* key, char* out, size_t size) const {
+    const std::vector<uint8_t>* value = find(key);
+    if (!value || !size || value->size() > size) return 0;
+    memcpy(out, value->data(), value->size());
+    return value->size();
+  }
+  size_t getBytesLength(const char* key) const {
+    const std::vector<uint8_t>* value = find(key);
+    return value ? value->size() : 0;
+  }
+  size_t getBytes(const char* key, void* out, size_t size) const {
+    const std::vector<uint8_t>* value = find(key);
+    if (!value || value->size() > size) return 0;
+    memcpy(out, value->data(), value->size());
+    return value->size();
+  }
+};
+
+#endif
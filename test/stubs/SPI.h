@@ -0,0 +1,33 @@
+#ifndef HOST_SPI_H
+#define HOST_SPI_H
+
+#include <Arduino.h>
+
+#define SPI_MODE3 3
+#define MSBFIRST 1
+#define SPI_CLOCK_DIV2 2
+
+// Every byte written goes to hostSpiWrite(), where the emulated panel
+// (HostPanel.h) picks it up
+void hostSpiWrite(uint8_t data);
+
+class SPIClass {
+public:
+  void begin() {}
+  void setDataMode(uint8_t) {}
+  void setBitOrder(uint8_t) {}
+  void setClockDivider(uint32_t) {}
+  void setFrequency(uint32_t) {}
+
+  uint8_t transfer(uint8_t data) {
+    hostSpiWrite(data);
+    return 0;
+  }
+  void writeBytes(const uint8_t* data, uint32_t length) {
+    for (uint32_t i = 0; i < length; i++) hostSpiWrite(data[i]);
+  }
+};
+
+extern SPIClass SPI;
+
+#endif
@@ -0,0 +1,102 @@
+#ifndef HOST_WSTRING_H
+#define HOST_WSTRING_H
+
+// Arduino String on top of std::string, with the members the firmware uses
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string>
+
+class String {
+private:
+  std::string s;
+
+  template <typename T>
+  static std::string format(const char* spec, T v) {
+    char buffer[32];
+    snprintf(buffer, sizeof(buffer), spec, v);
+    return buffer;
+  }
+
+public:
+  String() {}
+  String(const char* text) : s(text ? text : "") {}
+  String(const std::string& text) : s(text) {}
+  explicit String(char c) : s(1, c) {}
+  String(int v) : s(format("%d", v)) {}
+  String(unsigned int v) : s(format("%u", v)) {}
+  String(long v) : s(format("%ld", v)) {}
+  String(unsigned long v) : s(format("%lu", v)) {}
+  String(long long v) : s(format("%lld", v)) {}
+  String(unsigned long long v) : s(format("%llu", v)) {}
+  String(float v, unsigned int decimals = 2) : String((double)v, decimals) {}
+  String(double v, unsigned int decimals = 2) {
+    char buffer[48];
+    snprintf(buffer, sizeof(buffer), "%.*f", (int)decimals, v);
+    s = buffer;
+  }
+
+  const char* c_str() const { return s.c_str(); }
+  unsigned int length() const { return s.size(); }
+  void reserve(unsigned int size) { s.reserve(size); }
+  char operator[](unsigned int i) const { return i < s.size() ? s[i] : 0; }
+  char charAt(unsigned int i) const { return (*this)[i]; }
+
+  bool equals(const String& other) const { return s == other.s; }
+  bool operator==(const String& other) const { return s == other.s; }
+  bool operator==(const char* other) const { return s == other; }
+  bool operator!=(const String& other) const { return s != other.s; }
+  bool operator!=(const char* other) const { return s != other; }
+
+  bool startsWith(const String& prefix) const { return s.compare(0, prefix.s.size(), prefix.s) == 0; }
+  bool endsWith(const String& suffix) const {
+    return s.size() >= suffix.s.size() && s.compare(s.size() - suffix.s.size(), suffix.s.size(), suffix.s) == 0;
+  }
+  int indexOf(char c, unsigned int from = 0) const {
+    size_t at = s.find(c, from);
+    return at == std::string::npos ? -1 : (int)at;
+  }
+  int indexOf(const String& text, unsigned int from = 0) const {
+    size_t at = s.find(text.s, from);
+    return at == std::string::npos ? -1 : (int)at;
+  }
+  String substring(unsigned int from) const { return from < s.size() ? String(s.substr(from)) : String(); }
+  String substring(unsigned int from, unsigned int to) const {
+    if (to > s.size()) to = s.size();
+    return from < to ? String(s.substr(from, to - from)) : String();
+  }
+
+  long toInt() const { return atol(s.c_str()); }
+  float toFloat() const { return atof(s.c_str()); }
+  void toCharArray(char* out, unsigned int size) const {
+    if (!size) return;
+    size_t n = s.copy(out, size - 1);
+    out[n] = '\0';
+  }
+  void trim() {
+    size_t first = s.find_first_not_of(" \t\r\n");
+    size_t last = s.find_last_not_of(" \t\r\n");
+    s = first == std::string::npos ? "" : s.substr(first, last - first + 1);
+  }
+
+  String& operator+=(const String& other) {
+    s += other.s;
+    return *this;
+  }
+  String& operator+=(const char* other) {
+    s += other;
+    return *this;
+  }
+  String& operator+=(char c) {
+    s += c;
+    return *this;
+  }
+
+  friend String operator+(const String& a, const String& b) { return String(a.s + b.s); }
+  friend String operator+(const String& a, const char* b) { return String(a.s + b); }
+  friend String operator+(const char* a, const String& b) { return String(a + b.s); }
+  friend String operator+(const String& a, char c) { return String(a.s + c); }
+};
+
+#endif
@@ -0,0 +1,23 @@
+// WiFi and TCP stand-ins for the host test build
+
+#include <WiFi.h>
+#include <deque>
+
+HostWiFi WiFi;
+HostEsp ESP;
+
+static std::deque<std::shared_ptr<HostConnection>> pending;
+
+std::shared_ptr<HostConnection> hostConnect(const std::string& request) {
+  auto connection = std::make_shared<HostConnection>();
+  connection->request = request;
+  pending.push_back(connection);
+  return connection;
+}
+
+WiFiClient WiFiServer::available() {
+  if (pending.empty()) return WiFiClient();
+  WiFiClient client(pending.front());
+  pending.pop_front();
+  return client;
+}
@@ -0,0 +1,109 @@
+#ifndef HOST_WIFI_H
+#define HOST_WIFI_H
+
+// WiFi AP and TCP stand-ins. A test queues a connection with hostConnect();
+// the next WiFiServer::available() hands it to the firmware as a client,
+// and what the firmware writes back collects in the connection.
+
+#include <Arduino.h>
+#include <memory>
+#include <vector>
+
+#define WIFI_AP 2
+
+class IPAddress {
+private:
+  uint8_t bytes[4];
+
+public:
+  IPAddress(uint8_t a = 0, uint8_t b = 0, uint8_t c = 0, uint8_t d = 0) : bytes{a, b, c, d} {}
+  uint8_t operator[](int i) const { return bytes[i]; }
+  String toString() const {
+    char text[16];
+    snprintf(text, sizeof(text), "%u.%u.%u.%u", bytes[0], bytes[1], bytes[2], bytes[3]);
+    return String(text);
+  }
+  operator String() const { return toString(); }
+};
+
+struct HostConnection {
+  std::string request;        // bytes from the browser
+  size_t read = 0;
+  std::string response;       // bytes from the firmware
+  std::vector<size_t> writes; // size of each write() call
+  bool keepOpen = false;      // stays connected after the request is read
+  bool stopped = false;
+};
+
+// Queue a connection carrying request
+std::shared_ptr<HostConnection> hostConnect(const std::string& request);
+
+class WiFiClient {
+private:
+  std::shared_ptr<HostConnection> connection;
+
+public:
+  WiFiClient() {}
+  explicit WiFiClient(std::shared_ptr<HostConnection> c) : connection(c) {}
+
+  explicit operator bool() const { return connection != nullptr; }
+  bool connected() const {
+    return connection && !connection->stopped &&
+           (connection->keepOpen || connection->read < connection->request.size());
+  }
+  int available() const { return connection ? (int)(connection->request.size() - connection->read) : 0; }
+  int read() { return available() ? (uint8_t)connection->request[connection->read++] : -1; }
+  String readStringUntil(char end) {
+    String text;
+    for (int c; (c = read()) >= 0 && c != end;) text += (char)c;
+    return text;
+  }
+
+  size_t write(const uint8_t* data, size_t length) {
+    if (!connection || connection->stopped) return 0;
+    connection->response.append((const char*)data, length);
+    connection->writes.push_back(length);
+    return length;
+  }
+  size_t write(uint8_t c) { return write(&c, 1); }
+  size_t print(const char* text) { return write((const uint8_t*)text, strlen(text)); }
+  size_t print(const String& text) { return print(text.c_str()); }
+  size_t println(const char* text = "") { return print(text) + print("\r\n"); }
+  size_t println(const String& text) { return println(text.c_str()); }
+
+  int fd() const { return -1; }  // never writable for select()
+  void setNoDelay(bool) {}
+  void flush() {}
+  void stop() {
+    if (connection) connection->stopped = true;
+  }
+};
+
+class WiFiServer {
+public:
+  explicit WiFiServer(uint16_t) {}
+  void begin() {}
+  void setNoDelay(bool) {}
+  WiFiClient available();
+};
+
+class HostWiFi {
+public:
+  void mode(int) {}
+  bool softAP(const char*, const char*) { return true; }
+  IPAddress softAPIP() { return IPAddress(192, 168, 4, 1); }
+  void setSleep(bool) {}
+};
+
+extern HostWiFi WiFi;
+
+class HostEsp {
+public:
+  bool restarted = false;
+  void restart() { restarted = true; }
+  uint32_t getFreeHeap() { return 200000; }
+};
+
+extern HostEsp ESP;
+
+#endif
@@ -0,0 +1,9 @@
+#ifndef HOST_ESP_TIMER_H
+#define HOST_ESP_TIMER_H
+
+#include <Arduino.h>
+
+// Microseconds since boot, on the same clock as micros()
+inline int64_t esp_timer_get_time() { return (int64_t)hostMicros(); }
+
+#endif
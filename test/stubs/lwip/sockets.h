@@ -0,0 +1,9 @@
+#ifndef HOST_LWIP_SOCKETS_H
+#define HOST_LWIP_SOCKETS_H
+
+// lwIP offers the BSD socket calls; the host has the real ones
+#include <sys/select.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+
+#endif
@@ -0,0 +1,288 @@
+// ActivityHistory: the minute-to-hour roll-up, field clamping, both rings
+// wrapping, the export decoded chunk by chunk, and the hours kept across
+// reboots in NVS, with the time the device was off
+
+#include "Check.h"
+#include "ActivityHistory.h"
+#include <vector>
+
+static const int64_t MINUTE = 60000000;
+static const int64_t HOUR = 60 * MINUTE;
+
+// Big rings: off the stack
+static ActivityHistory* fresh(int64_t nowUs) {
+  ActivityHistory* history = new ActivityHistory();
+  history->begin(nowUs);
+  return history;
+}
+
+static void testRollUp() {
+  Preferences::reset();
+  ActivityHistory* history = fresh(0);
+  uint16_t v[HISTORY_FIELDS];
+  history->setConnected(true, 0);
+  for (int m = 0; m < 60; m++) {
+    history->jiggled(m * MINUTE + 1000);
+    history->jiggled(m * MINUTE + 2000);
+    history->addRssi(m % 2 ? -60 : -70, m * MINUTE + 3000);
+  }
+  history->setConnected(false, 59 * MINUTE + 30000000);
+
+  // 59 minutes closed: no hour yet
+  history->tick(60 * MINUTE - 1);
+  CHECK(!history->getHour(0, v));
+  CHECK(history->getMinute(0, v));
+  CHECK_EQ(v[HISTORY_JIGGLES], 2);
+  CHECK_EQ(v[HISTORY_CONNECTED], 60);
+  CHECK(!history->getMinute(59, v));
+
+  // The 60th closes the hour
+  history->tick(60 * MINUTE);
+  CHECK(history->getMinute(0, v));
+  CHECK_EQ(v[HISTORY_CONNECTED], 30);
+  CHECK_EQ(v[HISTORY_DISCONNECTS], 1);
+  CHECK(history->getHour(0, v));
+  CHECK_EQ(v[HISTORY_JIGGLES], 120);
+  CHECK_EQ(v[HISTORY_CONNECTED], 59 * 60 + 30);
+  CHECK_EQ(v[HISTORY_DISCONNECTS], 1);
+  CHECK_EQ(v[HISTORY_RSSI_MIN], 70);
+  CHECK_EQ(v[HISTORY_RSSI_AVG], 65);
+  CHECK(!history->getHour(1, v));
+}
+
+// Counts stop at the width of their field
+static void testClamping() {
+  Preferences::reset();
+  ActivityHistory* history = fresh(0);
+  uint16_t v[HISTORY_FIELDS];
+  for (int i = 0; i < 300; i++) history->jiggled(1000);
+  for (int i = 0; i < 20; i++) {
+    history->setConnected(true, 2000 + i * 2);
+    history->setConnected(false, 2001 + i * 2);
+  }
+  history->addRssi(-128, 3000);
+  history->addRssi(0, 3000);
+  history->tick(MINUTE);
+  CHECK(history->getMinute(0, v));
+  CHECK_EQ(v[HISTORY_JIGGLES], 255);
+  CHECK_EQ(v[HISTORY_DISCONNECTS], 15);
+  CHECK_EQ(v[HISTORY_RSSI_MIN], 127);
+  CHECK_EQ(v[HISTORY_RSSI_AVG], 64);
+
+  // The hour sums what came in, past the minutes' limits, up to its own
+  for (int m = 1; m < 60; m++) {
+    for (int i = 0; i < 1200; i++) history->jiggled(m * MINUTE);
+    for (int i = 0; i < 20; i++) {
+      history->setConnected(true, m * MINUTE + 2000 + i * 2);
+      history->setConnected(false, m * MINUTE + 2001 + i * 2);
+    }
+  }
+  history->tick(HOUR);
+  CHECK(history->getHour(0, v));
+  CHECK_EQ(v[HISTORY_JIGGLES], 0xFFFF);
+  CHECK_EQ(v[HISTORY_DISCONNECTS], 255);
+  CHECK_EQ(v[HISTORY_RSSI_MIN], 127);
+}
+
+// Minute m has m % 200 jiggles; a day and a minute wraps the minute ring,
+// 721 hours the hour ring
+static void testWrap() {
+  Preferences::reset();
+  ActivityHistory* history = fresh(0);
+  uint16_t v[HISTORY_FIELDS];
+  const int64_t minutes = 721 * 60;
+  for (int64_t m = 0; m < minutes; m++) {
+    for (int i = 0; i < m % 200; i++) history->jiggled(m * MINUTE);
+    history->tick(m * MINUTE);
+  }
+  history->tick(minutes * MINUTE);
+
+  CHECK(history->getMinute(0, v));
+  CHECK_EQ(v[HISTORY_JIGGLES], (minutes - 1) % 200);
+  CHECK(history->getMinute(ActivityHistory::MINUTES - 1, v));
+  CHECK_EQ(v[HISTORY_JIGGLES], (minutes - ActivityHistory::MINUTES) % 200);
+  CHECK(!history->getMinute(ActivityHistory::MINUTES, v));
+
+  uint32_t newest = 0, oldest = 0;
+  for (int64_t m = minutes - 60; m < minutes; m++) newest += m % 200;
+  for (int64_t m = 60; m < 120; m++) oldest += m % 200;
+  CHECK(history->getHour(0, v));
+  CHECK_EQ(v[HISTORY_JIGGLES], newest);
+  CHECK(history->getHour(ActivityHistory::HOURS - 1, v));
+  CHECK_EQ(v[HISTORY_JIGGLES], oldest);
+  CHECK(!history->getHour(ActivityHistory::HOURS, v));
+}
+
+static uint32_t varint(const std::vector<uint8_t>& data, size_t& pos) {
+  uint32_t v = 0;
+  for (uint8_t shift = 0; pos < data.size(); shift += 7) {
+    uint8_t b = data[pos++];
+    v |= (uint32_t)(b & 0x7F) << shift;
+    if (!(b & 0x80)) break;
+  }
+  return v;
+}
+
+// Decode one ring's columns and compare each bucket with get()
+static bool checkColumns(ActivityHistory* history, const std::vector<uint8_t>& data, size_t& pos, uint16_t count, bool minutes) {
+  bool same = true;
+  std::vector<std::vector<uint16_t>> columns(HISTORY_FIELDS);
+  for (uint8_t f = 0; f < HISTORY_FIELDS; f++) {
+    int32_t value = 0;
+    for (uint16_t i = 0; i < count; i++) {
+      uint32_t z = varint(data, pos);
+      value += (int32_t)(z >> 1) ^ -(int32_t)(z & 1);
+      columns[f].push_back(value);
+    }
+  }
+  for (uint16_t i = 0; i < count; i++) {
+    uint16_t v[HISTORY_FIELDS];
+    uint16_t ago = count - 1 - i;
+    same &= minutes ? history->getMinute(ago, v) : history->getHour(ago, v);
+    for (uint8_t f = 0; f < HISTORY_FIELDS; f++) same &= columns[f][i] == v[f];
+  }
+  return same;
+}
+
+static void testExport() {
+  Preferences::reset();
+  ActivityHistory* history = fresh(0);
+  uint32_t lcg = 1;
+  const int64_t minutes = 30 * 60 + 17;
+  bool connected = false;
+  for (int64_t m = 0; m < minutes; m++) {
+    lcg = lcg * 1664525 + 1013904223;
+    for (uint32_t i = 0; i < (lcg >> 24) % 40; i++) history->jiggled(m * MINUTE + i);
+    if (lcg & 0x100) {
+      connected = !connected;
+      history->setConnected(connected, m * MINUTE + (lcg >> 12) % MINUTE);
+    }
+    if (connected) history->addRssi(-(int8_t)(30 + (lcg >> 16) % 90), m * MINUTE + 50);
+  }
+  history->tick(minutes * MINUTE);
+
+  // The header in a chunk of its own, then a few bytes at a time
+  ActivityHistory::Cursor cursor;
+  history->startExport(cursor);
+  std::vector<uint8_t> data;
+  uint8_t chunk[ActivityHistory::HEADER_SIZE];
+  size_t size = sizeof(chunk);
+  for (size_t n; (n = history->exportChunk(cursor, chunk, size)) > 0; size = 3 + data.size() % 5) {
+    CHECK(n <= size);
+    data.insert(data.end(), chunk, chunk + n);
+  }
+  CHECK(data.size() > ActivityHistory::HEADER_SIZE);
+  CHECK(data[0] == 'A' && data[1] == 'H' && data[2] == ActivityHistory::VERSION && data[3] == HISTORY_FIELDS);
+  uint16_t minuteCount = data[4] | data[5] << 8;
+  uint16_t hourCount = data[6] | data[7] << 8;
+  uint32_t uptime = data[8] | data[9] << 8 | data[10] << 16 | (uint32_t)data[11] << 24;
+  CHECK_EQ(minuteCount, ActivityHistory::MINUTES);
+  CHECK_EQ(hourCount, 30);
+  CHECK_EQ(uptime, minutes);
+  CHECK_EQ(data[12] | data[13] << 8, 17);
+
+  size_t pos = ActivityHistory::HEADER_SIZE;
+  CHECK(checkColumns(history, data, pos, minuteCount, true));
+  CHECK(checkColumns(history, data, pos, hourCount, false));
+  CHECK_EQ(pos, data.size());
+}
+
+// Hours h of a run have h + 1 jiggles; the minutes run on the uptime clock
+// from startUs
+static void runHours(ActivityHistory* history, int64_t startUs, int hours, int firstHour) {
+  for (int h = 0; h < hours; h++) {
+    for (int i = 0; i <= firstHour + h; i++) history->jiggled(startUs + h * HOUR + i);
+    for (int m = 1; m <= 60; m++) history->tick(startUs + h * HOUR + m * MINUTE);
+  }
+}
+
+static uint16_t hourJiggles(ActivityHistory* history, uint16_t ago) {
+  uint16_t v[HISTORY_FIELDS];
+  return history->getHour(ago, v) ? v[HISTORY_JIGGLES] + 1 : 0;  // 0: none
+}
+
+static void testReboot() {
+  Preferences::reset();
+  ActivityHistory* before = fresh(0);
+  runHours(before, 0, 30, 0);
+  before->tick(30 * HOUR + 20 * MINUTE);  // an open hour is lost
+  CHECK_EQ(Preferences::totalWrites(), 30);  // one a closed hour
+
+  // Without the clock the hours follow on from the saved ones
+  ActivityHistory* after = fresh(0);
+  CHECK_EQ(hourJiggles(after, 0), 31);
+  CHECK_EQ(hourJiggles(after, 29), 2);
+  CHECK_EQ(hourJiggles(after, 30), 0);
+  uint16_t v[HISTORY_FIELDS];
+  CHECK(!after->getMinute(0, v));
+  runHours(after, 0, 2, 30);
+  CHECK_EQ(hourJiggles(after, 0), 33);
+  CHECK_EQ(hourJiggles(after, 2), 31);
+
+  // A block that does not check out only costs its hours
+  Preferences::store()["history/h0"][5] ^= 1;
+  ActivityHistory* corrupt = fresh(0);
+  CHECK_EQ(hourJiggles(corrupt, 0), 33);
+  CHECK_EQ(hourJiggles(corrupt, 7), 26);
+  CHECK_EQ(hourJiggles(corrupt, 8), 1);  // hour 23, in block 0: empty
+  CHECK_EQ(hourJiggles(corrupt, 31), 1);
+  CHECK_EQ(hourJiggles(corrupt, 32), 0);
+}
+
+// Off for 5 h 10 min: five empty hours between the saved hours and the
+// ones closed since boot, also when the clock comes after those
+static void testOffTime() {
+  const int64_t epoch = 1700000000;
+  Preferences::reset();
+  WallClock* clock = new WallClock();
+  clock->begin();
+  clock->setTime(epoch, 0, 0);
+  ActivityHistory* before = fresh(0);
+  before->setClock(clock);
+  runHours(before, 0, 3, 0);
+  before->tick(3 * HOUR + 40 * MINUTE);
+
+  // Booted 5 h 10 min after the last hour ended, clock set 2 h 5 min in
+  ActivityHistory* after = fresh(0);
+  WallClock* later = new WallClock();
+  later->begin();
+  after->setClock(later);
+  runHours(after, 0, 2, 10);
+  CHECK_EQ(hourJiggles(after, 2), 4);
+  later->setTime(epoch + 3 * 3600 + 5 * 3600 + 10 * 60 + 2 * 3600 + 5 * 60, 0, 2 * HOUR + 5 * MINUTE);
+  after->tick(2 * HOUR + 5 * MINUTE);
+  CHECK_EQ(hourJiggles(after, 0), 13);
+  CHECK_EQ(hourJiggles(after, 1), 12);
+  for (uint16_t ago = 2; ago < 7; ago++) CHECK_EQ(hourJiggles(after, ago), 1);
+  CHECK_EQ(hourJiggles(after, 7), 4);
+  CHECK_EQ(hourJiggles(after, 9), 2);
+  CHECK_EQ(hourJiggles(after, 10), 0);
+
+  // Saved as well, and counted once
+  after->tick(2 * HOUR + 6 * MINUTE);
+  ActivityHistory* again = fresh(0);
+  CHECK_EQ(hourJiggles(again, 0), 13);
+  CHECK_EQ(hourJiggles(again, 7), 4);
+  CHECK_EQ(hourJiggles(again, 10), 0);
+
+  // Off longer than the ring holds: only the hours since boot are left
+  WallClock* much = new WallClock();
+  much->begin();
+  again->setClock(much);
+  runHours(again, 0, 1, 40);
+  much->setTime(epoch + 100 * 86400, 0, HOUR);
+  again->tick(HOUR);
+  CHECK_EQ(hourJiggles(again, 0), 42);
+  CHECK_EQ(hourJiggles(again, 1), 1);
+  CHECK_EQ(hourJiggles(again, ActivityHistory::HOURS - 1), 1);
+}
+
+int main() {
+  testRollUp();
+  testClamping();
+  testWrap();
+  testExport();
+  testReboot();
+  testOffTime();
+  return testResult("test_activity_history");
+}
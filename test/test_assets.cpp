@@ -0,0 +1,93 @@
+// The settings page from the asset archive: GET / serves the archived copy
+// only when the archive was packed for this firmware's PAGE_VERSION
+
+#include "Check.h"
+#include "AssetStore.h"
+#include "WebServer.h"
+#include <vector>
+
+static const char* ARCHIVE = "test_assets.bin";
+static const char* PAGE = "<html>archived page</html>";
+
+static void putLE(std::vector<uint8_t>& out, uint32_t v, int bytes) {
+  for (int i = 0; i < bytes; i++) out.push_back(v >> (8 * i));
+}
+
+static uint32_t crc32(const uint8_t* data, size_t n) {
+  uint32_t crc = 0xFFFFFFFF;
+  while (n--) {
+    crc ^= *data++;
+    for (int k = 0; k < 8; k++) crc = (crc >> 1) ^ (0xEDB88320 & (0 - (crc & 1)));
+  }
+  return ~crc;
+}
+
+// An archive holding only web/index.html, laid out as tools/pack_assets.py does
+static bool writeArchive(uint32_t pageVersion) {
+  uint32_t size = strlen(PAGE);
+  uint32_t offset = 32 + 36;
+  std::vector<uint8_t> body;
+  char name[24] = "web/index.html";
+  body.insert(body.end(), name, name + sizeof(name));
+  putLE(body, offset, 4);
+  putLE(body, size, 4);
+  putLE(body, 0, 4);
+  body.insert(body.end(), PAGE, PAGE + size);
+  body.resize(body.size() + (-size & 3));
+
+  std::vector<uint8_t> archive = {'J', 'G', 'A', 'S'};
+  putLE(archive, AssetStore::FORMAT, 2);
+  putLE(archive, 1, 2);
+  putLE(archive, 20260101, 4);
+  putLE(archive, 32 + body.size(), 4);
+  putLE(archive, crc32(body.data(), body.size()), 4);
+  putLE(archive, pageVersion, 4);
+  archive.resize(32);
+  archive.insert(archive.end(), body.begin(), body.end());
+
+  FILE* file = fopen(ARCHIVE, "wb");
+  if (!file) return false;
+  bool ok = fwrite(archive.data(), 1, archive.size(), file) == archive.size();
+  return fclose(file) == 0 && ok;
+}
+
+static std::string getPage(JigglerWebServer& server) {
+  auto connection = hostConnect("GET / HTTP/1.1\r\nHost: 192.168.4.1\r\n\r\n");
+  server.handleClient();
+  size_t split = connection->response.find("\r\n\r\n");
+  return split == std::string::npos ? "" : connection->response.substr(split + 4);
+}
+
+int main() {
+  Serial.setEcho(false);
+  ConfigManager configManager;
+  configManager.begin();
+  JigglerWebServer server;
+  server.begin(&configManager);
+  AssetStore assets;
+  server.setAssets(&assets);
+
+  // Nothing mapped
+  CHECK(!server.hasAssetPage());
+  CHECK(getPage(server).find("<!DOCTYPE html>") != std::string::npos);
+
+  // Packed for this firmware
+  CHECK(writeArchive(JigglerWebServer::PAGE_VERSION));
+  CHECK(assets.begin(ARCHIVE));
+  CHECK_EQ(assets.getPageVersion(), JigglerWebServer::PAGE_VERSION);
+  CHECK(server.hasAssetPage());
+  CHECK(getPage(server) == std::string(PAGE) + "\r\n");  // every response ends with a blank line
+
+  // Packed for other firmware, or before pages had a version
+  uint32_t others[] = {JigglerWebServer::PAGE_VERSION + 1, 0};
+  for (uint32_t version : others) {
+    CHECK(writeArchive(version));
+    CHECK(assets.begin(ARCHIVE));
+    CHECK(!server.hasAssetPage());
+    CHECK(getPage(server).find("<!DOCTYPE html>") != std::string::npos);
+  }
+
+  assets.end();
+  remove(ARCHIVE);
+  return testResult("test_assets");
+}
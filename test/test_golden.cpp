@@ -0,0 +1,289 @@
+// Golden images of the UI screens, taken from the emulated panel: what the
+// LCD driver put on the SPI bus, not what the renderer thinks it drew.
+//
+// The display functions of main.cpp (updateDisplay, updateScreen,
+// updateCountdownOnly and the bar tween, showWiFiInfo, the toast) are
+// driven on the simulated clock through a fixed session, the way the UI
+// task drives them. The session runs twice, through the strip renderer and
+// drawing directly to the panel, and every step of both must match the
+// same image in golden/. The strip run also checks Paint_ReadLine() (the
+// screenshot and mirror source) against the panel.
+//
+//   test_golden            compare; differing steps are written to
+//                          golden_diff/<step>.bmp (what the panel shows)
+//                          and golden_diff/<step>_diff.bmp (differences
+//                          in magenta over a dimmed copy)
+//   test_golden --update   rewrite golden/ from the strip run
+
+#include "Check.h"
+#include "HostPanel.h"
+#include "LCD_Driver.h"
+#include "GUI_Paint.h"
+#include "GUI_Strip.h"
+#include "Config.h"
+#include "WebServer.h"
+#include "ProgressAnimator.h"
+#include <sys/stat.h>
+#include <algorithm>
+#include <vector>
+
+// As in main.cpp
+enum DisplayState {
+  STATE_INITIALIZING,
+  STATE_WAITING,
+  STATE_CONNECTED,
+  STATE_WIFI_INFO
+};
+
+extern ConfigManager configManager;
+extern JigglerWebServer webServer;
+extern DisplayState currentState;
+extern bool isJiggling, isMoving, isPaused;
+extern unsigned long jiggleCount, nextJiggleIn, nextJiggleAt, wifiInfoShownAt, toastUntil;
+extern bool logFrames;
+extern ProgressAnimator progressBar;
+void startDisplay();
+void encodeSetupCodes();
+void updateDisplay(bool forceFullRedraw);
+void updateScreen(unsigned long now);
+void drawStatusValue(bool moving, bool paused);
+void showToast(const char* message, unsigned long durationMs);
+unsigned long countdownAt(unsigned long now);
+
+static const uint16_t WIDTH = LCD_HEIGHT;   // landscape, as drawn
+static const uint16_t HEIGHT = LCD_WIDTH;
+static const uint32_t HEADER_SIZE = 14 + 40 + 12;
+
+typedef std::vector<uint16_t> Image;
+
+static bool update = false;
+static bool stripRun = true;
+
+static void putLE(std::vector<uint8_t>& out, uint32_t v, int bytes) {
+  for (int i = 0; i < bytes; i++) out.push_back(v >> (8 * i));
+}
+
+static uint32_t getLE(const uint8_t* p, int bytes) {
+  uint32_t v = 0;
+  for (int i = 0; i < bytes; i++) v |= (uint32_t)p[i] << (8 * i);
+  return v;
+}
+
+// Top-down 16 bit RGB565 BMP, the same layout as /api/screenshot
+static bool writeBmp(const std::string& path, const Image& image) {
+  uint32_t imageSize = WIDTH * HEIGHT * 2;
+  std::vector<uint8_t> out;
+  out.push_back('B');
+  out.push_back('M');
+  putLE(out, HEADER_SIZE + imageSize, 4);
+  putLE(out, 0, 4);
+  putLE(out, HEADER_SIZE, 4);
+  putLE(out, 40, 4);
+  putLE(out, WIDTH, 4);
+  putLE(out, (uint32_t) - (int32_t)HEIGHT, 4);
+  putLE(out, 1, 2);
+  putLE(out, 16, 2);
+  putLE(out, 3, 4);
+  putLE(out, imageSize, 4);
+  putLE(out, 2835, 4);
+  putLE(out, 2835, 4);
+  putLE(out, 0, 4);
+  putLE(out, 0, 4);
+  putLE(out, 0xF800, 4);
+  putLE(out, 0x07E0, 4);
+  putLE(out, 0x001F, 4);
+  for (uint16_t pixel : image) putLE(out, pixel, 2);
+
+  FILE* file = fopen(path.c_str(), "wb");
+  if (!file) return false;
+  bool ok = fwrite(out.data(), 1, out.size(), file) == out.size();
+  return fclose(file) == 0 && ok;
+}
+
+static bool readBmp(const std::string& path, Image& image) {
+  FILE* file = fopen(path.c_str(), "rb");
+  if (!file) return false;
+  std::vector<uint8_t> in;
+  uint8_t buffer[4096];
+  for (size_t n; (n = fread(buffer, 1, sizeof(buffer), file)) > 0;) in.insert(in.end(), buffer, buffer + n);
+  fclose(file);
+
+  if (in.size() < HEADER_SIZE || in[0] != 'B' || in[1] != 'M') return false;
+  uint32_t offset = getLE(&in[10], 4);
+  if (getLE(&in[18], 4) != WIDTH || (int32_t)getLE(&in[22], 4) != -(int32_t)HEIGHT ||
+      getLE(&in[28], 2) != 16 || in.size() < offset + WIDTH * HEIGHT * 2) {
+    return false;
+  }
+  image.resize(WIDTH * HEIGHT);
+  for (size_t i = 0; i < image.size(); i++) image[i] = getLE(&in[offset + 2 * i], 2);
+  return true;
+}
+
+// The visible panel in drawing orientation
+static Image panelImage() {
+  Image image(WIDTH * HEIGHT);
+  for (int y = 0; y < HEIGHT; y++) {
+    for (int x = 0; x < WIDTH; x++) {
+      int mx, my;
+      Paint_MapPoint(x, y, &mx, &my);
+      image[y * WIDTH + x] = hostPanel.visible(mx, my);
+    }
+  }
+  return image;
+}
+
+static void writeDiff(const char* step, const Image& actual, const Image& expected) {
+  mkdir("golden_diff", 0755);
+  Image diff(actual.size());
+  for (size_t i = 0; i < actual.size(); i++) {
+    uint16_t p = actual[i];
+    uint16_t gray = (((p >> 11) & 0x1F) + ((p >> 6) & 0x1F) + (p & 0x1F)) / 6;  // 0..15
+    diff[i] = actual[i] == expected[i] ? (gray << 11) | (gray << 6) | gray : 0xF81F;
+  }
+  std::string base = std::string("golden_diff/") + step + (stripRun ? "" : "_direct");
+  writeBmp(base + ".bmp", actual);
+  writeBmp(base + "_diff.bmp", diff);
+  printf("  wrote %s.bmp and %s_diff.bmp\n", base.c_str(), base.c_str());
+}
+
+// Compare the panel with golden/<step>.bmp
+static void step(const char* name) {
+  Image actual = panelImage();
+  std::string path = std::string(GOLDEN_DIR "/") + name + ".bmp";
+  CHECK_EQ(hostPanel.outside, 0);
+
+  if (stripRun) {
+    UWORD line[320];
+    uint32_t differ = 0;
+    for (int y = 0; y < HEIGHT; y++) {
+      CHECK(Paint_ReadLine(y, line));
+      for (int x = 0; x < WIDTH; x++) differ += line[x] != actual[y * WIDTH + x];
+    }
+    if (differ) printf("%s: Paint_ReadLine differs from the panel in %u pixels\n", name, differ);
+    CHECK_EQ(differ, 0);
+  }
+
+  if (update) {
+    if (stripRun) CHECK(writeBmp(path, actual));
+    return;
+  }
+
+  Image expected;
+  if (!readBmp(path, expected)) {
+    printf("%s: cannot read %s\n", name, path.c_str());
+    testFailures()++;
+    return;
+  }
+  uint32_t differ = 0;
+  int left = WIDTH, top = HEIGHT, right = -1, bottom = -1;
+  for (int y = 0; y < HEIGHT; y++) {
+    for (int x = 0; x < WIDTH; x++) {
+      if (actual[y * WIDTH + x] == expected[y * WIDTH + x]) continue;
+      differ++;
+      left = std::min(left, x);
+      right = std::max(right, x);
+      top = std::min(top, y);
+      bottom = std::max(bottom, y);
+    }
+  }
+  if (differ) {
+    printf("%s (%s): %u pixels differ from the golden image, in (%d,%d)-(%d,%d)\n",
+           name, stripRun ? "strip" : "direct", differ, left, top, right, bottom);
+    writeDiff(name, actual, expected);
+    testFailures()++;
+  }
+}
+
+// The UI task's loop on the simulated clock, for ms
+static void run(unsigned long ms) {
+  for (unsigned long t = 0; t < ms; t += 5) {
+    hostAdvance(5000);
+    updateScreen(millis());
+  }
+}
+
+// A fixed session, as the UI task sees it
+static void session() {
+  currentState = STATE_INITIALIZING;
+  isJiggling = isMoving = isPaused = false;
+  jiggleCount = 0;
+  toastUntil = 0;
+  updateDisplay(true);
+  step("splash");
+
+  // The AP is up (UI_WIFI_READY)
+  encodeSetupCodes();
+  currentState = STATE_WIFI_INFO;
+  updateDisplay(true);
+  wifiInfoShownAt = millis();
+  step("wifi_info");
+
+  // No host within WIFI_INFO_TIME
+  run(15000);
+  step("waiting");
+
+  // A host connects (UI_CONNECTED), the first jiggle is one interval away
+  isJiggling = true;
+  jiggleCount = 42;
+  nextJiggleAt = millis() + configManager.getConfig().jiggleInterval;
+  nextJiggleIn = countdownAt(millis());
+  currentState = STATE_CONNECTED;
+  updateDisplay(true);
+  step("connected");
+
+  // One second: new digits, then the bar tweens to its new length
+  run(1000);
+  CHECK(!progressBar.isAnimating());
+  step("countdown_tick");
+
+  // Most of the interval, second by second
+  run(20000);
+  step("countdown_late");
+
+  // A jiggle starts (UI_JIGGLE_START): only the status word
+  isMoving = true;
+  Paint_BeginUpdate();
+  drawStatusValue(true, false);
+  Paint_EndFrame();
+  step("moving");
+
+  // Outside the schedule (UI_PAUSED)
+  isMoving = false;
+  isPaused = true;
+  nextJiggleAt = millis();
+  nextJiggleIn = 0;
+  updateDisplay(true);
+  step("paused");
+
+  // Notices need the strip renderer's overlay; when it goes, the screen
+  // under it is back as it was
+  if (stripRun) {
+    showToast("Settings saved", 2000);
+    step("toast");
+    run(2100);
+    step("paused");
+  }
+}
+
+int main(int argc, char** argv) {
+  update = argc > 1 && strcmp(argv[1], "--update") == 0;
+  Serial.setEcho(false);
+  configManager.begin();
+  webServer.begin(&configManager);
+  startDisplay();
+  logFrames = false;
+
+  // Through the strip renderer, as on the device
+  hostPanel.fill(0xA5A5);
+  session();
+
+  // Straight to the panel
+  if (!update) {
+    stripRun = false;
+    Paint_SetFrameBudget(0, 0);
+    hostPanel.fill(0x5A5A);
+    session();
+  }
+
+  return testResult(update ? "test_golden --update" : "test_golden");
+}
@@ -0,0 +1,167 @@
+// JiggleScheduler: the deadlines stay on their grid over days of late
+// wakeups and jitter, missed deadlines are skipped, and the lateness
+// histogram adds up
+
+#include "Check.h"
+#include "JiggleScheduler.h"
+#include <initializer_list>
+
+static const int64_t SECOND = 1000000;
+static const int64_t DAY = 86400 * SECOND;
+
+// Repeatable wakeup delays
+static uint32_t lcg = 12345;
+static uint32_t randomUs(uint32_t below) {
+  lcg = lcg * 1664525 + 1013904223;
+  return (lcg >> 8) % below;
+}
+
+// Seven days of 30 s jiggles, every wakeup up to 5 ms late and then busy
+// for 150 ms: after n jiggles the deadline is exactly n + 1 intervals on
+static void testNoDrift() {
+  JiggleScheduler scheduler;
+  scheduler.setInterval(30000);
+  int64_t start = SECOND, now = start;
+  scheduler.start(now);
+  uint32_t n = 0;
+  bool dueOnTime = true;
+  while (now < start + 7 * DAY) {
+    now = scheduler.deadline() + randomUs(5000);
+    dueOnTime &= scheduler.isDue(now);
+    scheduler.fired(now);
+    n++;
+    now += 150000;  // the jiggle plays
+    dueOnTime &= !scheduler.isDue(now);
+  }
+  CHECK(dueOnTime);
+  CHECK_EQ(n, 7 * 86400 / 30);
+  CHECK_EQ(scheduler.deadline(), start + (int64_t)(n + 1) * 30 * SECOND);
+
+  const JiggleTiming& timing = scheduler.getTiming();
+  CHECK_EQ(timing.fired, n);
+  CHECK_EQ(timing.skipped, 0);
+  CHECK(timing.maxLateUs < 5000);
+  uint32_t counted = 0;
+  for (uint32_t bucket : timing.buckets) counted += bucket;
+  CHECK_EQ(counted, n);
+
+  scheduler.resetTiming();
+  CHECK_EQ(scheduler.getTiming().fired, 0);
+}
+
+// Jitter moves single jiggles up to 5 s either way, never the grid
+static void testJitter() {
+  JiggleScheduler scheduler;
+  scheduler.setSeed(99);
+  scheduler.setInterval(30000, 5000);
+  int64_t start = SECOND, now = start;
+  scheduler.start(now);
+  int64_t minOffset = INT64_MAX, maxOffset = INT64_MIN, previous = start;
+  bool ordered = true;
+  for (int64_t k = 1; now < start + 30 * DAY; k++) {
+    int64_t offset = scheduler.deadline() - (start + k * 30 * SECOND);
+    if (offset < minOffset) minOffset = offset;
+    if (offset > maxOffset) maxOffset = offset;
+    ordered &= scheduler.deadline() > previous;
+    previous = scheduler.deadline();
+    now = scheduler.deadline() + randomUs(2000);
+    scheduler.fired(now);
+  }
+  CHECK(ordered);
+  CHECK(minOffset >= -5 * SECOND && minOffset < -49 * SECOND / 10);
+  CHECK(maxOffset <= 5 * SECOND && maxOffset > 49 * SECOND / 10);
+
+  // At most a third of the interval
+  JiggleScheduler limited;
+  limited.setInterval(6000, 10000);
+  limited.start(0);
+  CHECK(limited.deadline() >= 4 * SECOND && limited.deadline() <= 8 * SECOND);
+
+  // The same seed replays the same deadlines
+  JiggleScheduler a, b;
+  a.setSeed(7);
+  b.setSeed(7);
+  a.setInterval(10000, 2000);
+  b.setInterval(10000, 2000);
+  a.start(0);
+  b.start(0);
+  bool same = true;
+  for (int i = 0; i < 100; i++) {
+    same &= a.deadline() == b.deadline();
+    a.fired(a.deadline());
+    b.fired(b.deadline());
+  }
+  CHECK(same);
+}
+
+static void testSkipped() {
+  // Due at 1 s, fired at 3.5 s: the 2 s and 3 s deadlines are gone, the
+  // next is back on the grid
+  JiggleScheduler scheduler;
+  scheduler.setInterval(1000);
+  scheduler.start(0);
+  scheduler.fired(35 * SECOND / 10);
+  CHECK_EQ(scheduler.getTiming().skipped, 2);
+  CHECK_EQ(scheduler.deadline(), 4 * SECOND);
+  CHECK_EQ(scheduler.getTiming().maxLateUs, 25 * SECOND / 10);
+  CHECK_EQ(scheduler.getTiming().fired, 1);
+
+  // Exactly one interval late skips one
+  scheduler.fired(5 * SECOND);
+  CHECK_EQ(scheduler.getTiming().skipped, 3);
+  CHECK_EQ(scheduler.deadline(), 6 * SECOND);
+
+  // Just under an interval late skips none
+  scheduler.fired(7 * SECOND - 1);
+  CHECK_EQ(scheduler.getTiming().skipped, 3);
+  CHECK_EQ(scheduler.deadline(), 7 * SECOND);
+
+  // A new interval moves the running deadline from where it started
+  scheduler.setInterval(2000);
+  CHECK_EQ(scheduler.deadline(), 8 * SECOND);
+  CHECK(!scheduler.isDue(8 * SECOND - 1));
+  CHECK(scheduler.isDue(8 * SECOND));
+  CHECK_EQ(scheduler.usUntilDue(7 * SECOND), SECOND);
+  CHECK_EQ(scheduler.usUntilDue(10 * SECOND), 0);
+
+  // Stopped: never due, and fired() changes nothing
+  scheduler.stop();
+  CHECK(!scheduler.isDue(INT64_MAX / 2));
+  CHECK_EQ(scheduler.usUntilDue(0), -1);
+  scheduler.fired(100 * SECOND);
+  CHECK_EQ(scheduler.getTiming().fired, 3);
+}
+
+// Nothing changes past the 32-bit millis() wrap (49.7 days)
+static void testLongUptime() {
+  JiggleScheduler scheduler;
+  scheduler.setInterval(30000);
+  int64_t start = (int64_t)0xFFFFFFFF * 1000 - 10 * SECOND;
+  scheduler.start(start);
+  for (int i = 0; i < 10; i++) scheduler.fired(scheduler.deadline());
+  CHECK_EQ(scheduler.deadline(), start + 11 * 30 * SECOND);
+  CHECK_EQ(scheduler.getTiming().maxLateUs, 0);
+}
+
+static void testBuckets() {
+  JiggleTiming timing = {};
+  for (uint32_t late : {0u, 1u, 2u, 3u, 1023u, 1024u, 0xFFFFFFFFu}) timing.add(late);
+  CHECK_EQ(timing.buckets[0], 2);
+  CHECK_EQ(timing.buckets[1], 2);
+  CHECK_EQ(timing.buckets[9], 1);
+  CHECK_EQ(timing.buckets[10], 1);
+  CHECK_EQ(timing.buckets[JiggleTiming::BUCKETS - 1], 1);
+  CHECK_EQ(timing.fired, 7);
+  CHECK_EQ(timing.maxLateUs, 0xFFFFFFFF);
+  CHECK_EQ(JiggleTiming::bucketStartUs(0), 0);
+  CHECK_EQ(JiggleTiming::bucketStartUs(10), 1024);
+}
+
+int main() {
+  testNoDrift();
+  testJitter();
+  testSkipped();
+  testLongUptime();
+  testBuckets();
+  return testResult("test_jiggle_scheduler");
+}
@@ -0,0 +1,161 @@
+// LifetimeStats: what survives a reboot, and how often it writes NVS. The
+// Preferences stand-in counts every write, so the rate limit is checked
+// against the writes the firmware actually made.
+
+#include "Check.h"
+#include "LifetimeStats.h"
+#include <string>
+
+static const int64_t SECOND = 1000000;
+static const int64_t HOUR = 3600 * SECOND;
+
+static std::string slotKey(uint32_t sequence) {
+  return "lifetime/rec" + std::to_string((sequence - 1) % LifetimeStats::SLOTS);
+}
+
+static uint32_t lifetimeWrites() {
+  uint32_t total = 0;
+  for (const auto& entry : Preferences::writes()) {
+    if (entry.first.compare(0, 9, "lifetime/") == 0) total += entry.second;
+  }
+  return total;
+}
+
+static void testFirstBoot() {
+  Preferences::reset();
+  LifetimeStats stats;
+  stats.begin(0);
+  LifetimeCounters counters = stats.get(0);
+  CHECK_EQ(counters.reboots, 1);
+  CHECK_EQ(counters.jiggles, 0);
+  CHECK_EQ(counters.connections, 0);
+  CHECK_EQ(stats.getSequence(), 1);
+  CHECK_EQ(Preferences::writes()["lifetime/rec0"], 1);
+  CHECK_EQ(Preferences::totalWrites(), 1);
+
+  // Nothing changed: neither tick() nor flush() writes
+  stats.tick(HOUR);
+  stats.flush(HOUR);
+  CHECK_EQ(Preferences::totalWrites(), 1);
+}
+
+// A day with a host connected and a jiggle every 30 s: one commit per
+// COMMIT_INTERVAL_MS at most, spread over the ring of slots
+static void testDay() {
+  Preferences::reset();
+  {
+    LifetimeStats stats;
+    stats.begin(0);
+    stats.setConnected(true, 0);
+    for (int64_t t = 0; t < 24 * HOUR; t += SECOND / 4) {
+      if (t % (30 * SECOND) == 0) stats.jiggled();
+      stats.tick(t);
+    }
+    LifetimeCounters counters = stats.get(24 * HOUR);
+    CHECK_EQ(counters.connectedSeconds, 86400);
+    CHECK_EQ(counters.jiggles, 2880);
+    CHECK_EQ(counters.connections, 1);
+    stats.flush(24 * HOUR);
+
+    // The boot commit, one per interval, and the flush
+    uint32_t perDay = 24 * 3600 * 1000 / LifetimeStats::COMMIT_INTERVAL_MS;
+    uint32_t writes = lifetimeWrites();
+    CHECK(writes >= perDay && writes <= perDay + 2);
+    CHECK_EQ(writes, stats.getSequence());
+    // Every slot of the ring takes its share
+    for (uint8_t i = 0; i < LifetimeStats::SLOTS; i++) {
+      uint32_t slot = Preferences::writes()["lifetime/rec" + std::to_string(i)];
+      CHECK(slot >= writes / LifetimeStats::SLOTS && slot <= writes / LifetimeStats::SLOTS + 1);
+    }
+  }
+
+  // After a reboot: the newest record, plus this boot
+  LifetimeStats stats;
+  stats.begin(25 * HOUR);
+  LifetimeCounters counters = stats.get(25 * HOUR);
+  CHECK_EQ(counters.jiggles, 2880);
+  CHECK_EQ(counters.connectedSeconds, 86400);
+  CHECK_EQ(counters.reboots, 2);
+}
+
+// Fractions of a second add up instead of being dropped at each tick
+static void testConnectedTime() {
+  Preferences::reset();
+  LifetimeStats stats;
+  stats.begin(0);
+  stats.setConnected(true, 0);
+  for (int64_t t = 0; t <= 10 * SECOND; t += 300000) stats.get(t);
+  CHECK_EQ(stats.get(10 * SECOND).connectedSeconds, 10);
+  stats.setConnected(false, 10 * SECOND + 500000);
+  stats.setConnected(true, 20 * SECOND);
+  stats.setConnected(true, 21 * SECOND);  // no change
+  CHECK_EQ(stats.get(20 * SECOND + 600000).connectedSeconds, 11);
+  CHECK_EQ(stats.get(20 * SECOND + 600000).connections, 2);
+
+  // flush() writes what changed, without waiting for the interval
+  uint32_t before = Preferences::totalWrites();
+  stats.flush(21 * SECOND);
+  CHECK_EQ(Preferences::totalWrites(), before + 1);
+}
+
+// A record lost mid-write only costs that commit
+static void testCorruptRecord() {
+  Preferences::reset();
+  uint32_t sequence;
+  {
+    LifetimeStats stats;
+    stats.begin(0);
+    for (int i = 0; i < 5; i++) stats.jiggled();
+    stats.flush(SECOND);
+    for (int i = 0; i < 3; i++) stats.jiggled();
+    stats.flush(2 * SECOND);
+    sequence = stats.getSequence();
+  }
+  CHECK_EQ(sequence, 3);
+  Preferences::store()[slotKey(sequence)][6] ^= 1;
+
+  LifetimeStats stats;
+  stats.begin(0);
+  LifetimeCounters counters = stats.get(0);
+  CHECK_EQ(counters.jiggles, 5);
+  CHECK_EQ(counters.reboots, 2);
+  CHECK_EQ(stats.getSequence(), sequence);  // overwrote the corrupt slot
+
+  // A short record is skipped too
+  Preferences::store()[slotKey(stats.getSequence())].resize(4);
+  LifetimeStats again;
+  again.begin(0);
+  CHECK_EQ(again.get(0).reboots, 2);
+}
+
+// The ring keeps working when the sequence number wraps
+static void testSequenceWrap() {
+  Preferences::reset();
+  {
+    LifetimeStats stats;
+    stats.begin(0);
+  }
+  // Forge the newest record just before the wrap
+  std::vector<uint8_t>& record = Preferences::store()["lifetime/rec0"];
+  uint32_t sequence = 0xFFFFFFFE;
+  memcpy(record.data(), &sequence, sizeof(sequence));
+  uint32_t check = 2166136261u;
+  for (size_t i = 0; i + 4 < record.size(); i++) check = (check ^ record[i]) * 16777619u;
+  memcpy(record.data() + record.size() - 4, &check, sizeof(check));
+
+  for (int boot = 0; boot < 4; boot++) {
+    LifetimeStats stats;
+    stats.begin(0);
+    CHECK_EQ(stats.get(0).reboots, 2 + boot);
+    CHECK_EQ(stats.getSequence(), (uint32_t)(0xFFFFFFFF + boot));
+  }
+}
+
+int main() {
+  testFirstBoot();
+  testDay();
+  testConnectedTime();
+  testCorruptRecord();
+  testSequenceWrap();
+  return testResult("test_lifetime");
+}
@@ -0,0 +1,87 @@
+// CurveRunner: every path ends exactly where it started, within the report
+// and time limits, over many seeds, durations and amplitudes. Also prints
+// the cost per report (render_bench has it as curve_1000_reports too).
+
+#include "Check.h"
+#include "MotionCurve.h"
+#include <algorithm>
+#include <chrono>
+#include <stdlib.h>
+
+static void testEase() {
+  CHECK_EQ(CurveRunner::ease(0), 0);
+  CHECK_EQ(CurveRunner::ease(0x8000), 16384);
+  CHECK_EQ(CurveRunner::ease(0x10000), 32768);
+  CHECK_EQ(CurveRunner::ease(0xFFFFFFFF), 32768);
+  bool rising = true;
+  for (uint32_t t = 1; t <= 0x10000; t++) rising &= CurveRunner::ease(t) >= CurveRunner::ease(t - 1);
+  CHECK(rising);
+}
+
+static void testPaths() {
+  static const uint16_t durations[] = {CurveRunner::MIN_DURATION, 1000, 2500, CurveRunner::MAX_DURATION};
+  static const uint8_t amplitudes[] = {CurveRunner::MIN_AMPLITUDE, 5, 20, 60, CurveRunner::MAX_AMPLITUDE};
+  CurveRunner curve;
+  MotionStep step;
+  uint32_t paths = 0, mostReports = 0, open = 0, late = 0, wide = 0;
+  uint64_t reports = 0;
+  auto t0 = std::chrono::steady_clock::now();
+  for (uint32_t seed = 1; seed <= 20000; seed++) {
+    for (uint16_t duration : durations) {
+      for (uint8_t amplitude : amplitudes) {
+        curve.begin(duration, amplitude, seed);
+        int32_t x = 0, y = 0, farthest = 0;
+        uint32_t n = 0, time = 0;
+        while (curve.next(step) && n < 1000) {
+          x += step.x;
+          y += step.y;
+          time += step.delay;
+          farthest = std::max(farthest, std::max(abs(x), abs(y)));
+          n++;
+        }
+        paths++;
+        reports += n;
+        if (n > mostReports) mostReports = n;
+        open += x != 0 || y != 0;
+        late += time > duration + CurveRunner::REPORT_MS;
+        // Waypoints are amplitude out, and a leg bows out by a quarter of
+        // its length at most
+        wide += farthest > 2 * amplitude;
+      }
+    }
+  }
+  double ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - t0).count();
+
+  CHECK_EQ(open, 0);
+  CHECK_EQ(late, 0);
+  CHECK_EQ(wide, 0);
+  CHECK(mostReports <= CurveRunner::MAX_DURATION / CurveRunner::REPORT_MS);
+  printf("curve: %u paths, %llu reports, at most %u a path, %.1f ns per report\n", paths,
+         (unsigned long long)reports, mostReports, ns / reports);
+}
+
+// The same seed replays the same path; limits are clamped
+static void testSeeds() {
+  CurveRunner a, b;
+  MotionStep sa, sb;
+  a.begin(1500, 30, 77);
+  b.begin(1500, 30, 77);
+  bool same = true;
+  while (a.next(sa)) {
+    same &= b.next(sb) && sa.delay == sb.delay && sa.x == sb.x && sa.y == sb.y;
+  }
+  CHECK(same && !b.next(sb));
+
+  a.begin(1, 0, 5);
+  b.begin(CurveRunner::MIN_DURATION, CurveRunner::MIN_AMPLITUDE, 5);
+  same = true;
+  while (a.next(sa)) same &= b.next(sb) && sa.delay == sb.delay && sa.x == sb.x && sa.y == sb.y;
+  CHECK(same);
+}
+
+int main() {
+  testEase();
+  testPaths();
+  testSeeds();
+  return testResult("test_motion_curve");
+}
@@ -0,0 +1,156 @@
+// MotionExecutor: when each report goes out, driven the way the BLE task
+// drives it (tick() whenever msUntilNext() has passed) and with late wakeups
+
+#include "Check.h"
+#include "MotionExecutor.h"
+#include <vector>
+
+struct Report {
+  unsigned long at;
+  int x, y, wheel, click;
+};
+
+static std::vector<Report> reports;
+static unsigned long now;
+
+static void record(const MotionStep& step, void*) {
+  reports.push_back({now, step.x, step.y, step.wheel, step.click});
+}
+
+static void checkReports(const char* name, const std::vector<Report>& expected) {
+  bool same = reports.size() == expected.size();
+  for (size_t i = 0; same && i < expected.size(); i++) {
+    const Report& a = reports[i];
+    const Report& e = expected[i];
+    same = a.at == e.at && a.x == e.x && a.y == e.y && a.wheel == e.wheel && a.click == e.click;
+  }
+  if (!same) {
+    printf("%s: sent", name);
+    for (const Report& r : reports) printf(" %lu:(%d,%d,%d,%d)", r.at, r.x, r.y, r.wheel, r.click);
+    printf("\n");
+  }
+  CHECK(same);
+  reports.clear();
+}
+
+// Sleep exactly until each step is due; returns when the pattern ended
+static unsigned long runOnTime(MotionExecutor& motion) {
+  unsigned long done = 0;
+  while (motion.isRunning()) {
+    now += motion.msUntilNext(now, 1000);
+    if (motion.tick(now)) done = now;
+  }
+  return done;
+}
+
+// Steps 0..n-1 with a 10 ms delay each, more than the queue holds
+class CountingSource : public MotionSource {
+public:
+  int n;
+  int produced = 0;
+  explicit CountingSource(int steps) : n(steps) {}
+  bool next(MotionStep& step) override {
+    if (produced == n) return false;
+    step = {10, (int8_t)(produced % 100 + 1), 0, 0, 0};
+    produced++;
+    return true;
+  }
+};
+
+int main() {
+  MotionExecutor motion;
+  motion.setOutput(record, nullptr);
+  MotionStep steps[MotionExecutor::MAX_STEPS + 1];
+
+  // Square: four reports 50 ms apart, done 200 ms after the start
+  now = 1000;
+  uint8_t n = MotionExecutor::square(steps, 2);
+  CHECK(motion.play(steps, n, now));
+  CHECK_EQ(runOnTime(motion), 1200);
+  checkReports("square", {{1000, 2, 0, 0, 0}, {1050, 0, 2, 0, 0}, {1100, -2, 0, 0, 0}, {1150, 0, -2, 0, 0}});
+  CHECK_EQ(motion.getStats().patterns, 1);
+  CHECK_EQ(motion.getStats().reports, 4);
+  CHECK_EQ(motion.getStats().maxLate, 0);
+
+  // Out and back, done after 150 ms
+  now = 5000;
+  n = MotionExecutor::outAndBack(steps, -3, 4);
+  CHECK(motion.play(steps, n, now));
+  CHECK_EQ(runOnTime(motion), 5150);
+  checkReports("out_and_back", {{5000, -3, 4, 0, 0}, {5100, 3, -4, 0, 0}});
+
+  // Late wakeups delay one report, never the ones after it
+  motion.resetStats();
+  now = 10000;
+  n = MotionExecutor::square(steps, 5);
+  motion.play(steps, n, now);
+  for (unsigned long t : {10000UL, 10073UL, 10101UL, 10149UL, 10150UL, 10199UL}) {
+    now = t;
+    CHECK(!motion.tick(now));
+  }
+  CHECK_EQ(motion.msUntilNext(now, 1000), 1);
+  now = 10230;
+  CHECK(motion.tick(now));
+  CHECK(!motion.isRunning());
+  checkReports("late", {{10000, 5, 0, 0, 0}, {10073, 0, 5, 0, 0}, {10101, -5, 0, 0, 0}, {10150, 0, -5, 0, 0}});
+  CHECK_EQ(motion.getStats().maxLate, 23);
+
+  // One very late tick sends everything due, in order
+  now = 20000;
+  motion.play(steps, n, now);
+  now = 20500;
+  CHECK(motion.tick(now));
+  checkReports("burst", {{20500, 5, 0, 0, 0}, {20500, 0, 5, 0, 0}, {20500, -5, 0, 0, 0}, {20500, 0, -5, 0, 0}});
+  CHECK_EQ(motion.getStats().maxLate, 500);
+
+  // Time-only steps send nothing; clicks and the wheel go out
+  MotionStep mixed[] = {{0, 0, 0, 0, 0}, {30, 0, 0, 0, 1}, {30, 0, 0, -2, 0}, {40, 0, 0, 0, 0}};
+  now = 30000;
+  motion.play(mixed, 4, now);
+  CHECK_EQ(runOnTime(motion), 30100);
+  checkReports("mixed", {{30030, 0, 0, 0, 1}, {30060, 0, 0, -2, 0}});
+
+  // Cancelled: nothing more goes out, and it does not count as played
+  uint32_t played = motion.getStats().patterns;
+  now = 40000;
+  motion.play(steps, n, now);
+  motion.tick(now);
+  motion.cancel();
+  CHECK(!motion.isRunning());
+  now = 40100;
+  CHECK(!motion.tick(now));
+  checkReports("cancel", {{40000, 5, 0, 0, 0}});
+  CHECK_EQ(motion.getStats().patterns, played);
+
+  // Playing replaces a pattern that is still running
+  now = 50000;
+  motion.play(steps, n, now);
+  motion.tick(now);
+  n = MotionExecutor::outAndBack(steps, 1, 1);
+  motion.play(steps, n, now + 10);
+  now += 10;
+  runOnTime(motion);
+  checkReports("replace", {{50000, 5, 0, 0, 0}, {50010, 1, 1, 0, 0}, {50110, -1, -1, 0, 0}});
+
+  // Idle, empty and oversized patterns
+  CHECK_EQ(motion.msUntilNext(now, 77), 77);
+  CHECK(!motion.play(steps, 0, now));
+  CHECK(!motion.play(steps, MotionExecutor::MAX_STEPS + 1, now));
+  CHECK(!motion.isRunning());
+
+  // A source plays more steps than the queue holds, fetched one at a time
+  CountingSource source(100);
+  now = 60000;
+  CHECK(motion.play(source, now));
+  CHECK(source.produced <= 2);
+  CHECK_EQ(runOnTime(motion), 60000 + 100 * 10);
+  CHECK_EQ(reports.size(), 100);
+  bool spaced = true;
+  for (size_t i = 0; i < reports.size(); i++) spaced &= reports[i].at == 60010 + 10 * i;
+  CHECK(spaced);
+  reports.clear();
+  CountingSource empty(0);
+  CHECK(!motion.play(empty, now));
+
+  return testResult("test_motion_executor");
+}
@@ -0,0 +1,241 @@
+// MotionPattern and PatternRunner: the bytecode the compiler emits, its
+// error messages, nested repeats and random ranges as played through
+// MotionExecutor, the decompiler, and bytecode check() must refuse
+
+#include "Check.h"
+#include "MotionPattern.h"
+#include <string>
+#include <vector>
+
+struct Report {
+  unsigned long at;
+  int x, y, wheel, click;
+};
+
+static std::vector<Report> reports;
+static unsigned long now;
+
+static void record(const MotionStep& step, void*) {
+  reports.push_back({now, step.x, step.y, step.wheel, step.click});
+}
+
+// Compile and play source from start, ticking every stepMs
+static std::vector<Report> play(const char* source, uint32_t seed, unsigned long start = 1000, unsigned long stepMs = 1) {
+  uint8_t code[MotionPattern::MAX_BYTES];
+  MotionPattern::Result result = MotionPattern::compile(source, code, sizeof(code));
+  if (!result.ok) {
+    printf("\"%s\": line %u: %s\n", source, result.line, result.error);
+    testFailures()++;
+    return {};
+  }
+  static PatternRunner runner;
+  MotionExecutor motion;
+  motion.setOutput(record, nullptr);
+  reports.clear();
+  CHECK(runner.begin(code, result.length, seed));
+  now = start;
+  CHECK(motion.play(runner, now));
+  for (int i = 0; i < 100000 && motion.isRunning(); i++) {
+    motion.tick(now);
+    if (motion.isRunning()) now += stepMs;
+  }
+  return reports;
+}
+
+static void checkError(const char* source, uint16_t line, const char* error) {
+  uint8_t code[MotionPattern::MAX_BYTES];
+  MotionPattern::Result result = MotionPattern::compile(source, code, sizeof(code));
+  bool same = !result.ok && result.line == line && result.error && strcmp(result.error, error) == 0;
+  if (!same) {
+    printf("\"%s\": expected line %u: %s, got %s line %u: %s\n", source, line, error,
+           result.ok ? "ok" : "error", result.line, result.error ? result.error : "-");
+  }
+  CHECK(same);
+}
+
+static void testBytecode() {
+  uint8_t code[MotionPattern::MAX_BYTES];
+  MotionPattern::Result result =
+      MotionPattern::compile("move 3 -4\nwait 300\nscroll -2\nclick right\nrepeat 2; move 1..5 0; end", code, sizeof(code));
+  CHECK(result.ok);
+  const uint8_t expected[] = {0x10, 3, 0xFC, 0x20, 0x2C, 0x01, 0x30, 0xFE, 0x42, 0x50, 2, 0x11, 1, 5, 0, 0x00};
+  CHECK_EQ(result.length, sizeof(expected));
+  CHECK(memcmp(code, expected, sizeof(expected)) == 0);
+  CHECK_EQ(result.info.duration, 300);
+  CHECK_EQ(result.info.reports, 5);
+}
+
+static void testPlayback() {
+  // Reports and their times
+  std::vector<Report> v = play("move 2 0; wait 50; move 0 2; wait 50; move -2 0; wait 50; move 0 -2", 1);
+  CHECK_EQ(v.size(), 4);
+  if (v.size() == 4) {
+    CHECK(v[0].at == 1000 && v[0].x == 2 && v[0].y == 0);
+    CHECK(v[1].at == 1050 && v[1].y == 2);
+    CHECK(v[2].at == 1100 && v[2].x == -2);
+    CHECK(v[3].at == 1150 && v[3].y == -2);
+  }
+
+  // Waits add up; a trailing wait keeps the pattern running
+  v = play("wait 10\nwait 20\nclick\nscroll 3\nclick middle # comment\nwait 100", 1);
+  CHECK_EQ(v.size(), 3);
+  if (v.size() == 3) {
+    CHECK(v[0].at == 1030 && v[0].click == 1);
+    CHECK(v[1].at == 1030 && v[1].wheel == 3);
+    CHECK(v[2].at == 1030 && v[2].click == 4);
+  }
+  CHECK_EQ(now, 1130);
+
+  // Late ticks keep the schedule
+  v = play("move 1 0; wait 50; move 2 0; wait 50; move 3 0", 1, 1000, 7);
+  CHECK_EQ(v.size(), 3);
+  if (v.size() == 3) CHECK(v[1].at == 1056 && v[2].at == 1105);
+}
+
+static void testNestedRepeats() {
+  std::vector<Report> v = play("repeat 3\n  repeat 2\n    move 1 0\n    wait 10\n  end\n  move 0 1\nend", 1);
+  CHECK_EQ(v.size(), 9);
+  int x = 0, y = 0;
+  for (const Report& r : v) {
+    x += r.x;
+    y += r.y;
+  }
+  CHECK(x == 6 && y == 3);
+  if (v.size() == 9) CHECK(v[8].at == 1060 && v[8].y == 1);
+
+  // Four deep, the limit: every level multiplies the body
+  uint8_t code[MotionPattern::MAX_BYTES];
+  MotionPattern::Result result =
+      MotionPattern::compile("repeat 2; repeat 3; repeat 4; repeat 5; move 1 0; wait 1; end; click; end; end; end", code, sizeof(code));
+  CHECK(result.ok);
+  CHECK_EQ(result.info.reports, 2 * 3 * 4 * 5 + 2 * 3 * 4);
+  CHECK_EQ(result.info.duration, 2 * 3 * 4 * 5);
+  v = play("repeat 2; repeat 3; repeat 4; repeat 5; move 1 0; wait 1; end; click; end; end; end", 1);
+  int clicks = 0;
+  x = 0;
+  for (const Report& r : v) {
+    clicks += r.click != 0;
+    x += r.x;
+  }
+  CHECK_EQ(x, 120);
+  CHECK_EQ(clicks, 24);
+
+  // Ranges stay in range and replay exactly with the same seed
+  std::vector<Report> a = play("repeat 50; move -3..3 1..2; wait 5..15; end", 42);
+  std::vector<Report> b = play("repeat 50; move -3..3 1..2; wait 5..15; end", 42);
+  CHECK_EQ(a.size(), 50);
+  CHECK_EQ(b.size(), a.size());
+  bool same = true, inRange = true, varied = false;
+  for (size_t i = 0; i < a.size() && i < b.size(); i++) {
+    same &= a[i].at == b[i].at && a[i].x == b[i].x && a[i].y == b[i].y;
+    inRange &= a[i].x >= -3 && a[i].x <= 3 && a[i].y >= 1 && a[i].y <= 2;
+    if (i) {
+      unsigned long gap = a[i].at - a[i - 1].at;
+      inRange &= gap >= 5 && gap <= 15;
+      varied |= a[i].x != a[0].x;
+    }
+  }
+  CHECK(same);
+  CHECK(inRange);
+  CHECK(varied);
+}
+
+static void testErrors() {
+  checkError("move 1", 1, "move takes x and y");
+  checkError("move 1 200", 1, "number out of range");
+  checkError("move 1 x", 1, "bad number");
+  checkError("\nwait 5..1", 2, "range is backwards");
+  checkError("jump 3", 1, "unknown command");
+  checkError("click up", 1, "unknown button");
+  checkError("end", 1, "end without repeat");
+  checkError("move 1 1\nrepeat 2\nmove 1 1", 2, "repeat without end");
+  checkError("repeat 2\n  repeat 3\n    move 1 1\n  end", 1, "repeat without end");
+  checkError("repeat 1..2\nend", 1, "repeat count cannot be random");
+  checkError("repeat 0\nend", 1, "number out of range");
+  checkError("repeat 2;repeat 2;repeat 2;repeat 2;repeat 2;end;end;end;end;end", 1, "repeats nested too deep");
+  checkError("wait 10001", 1, "number out of range");
+  checkError("move 1 2 3 4 5", 1, "statement too long");
+  checkError("# nothing", 0, "empty pattern");
+  checkError("wait 100", 0, "pattern never moves");
+  checkError("repeat 2; move 1 1; wait 6000; end", 0, "pattern runs longer than 10 s");
+  checkError("repeat 255; repeat 2; move 1 1; end; end", 0, "pattern sends too many reports");
+  std::string lines;
+  for (int i = 0; i < 40; i++) lines += "move 1 1\n";
+  checkError(lines.c_str(), 33, "pattern too long");
+
+  // A worst case beyond 32 bits (255 * 245 * 161 * 427 ms is 2^32 + 1529)
+  // is too long, not read as 1.5 s
+  const char* huge = "repeat 255; repeat 245; repeat 161; wait 427; end; end; end; move 1 1";
+  checkError(huge, 0, "pattern runs longer than 10 s");
+  uint8_t code[MotionPattern::MAX_BYTES];
+  MotionPattern::Result result = MotionPattern::compile(huge, code, sizeof(code));
+  CHECK_EQ(result.info.duration, 0xFFFFFFFF);
+  result = MotionPattern::compile("repeat 255; repeat 255; repeat 255; repeat 255; click; click; end; end; end; end", code, sizeof(code));
+  CHECK_EQ(result.info.reports, 0xFFFFFFFF);
+}
+
+static void testDecompile() {
+  const char* source = "repeat 3\n  move -1..1 2\n  repeat 2\n    wait 10..20\n    click right\n  end\n  scroll -1\nend\n";
+  uint8_t code[MotionPattern::MAX_BYTES];
+  MotionPattern::Result result = MotionPattern::compile(source, code, sizeof(code));
+  CHECK(result.ok);
+  char text[512];
+  CHECK_EQ(MotionPattern::decompile(code, result.length, text, sizeof(text)), strlen(source));
+  CHECK(strcmp(text, source) == 0);
+
+  // The widest values come back whole and compile again
+  const char* wide = "wait 10000..10000\nmove -127..-127 -100..127\nscroll -127..-127\n";
+  result = MotionPattern::compile(wide, code, sizeof(code));
+  CHECK(result.ok);
+  CHECK_EQ(MotionPattern::decompile(code, result.length, text, sizeof(text)), strlen(wide));
+  CHECK(strcmp(text, wide) == 0);
+  CHECK(MotionPattern::compile(text, code, sizeof(code)).ok);
+  result = MotionPattern::compile(source, code, sizeof(code));
+
+  // Cut at a whole line
+  char tiny[10];
+  CHECK_EQ(MotionPattern::decompile(code, result.length, tiny, sizeof(tiny)), 9);
+  CHECK(strcmp(tiny, "repeat 3\n") == 0);
+
+  // The longest text any program decompiles to fits MAX_SOURCE
+  uint8_t worst[MotionPattern::MAX_BYTES];
+  uint8_t n = 0;
+  for (int i = 0; i < MotionPattern::MAX_DEPTH; i++) {
+    worst[n++] = MotionPattern::OP_REPEAT;
+    worst[n++] = 1;
+  }
+  while (n < sizeof(worst) - MotionPattern::MAX_DEPTH) worst[n++] = MotionPattern::OP_CLICK | 4;
+  for (int i = 0; i < MotionPattern::MAX_DEPTH; i++) worst[n++] = MotionPattern::OP_END;
+  static char big[8192];
+  CHECK(MotionPattern::decompile(worst, n, big, sizeof(big)) < MotionPattern::MAX_SOURCE);
+}
+
+static void testCheck() {
+  const uint8_t noEnd[] = {0x50, 2, 0x10, 1, 1};
+  const uint8_t shortOperands[] = {0x10, 1};
+  const uint8_t unknown[] = {0x60};
+  const uint8_t backwards[] = {0x13, 5, 1, 0, 0};
+  const uint8_t zeroRepeat[] = {0x50, 0, 0x10, 1, 1, 0x00};
+  const uint8_t longWait[] = {0x20, 0x11, 0x27, 0x10, 1, 1};  // 10001 ms
+  CHECK(!MotionPattern::check(noEnd, sizeof(noEnd)));
+  CHECK(!MotionPattern::check(shortOperands, sizeof(shortOperands)));
+  CHECK(!MotionPattern::check(unknown, sizeof(unknown)));
+  CHECK(!MotionPattern::check(backwards, sizeof(backwards)));
+  CHECK(!MotionPattern::check(zeroRepeat, sizeof(zeroRepeat)));
+  CHECK(!MotionPattern::check(longWait, sizeof(longWait)));
+
+  PatternRunner runner;
+  CHECK(!runner.begin(noEnd, sizeof(noEnd), 1));
+  MotionStep step;
+  CHECK(!runner.next(step));
+}
+
+int main() {
+  testBytecode();
+  testPlayback();
+  testNestedRepeats();
+  testErrors();
+  testDecompile();
+  testCheck();
+  return testResult("test_motion_pattern");
+}
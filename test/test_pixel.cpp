@@ -0,0 +1,23 @@
+// Pixel kernels (GUI_Pixel.cpp) against the per-pixel reference in
+// PixelCheck.h, with more cases and seeds than the on-device check
+
+#include "Check.h"
+#include "PixelCheck.h"
+
+int main() {
+  Serial.setEcho(false);
+  for (uint32_t seed = 1; seed <= 8; seed++) {
+    PixelCheck check(seed);
+    CHECK(check.run(20000));
+  }
+  if (testFailures()) fputs(Serial.output().c_str(), stdout);
+
+  // A known case by hand: half alpha of white over black
+  UWORD pixels[3] = {0, 0, 0x1234};
+  Pixel_Blend(pixels, 0xFFFF, 128, 2);
+  CHECK_EQ(PIXEL_SWAP(pixels[0]), 0x7BEF);
+  CHECK_EQ(PIXEL_SWAP(pixels[1]), 0x7BEF);
+  CHECK_EQ(pixels[2], 0x1234);
+
+  return testResult("test_pixel");
+}
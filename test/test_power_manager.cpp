@@ -0,0 +1,132 @@
+// PowerManager: counted locks, the awake time and wakeups they add up to,
+// PowerGuard, and locks taken from several tasks at once
+
+#include "Check.h"
+#include "PowerManager.h"
+#include "JiggleScheduler.h"
+#include <thread>
+
+static const int64_t MS = 1000;
+static const int64_t SECOND = 1000000;
+
+static void testAccounting() {
+  PowerManager power;
+  power.begin(240, 80, true, 0);
+  CHECK(power.isSleepEnabled());
+  CHECK(!power.isAwake());
+  CHECK_EQ(power.awakePermille(SECOND), 0);
+  CHECK_EQ(power.wakeupsPerHour(SECOND), 0);
+
+  // Overlapping locks are one awake period and one wakeup
+  power.acquire(POWER_MOTION, 1000 * MS);
+  power.acquire(POWER_RENDER, 1100 * MS);
+  power.release(POWER_MOTION, 1150 * MS);
+  CHECK(power.isAwake());
+  CHECK(power.isHeld(POWER_RENDER));
+  CHECK(!power.isHeld(POWER_MOTION));
+  power.release(POWER_RENDER, 1200 * MS);
+  CHECK(!power.isAwake());
+  CHECK_EQ(power.awakePermille(2 * SECOND), 100);  // 200 ms of 2 s
+  CHECK_EQ(power.wakeupsPerHour(3600 * SECOND), 1);
+
+  // Counted: two requests at once, then an unmatched release is ignored
+  power.acquire(POWER_HTTP, 2000 * MS);
+  power.acquire(POWER_HTTP, 2000 * MS);
+  power.release(POWER_HTTP, 2100 * MS);
+  CHECK(power.isAwake());
+  power.release(POWER_HTTP, 2200 * MS);
+  CHECK(!power.isAwake());
+  power.release(POWER_HTTP, 2300 * MS);
+  CHECK(!power.isAwake());
+  power.acquire(POWER_HTTP, 2300 * MS);
+  CHECK(power.isAwake());
+  power.release(POWER_HTTP, 2300 * MS);
+  CHECK(!power.isHeld(POWER_HTTP));
+  CHECK_EQ(power.awakePermille(4 * SECOND), 100);  // 400 ms of 4 s
+
+  // A period still open counts up to now
+  power.acquire(POWER_RENDER, 4 * SECOND);
+  CHECK_EQ(power.awakePermille(5 * SECOND), 280);
+  power.release(POWER_RENDER, 5 * SECOND);
+  CHECK_EQ(power.statsSeconds(5 * SECOND), 5);
+
+  // Reset while a lock is held: counting goes on from the reset
+  power.acquire(POWER_RENDER, 5 * SECOND);
+  power.resetStats(6 * SECOND);
+  CHECK_EQ(power.wakeupsPerHour(7 * SECOND), 0);
+  power.release(POWER_RENDER, 7 * SECOND);
+  CHECK_EQ(power.awakePermille(8 * SECOND), 500);
+}
+
+// A simulated day of 30 s jiggles (150 ms each) and a countdown redrawn
+// every second (4 ms each), with deadlines from the scheduler
+static void testDay() {
+  PowerManager power;
+  power.begin(240, 80, true, 0);
+  JiggleScheduler scheduler;
+  scheduler.setInterval(30000);
+  scheduler.start(0);
+  const int64_t day = 86400 * SECOND;
+  uint32_t jiggles = 0;
+  for (int64_t t = SECOND; t < day; t += SECOND) {
+    power.acquire(POWER_RENDER, t);
+    bool jiggle = scheduler.isDue(t);
+    if (jiggle) {
+      scheduler.fired(t);
+      power.acquire(POWER_MOTION, t + 1);
+      jiggles++;
+    }
+    power.release(POWER_RENDER, t + 4 * MS);
+    if (jiggle) power.release(POWER_MOTION, t + 150 * MS + 1);
+  }
+  CHECK_EQ(jiggles, 2879);
+
+  // 86399 redraws of 4 ms, and each jiggle adds 146 ms past its redraw
+  int64_t awake = 86399 * 4 * MS + 2879 * (146 * MS + 1);
+  CHECK_EQ(power.awakePermille(day), awake * 1000 / day);
+  // A jiggle starts inside a redraw: one wakeup, not two
+  CHECK_EQ(power.wakeupsPerHour(day), 86399 / 24);
+}
+
+static void testGuard() {
+  PowerManager power;
+  power.begin(240, 80, false, PowerManager::now());
+  CHECK(!power.isSleepEnabled());
+  {
+    PowerGuard none(nullptr, POWER_HTTP);
+  }
+  {
+    PowerGuard guard(&power, POWER_HTTP);
+    CHECK(power.isAwake());
+    CHECK(power.isHeld(POWER_HTTP));
+  }
+  CHECK(!power.isAwake());
+}
+
+// The UI, HTTP and BLE tasks take their locks concurrently
+static void testTasks() {
+  PowerManager power;
+  power.begin(240, 80, true, PowerManager::now());
+  const PowerLock locks[] = {POWER_RENDER, POWER_HTTP, POWER_MOTION};
+  std::thread tasks[3];
+  for (int i = 0; i < 3; i++) {
+    tasks[i] = std::thread([&power, &locks, i]() {
+      for (int n = 0; n < 20000; n++) {
+        PowerGuard guard(&power, locks[i]);
+        if (n % 500 == 0) std::this_thread::yield();
+      }
+    });
+  }
+  for (std::thread& task : tasks) task.join();
+  CHECK(!power.isAwake());
+  for (PowerLock lock : locks) CHECK(!power.isHeld(lock));
+  CHECK(power.awakePermille(PowerManager::now()) <= 1000);
+}
+
+int main() {
+  testAccounting();
+  testDay();
+  testGuard();
+  testTasks();
+  return testResult("test_power_manager");
+}
@@ -0,0 +1,121 @@
+// Profiler, built with PROFILE_SCOPES as the firmware is with
+// -DPROFILE_SCOPES: the log2 buckets, nested scopes and their totals,
+// reset(), and the /api/stats route
+
+#include "Check.h"
+#include "Profiler.h"
+#include "WebServer.h"
+#include <string>
+
+#ifndef PROFILE_SCOPES
+#error test_profiler is built with PROFILE_SCOPES
+#endif
+
+static const int64_t MS = 1000;
+
+static uint32_t bucketCount(const ProfileStats& s) {
+  uint32_t n = 0;
+  for (uint32_t b : s.buckets) n += b;
+  return n;
+}
+
+static void testBuckets() {
+  ProfileStats s = {};
+  for (uint32_t us : {0u, 1u, 2u, 3u, 4u, 1023u, 1024u, 300000u, 0xFFFFFFFFu}) s.add(us);
+  CHECK_EQ(s.buckets[0], 2);
+  CHECK_EQ(s.buckets[1], 2);
+  CHECK_EQ(s.buckets[2], 1);
+  CHECK_EQ(s.buckets[9], 1);
+  CHECK_EQ(s.buckets[10], 1);
+  CHECK_EQ(s.buckets[18], 1);  // 2^18 = 262144
+  CHECK_EQ(s.buckets[ProfileStats::BUCKETS - 1], 1);
+  CHECK_EQ(s.calls, 9);
+  CHECK_EQ(bucketCount(s), 9);
+  CHECK_EQ(s.maxUs, 0xFFFFFFFF);
+  CHECK_EQ(s.totalUs, 0 + 1 + 2 + 3 + 4 + 1023 + 1024 + 300000 + 0xFFFFFFFFull);
+  CHECK_EQ(ProfileStats::bucketStartUs(0), 0);
+  CHECK_EQ(ProfileStats::bucketStartUs(10), 1024);
+
+  // Out of range times are clamped, not wrapped
+  Profiler& profiler = Profiler::instance();
+  profiler.reset();
+  profiler.add(PROF_JIGGLE, -5);
+  profiler.add(PROF_JIGGLE, 0x100000000LL);
+  ProfileStats stats[PROF_COUNT];
+  profiler.copy(stats);
+  CHECK_EQ(stats[PROF_JIGGLE].buckets[0], 1);
+  CHECK_EQ(stats[PROF_JIGGLE].maxUs, 0xFFFFFFFF);
+}
+
+// An outer scope holds an inner one: both count every call, and the outer
+// total takes in the inner one
+static void testNested() {
+  Profiler& profiler = Profiler::instance();
+  profiler.reset();
+  for (int i = 0; i < 5; i++) {
+    PROFILE_SCOPE(PROF_HTTP);
+    Task::sleep(2);
+    {
+      PROFILE_SCOPE(PROF_NVS_WRITE);
+      Task::sleep(2);
+    }
+  }
+  ProfileStats stats[PROF_COUNT];
+  int64_t since = profiler.copy(stats);
+  const ProfileStats& outer = stats[PROF_HTTP];
+  const ProfileStats& inner = stats[PROF_NVS_WRITE];
+  CHECK_EQ(outer.calls, 5);
+  CHECK_EQ(inner.calls, 5);
+  CHECK_EQ(bucketCount(outer), 5);
+  CHECK_EQ(bucketCount(inner), 5);
+  CHECK(inner.totalUs >= 10 * MS);
+  CHECK(outer.totalUs >= inner.totalUs + 10 * MS);
+  CHECK(outer.maxUs >= 4 * MS && outer.maxUs * 5 >= outer.totalUs);
+  CHECK(outer.totalUs <= (uint64_t)(Profiler::now() - since));
+  // At least 2 ms inside and 4 ms outside: nothing below 1024 and 2048 us
+  for (uint8_t b = 0; b < 10; b++) CHECK_EQ(inner.buckets[b], 0);
+  for (uint8_t b = 0; b < 11; b++) CHECK_EQ(outer.buckets[b], 0);
+  for (uint8_t i = 0; i < PROF_COUNT; i++) {
+    if (i != PROF_HTTP && i != PROF_NVS_WRITE) CHECK_EQ(stats[i].calls, 0);
+  }
+
+  profiler.reset();
+  profiler.copy(stats);
+  CHECK_EQ(stats[PROF_HTTP].calls, 0);
+  CHECK_EQ(bucketCount(stats[PROF_NVS_WRITE]), 0);
+}
+
+static std::string get(JigglerWebServer& server, const char* path) {
+  auto connection = hostConnect(std::string("GET ") + path + " HTTP/1.1\r\nHost: 192.168.4.1\r\n\r\n");
+  server.handleClient();
+  size_t split = connection->response.find("\r\n\r\n");
+  return split == std::string::npos ? "" : connection->response.substr(split + 4);
+}
+
+static void testApi() {
+  Serial.setEcho(false);
+  ConfigManager configManager;
+  configManager.begin();
+  JigglerWebServer server;
+  server.begin(&configManager);
+
+  Profiler::instance().reset();
+  for (int i = 0; i < 3; i++) Profiler::instance().add(PROF_COUNTDOWN, 1500);
+  std::string json = get(server, "/api/stats");
+  CHECK(json.find("\"seconds\":") != std::string::npos);
+  CHECK(json.find("{\"name\":\"countdown\",\"calls\":3,\"totalUs\":4500,\"maxUs\":1500,"
+                  "\"buckets\":[0,0,0,0,0,0,0,0,0,0,3,0,0,0,0,0,0,0,0,0]}") != std::string::npos);
+  CHECK(json.find("{\"name\":\"nvs_write\",\"calls\":0,") != std::string::npos);
+
+  // The request itself was timed as an http scope
+  ProfileStats stats[PROF_COUNT];
+  Profiler::instance().copy(stats);
+  CHECK(stats[PROF_HTTP].calls >= 1);
+}
+
+int main() {
+  testBuckets();
+  testNested();
+  testApi();
+  return testResult("test_profiler");
+}
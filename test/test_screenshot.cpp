@@ -0,0 +1,119 @@
+// GET /api/screenshot: decode the BMP the web server streams and compare
+// every row with Paint_ReadLine() and with what the emulated panel shows
+
+#include "Check.h"
+#include "HostPanel.h"
+#include "LCD_Driver.h"
+#include "GUI_Paint.h"
+#include "GUI_Strip.h"
+#include "WebServer.h"
+
+static uint32_t le16(const uint8_t* p) {
+  return p[0] | p[1] << 8;
+}
+
+static uint32_t le32(const uint8_t* p) {
+  return le16(p) | le16(p + 2) << 16;
+}
+
+static void drawScreen(const char* label) {
+  static const PAINT_GRADIENT gradient = {GRADIENT_VERTICAL, 2, 0, 24, {0x04DF, 0x000C, 0}};
+  Paint_BeginFrame();
+  Paint_Clear(0x0010);
+  Paint_DrawGradient(0, 0, LCD_HEIGHT, 25, &gradient);
+  Paint_DrawString_EN(8, 5, label, &Font16, FONT_BACKGROUND, 0xFFFF);
+  Paint_DrawCircle(200, 90, 30, 0xF800, DOT_PIXEL_1X1, DRAW_FILL_FULL);
+  Paint_DrawLine(0, 134, 239, 30, 0x07E0, DOT_PIXEL_2X2, LINE_STYLE_SOLID);
+  Paint_DrawNum(10, 100, 1234567, &Font20, 0x0010, 0xFFE0);
+  Paint_EndFrame();
+
+  // A notice on the overlay, blended over the base layer
+  Paint_BeginOverlay(192, OVERLAY_NO_KEY);
+  Paint_ClearWindows(40, 45, 200, 80, 0x0000);
+  Paint_DrawString_EN(50, 53, "Saved", &Font16, FONT_BACKGROUND, 0xFFFF);
+  Paint_EndFrame();
+}
+
+static void checkScreenshot(JigglerWebServer& server, const char* name) {
+  auto connection = hostConnect("GET /api/screenshot HTTP/1.1\r\nHost: 192.168.4.1\r\n\r\n");
+  server.handleClient();
+
+  const std::string& response = connection->response;
+  size_t split = response.find("\r\n\r\n");
+  CHECK(response.compare(0, 15, "HTTP/1.1 200 OK") == 0);
+  if (split == std::string::npos) return;
+  std::string head = response.substr(0, split);
+  const uint8_t* bmp = (const uint8_t*)response.data() + split + 4;
+  size_t size = response.size() - split - 4;
+
+  size_t lengthAt = head.find("Content-Length: ");
+  CHECK(lengthAt != std::string::npos);
+  if (lengthAt != std::string::npos) CHECK_EQ(atol(head.c_str() + lengthAt + 16), size);
+  for (size_t n : connection->writes) CHECK(n <= 1436);
+
+  CHECK(size >= 66);
+  if (size < 66) return;
+  CHECK(bmp[0] == 'B' && bmp[1] == 'M');
+  CHECK_EQ(le32(bmp + 2), size);
+  uint32_t offset = le32(bmp + 10);
+  int32_t width = le32(bmp + 18);
+  int32_t height = -(int32_t)le32(bmp + 22);  // top-down
+  CHECK_EQ(le32(bmp + 14), 40);
+  CHECK_EQ(width, Paint.Width);
+  CHECK_EQ(height, Paint.Height);
+  CHECK_EQ(le16(bmp + 28), 16);
+  CHECK_EQ(le32(bmp + 30), 3);
+  CHECK_EQ(le32(bmp + 54), 0xF800);
+  CHECK_EQ(le32(bmp + 58), 0x07E0);
+  CHECK_EQ(le32(bmp + 62), 0x001F);
+  uint32_t stride = (width * 2 + 3) & ~3;
+  CHECK_EQ(size, offset + stride * height);
+  if (size != offset + stride * height) return;
+
+  uint32_t readDiffs = 0, panelDiffs = 0;
+  UWORD line[320];
+  for (int y = 0; y < height; y++) {
+    CHECK(Paint_ReadLine(y, line));
+    for (int x = 0; x < width; x++) {
+      UWORD pixel = le16(bmp + offset + y * stride + x * 2);
+      int mx, my;
+      Paint_MapPoint(x, y, &mx, &my);
+      readDiffs += pixel != line[x];
+      panelDiffs += pixel != hostPanel.visible(mx, my);
+    }
+  }
+  if (readDiffs || panelDiffs) printf("%s: %u pixels differ from Paint_ReadLine, %u from the panel\n", name, readDiffs, panelDiffs);
+  CHECK_EQ(readDiffs, 0);
+  CHECK_EQ(panelDiffs, 0);
+}
+
+int main() {
+  Serial.setEcho(false);
+  Config_Init();
+  LCD_Init();
+  Paint_NewImage(LCD_WIDTH, LCD_HEIGHT, 90, WHITE);
+  Paint_SetRotate(90);
+  CHECK(Paint_SetFrameBudget(PAINT_STRIP_BYTES_DFT, PAINT_LIST_BYTES_DFT));
+
+  ConfigManager configManager;
+  configManager.begin();
+  JigglerWebServer server;
+  server.begin(&configManager);
+
+  drawScreen("Rotate 90");
+  checkScreenshot(server, "rotate_90");
+
+  // Rows that run backwards through panel memory
+  Paint_SetRotate(270);
+  Paint_SetMirroring(MIRROR_HORIZONTAL);
+  drawScreen("Rotate 270, mirrored");
+  checkScreenshot(server, "rotate_270_mirrored");
+
+  // Without a display list there is nothing to read back
+  Paint_SetFrameBudget(0, 0);
+  auto connection = hostConnect("GET /api/screenshot HTTP/1.1\r\n\r\n");
+  server.handleClient();
+  CHECK(connection->response.compare(0, 12, "HTTP/1.1 503") == 0);
+
+  return testResult("test_screenshot");
+}
@@ -0,0 +1,183 @@
+// The task primitives of Tasks.h on std::thread, and ConfigManager read
+// from one thread while another saves: the hand-offs the firmware's BLE,
+// UI and HTTP tasks rely on
+
+#include "Check.h"
+#include "Tasks.h"
+#include "Config.h"
+#include <atomic>
+#include <chrono>
+#include <thread>
+
+static const uint32_t FLAG_A = 1 << 0;
+static const uint32_t FLAG_B = 1 << 1;
+
+static long long elapsedMs(std::chrono::steady_clock::time_point since) {
+  return std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - since).count();
+}
+
+static void testEventFlags() {
+  EventFlags events;
+  CHECK(events.begin());
+
+  // Nothing set: the wait times out without the flags
+  auto start = std::chrono::steady_clock::now();
+  CHECK_EQ(events.wait(FLAG_A, 20) & FLAG_A, 0);
+  CHECK(elapsedMs(start) >= 20);
+
+  // Set from another task: wakes the waiter, and the awaited flags are cleared
+  std::thread setter([&]() {
+    Task::sleep(10);
+    events.set(FLAG_A);
+  });
+  CHECK(events.wait(FLAG_A | FLAG_B, TASK_WAIT_FOREVER) & FLAG_A);
+  setter.join();
+  CHECK_EQ(events.wait(FLAG_A, 0) & FLAG_A, 0);
+
+  // waitAll needs every flag; flags that are not awaited stay set
+  events.set(FLAG_A);
+  CHECK_EQ(events.wait(FLAG_A | FLAG_B, 10, true) & FLAG_B, 0);
+  events.set(FLAG_B);
+  CHECK_EQ(events.wait(FLAG_A | FLAG_B, 10, true) & (FLAG_A | FLAG_B), FLAG_A | FLAG_B);
+  events.set(FLAG_A | FLAG_B);
+  CHECK(events.wait(FLAG_A, 0) & FLAG_A);
+  CHECK(events.wait(FLAG_B, 0) & FLAG_B);
+
+  events.set(FLAG_A);
+  events.clear(FLAG_A);
+  CHECK_EQ(events.wait(FLAG_A, 0) & FLAG_A, 0);
+}
+
+static void testMessageQueue() {
+  MessageQueue<int, 4> queue;
+  CHECK(queue.begin());
+
+  // First in, first out; a full queue refuses
+  for (int i = 0; i < 4; i++) CHECK(queue.send(i));
+  CHECK(!queue.send(4));
+  CHECK(!queue.send(4, 10));
+  int value = -1;
+  for (int i = 0; i < 4; i++) {
+    CHECK(queue.receive(value, 0));
+    CHECK_EQ(value, i);
+  }
+  CHECK(!queue.receive(value, 10));
+
+  // A producer faster than the consumer blocks instead of losing messages
+  const int COUNT = 1000;
+  std::thread producer([&]() {
+    for (int i = 0; i < COUNT; i++) queue.send(i, TASK_WAIT_FOREVER);
+  });
+  int received = 0;
+  bool ordered = true;
+  while (received < COUNT && queue.receive(value, 1000)) ordered &= value == received++;
+  producer.join();
+  CHECK_EQ(received, COUNT);
+  CHECK(ordered);
+}
+
+static void testMutex() {
+  Mutex mutex;
+  CHECK(mutex.begin());
+  long counter = 0;
+  const int THREADS = 4, ROUNDS = 20000;
+  std::thread threads[THREADS];
+  for (std::thread& thread : threads) {
+    thread = std::thread([&]() {
+      for (int i = 0; i < ROUNDS; i++) {
+        LockGuard guard(&mutex);
+        long v = counter;
+        if ((i & 255) == 0) std::this_thread::yield();
+        counter = v + 1;
+      }
+    });
+  }
+  for (std::thread& thread : threads) thread.join();
+  CHECK_EQ(counter, THREADS * ROUNDS);
+
+  LockGuard none(nullptr);  // no mutex, nothing to lock
+}
+
+static void testDeadlineTimer() {
+  // Never destroyed, like the firmware's: the timer thread runs for good
+  EventFlags& events = *new EventFlags;
+  events.begin();
+  DeadlineTimer& timer = *new DeadlineTimer;
+  CHECK(timer.begin(&events, FLAG_A));
+
+  auto start = std::chrono::steady_clock::now();
+  timer.start(30000);
+  CHECK(events.wait(FLAG_A, 1000) & FLAG_A);
+  long long took = elapsedMs(start);
+  CHECK(took >= 30 && took < 500);
+
+  // Restarting replaces the pending deadline
+  start = std::chrono::steady_clock::now();
+  timer.start(500000);
+  timer.start(20000);
+  CHECK(events.wait(FLAG_A, 1000) & FLAG_A);
+  CHECK(elapsedMs(start) < 400);
+
+  // Stopped: never fires
+  timer.start(20000);
+  timer.stop();
+  CHECK_EQ(events.wait(FLAG_A, 100) & FLAG_A, 0);
+}
+
+// The HTTP task saves while the BLE task reads: every copy is one of the
+// saved settings, never a mix of two
+static void testConfigSnapshots() {
+  Preferences::reset();
+  ConfigManager manager;
+  manager.begin();
+
+  JigglerConfig first = ConfigManager::defaults();
+  JigglerConfig second = first;
+  second.jiggleInterval = 120000;
+  second.moveDistance = 9;
+  strcpy(second.deviceName, "Second, with a longer name");
+  memset(second.schedule, 0x0F, sizeof(second.schedule));
+
+  std::atomic<bool> done(false);
+  std::thread writer([&]() {
+    for (int i = 0; i < 20000; i++) manager.setConfig(i & 1 ? second : first);
+    done = true;
+  });
+  uint32_t reads = 0, torn = 0;
+  while (!done) {
+    JigglerConfig copy = manager.getConfig();
+    const JigglerConfig& expected = copy.jiggleInterval == second.jiggleInterval ? second : first;
+    torn += copy.moveDistance != expected.moveDistance || strcmp(copy.deviceName, expected.deviceName) != 0 ||
+            memcmp(copy.schedule, expected.schedule, sizeof(copy.schedule)) != 0;
+    reads++;
+  }
+  writer.join();
+  CHECK(reads > 0);
+  CHECK_EQ(torn, 0);
+
+  // A copy does not follow later saves
+  JigglerConfig copy = manager.getConfig();
+  manager.setConfig(first);
+  CHECK_EQ(copy.jiggleInterval, second.jiggleInterval);
+  CHECK_EQ(manager.getConfig().jiggleInterval, first.jiggleInterval);
+
+  // Saved to NVS as well: a new manager loads it
+  ConfigManager reloaded;
+  reloaded.begin();
+  CHECK_EQ(reloaded.getConfig().jiggleInterval, first.jiggleInterval);
+
+  manager.setConfig(second);
+  manager.resetToDefaults();
+  CHECK_EQ(manager.getConfig().jiggleInterval, ConfigManager::defaults().jiggleInterval);
+  CHECK(strcmp(manager.getConfig().deviceName, ConfigManager::defaults().deviceName) == 0);
+}
+
+int main() {
+  Serial.setEcho(false);
+  testEventFlags();
+  testMessageQueue();
+  testMutex();
+  testDeadlineTimer();
+  testConfigSnapshots();
+  return testResult("test_tasks");
+}
@@ -0,0 +1,173 @@
+// WeekSchedule and WallClock: rules compiled to the week's quarter hours,
+// windows past midnight (Sunday into Monday too), "except" and 24:00, the
+// errors and the lines they point at, random weeks through decompile() and
+// back, and the local day and minute of a known time
+
+#include "Check.h"
+#include "WeekSchedule.h"
+
+static bool compiles(const char* rules, uint8_t* bits) {
+  WeekSchedule::Result result = WeekSchedule::compile(rules, bits);
+  if (!result.ok) printf("\"%s\": line %u: %s\n", rules, result.line, result.error);
+  return result.ok;
+}
+
+static void checkError(const char* rules, uint16_t line, const char* error) {
+  uint8_t bits[WeekSchedule::BYTES];
+  WeekSchedule::Result result = WeekSchedule::compile(rules, bits);
+  bool same = !result.ok && result.line == line && result.error && strcmp(result.error, error) == 0;
+  if (!same) {
+    printf("\"%s\": expected line %u: %s, got %s line %u: %s\n", rules, line, error,
+           result.ok ? "ok" : "error", result.line, result.error ? result.error : "-");
+  }
+  CHECK(same);
+}
+
+// Day 0 is Monday; minute of the day
+static bool open(const uint8_t* bits, uint8_t day, uint8_t hour, uint8_t minute) {
+  return WeekSchedule::isOpen(bits, day, hour * 60 + minute);
+}
+
+static void testRules() {
+  uint8_t bits[WeekSchedule::BYTES];
+  CHECK(compiles("Mon-Fri 08:30-18:00\nexcept Mon-Fri 12:00-13:00  # lunch", bits));
+  CHECK(!open(bits, 0, 8, 29) && open(bits, 0, 8, 30) && open(bits, 4, 17, 59) && !open(bits, 4, 18, 0));
+  CHECK(open(bits, 2, 11, 59) && !open(bits, 2, 12, 0) && !open(bits, 2, 12, 59) && open(bits, 2, 13, 0));
+  CHECK(!open(bits, 5, 10, 0) && !open(bits, 6, 10, 0));
+  CHECK_EQ(WeekSchedule::openSlots(bits), 5 * (38 - 4));
+
+  // Lists, single-digit hours and ';'
+  CHECK(compiles("Mon,Wed,Fri-Sun 9:00-9:15; Tue 07:45-08:00", bits));
+  CHECK_EQ(WeekSchedule::openSlots(bits), 6);
+  CHECK(open(bits, 0, 9, 0) && !open(bits, 1, 9, 0) && open(bits, 6, 9, 14) && open(bits, 1, 7, 45));
+
+  // Past midnight, and from Sunday into Monday
+  CHECK(compiles("Fri 22:00-02:00\nSun 23:00-01:00", bits));
+  CHECK(!open(bits, 4, 21, 45) && open(bits, 4, 23, 59) && open(bits, 5, 1, 59) && !open(bits, 5, 2, 0));
+  CHECK(open(bits, 6, 23, 0) && open(bits, 0, 0, 45) && !open(bits, 0, 1, 0) && !open(bits, 6, 0, 30));
+  CHECK_EQ(WeekSchedule::openSlots(bits), 16 + 8);
+
+  // 24:00 is the end of the day; a range of days may wrap
+  CHECK(compiles("daily 18:00-24:00\nexcept Sat-Mon 20:00-24:00", bits));
+  CHECK(open(bits, 3, 23, 45) && !open(bits, 4, 0, 0) && open(bits, 5, 19, 45) && !open(bits, 6, 20, 0));
+  CHECK(!open(bits, 0, 23, 0) && open(bits, 1, 23, 0));
+  CHECK(compiles("Tue 00:00-24:00", bits));
+  CHECK_EQ(WeekSchedule::openSlots(bits), 96);
+}
+
+static void testErrors() {
+  checkError("Mon 25:00-26:00", 1, "bad time");
+  checkError("Mon 8-9", 1, "bad time");
+  checkError("Mon 08:00-9:5", 1, "bad time");
+  checkError("Mon 24:15-01:00", 1, "bad time");
+  checkError("\n# comment\nMon 08:00-08:00", 3, "window is empty");
+  checkError("Mon 08:00-09:00\nMo 08:00-09:00", 2, "unknown day");
+  checkError("Mon-Fry 08:00-09:00", 1, "unknown day");
+  checkError("Mon 08:10-09:00", 1, "times must be on the quarter hour");
+  checkError("Mon 24:00-01:00", 1, "window starts at 24:00");
+  checkError("Mon 08:00", 1, "expected a time like 08:30-18:00");
+  checkError("Mon", 1, "expected a time like 08:30-18:00");
+  checkError("Mon 08:00-09:00 sharp", 1, "unexpected text after the time");
+  checkError("  # nothing\n\n", 0, "no rules");
+  checkError("Mon 08:00-09:00\nexcept daily 00:00-24:00", 0, "the rules leave no time to jiggle");
+}
+
+static uint32_t lcg = 2024;
+static uint32_t nextRandom() {
+  lcg = lcg * 1664525 + 1013904223;
+  return lcg >> 8;
+}
+
+// Random weeks, half of them noise and half of them runs, decompile to
+// rules that compile back to the same bits
+static void testRoundTrip() {
+  static char text[32768];
+  uint32_t failed = 0;
+  for (int i = 0; i < 20000; i++) {
+    uint8_t bits[WeekSchedule::BYTES] = {};
+    if (i % 2) {
+      for (uint8_t& b : bits) b = nextRandom();
+    } else {
+      bool on = nextRandom() & 1;
+      for (uint16_t s = 0; s < WeekSchedule::SLOTS;) {
+        uint16_t run = 1 + nextRandom() % 40;
+        for (; run && s < WeekSchedule::SLOTS; run--, s++) {
+          if (on) bits[s >> 3] |= 1 << (s & 7);
+        }
+        on = !on;
+      }
+    }
+    if (WeekSchedule::openSlots(bits) == 0) bits[0] = 1;
+
+    size_t n = WeekSchedule::decompile(bits, text, sizeof(text));
+    uint8_t again[WeekSchedule::BYTES];
+    WeekSchedule::Result result = WeekSchedule::compile(text, again);
+    if (n == 0 || n + 1 >= sizeof(text) || !result.ok || memcmp(bits, again, sizeof(bits)) != 0) {
+      if (!failed) printf("week %d does not round trip: %s\n", i, result.ok ? "different bits" : result.error);
+      failed++;
+    }
+  }
+  CHECK_EQ(failed, 0);
+
+  // Days with the same windows share a line
+  uint8_t bits[WeekSchedule::BYTES];
+  CHECK(compiles("Mon-Fri 08:30-18:00\nexcept Mon-Fri 12:00-13:00", bits));
+  CHECK_EQ(WeekSchedule::decompile(bits, text, sizeof(text)), 40);
+  CHECK(strcmp(text, "Mon-Fri 08:30-12:00\nMon-Fri 13:00-18:00\n") == 0);
+  CHECK(compiles("daily 00:00-24:00", bits));
+  WeekSchedule::decompile(bits, text, sizeof(text));
+  CHECK(strcmp(text, "daily 00:00-24:00\n") == 0);
+}
+
+static void testClock() {
+  // 1700000000 is Tuesday 14 November 2023, 22:13:20 UTC
+  static const int64_t EPOCH = 1700000000;
+  static const int64_t SECOND = 1000000;
+  WallClock clock;
+  clock.begin();
+  uint8_t day = 9;
+  uint16_t minute = 9;
+  CHECK(!clock.isSet());
+  CHECK(!clock.local(0, day, minute));
+
+  // Unknown time: open whatever the rules say
+  uint8_t bits[WeekSchedule::BYTES];
+  CHECK(compiles("Sun 00:00-00:15", bits));
+  CHECK(WeekSchedule::isOpenAt(bits, clock, 0));
+
+  clock.setTime(EPOCH, 0, 5 * SECOND);
+  CHECK(clock.isSet());
+  CHECK(clock.local(5 * SECOND, day, minute));
+  CHECK_EQ(day, 1);
+  CHECK_EQ(minute, 22 * 60 + 13);
+  CHECK(!WeekSchedule::isOpenAt(bits, clock, 5 * SECOND));
+
+  // Counts on from uptime, into Wednesday
+  CHECK(clock.local(5 * SECOND + 2 * 3600 * SECOND, day, minute));
+  CHECK_EQ(day, 2);
+  CHECK_EQ(minute, 13);
+  int64_t us = 0;
+  CHECK(clock.localUs(5 * SECOND, us));
+  CHECK_EQ(us, EPOCH * SECOND);
+
+  // CET and a time zone west of UTC; Sunday evening in New York
+  clock.setTime(EPOCH, 60, 0);
+  CHECK(clock.local(0, day, minute));
+  CHECK(day == 1 && minute == 23 * 60 + 13);
+  clock.setTime(EPOCH + 4 * 86400, -300, 0);
+  CHECK(clock.local(0, day, minute));
+  CHECK(day == 5 && minute == 17 * 60 + 13);
+  clock.setTime(EPOCH + 4 * 86400 + 7 * 3600 - 13 * 60, -300, 0);
+  CHECK(clock.local(0, day, minute));
+  CHECK(day == 6 && minute == 0);
+  CHECK(WeekSchedule::isOpenAt(bits, clock, 14 * 60 * SECOND));
+  CHECK(!WeekSchedule::isOpenAt(bits, clock, 15 * 60 * SECOND));
+}
+
+int main() {
+  testRules();
+  testErrors();
+  testRoundTrip();
+  testClock();
+  return testResult("test_week_schedule");
+}
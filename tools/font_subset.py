@@ -0,0 +1,232 @@
+"""Generate src/font_subset.cpp: bit-packed, subsetted copies of the ASCII fonts.
+
+The full tables in src/font*.cpp store every printable ASCII character with
+each glyph row padded to whole bytes. The UI only draws a few characters in
+most sizes, so for each font this keeps:
+
+  - the characters of every string or char literal drawn with it (any
+    statement in src/ mentioning &FontN), plus a declared charset for text
+    that is only known at run time, or the full set when the charset is None
+  - the glyph bits packed back to back, with no padding at the end of a row
+
+A 95-entry remap table turns a character into its glyph index. Characters
+that are not in the subset map to the space glyph.
+
+The output is only compiled with -DFONT_SUBSET, which also compiles out the
+full tables. src/font_subset.cpp is checked in, and the build never writes
+to src/: as a PlatformIO pre-script (see platformio.ini) this only checks
+that the file is up to date, and fails the build when it is not. Regenerate
+it by hand:
+
+  python tools/font_subset.py            rewrite src/font_subset.cpp
+  python tools/font_subset.py --check    exit 1 if it is out of date
+"""
+
+import os
+import re
+import sys
+
+# name, source file, table symbol, charset for run-time text (None: full ASCII)
+FONTS = [
+    ("Font8", "font8.cpp", "Font8_Table", "0123456789."),  # IP address
+    ("Font16", "font16.cpp", "Font16_Table", None),        # SSID, password, notices
+    ("Font20", "font20.cpp", "Font20_Table", "0123456789."),  # IP address on the WIFI_Driver demo pages
+    ("Font24", "font24.cpp", "Font24_Table", ""),
+]
+
+FIRST, LAST = 0x20, 0x7E
+CHARS = LAST - FIRST + 1
+OUTPUT = "font_subset.cpp"
+
+
+def read(path):
+    with open(path, encoding="utf-8", errors="replace") as f:
+        return f.read()
+
+
+def strip_comments(text):
+    """Remove comments, keeping line numbers."""
+    text = re.sub(r"/\*.*?\*/", lambda m: "\n" * m.group(0).count("\n"), text, flags=re.S)
+    return re.sub(r"//[^\n]*", "", text)
+
+
+def load_table(path, symbol):
+    text = strip_comments(read(path))
+    match = re.search(re.escape(symbol) + r"\s*\[\s*\]\s*PROGMEM\s*=\s*\{(.*?)\};", text, re.S)
+    if not match:
+        sys.exit("font_subset: %s not found in %s" % (symbol, path))
+    return [int(v, 16) for v in re.findall(r"0x([0-9A-Fa-f]{2})", match.group(1))]
+
+
+def literal_chars(statement):
+    chars = set()
+    for body in re.findall(r'"((?:[^"\\]|\\.)*)"', statement):
+        chars.update(bytes(body, "utf-8").decode("unicode_escape"))
+    for body in re.findall(r"'((?:[^'\\]|\\.))'", statement):
+        chars.update(bytes(body, "utf-8").decode("unicode_escape"))
+    return chars
+
+
+def scan_sources(src, names):
+    """Characters drawn with each font, and statements that draw run-time text."""
+    used = {name: set() for name in names}
+    dynamic = {name: [] for name in names}
+    for file in sorted(os.listdir(src)):
+        if not file.endswith((".cpp", ".h")) or file.startswith("font") or file == OUTPUT:
+            continue
+        text = strip_comments(read(os.path.join(src, file)))
+        line = 1
+        for statement in text.split(";"):
+            start = line + statement[:len(statement) - len(statement.lstrip())].count("\n")
+            line += statement.count("\n")
+            for name in names:
+                if not re.search(r"&" + name + r"\b", statement):
+                    continue
+                chars = literal_chars(statement)
+                used[name] |= chars
+                call = re.search(r"Paint_Draw(String_EN|Char)\s*\(([^,]*,){2}\s*([^,]*),", statement)
+                drawn = re.search(r"\bPaint_Draw\w*\s*\(", statement)
+                if drawn and (not chars or (call and not call.group(3).strip().startswith(("\"", "'")))):
+                    dynamic[name].append("%s:%d" % (file, start))
+    return used, dynamic
+
+
+def pack(table, width, height, glyphs):
+    stride = (width + 7) // 8
+    out = []
+    for code in glyphs:
+        base = (code - FIRST) * height * stride
+        bits = []
+        for row in range(height):
+            for col in range(width):
+                byte = table[base + row * stride + col // 8]
+                bits.append((byte >> (7 - col % 8)) & 1)
+        bits += [0] * (-len(bits) % 8)
+        for i in range(0, len(bits), 8):
+            out.append(sum(bit << (7 - j) for j, bit in enumerate(bits[i:i + 8])))
+    return out
+
+
+def c_array(values, indent="  ", per_line=16):
+    lines = []
+    for i in range(0, len(values), per_line):
+        lines.append(indent + ", ".join("0x%02X" % v for v in values[i:i + per_line]) + ",")
+    return lines
+
+
+def generate(project):
+    """The contents of src/font_subset.cpp, and a size report."""
+    src = os.path.join(project, "src")
+    used, dynamic = scan_sources(src, [f[0] for f in FONTS])
+
+    parts = [
+        "/*****************************************************************************",
+        "* | File        :   font_subset.cpp",
+        "* | Function    :   Subsetted, bit-packed ASCII fonts",
+        "* | Info        :",
+        "*   Generated by tools/font_subset.py from font*.cpp and the text drawn",
+        "*   with each font. Do not edit; rebuild or rerun the script instead.",
+        "******************************************************************************/",
+        "#ifdef FONT_SUBSET",
+        "",
+        "#include <stddef.h>",
+        '#include "fonts.h"',
+        "",
+    ]
+    report = []
+    total_full = total_subset = 0
+
+    for name, file, symbol, charset in FONTS:
+        path = os.path.join(src, file)
+        width = int(re.search(r"(\d+),\s*/\*\s*Width", read(path)).group(1))
+        height = int(re.search(r"(\d+),\s*/\*\s*Height", read(path)).group(1))
+        table = load_table(path, symbol)
+        full = CHARS * height * ((width + 7) // 8)
+        if len(table) != full:
+            sys.exit("font_subset: %s has %d bytes, expected %d" % (symbol, len(table), full))
+
+        if charset is None:
+            glyphs = list(range(FIRST, LAST + 1))
+        else:
+            wanted = used[name] | set(charset) | {" "}
+            glyphs = sorted(ord(c) for c in wanted if FIRST <= ord(c) <= LAST)
+            if charset == "" and dynamic[name]:
+                print("font_subset: %s draws run-time text at %s; declare its characters"
+                      % (name, ", ".join(dynamic[name])))
+
+        glyph_bytes = (width * height + 7) // 8
+        packed = pack(table, width, height, glyphs)
+        remap = [glyphs.index(c) if c in glyphs else glyphs.index(ord(" ")) for c in range(FIRST, LAST + 1)]
+        subset = len(packed) + (CHARS if charset is not None else 0)
+        total_full += full
+        total_subset += subset
+
+        shown = "".join(chr(c) for c in glyphs)
+        parts.append("// %s: %d of %d glyphs, %dx%d, %d bytes each (%d padded)"
+                     % (name, len(glyphs), CHARS, width, height, glyph_bytes, full // CHARS))
+        if charset is not None:
+            parts.append('// "%s"' % shown)
+            parts.append("static const uint8_t %s_Remap[%d] PROGMEM =" % (name, CHARS))
+            parts.append("{")
+            parts.extend(c_array(remap))
+            parts.append("};")
+            parts.append("")
+        parts.append("static const uint8_t %s_Packed[%d] PROGMEM =" % (name, len(packed)))
+        parts.append("{")
+        parts.extend(c_array(packed))
+        parts.append("};")
+        parts.append("")
+        parts.append("sFONT %s = {" % name)
+        parts.append("  %s_Packed," % name)
+        parts.append("  %d, /* Width */" % width)
+        parts.append("  %d, /* Height */" % height)
+        parts.append("  %s," % ("%s_Remap" % name if charset is not None else "NULL"))
+        parts.append("  1, /* Packed */")
+        parts.append("};")
+        parts.append("")
+        report.append("  %-7s %3d glyphs %6d -> %5d bytes" % (name, len(glyphs), full, subset))
+
+    parts.append("#endif /* FONT_SUBSET */")
+    parts.append("")
+    report.insert(0, "font_subset: font tables %d -> %d bytes of flash" % (total_full, total_subset))
+    return "\r\n".join(parts), report
+
+
+def is_current(project, text):
+    out = os.path.join(project, "src", OUTPUT)
+    if not os.path.exists(out):
+        return False
+    with open(out, "rb") as f:
+        return f.read().decode("utf-8") == text
+
+
+def check(project):
+    """True if src/font_subset.cpp matches the sources."""
+    text, report = generate(project)
+    if not is_current(project, text):
+        print("font_subset: src/%s is out of date with the text drawn in src/;" % OUTPUT)
+        print("font_subset: run \"python tools/font_subset.py\" and commit the result")
+        return False
+    print("\n".join(report))
+    return True
+
+
+def update(project):
+    text, report = generate(project)
+    if not is_current(project, text):
+        with open(os.path.join(project, "src", OUTPUT), "wb") as f:
+            f.write(text.encode("utf-8"))
+        print("font_subset: wrote src/%s" % OUTPUT)
+    print("\n".join(report))
+
+
+try:
+    Import("env")  # noqa: F821 (PlatformIO/SCons)
+    if not check(env.subst("$PROJECT_DIR")):  # noqa: F821
+        env.Exit(1)  # noqa: F821
+except NameError:
+    if __name__ == "__main__":
+        root = os.path.dirname(os.path.dirname(os.path.abspath(__file__)))
+        if sys.argv[1:] == ["--check"]:
+            sys.exit(0 if check(root) else 1)
+        update(root)
@@ -0,0 +1,121 @@
+"""Build assets.bin, the archive flashed to the "assets" partition.
+
+Contents:
+  font/<w>x<h>               Font8..Font24, full ASCII, glyph rows bit-packed
+  image/70x70, image/pic1    RGB565 bitmaps from src/image.cpp
+  web/index.html             the settings page from src/WebServer.h
+
+The header carries the page version (PAGE_VERSION in src/WebServer.h); the
+firmware serves the archived page only when its own PAGE_VERSION matches,
+so an archive packed for other firmware falls back to the built-in page.
+
+The format is described in src/AssetStore.h. Flash the result with
+esptool at the offset of the assets partition in partitions.csv:
+
+  python tools/pack_assets.py -o assets.bin
+  esptool.py --chip esp32s3 write_flash 0x310000 assets.bin
+"""
+
+import argparse
+import os
+import re
+import struct
+import sys
+import time
+import zlib
+
+sys.path.insert(0, os.path.dirname(os.path.abspath(__file__)))
+import font_subset  # noqa: E402
+
+FORMAT = 1
+MAGIC = b"JGAS"
+HEADER_SIZE = 32
+ENTRY = struct.Struct("<24sIIHH")
+FONT = struct.Struct("<HHBBH")
+PARTITION_SIZE = 0x40000
+
+IMAGES = [("image/70x70", "gImage_70X70"), ("image/pic1", "gImage_pic1")]
+
+
+def fonts(src):
+    out = []
+    for name, file, symbol, _ in font_subset.FONTS:
+        path = os.path.join(src, file)
+        text = font_subset.read(path)
+        width = int(re.search(r"(\d+),\s*/\*\s*Width", text).group(1))
+        height = int(re.search(r"(\d+),\s*/\*\s*Height", text).group(1))
+        table = font_subset.load_table(path, symbol)
+        glyphs = list(range(font_subset.FIRST, font_subset.LAST + 1))
+        packed = font_subset.pack(table, width, height, glyphs)
+        out.append(("font/%dx%d" % (width, height), FONT.pack(width, height, 1, 0, len(glyphs)) + bytes(packed), 0, 0))
+    return out
+
+
+def images(src):
+    text = font_subset.read(os.path.join(src, "image.cpp"))
+    out = []
+    for name, symbol in IMAGES:
+        match = re.search(symbol + r"\[\d*\]\s*=\s*\{\s*/\*([^*]*)\*/(.*?)\};", text, re.S)
+        if not match:
+            sys.exit("pack_assets: %s not found in image.cpp" % symbol)
+        info = [int(v, 16) for v in re.findall(r"0[xX]([0-9A-Fa-f]{2})", match.group(1))]
+        width, height = info[2] | info[3] << 8, info[4] | info[5] << 8
+        data = bytes(int(v, 16) for v in re.findall(r"0[xX]([0-9A-Fa-f]{2})", match.group(2)))
+        if len(data) != width * height * 2:
+            sys.exit("pack_assets: %s is %d bytes, expected %dx%d" % (symbol, len(data), width, height))
+        out.append((name, data, width, height))
+    return out
+
+
+def web(src):
+    """The settings page entry, and its PAGE_VERSION."""
+    text = font_subset.read(os.path.join(src, "WebServer.h"))
+    match = re.search(r'R"rawliteral\(\n(.*?)\)rawliteral"', text, re.S)
+    if not match:
+        sys.exit("pack_assets: settings page not found in WebServer.h")
+    version = re.search(r"\bPAGE_VERSION\s*=\s*(\d+)", text)
+    if not version:
+        sys.exit("pack_assets: PAGE_VERSION not found in WebServer.h")
+    return [("web/index.html", match.group(1).encode("utf-8"), 0, 0)], int(version.group(1))
+
+
+def build(items, version, page_version):
+    table_end = HEADER_SIZE + len(items) * ENTRY.size
+    offset = (table_end + 3) & ~3
+    entries, data = b"", b""
+    for name, blob, width, height in items:
+        if len(name) >= 24:
+            sys.exit("pack_assets: name too long: " + name)
+        entries += ENTRY.pack(name.encode(), offset + len(data), len(blob), width, height)
+        data += blob + b"\0" * (-len(blob) % 4)
+    body = entries + b"\0" * (offset - table_end) + data
+    size = HEADER_SIZE + len(body)
+    header = struct.pack("<4sHHIIII8x", MAGIC, FORMAT, len(items), version, size, zlib.crc32(body), page_version)
+    return header + body
+
+
+def main():
+    project = os.path.dirname(os.path.dirname(os.path.abspath(__file__)))
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("-o", "--output", default="assets.bin")
+    parser.add_argument("--version", type=int, default=int(time.strftime("%Y%m%d")),
+                        help="content version stored in the header (default: today, YYYYMMDD)")
+    args = parser.parse_args()
+
+    src = os.path.join(project, "src")
+    page, page_version = web(src)
+    items = fonts(src) + images(src) + page
+    archive = build(items, args.version, page_version)
+    if len(archive) > PARTITION_SIZE:
+        sys.exit("pack_assets: %d bytes do not fit the %d byte partition" % (len(archive), PARTITION_SIZE))
+    with open(args.output, "wb") as f:
+        f.write(archive)
+
+    print("pack_assets: %s, version %d, page version %d, %d bytes"
+          % (args.output, args.version, page_version, len(archive)))
+    for name, blob, width, height in items:
+        print("  %-16s %6d bytes%s" % (name, len(blob), " %dx%d" % (width, height) if width else ""))
+
+
+if __name__ == "__main__":
+    main()